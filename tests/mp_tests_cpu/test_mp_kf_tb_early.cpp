@@ -0,0 +1,236 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+
+/*  
+ *  Test of the MultiPipe construct with KF, time-based windows with early firing and
+ *  DETERMINISTIC mode. The Sink checks that the final results are the same of the case
+ *  without early firing, and it counts the early results received before them.
+ *  
+ *  +-----+   +-----+   +-----+   +-------+   +-----+
+ *  |  S  |   |  F  |   |  M  |   | KF_TB |   |  S  |
+ *  | (1) +-->+ (*) +-->+ (*) +-->+  (*)  +-->+ (1) |
+ *  +-----+   +-----+   +-----+   +-------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variables for the results
+long final_sum;
+size_t early_received;
+
+// struct of the output data type (marked as early or final)
+struct early_output_t
+{
+    size_t key;
+    uint64_t id;
+    uint64_t ts;
+    int64_t value;
+    bool early;
+
+    // default constructor
+    early_output_t():
+                   key(0),
+                   id(0),
+                   ts(0),
+                   value(0),
+                   early(false) {}
+
+    // getControlFields method
+    tuple<size_t, uint64_t, uint64_t> getControlFields() const
+    {
+        return tuple<size_t, uint64_t, uint64_t>(key, id, ts);
+    }
+
+    // setControlFields method
+    void setControlFields(size_t _key, uint64_t _id, uint64_t _ts)
+    {
+        key = _key;
+        id = _id;
+        ts = _ts;
+    }
+
+    // setEarly method
+    void setEarly(bool _early)
+    {
+        early = _early;
+    }
+};
+
+// Key_Farm function (non-incremental)
+void kf_early_function(size_t, const Iterable<tuple_t> &input, early_output_t &result) {
+    long sum = 0;
+    for (auto t : input) {
+        sum += t.value;
+    }
+    result.value = sum;
+};
+
+// sink functor separating early and final results
+class Early_Sink_Functor
+{
+private:
+    size_t n_final; // counter of received final results
+    size_t n_early; // counter of received early results
+    long totalsum; // sum of the final results
+
+public:
+    // constructor
+    Early_Sink_Functor():
+                       n_final(0),
+                       n_early(0),
+                       totalsum(0) {}
+
+    // operator()
+    void operator()(optional<early_output_t> &out)
+    {
+        if (out) {
+            if ((*out).early) {
+                n_early++;
+            }
+            else {
+                n_final++;
+                totalsum += (*out).value;
+            }
+        }
+        else {
+            cout << "Received " << n_final << " final results (total sum " << totalsum << ") and " << n_early << " early results" << endl;
+            final_sum = totalsum;
+            early_received = n_early;
+        }
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    size_t early_interval = 1000;
+    // arguments from command line
+    if (argc != 13) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec] -e [early interval usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:e:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            case 'e': early_interval = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec] -e [early interval usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int filter_degree, map_degree, kf_degree;
+    size_t source_degree = 1;
+    long last_result = 0;
+    // executes the runs (the first one without early firing)
+    for (size_t i=0; i<runs; i++) {
+        filter_degree = dist6(rng);
+        map_degree = dist6(rng);
+        kf_degree = dist6(rng);
+        cout << "Run " << i << endl;
+        cout << "+-----+   +-----+   +-----+   +-------+   +-----+" << endl;
+        cout << "|  S  |   |  F  |   |  M  |   | KF_TB |   |  S  |" << endl;
+        cout << "| (" << source_degree << ") +-->+ (" << filter_degree << ") +-->+ (" << map_degree << ") +-->+  (" << kf_degree << ")  +-->+ (1) |" << endl;
+        cout << "+-----+   +-----+   +-----+   +-------+   +-----+" << endl;
+        // prepare the test
+        PipeGraph graph("test_kf_tb_early", Mode::DETERMINISTIC);
+        // source
+        Source_Functor source_functor(stream_len, n_keys);
+        Source source = Source_Builder(source_functor)
+                            .withName("source")
+                            .withParallelism(source_degree)
+                            .build();
+        MultiPipe &mp = graph.add_source(source);
+        // filter
+        Filter_Functor filter_functor;
+        Filter filter = Filter_Builder(filter_functor)
+                            .withName("filter")
+                            .withParallelism(filter_degree)
+                            .build();
+        mp.chain(filter);
+        // map
+        Map_Functor map_functor;
+        Map map = Map_Builder(map_functor)
+                        .withName("map")
+                        .withParallelism(map_degree)
+                        .build();
+        mp.chain(map);
+        // kf
+        Key_Farm kf = KeyFarm_Builder(kf_early_function)
+                            .withName("kf")
+                            .withParallelism(kf_degree)
+                            .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                            .withEarlyFiring(microseconds((i == 0) ? 0 : early_interval))
+                            .build();
+        mp.add(kf);
+        // sink
+        Early_Sink_Functor sink_functor;
+        Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+        mp.chain_sink(sink);
+        // run the application
+        graph.run();
+        if (i == 0) {
+            last_result = final_sum;
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            if (last_result == final_sum) {
+                cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+            }
+            else {
+                cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,175 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test of the elastic Key_Farm with time-based windows in DEFAULT mode. The first
+ *  application runs with a fixed parallelism and it is the reference, the second one
+ *  starts with one replica out of the maximum parallelism, and a controller thread
+ *  changes the number of active replicas at random while the stream is processed
+ *  (the key groups are migrated with their windows). Both the results and the number
+ *  of parallelism changes and key-group migrations are reported.
+ *  
+ *  +-----+   +-------+   +-----+
+ *  |  S  |   | KF_TB |   |  S  |
+ *  | (1) +-->+  (*)  +-->+ (1) |
+ *  +-----+   +-------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<thread>
+#include<atomic>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 2;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int kf_degree;
+    size_t source_degree = 1;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        kf_degree = dist6(rng);
+        cout << "Run " << i << " (maximum parallelism " << kf_degree << ")" << endl;
+        // first application with a fixed parallelism
+        long base_result = 0;
+        {
+            PipeGraph graph("test_kf_tb_elastic_base", Mode::DEFAULT);
+            Source_Functor source_functor(stream_len, n_keys);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Key_Farm kf = KeyFarm_Builder(kf_function)
+                                .withName("kf")
+                                .withParallelism(kf_degree)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .build();
+            mp.add(kf);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            graph.run();
+            base_result = global_sum;
+        }
+        // second application with elastic replicas
+        long elastic_result = 0;
+        uint64_t changes = 0;
+        uint64_t migrations = 0;
+        {
+            PipeGraph graph("test_kf_tb_elastic", Mode::DEFAULT);
+            Source_Functor source_functor(stream_len, n_keys);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Key_Farm kf = KeyFarm_Builder(kf_function)
+                                .withName("kf")
+                                .withParallelism(1)
+                                .withElasticity(kf_degree)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .build();
+            mp.add(kf);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            // controller thread changing the number of active replicas
+            auto controller = kf.getElasticController();
+            atomic<bool> done(false);
+            thread driver([&]() {
+                mt19937 rng_driver(i);
+                std::uniform_int_distribution<std::mt19937::result_type> dist_par(1, kf_degree);
+                while (!done.load()) {
+                    size_t n = dist_par(rng_driver);
+                    if (n != controller->getParallelism()) {
+                        controller->setParallelism(n);
+                        changes++;
+                    }
+                    this_thread::sleep_for(milliseconds(5));
+                }
+            });
+            graph.run();
+            done.store(true);
+            driver.join();
+            elastic_result = global_sum;
+            migrations = kf.getKeyGroupManager()->getNumMigrations();
+        }
+        cout << "Elastic KF changed parallelism " << changes << " times with " << migrations << " key-group migrations" << endl;
+        if (base_result == elastic_result) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,206 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test of the hot-key splitting of the Key_Farm with time-based windows on a stream
+ *  whose keys follow a Zipf distribution (exponent 1.2) in DETERMINISTIC mode. The
+ *  first application runs without splitting and it is the reference, the second one
+ *  spreads the tuples of the hot keys over several replicas. Both the results and the
+ *  execution times of the two applications are reported.
+ *  
+ *  +-----+   +-------+   +-----+
+ *  |  S  |   | KF_TB |   |  S  |
+ *  | (1) +-->+  (*)  +-->+ (1) |
+ *  +-----+   +-------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// source functor generating a stream with Zipf-distributed keys
+class Zipf_Source_Functor
+{
+private:
+    size_t len; // total stream length
+    size_t sent;
+    vector<double> cdf; // cumulative distribution of the keys
+    vector<uint64_t> ids;
+    uint64_t next_ts;
+
+public:
+    // Constructor
+    Zipf_Source_Functor(size_t _len,
+                        size_t _keys,
+                        double _exponent):
+                        len(_len),
+                        sent(0),
+                        ids(_keys, 0),
+                        next_ts(0)
+    {
+        double sum = 0;
+        for (size_t k=1; k<=_keys; k++) {
+            sum += 1.0 / pow(k, _exponent);
+            cdf.push_back(sum);
+        }
+        for (auto &p: cdf) {
+            p /= sum;
+        }
+        srand(0);
+    }
+
+    bool operator()(tuple_t &t)
+    {
+        double u = ((double) random()) / RAND_MAX;
+        size_t k = lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+        if (k >= ids.size()) {
+            k = ids.size() - 1;
+        }
+        t.setControlFields(k, ids[k], next_ts);
+        t.value = ids[k]++;
+        sent++;
+        double x = (1000 * 0.05) / 1.05;
+        next_ts += ceil(pareto(1.05, x));
+        return (sent < len);
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 2;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int kf_degree, split_degree;
+    size_t source_degree = 1;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        kf_degree = dist6(rng);
+        split_degree = 2 + (dist6(rng) % (kf_degree - 1));
+        cout << "Run " << i << " (Zipf 1.2, parallelism " << kf_degree << ", split degree " << split_degree << ")" << endl;
+        // first application without hot-key splitting
+        long base_result = 0;
+        double base_time = 0;
+        {
+            PipeGraph graph("test_kf_tb_hotkeys_base", Mode::DETERMINISTIC);
+            Zipf_Source_Functor source_functor(stream_len, n_keys, 1.2);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Key_Farm kf = KeyFarm_Builder(kf_function)
+                                .withName("kf")
+                                .withParallelism(kf_degree)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .build();
+            mp.add(kf);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            auto start = steady_clock::now();
+            graph.run();
+            base_time = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+            base_result = global_sum;
+        }
+        // second application with hot-key splitting
+        long split_result = 0;
+        double split_time = 0;
+        {
+            PipeGraph graph("test_kf_tb_hotkeys_split", Mode::DETERMINISTIC);
+            Zipf_Source_Functor source_functor(stream_len, n_keys, 1.2);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Key_Farm kf = KeyFarm_Builder(kf_function)
+                                .withName("kf")
+                                .withParallelism(kf_degree)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .withHotKeySplitting(combineFunction, split_degree)
+                                .build();
+            mp.add(kf);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            auto start = steady_clock::now();
+            graph.run();
+            split_time = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+            split_result = global_sum;
+        }
+        cout << "KF time " << base_time << " ms, KF with hot-key splitting time " << split_time << " ms" << endl;
+        if (base_result == split_result) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,310 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/*  
+ *  Test of the live migration of key groups of the Key_Farm while one of its upstream Sources
+ *  is idle (DEFAULT mode with watermarks). The second Source generates a few tuples of all the
+ *  keys and then it stays idle until the first one has terminated, while the first Source
+ *  generates a stream with Zipf-distributed keys (exponent 1.2) triggering the migrations. The
+ *  emitter of the idle Source must release the migrated key groups, otherwise their windows
+ *  are not fired until its termination. The first Source waits for all the results of the
+ *  application without key groups before terminating.
+ *  
+ *  +-----+
+ *  |  S  +--+
+ *  | (1) |  |   +-------+   +-----+
+ *  +-----+  +-->+ KF_TB |   |  S  |
+ *  +-----+  |   |  (*)  +-->+ (1) |
+ *  |  S  +--+   +-------+   +-----+
+ *  | (1) |
+ *  +-----+
+ */ 
+
+// includes
+#include<string>
+#include<atomic>
+#include<thread>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variables
+extern long global_sum;
+atomic<long> running_sum; // sum of the results received by the Sink so far
+atomic<long> expected_sum; // result of the application without key groups (zero if unknown)
+atomic<bool> idle_started; // true when the second Source is idle
+atomic<bool> active_ended; // true when the first Source has terminated
+long early_sum; // sum of the results received before the termination of the first Source
+
+// idle timeout of the Sources (in microseconds)
+#define IDLE_TIMEOUT 10000
+
+// maximum wall-clock time waited by the first Source for the results (in microseconds)
+#define MAX_WAIT 5000000
+
+// functor of the first Source generating a stream with Zipf-distributed keys
+class Zipf_Source_Functor
+{
+private:
+    size_t len; // total stream length
+    size_t sent;
+    vector<double> cdf; // cumulative distribution of the keys
+    vector<uint64_t> ids;
+    uint64_t next_ts;
+    uint64_t win_len; // window length (the last watermark closes all the windows)
+    uint64_t wait_start; // wall-clock time when the Source has started to wait for the results
+
+public:
+    // Constructor
+    Zipf_Source_Functor(size_t _len,
+                        size_t _keys,
+                        double _exponent,
+                        uint64_t _start_ts,
+                        uint64_t _win_len):
+                        len(_len),
+                        sent(0),
+                        ids(_keys, 0),
+                        next_ts(_start_ts),
+                        win_len(_win_len),
+                        wait_start(0)
+    {
+        double sum = 0;
+        for (size_t k=1; k<=_keys; k++) {
+            sum += 1.0 / pow(k, _exponent);
+            cdf.push_back(sum);
+        }
+        for (auto &p: cdf) {
+            p /= sum;
+        }
+        srand(0);
+    }
+
+    bool operator()(Shipper<tuple_t> &shipper)
+    {
+        // the stream starts when the second Source is idle
+        if (!idle_started.load()) {
+            this_thread::sleep_for(milliseconds(1));
+            return true;
+        }
+        if (sent < len) {
+            double u = ((double) random()) / RAND_MAX;
+            size_t k = lower_bound(cdf.begin(), cdf.end(), u) - cdf.begin();
+            if (k >= ids.size()) {
+                k = ids.size() - 1;
+            }
+            tuple_t t;
+            t.setControlFields(k, ids[k], next_ts);
+            t.value = ids[k]++;
+            shipper.push(t);
+            sent++;
+            double x = (1000 * 0.05) / 1.05;
+            next_ts += ceil(pareto(1.05, x));
+            if (sent == len) {
+                shipper.pushWatermark(next_ts + win_len);
+            }
+            return true;
+        }
+        // the stream is over: the Source waits for the results (the idle Source is still running)
+        if (wait_start == 0) {
+            wait_start = current_time_usecs();
+        }
+        long expected = expected_sum.load();
+        if (expected != 0 && running_sum.load() != expected && current_time_usecs() - wait_start < MAX_WAIT) {
+            this_thread::sleep_for(milliseconds(1));
+            return true;
+        }
+        early_sum = running_sum.load();
+        active_ended.store(true);
+        return false;
+    }
+};
+
+// functor of the second Source (a few tuples of all the keys, then idle until the first Source has terminated)
+class Idle_Source_Functor
+{
+private:
+    size_t len; // number of tuples per key
+    size_t keys; // number of keys
+    size_t k;
+    size_t sent;
+    uint64_t next_ts;
+
+public:
+    // Constructor
+    Idle_Source_Functor(size_t _len,
+                        size_t _keys):
+                        len(_len),
+                        keys(_keys),
+                        k(0),
+                        sent(0),
+                        next_ts(0) {}
+
+    bool operator()(Shipper<tuple_t> &shipper)
+    {
+        if (sent < len*keys) {
+            tuple_t t;
+            t.setControlFields(k, sent / keys, next_ts);
+            t.value = 1;
+            shipper.push(t);
+            sent++;
+            k = (k+1) % keys;
+            next_ts += 10;
+            return true;
+        }
+        idle_started.store(true);
+        if (!active_ended.load()) {
+            this_thread::sleep_for(milliseconds(1));
+            return true;
+        }
+        return false;
+    }
+};
+
+// sink functor updating the running sum of the results
+class Running_Sink_Functor
+{
+private:
+    long totalsum;
+
+public:
+    // constructor
+    Running_Sink_Functor(): totalsum(0) {}
+
+    // operator()
+    void operator()(optional<output_t> &out)
+    {
+        if (out) {
+            totalsum += (*out).value;
+            running_sum.store(totalsum);
+        }
+        else {
+            global_sum = totalsum;
+        }
+    }
+};
+
+// run the application (with key groups if _n_groups is not zero), returns the number of migrations
+size_t run_app(size_t _kf_degree, size_t _n_groups, size_t _stream_len, size_t _n_keys, size_t _win_len, size_t _win_slide)
+{
+    running_sum = 0;
+    idle_started = false;
+    active_ended = false;
+    PipeGraph graph("test_kf_tb_keygroups_idle");
+    Idle_Source_Functor source_functor2(10, _n_keys);
+    Source source2 = Source_Builder(source_functor2)
+                        .withName("source2")
+                        .withParallelism(1)
+                        .withWatermarks(_win_slide, 0, IDLE_TIMEOUT)
+                        .build();
+    MultiPipe &mp2 = graph.add_source(source2);
+    Zipf_Source_Functor source_functor1(_stream_len, _n_keys, 1.2, 10 * _n_keys * 10, _win_len);
+    Source source1 = Source_Builder(source_functor1)
+                        .withName("source1")
+                        .withParallelism(1)
+                        .withWatermarks(_win_slide, 0, IDLE_TIMEOUT)
+                        .build();
+    MultiPipe &mp1 = graph.add_source(source1);
+    MultiPipe &mp = mp1.merge(mp2);
+    KeyFarm_Builder builder(kf_function);
+    builder.withName("kf")
+           .withParallelism(_kf_degree)
+           .withTBWindows(microseconds(_win_len), microseconds(_win_slide), /* delay */ seconds(1)); // huge delay, the windows are fired by the watermarks
+    if (_n_groups > 0) {
+        builder.withKeyGroups(_n_groups, milliseconds(1), 0.1);
+    }
+    Key_Farm kf = builder.build();
+    mp.add(kf);
+    Running_Sink_Functor sink_functor;
+    Sink sink = Sink_Builder(sink_functor)
+                    .withName("sink")
+                    .withParallelism(1)
+                    .build();
+    mp.chain_sink(sink);
+    graph.run();
+    return (_n_groups > 0) ? kf.getKeyGroupManager()->getNumMigrations() : 0;
+}
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 2;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int kf_degree;
+    size_t n_groups = 64;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        kf_degree = dist6(rng);
+        cout << "Run " << i << " (Zipf 1.2, parallelism " << kf_degree << ", key groups " << n_groups << ")" << endl;
+        // first application without key groups
+        expected_sum = 0;
+        run_app(kf_degree, 0, stream_len, n_keys, win_len, win_slide);
+        long base_result = global_sum;
+        // second application with the migration of key groups
+        expected_sum = base_result;
+        size_t migrations = run_app(kf_degree, n_groups, stream_len, n_keys, win_len, win_slide);
+        long kg_result = global_sum;
+        cout << "Migrations " << migrations << ", results before the termination of the first Source " << early_sum << " (expected " << base_result << ")" << endl;
+        if (base_result == kg_result && early_sum == base_result) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,178 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test of the merging of sessions with KS (incremental function with a combine function)
+ *  and DEFAULT mode. For each key, the Source generates a tuple opening a session, a tuple
+ *  opening a second session after the gap, and then a tuple received out-of-order that
+ *  fills the gap between the two. The KS must produce a single session with the three
+ *  tuples, so the number of results is stream_length * n_keys and each result is 3.
+ *  
+ *  +-----+   +---------+   +-----+
+ *  |  S  |   |   KS    |   |  S  |
+ *  | (1) +-->+   (*)   +-->+ (1) |
+ *  +-----+   +---------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variables for the result
+extern long global_sum;
+extern long global_received;
+
+// source functor generating the tuples bridging two sessions of each key
+class Bridge_Source_Functor
+{
+private:
+    size_t len; // number of sessions per key
+    size_t keys; // number of keys
+    uint64_t gap; // session gap in time units
+    size_t sent; // number of sessions generated so far
+
+public:
+    // Constructor
+    Bridge_Source_Functor(size_t _len,
+                          size_t _keys,
+                          uint64_t _gap):
+                          len(_len),
+                          keys(_keys),
+                          gap(_gap),
+                          sent(0) {}
+
+    bool operator()(Shipper<tuple_t> &shipper)
+    {
+        // the sessions of the same key are 10 gaps apart
+        uint64_t base = (sent / keys) * 10 * gap;
+        size_t key = sent % keys;
+        // first session, second session after the gap, and the out-of-order tuple bridging them
+        shipper.push(tuple_t(key, 0, base, 1));
+        shipper.push(tuple_t(key, 1, base + gap + (gap / 2), 1));
+        shipper.push(tuple_t(key, 2, base + (gap / 2) + 1, 1));
+        sent++;
+        return (sent < len * keys);
+    }
+};
+
+// Key_Session function (incremental)
+void ks_update(uint64_t, const tuple_t &t, output_t &result)
+{
+    result.value += t.value;
+}
+
+// combine function of the partial results of two merged sessions
+void ks_combine(const output_t &r1, const output_t &r2, output_t &result)
+{
+    result.value = r1.value + r2.value;
+}
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t gap = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 9) {
+        cout << argv[0] << " -r [runs] -l [sessions per key] -k [n_keys] -s [session gap usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 's': gap = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [sessions per key] -k [n_keys] -s [session gap usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    if (gap < 3) {
+        cout << "The session gap must be at least 3 usec" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int ks_degree;
+    size_t source_degree = 1;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        ks_degree = dist6(rng);
+        cout << "Run " << i << endl;
+        cout << "+-----+   +---------+   +-----+" << endl;
+        cout << "|  S  |   |   KS    |   |  S  |" << endl;
+        cout << "| (" << source_degree << ") +-->+   (" << ks_degree << ")   +-->+ (1) |" << endl;
+        cout << "+-----+   +---------+   +-----+" << endl;
+        // prepare the test
+        PipeGraph graph("test_ks_tb_bridge", Mode::DEFAULT);
+        // source
+        Bridge_Source_Functor source_functor(stream_len, n_keys, gap);
+        Source source = Source_Builder(source_functor)
+                            .withName("source")
+                            .withParallelism(source_degree)
+                            .build();
+        MultiPipe &mp = graph.add_source(source);
+        // ks with sessions closed by a gap of gap usec (the triggering delay covers the out-of-order tuples)
+        Key_Session ks = KeySession_Builder(ks_update)
+                                .withCombine(ks_combine)
+                                .withGap(microseconds(gap))
+                                .withTriggeringDelay(microseconds(2 * gap))
+                                .withParallelism(ks_degree)
+                                .withName("ks")
+                                .build();
+        mp.add(ks);
+        // sink
+        Sink_Functor sink_functor(n_keys);
+        Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+        mp.chain_sink(sink);
+        // run the application
+        graph.run();
+        if (global_received == (long) (stream_len * n_keys) && global_sum == (long) (3 * stream_len * n_keys)) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
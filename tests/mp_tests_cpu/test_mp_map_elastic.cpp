@@ -0,0 +1,161 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/*  
+ *  Test of the elastic Map and Sink operators in DEFAULT mode. A controller thread changes
+ *  the number of active replicas of both the operators at random while the stream is
+ *  processed, so the replicas are parked (and they sleep once their input channels are
+ *  idle) and then activated again. The result must be the same of the non-elastic case.
+ *  
+ *  +-----+   +-----+   +-----+
+ *  |  S  |   |  M  |   |  S  |
+ *  | (*) +-->+ (*) +-->+ (*) |
+ *  +-----+   +-----+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<thread>
+#include<atomic>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variables
+atomic<long> elastic_sum; // sum of the tuples received by all the replicas of the Sink
+
+// sink functor summing the received tuples
+class Sum_Sink_Functor
+{
+public:
+    // operator()
+    void operator()(optional<tuple_t> &t)
+    {
+        if (t) {
+            elastic_sum += (*t).value;
+        }
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t n_keys = 1;
+    // arguments from command line
+    if (argc != 7) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 2;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int source_degree, map_degree, sink_degree;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        source_degree = dist6(rng);
+        map_degree = dist6(rng);
+        sink_degree = dist6(rng);
+        elastic_sum = 0;
+        cout << "Run " << i << " (maximum parallelism of the Map " << map_degree << ", of the Sink " << sink_degree << ")" << endl;
+        cout << "+-----+   +-----+   +-----+" << endl;
+        cout << "|  S  |   |  M  |   |  S  |" << endl;
+        cout << "| (" << source_degree << ") +-->+ (" << map_degree << ") +-->+ (" << sink_degree << ") |" << endl;
+        cout << "+-----+   +-----+   +-----+" << endl;
+        // prepare the test
+        PipeGraph graph("test_map_elastic", Mode::DEFAULT);
+        // source
+        Source_Functor source_functor(stream_len, n_keys);
+        Source source = Source_Builder(source_functor)
+                            .withName("source")
+                            .withParallelism(source_degree)
+                            .withWatermarks(1000)
+                            .build();
+        MultiPipe &mp = graph.add_source(source);
+        // map
+        Map_Functor map_functor;
+        Map map = Map_Builder(map_functor)
+                        .withName("map")
+                        .withParallelism(1)
+                        .withElasticity(map_degree)
+                        .build();
+        mp.add(map);
+        // sink
+        Sum_Sink_Functor sink_functor;
+        Sink sink = Sink_Builder(sink_functor)
+                        .withName("sink")
+                        .withParallelism(1)
+                        .withElasticity(sink_degree)
+                        .build();
+        mp.add_sink(sink);
+        // controller thread changing the number of active replicas
+        auto map_controller = map.getElasticController();
+        auto sink_controller = sink.getElasticController();
+        atomic<bool> done(false);
+        uint64_t changes = 0;
+        thread driver([&]() {
+            mt19937 rng_driver(i);
+            std::uniform_int_distribution<std::mt19937::result_type> dist_map(1, map_degree);
+            std::uniform_int_distribution<std::mt19937::result_type> dist_sink(1, sink_degree);
+            while (!done.load()) {
+                map_controller->setParallelism(dist_map(rng_driver));
+                sink_controller->setParallelism(dist_sink(rng_driver));
+                changes++;
+                this_thread::sleep_for(milliseconds(5));
+            }
+        });
+        // run the application
+        graph.run();
+        done.store(true);
+        driver.join();
+        // each key generates the values from 0 to stream_len-1 in each Source replica, doubled by the Map
+        long expected_sum = 2 * source_degree * n_keys * (stream_len * (stream_len - 1) / 2);
+        cout << "Elastic Map and Sink changed parallelism " << changes << " times, total sum " << elastic_sum << " (expected " << expected_sum << ")" << endl;
+        if (elastic_sum == expected_sum) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
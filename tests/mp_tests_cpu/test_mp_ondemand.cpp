@@ -0,0 +1,238 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+
+/*  
+ *  Test of the on-demand scheduling of a Map whose inputs have a bimodal processing
+ *  cost (most inputs are cheap, one every COST_PERIOD is expensive). The source emits
+ *  the inputs at a rate sustaining about 70% of the capacity of the Map replicas. The
+ *  first application uses the pseudo round-robin distribution and it is the reference,
+ *  the second one the on-demand scheduling. Both the results and the latency of the
+ *  inputs (median and 99th percentile) of the two applications are reported.
+ *  
+ *  +-----+   +-----+   +-----+
+ *  |  S  |   |  M  |   |  S  |
+ *  | (1) +-->+ (*) +-->+ (1) |
+ *  +-----+   +-----+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<vector>
+#include<iostream>
+#include<random>
+#include<algorithm>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// processing cost of the cheap and of the expensive inputs (in nanoseconds)
+#define CHEAP_COST 2000
+#define EXPENSIVE_COST 400000
+// one input every COST_PERIOD is expensive
+#define COST_PERIOD 64
+
+// global variables for the results
+extern long global_sum;
+double global_p50 = 0;
+double global_p99 = 0;
+
+// busy waiting for the given number of nanoseconds
+void busy_wait(uint64_t nsecs)
+{
+    uint64_t start = current_time_nsecs();
+    while (current_time_nsecs() - start < nsecs);
+}
+
+// source functor generating the inputs at a fixed rate (the timestamp is the generation time)
+class Paced_Source_Functor
+{
+private:
+    size_t len; // stream length per key
+    size_t keys; // number of keys
+    uint64_t gap; // time between two inputs (in nanoseconds)
+    size_t k;
+    size_t sent;
+    vector<uint64_t> ids;
+    uint64_t next_time;
+
+public:
+    // Constructor
+    Paced_Source_Functor(size_t _len,
+                         size_t _keys,
+                         uint64_t _gap):
+                         len(_len),
+                         keys(_keys),
+                         gap(_gap),
+                         k(0),
+                         sent(0),
+                         ids(_keys, 0),
+                         next_time(0) {}
+
+    bool operator()(tuple_t &t)
+    {
+        if (next_time == 0) {
+            next_time = current_time_nsecs();
+        }
+        while (current_time_nsecs() < next_time);
+        next_time += gap;
+        t.setControlFields(k, ids[k], current_time_usecs());
+        t.value = ids[k]++;
+        sent++;
+        k = (k+1) % keys;
+        return (sent < len*keys);
+    }
+};
+
+// map functor with a bimodal processing cost
+class Costly_Map_Functor
+{
+public:
+    // operator()
+    void operator()(tuple_t &t)
+    {
+        busy_wait((t.value % COST_PERIOD == 0) ? EXPENSIVE_COST : CHEAP_COST);
+        t.value = t.value * 2;
+    }
+};
+
+// sink functor measuring the latency of the inputs
+class Latency_Sink_Functor
+{
+private:
+    long totalsum;
+    vector<uint64_t> latencies; // latencies of the inputs (in microseconds)
+
+public:
+    // constructor
+    Latency_Sink_Functor(): totalsum(0) {}
+
+    // operator()
+    void operator()(optional<tuple_t> &t)
+    {
+        if (t) {
+            totalsum += (*t).value;
+            latencies.push_back(current_time_usecs() - (*t).ts);
+        }
+        else {
+            sort(latencies.begin(), latencies.end());
+            global_sum = totalsum;
+            global_p50 = latencies.empty() ? 0 : latencies[latencies.size() / 2];
+            global_p99 = latencies.empty() ? 0 : latencies[(latencies.size() * 99) / 100];
+            cout << "Received " << latencies.size() << " tuples, total sum " << totalsum << endl;
+        }
+    }
+};
+
+// run the MultiPipe with or without the on-demand scheduling of the Map
+void run(bool ondemand, size_t stream_len, size_t n_keys, size_t map_degree)
+{
+    PipeGraph graph("test_ondemand", Mode::DEFAULT);
+    // the inputs are generated at about 70% of the capacity of the Map replicas
+    uint64_t avg_cost = ((COST_PERIOD - 1) * CHEAP_COST + EXPENSIVE_COST) / COST_PERIOD;
+    Paced_Source_Functor source_functor(stream_len, n_keys, avg_cost / (0.7 * map_degree));
+    Source source = Source_Builder(source_functor)
+                        .withName("source")
+                        .withParallelism(1)
+                        .build();
+    MultiPipe &mp = graph.add_source(source);
+    Costly_Map_Functor map_functor;
+    if (ondemand) {
+        Map map = Map_Builder(map_functor)
+                        .withName("map")
+                        .withParallelism(map_degree)
+                        .withOnDemandScheduling()
+                        .build();
+        mp.add(map);
+    }
+    else {
+        Map map = Map_Builder(map_functor)
+                        .withName("map")
+                        .withParallelism(map_degree)
+                        .build();
+        mp.add(map);
+    }
+    Latency_Sink_Functor sink_functor;
+    Sink sink = Sink_Builder(sink_functor)
+                    .withName("sink")
+                    .withParallelism(1)
+                    .build();
+    mp.add_sink(sink);
+    graph.run();
+}
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 7) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 2;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int map_degree;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        map_degree = dist6(rng);
+        cout << "Run " << i << " (Map parallelism " << map_degree << ")" << endl;
+        // first application with the pseudo round-robin distribution
+        run(false, stream_len, n_keys, map_degree);
+        long base_result = global_sum;
+        double base_p50 = global_p50;
+        double base_p99 = global_p99;
+        // second application with the on-demand scheduling
+        run(true, stream_len, n_keys, map_degree);
+        long ondemand_result = global_sum;
+        cout << "Latency (usec) round-robin p50 " << base_p50 << " p99 " << base_p99 << ", on-demand p50 " << global_p50 << " p99 " << global_p99 << endl;
+        if (base_result == ondemand_result) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
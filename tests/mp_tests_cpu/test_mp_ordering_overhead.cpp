@@ -0,0 +1,163 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test measuring the overhead of the DETERMINISTIC mode with respect to the DEFAULT
+ *  mode. The same MultiPipe is executed in both the modes. In DETERMINISTIC mode
+ *  each operator (and the sink) receives its inputs through an Ordering_Node merging
+ *  the streams coming from the replicas of the previous operator. Both the results
+ *  and the execution times of the two modes are reported.
+ *  
+ *  +-----+   +-----+   +------+   +-----+   +-----+
+ *  |  S  |   |  F  |   |  FM  |   |  M  |   |  S  |
+ *  | (1) +-->+ (*) +-->+  (*) +-->+ (*) +-->+ (1) |
+ *  +-----+   +-----+   +------+   +-----+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// sink functor receiving the tuples of the stream
+class Tuple_Sink_Functor
+{
+private:
+    size_t received; // counter of received tuples
+    long totalsum;
+
+public:
+    // constructor
+    Tuple_Sink_Functor(): received(0), totalsum(0) {}
+
+    // operator()
+    void operator()(optional<tuple_t> &t)
+    {
+        if (t) {
+            received++;
+            totalsum += (*t).value;
+        }
+        else {
+            cout << "Received " << received << " tuples, total sum " << totalsum << endl;
+            global_sum = totalsum;
+        }
+    }
+};
+
+// run the MultiPipe in the given mode and return its execution time in milliseconds
+double run_mode(Mode mode, size_t stream_len, size_t n_keys, size_t par_degree)
+{
+    PipeGraph graph("test_ordering_overhead", mode);
+    // source
+    Source_Functor source_functor(stream_len, n_keys);
+    Source source = Source_Builder(source_functor)
+                        .withName("source")
+                        .withParallelism(1)
+                        .build();
+    MultiPipe &mp = graph.add_source(source);
+    // filter
+    Filter_Functor filter_functor;
+    Filter filter = Filter_Builder(filter_functor)
+                        .withName("filter")
+                        .withParallelism(par_degree)
+                        .build();
+    mp.add(filter);
+    // flatmap
+    FlatMap_Functor flatmap_functor;
+    FlatMap flatmap = FlatMap_Builder(flatmap_functor)
+                            .withName("flatmap")
+                            .withParallelism(par_degree)
+                            .build();
+    mp.add(flatmap);
+    // map
+    Map_Functor map_functor;
+    Map map = Map_Builder(map_functor)
+                    .withName("map")
+                    .withParallelism(par_degree)
+                    .build();
+    mp.add(map);
+    // sink
+    Tuple_Sink_Functor sink_functor;
+    Sink sink = Sink_Builder(sink_functor)
+                        .withName("sink")
+                        .withParallelism(1)
+                        .build();
+    mp.add_sink(sink);
+    // run the application
+    auto start = steady_clock::now();
+    graph.run();
+    return duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+}
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t n_keys = 1;
+    size_t par_degree = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 9) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -p [parallelism]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:p:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'p': par_degree = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -p [parallelism]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        cout << "Run " << i << " (parallelism " << par_degree << ")" << endl;
+        double default_time = run_mode(Mode::DEFAULT, stream_len, n_keys, par_degree);
+        long default_result = global_sum;
+        double det_time = run_mode(Mode::DETERMINISTIC, stream_len, n_keys, par_degree);
+        long det_result = global_sum;
+        cout << "DEFAULT time " << default_time << " ms, DETERMINISTIC time " << det_time << " ms (overhead " << ((det_time - default_time) / default_time) * 100 << "%)" << endl;
+        if (default_result == det_result) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,167 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+
+/*  
+ *  Test of the partitioners of the key-based distribution with KF, time-based windows
+ *  and DETERMINISTIC mode. The Map (configured with keyBy) and the KF use the same
+ *  partitioner, which changes at each run (default routing, Hash_Partitioner,
+ *  JumpConsistent_Partitioner, Rendezvous_Partitioner and Range_Partitioner). The
+ *  result must be the same with all the partitioners.
+ *  
+ *  +-----+   +-----+   +-------+   +-----+
+ *  |  S  |   |  M  |   | KF_TB |   |  S  |
+ *  | (*) +-->+ (*) +-->+  (*)  +-->+ (1) |
+ *  +-----+   +-----+   +-------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int source_degree, map_degree, kf_degree;
+    long last_result = 0;
+    std::vector<std::string> names = {"default", "hash", "jump consistent", "rendezvous", "range"};
+    // executes the runs (with a different partitioner in each run)
+    for (size_t i=0; i<runs; i++) {
+        source_degree = dist6(rng);
+        map_degree = dist6(rng);
+        kf_degree = dist6(rng);
+        cout << "Run " << i << " (" << names[i % names.size()] << " partitioner)" << endl;
+        cout << "+-----+   +-----+   +-------+   +-----+" << endl;
+        cout << "|  S  |   |  M  |   | KF_TB |   |  S  |" << endl;
+        cout << "| (" << source_degree << ") +-->+ (" << map_degree << ") +-->+  (" << kf_degree << ")  +-->+ (1) |" << endl;
+        cout << "+-----+   +-----+   +-------+   +-----+" << endl;
+        // partitioner of the run (the range one splits the keys in equal parts)
+        std::function<size_t(size_t, size_t)> partitioner = default_routing;
+        switch (i % names.size()) {
+            case 1: partitioner = Hash_Partitioner(i);
+                    break;
+            case 2: partitioner = JumpConsistent_Partitioner(i);
+                    break;
+            case 3: partitioner = Rendezvous_Partitioner(i);
+                    break;
+            case 4: {
+                std::vector<size_t> splits;
+                for (size_t j=1; j<n_keys; j++) {
+                    splits.push_back(j);
+                }
+                partitioner = Range_Partitioner(splits);
+                break;
+            }
+        }
+        // prepare the test
+        PipeGraph graph("test_partitioners", Mode::DETERMINISTIC);
+        // source
+        Source_Functor source_functor(stream_len, n_keys);
+        Source source = Source_Builder(source_functor)
+                            .withName("source")
+                            .withParallelism(source_degree)
+                            .build();
+        MultiPipe &mp = graph.add_source(source);
+        // map
+        Map_Functor map_functor;
+        Map map = Map_Builder(map_functor)
+                        .withName("map")
+                        .withParallelism(map_degree)
+                        .enable_KeyBy()
+                        .withPartitioner(partitioner)
+                        .build();
+        mp.add(map);
+        // kf
+        Key_Farm kf = KeyFarm_Builder(kf_function)
+                            .withName("kf")
+                            .withParallelism(kf_degree)
+                            .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                            .withPartitioner(partitioner)
+                            .build();
+        mp.add(kf);
+        // sink
+        Sink_Functor sink_functor(n_keys);
+        Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+        mp.chain_sink(sink);
+        // run the application
+        graph.run();
+        if (i == 0) {
+            last_result = global_sum;
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            if (last_result == global_sum) {
+                cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+            }
+            else {
+                cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,185 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test of the placement of the replicas on the CPUs and NUMA nodes of the machine.
+ *  The same application is executed without placement (reference), with the COMPACT
+ *  and with the SPREAD policies, and the results must be the same. A last application
+ *  pins all the replicas of the Map on the CPU 0 and checks that each input is
+ *  processed on that CPU.
+ *  
+ *  +-----+   +-----+   +-------+   +-----+
+ *  |  S  |   |  M  |   | KF_TB |   |  S  |
+ *  | (*) +-->+ (*) +-->+  (*)  +-->+ (1) |
+ *  +-----+   +-----+   +-------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<atomic>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<sched.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// number of inputs processed by the Map outside the CPU where it is pinned
+atomic<size_t> wrong_cpu(0);
+
+// map functor checking the CPU where it is running
+class Pinned_Map_Functor
+{
+private:
+    int cpu; // CPU where the replicas are pinned
+
+public:
+    // constructor
+    Pinned_Map_Functor(int _cpu): cpu(_cpu) {}
+
+    // operator()
+    void operator()(tuple_t &t)
+    {
+        if (sched_getcpu() != cpu) {
+            wrong_cpu++;
+        }
+        t.value = t.value * 2;
+    }
+};
+
+// run the application with the given placement policy and CPUs of the Map
+template<typename map_functor_t>
+long run_app(Placement _placement,
+             map_functor_t _map_functor,
+             vector<int> _map_cpus,
+             size_t _stream_len,
+             size_t _n_keys,
+             size_t _win_len,
+             size_t _win_slide,
+             size_t _source_degree,
+             size_t _map_degree,
+             size_t _kf_degree)
+{
+    PipeGraph graph("test_placement", Mode::DETERMINISTIC, Slack_Policy(), _placement);
+    Source_Functor source_functor(_stream_len, _n_keys);
+    Source source = Source_Builder(source_functor)
+                        .withName("source")
+                        .withParallelism(_source_degree)
+                        .build();
+    MultiPipe &mp = graph.add_source(source);
+    Map map = Map_Builder(_map_functor)
+                    .withName("map")
+                    .withParallelism(_map_degree)
+                    .withCPUs(_map_cpus)
+                    .build();
+    mp.chain(map);
+    Key_Farm kf = KeyFarm_Builder(kf_function)
+                        .withName("kf")
+                        .withParallelism(_kf_degree)
+                        .withTBWindows(microseconds(_win_len), microseconds(_win_slide))
+                        .build();
+    mp.add(kf);
+    Sink_Functor sink_functor(_n_keys);
+    Sink sink = Sink_Builder(sink_functor)
+                    .withName("sink")
+                    .withParallelism(1)
+                    .build();
+    mp.chain_sink(sink);
+    graph.run();
+    return global_sum;
+}
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int source_degree, map_degree, kf_degree;
+    // print the topology of the machine
+    Topology topology;
+    cout << "Machine with " << topology.getNumNodes() << " NUMA node(s)" << endl;
+    for (size_t n=0; n<topology.getNumNodes(); n++) {
+        cout << "  Node " << topology.getNodeId(n) << " has " << topology.getCPUs(n).size() << " CPU(s)" << endl;
+    }
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        source_degree = dist6(rng);
+        map_degree = dist6(rng);
+        kf_degree = dist6(rng);
+        cout << "Run " << i << " Source(" << source_degree << ")->Map(" << map_degree << ")->Key_Farm_TB(" << kf_degree << ")->Sink(1)" << endl;
+        // reference application without placement
+        long base_result = run_app(Placement::NONE, Map_Functor(), {}, stream_len, n_keys, win_len, win_slide, source_degree, map_degree, kf_degree);
+        // application with the COMPACT placement
+        long compact_result = run_app(Placement::COMPACT, Map_Functor(), {}, stream_len, n_keys, win_len, win_slide, source_degree, map_degree, kf_degree);
+        // application with the SPREAD placement
+        long spread_result = run_app(Placement::SPREAD, Map_Functor(), {}, stream_len, n_keys, win_len, win_slide, source_degree, map_degree, kf_degree);
+        // application with the replicas of the Map pinned on the CPU 0
+        wrong_cpu = 0;
+        long pinned_result = run_app(Placement::NONE, Pinned_Map_Functor(0), {0}, stream_len, n_keys, win_len, win_slide, source_degree, map_degree, kf_degree);
+        cout << "Results -> NONE: " << base_result << ", COMPACT: " << compact_result << ", SPREAD: " << spread_result << ", PINNED: " << pinned_result << endl;
+        cout << "Inputs of the pinned Map processed outside the CPU 0: " << wrong_cpu << endl;
+        if (base_result == compact_result && base_result == spread_result && base_result == pinned_result && wrong_cpu == 0) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,190 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+
+/*  
+ *  Test of the event-time alignment of the Source replicas with KF, time-based windows
+ *  and DETERMINISTIC mode. The replicas of the Source generate timestamps at different
+ *  speeds, so without alignment the fastest ones run ahead in event time. The result
+ *  must be the same with and without the alignment (the first run is without it).
+ *  
+ *  +-----+   +-----+   +-------+   +-----+
+ *  |  S  |   |  M  |   | KF_TB |   |  S  |
+ *  | (*) +-->+ (*) +-->+  (*)  +-->+ (1) |
+ *  +-----+   +-----+   +-------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// source functor whose replicas generate timestamps at different speeds
+class Skewed_Source_Functor
+{
+private:
+    size_t len; // stream length per key
+    size_t keys; // number of keys
+    size_t sent; // number of tuples generated by the replica
+    uint64_t next_ts; // timestamp of the next tuple
+    uint64_t step; // timestamp increment of the replica (zero until the first call)
+
+public:
+    // Constructor
+    Skewed_Source_Functor(size_t _len,
+                          size_t _keys):
+                          len(_len),
+                          keys(_keys),
+                          sent(0),
+                          next_ts(0),
+                          step(0) {}
+
+    // operator()
+    bool operator()(tuple_t &t, RuntimeContext &rc)
+    {
+        // the i-th replica advances its timestamps (i+1) times faster than the first one
+        if (step == 0) {
+            step = 10 * (rc.getReplicaIndex() + 1);
+        }
+        size_t k = (sent % keys);
+        t.setControlFields(k, sent / keys, next_ts);
+        t.value = sent;
+        sent++;
+        next_ts += step;
+        return (sent < len * keys);
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    size_t source_degree = 2;
+    uint64_t delta = 1000;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 15) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec] -n [source replicas] -d [delta usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:n:d:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            case 'n': source_degree = atoi(optarg);
+                     break;
+            case 'd': delta = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec] -n [source replicas] -d [delta usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int map_degree, kf_degree;
+    long last_result = 0;
+    // executes the runs (the first one without alignment)
+    for (size_t i=0; i<runs; i++) {
+        map_degree = dist6(rng);
+        kf_degree = dist6(rng);
+        cout << "Run " << i << ((i == 0) ? " (without alignment)" : " (with alignment)") << endl;
+        cout << "+-----+   +-----+   +-------+   +-----+" << endl;
+        cout << "|  S  |   |  M  |   | KF_TB |   |  S  |" << endl;
+        cout << "| (" << source_degree << ") +-->+ (" << map_degree << ") +-->+  (" << kf_degree << ")  +-->+ (1) |" << endl;
+        cout << "+-----+   +-----+   +-------+   +-----+" << endl;
+        // prepare the test
+        PipeGraph graph("test_source_align", Mode::DETERMINISTIC);
+        // source
+        Skewed_Source_Functor source_functor(stream_len, n_keys);
+        Source_Builder source_builder(source_functor);
+        source_builder.withName("source").withParallelism(source_degree);
+        if (i > 0) {
+            source_builder.withEventTimeAlignment(delta);
+        }
+        Source source = source_builder.build();
+        MultiPipe &mp = graph.add_source(source);
+        // map
+        Map_Functor map_functor;
+        Map map = Map_Builder(map_functor)
+                        .withName("map")
+                        .withParallelism(map_degree)
+                        .build();
+        mp.chain(map);
+        // kf
+        Key_Farm kf = KeyFarm_Builder(kf_function)
+                            .withName("kf")
+                            .withParallelism(kf_degree)
+                            .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                            .build();
+        mp.add(kf);
+        // sink
+        Sink_Functor sink_functor(n_keys);
+        Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+        mp.chain_sink(sink);
+        // run the application
+        auto start_time = steady_clock::now();
+        graph.run();
+        double elapsed = duration_cast<microseconds>(steady_clock::now() - start_time).count() / 1000.0;
+        cout << "Execution time " << elapsed << " ms" << endl;
+        if (i == 0) {
+            last_result = global_sum;
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            if (last_result == global_sum) {
+                cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+            }
+            else {
+                cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,187 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/*  
+ *  Test of the processing-time timers of the RuntimeContext. The Sink buffers the
+ *  received tuples and flushes the buffer periodically through a timer (and at the
+ *  end of the stream), so the result must be the same of the unbuffered case.
+ *  
+ *  +-----+   +-----+   +-----+   +-----+
+ *  |  S  |   |  F  |   |  M  |   |  S  |
+ *  | (1) +-->+ (*) +-->+ (*) +-->+ (*) |
+ *  +-----+   +-----+   +-----+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<vector>
+#include<atomic>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variables
+atomic<long> flushed_sum;
+atomic<size_t> n_flushes;
+
+// sink functor buffering the received tuples
+class Buffered_Sink_Functor
+{
+private:
+    uint64_t period; // flush period in microseconds
+    vector<tuple_t> buffer; // buffered tuples
+    bool timerSet; // true if the timer has been registered
+
+public:
+    // Constructor
+    Buffered_Sink_Functor(uint64_t _period):
+                          period(_period),
+                          timerSet(false) {}
+
+    // flush the buffer
+    void flush()
+    {
+        long sum = 0;
+        for (auto &t: buffer) {
+            sum += t.value;
+        }
+        flushed_sum += sum;
+        n_flushes++;
+        buffer.clear();
+    }
+
+    // operator()
+    void operator()(optional<tuple_t> &t, RuntimeContext &rc)
+    {
+        if (!timerSet) {
+            // the callbacks are executed by the replica itself, so the buffer is not protected
+            rc.registerPeriodicTimer(period, [this](RuntimeContext &) { flush(); });
+            timerSet = true;
+        }
+        if (t) {
+            buffer.push_back(*t);
+        }
+        else {
+            flush();
+        }
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t n_keys = 1;
+    uint64_t period = 1000;
+    // arguments from command line
+    if (argc != 9) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -p [flush period usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:p:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'p': period = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -p [flush period usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int filter_degree, map_degree, sink_degree;
+    size_t source_degree = 1;
+    long last_result = 0;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        filter_degree = dist6(rng);
+        map_degree = dist6(rng);
+        sink_degree = dist6(rng);
+        flushed_sum = 0;
+        n_flushes = 0;
+        cout << "Run " << i << endl;
+        cout << "+-----+   +-----+   +-----+   +-----+" << endl;
+        cout << "|  S  |   |  F  |   |  M  |   |  S  |" << endl;
+        cout << "| (" << source_degree << ") +-->+ (" << filter_degree << ") +-->+ (" << map_degree << ") +-->+ (" << sink_degree << ") |" << endl;
+        cout << "+-----+   +-----+   +-----+   +-----+" << endl;
+        // prepare the test
+        PipeGraph graph("test_timers");
+        // source
+        Source_Functor source_functor(stream_len, n_keys);
+        Source source = Source_Builder(source_functor)
+                            .withName("source")
+                            .withParallelism(source_degree)
+                            .build();
+        MultiPipe &mp = graph.add_source(source);
+        // filter
+        Filter_Functor filter_functor;
+        Filter filter = Filter_Builder(filter_functor)
+                            .withName("filter")
+                            .withParallelism(filter_degree)
+                            .build();
+        mp.chain(filter);
+        // map
+        Map_Functor map_functor;
+        Map map = Map_Builder(map_functor)
+                        .withName("map")
+                        .withParallelism(map_degree)
+                        .build();
+        mp.chain(map);
+        // sink
+        Buffered_Sink_Functor sink_functor(period);
+        Sink sink = Sink_Builder(sink_functor)
+                        .withName("sink")
+                        .withParallelism(sink_degree)
+                        .build();
+        mp.chain_sink(sink);
+        // run the application
+        graph.run();
+        cout << "Total sum " << flushed_sum << " with " << n_flushes << " flushes" << endl;
+        if (i == 0) {
+            last_result = flushed_sum;
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            if (last_result == flushed_sum) {
+                cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+            }
+            else {
+                cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+            }
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,238 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/*  
+ *  Test of the processing-time timers emitting results through the Shipper of the
+ *  replica. The FlatMap buffers the received tuples and emits them only from a periodic
+ *  timer. After the stream, the Source stays idle (without terminating) until the Sink
+ *  has received all the tuples, so the timers must be fired by the idle marks repeated
+ *  by the Source (idle timeout of the watermarks) and not by the end of the stream.
+ *  
+ *  +-----+   +-----+   +-----+
+ *  |  S  |   |  F  |   |  S  |
+ *  | (*) +-->+ (*) +-->+ (1) |
+ *  +-----+   +-----+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<vector>
+#include<atomic>
+#include<thread>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variables
+atomic<size_t> n_received; // tuples received by the Sink
+atomic<size_t> n_expected; // tuples generated by all the Sources
+atomic<size_t> early_received; // tuples received by the Sink before the termination of the Sources
+atomic<long> received_sum; // sum of the tuples received by the Sink
+
+// idle timeout of the Source (in microseconds)
+#define IDLE_TIMEOUT 5000
+
+// maximum wall-clock time waited by the Source for the results (in microseconds)
+#define MAX_WAIT 2000000
+
+// functor of the Source (it waits for all the tuples to be received by the Sink before terminating)
+class Waiting_Source_Functor
+{
+private:
+    size_t len; // stream length per key
+    size_t keys; // number of keys
+    size_t k;
+    size_t sent;
+    vector<uint64_t> ids;
+    uint64_t next_ts;
+    uint64_t wait_start; // wall-clock time when the Source has started to wait for the results
+
+public:
+    // Constructor
+    Waiting_Source_Functor(size_t _len,
+                           size_t _keys):
+                           len(_len),
+                           keys(_keys),
+                           k(0),
+                           sent(0),
+                           ids(_keys, 0),
+                           next_ts(0),
+                           wait_start(0) {}
+
+    bool operator()(Shipper<tuple_t> &shipper)
+    {
+        if (sent < len*keys) {
+            tuple_t t;
+            t.setControlFields(k, ids[k], next_ts);
+            t.value = ids[k]++;
+            shipper.push(t);
+            sent++;
+            k = (k+1) % keys;
+            next_ts += 1000;
+            return true;
+        }
+        // the stream is over: the Source waits for the tuples buffered by the FlatMap
+        if (wait_start == 0) {
+            wait_start = current_time_usecs();
+        }
+        if (n_received.load() < n_expected.load() && current_time_usecs() - wait_start < MAX_WAIT) {
+            this_thread::sleep_for(milliseconds(1));
+            return true;
+        }
+        early_received.store(n_received.load());
+        return false;
+    }
+};
+
+// flatmap functor buffering the received tuples and emitting them from a periodic timer
+class Buffered_FlatMap_Functor
+{
+private:
+    uint64_t period; // flush period in microseconds
+    vector<tuple_t> buffer; // buffered tuples
+    bool timerSet; // true if the timer has been registered
+
+public:
+    // Constructor
+    Buffered_FlatMap_Functor(uint64_t _period):
+                             period(_period),
+                             timerSet(false) {}
+
+    // operator()
+    void operator()(const tuple_t &t, Shipper<tuple_t> &, RuntimeContext &rc)
+    {
+        if (!timerSet) {
+            // the callbacks are executed by the replica itself, so the buffer is not protected
+            rc.registerPeriodicTimer<tuple_t>(period, [this](Shipper<tuple_t> &shipper, RuntimeContext &) {
+                for (auto &b: buffer) {
+                    shipper.push(b);
+                }
+                buffer.clear();
+            });
+            timerSet = true;
+        }
+        buffer.push_back(t);
+    }
+};
+
+// sink functor counting the received tuples
+class Counting_Sink_Functor
+{
+public:
+    // operator()
+    void operator()(optional<tuple_t> &t)
+    {
+        if (t) {
+            received_sum += (*t).value;
+            n_received++;
+        }
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t n_keys = 1;
+    uint64_t period = 1000;
+    // arguments from command line
+    if (argc != 9) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -p [flush period usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:p:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'p': period = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -p [flush period usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int source_degree, flatmap_degree;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        source_degree = dist6(rng);
+        flatmap_degree = dist6(rng);
+        n_received = 0;
+        n_expected = source_degree * stream_len * n_keys;
+        early_received = 0;
+        received_sum = 0;
+        cout << "Run " << i << endl;
+        cout << "+-----+   +-----+   +-----+" << endl;
+        cout << "|  S  |   |  F  |   |  S  |" << endl;
+        cout << "| (" << source_degree << ") +-->+ (" << flatmap_degree << ") +-->+ (1) |" << endl;
+        cout << "+-----+   +-----+   +-----+" << endl;
+        // prepare the test
+        PipeGraph graph("test_timers_shipper");
+        // source
+        Waiting_Source_Functor source_functor(stream_len, n_keys);
+        Source source = Source_Builder(source_functor)
+                            .withName("source")
+                            .withParallelism(source_degree)
+                            .withWatermarks(1000, 0, IDLE_TIMEOUT)
+                            .build();
+        MultiPipe &mp = graph.add_source(source);
+        // flatmap
+        Buffered_FlatMap_Functor flatmap_functor(period);
+        FlatMap flatmap = FlatMap_Builder(flatmap_functor)
+                            .withName("flatmap")
+                            .withParallelism(flatmap_degree)
+                            .build();
+        mp.chain(flatmap);
+        // sink
+        Counting_Sink_Functor sink_functor;
+        Sink sink = Sink_Builder(sink_functor)
+                        .withName("sink")
+                        .withParallelism(1)
+                        .build();
+        mp.chain_sink(sink);
+        // run the application
+        graph.run();
+        cout << "Received " << early_received << " tuples before the end of the stream (expected " << n_expected << "), total sum " << received_sum << endl;
+        long expected_sum = source_degree * n_keys * (stream_len * (stream_len - 1) / 2);
+        bool ok = (early_received.load() == n_expected.load()) && (received_sum == expected_sum);
+        if (ok) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,184 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test of the dynamic scheduling of the windows of the Win_Farm with time-based windows
+ *  in DETERMINISTIC mode. The cost of the windows is skewed: one window every n (where n
+ *  is the parallelism) is much more expensive than the others, so with the static
+ *  scheduling all the expensive windows of a key are computed by the same replica. The
+ *  first application uses the static scheduling and it is the reference, the second one
+ *  uses the dynamic scheduling. Both the results and the execution times of the two
+ *  applications are reported, together with the windows evaluated by each replica.
+ *  
+ *  +-----+   +-------+   +-----+
+ *  |  S  |   | WF_TB |   |  S  |
+ *  | (1) +-->+  (*)  +-->+ (1) |
+ *  +-----+   +-------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// one window every skew_period is expensive
+size_t skew_period = 1;
+
+// Win_Farm function (non-incremental) with skewed cost of the windows
+void skewed_function(size_t wid, const Iterable<tuple_t> &input, output_t &result) {
+    long sum = 0;
+    for (auto t : input) {
+        int value = t.value;
+        sum += value;
+    }
+    // busy waiting emulating an expensive window
+    if (wid % skew_period == 0) {
+        auto start = steady_clock::now();
+        while (duration_cast<microseconds>(steady_clock::now() - start).count() < 200);
+    }
+    result.value = sum;
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 2;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int wf_degree;
+    size_t source_degree = 1;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        wf_degree = dist6(rng);
+        skew_period = wf_degree;
+        cout << "Run " << i << " (parallelism " << wf_degree << ", one expensive window every " << skew_period << ")" << endl;
+        // first application with the static scheduling
+        long static_result = 0;
+        double static_time = 0;
+        {
+            PipeGraph graph("test_wf_tb_dynamic_static", Mode::DETERMINISTIC);
+            Source_Functor source_functor(stream_len, n_keys);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Win_Farm wf = WinFarm_Builder(skewed_function)
+                                .withName("wf")
+                                .withParallelism(wf_degree)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .build();
+            mp.add(wf);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            auto start = steady_clock::now();
+            graph.run();
+            static_time = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+            static_result = global_sum;
+        }
+        // second application with the dynamic scheduling
+        long dynamic_result = 0;
+        double dynamic_time = 0;
+        {
+            PipeGraph graph("test_wf_tb_dynamic_dynamic", Mode::DETERMINISTIC);
+            Source_Functor source_functor(stream_len, n_keys);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Win_Farm wf = WinFarm_Builder(skewed_function)
+                                .withName("wf")
+                                .withParallelism(wf_degree)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .withDynamicScheduling()
+                                .build();
+            mp.add(wf);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            auto start = steady_clock::now();
+            graph.run();
+            dynamic_time = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+            dynamic_result = global_sum;
+            cout << "Windows evaluated by the replicas:";
+            for (int r=0; r<wf_degree; r++) {
+                cout << " " << (wf.getWinScheduler())->getNumWindows(r);
+            }
+            cout << endl;
+        }
+        cout << "WF time " << static_time << " ms, WF with dynamic scheduling time " << dynamic_time << " ms" << endl;
+        if (static_result == dynamic_result) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
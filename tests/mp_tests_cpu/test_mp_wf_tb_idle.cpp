@@ -0,0 +1,273 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test of the idle timeout of the watermarks in the DEFAULT mode. The second Source does not
+ *  generate any tuple until the first one has terminated, so the windows must be fired by the
+ *  watermarks of the first Source while the second one is idle (and not only at the end of the
+ *  stream). The first Source waits for the first result before terminating.
+ *  
+ *  +-----+   +-----+
+ *  |  S  |   |  M  |
+ *  | (1) +-->+ (*) +--+
+ *  +-----+   +-----+  |   +-------+   +-----+
+ *                     +-->+ WF_TB |   |  S  |
+ *  +-----+   +-----+  |   |  (*)  +-->+ (1) |
+ *  |  S  |   |  M  |  |   +-------+   +-----+
+ *  | (1) +-->+ (*) +--+
+ *  +-----+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<atomic>
+#include<thread>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variables
+extern long global_sum;
+atomic<size_t> n_results; // results received by the Sink
+atomic<size_t> early_results; // results received before the termination of the first Source
+atomic<bool> active_ended; // true when the first Source has terminated
+
+// idle timeout of the Sources (in microseconds)
+#define IDLE_TIMEOUT 10000
+
+// maximum wall-clock time waited by the first Source for the first result (in microseconds)
+#define MAX_WAIT 2000000
+
+// functor of the first Source
+class Active_Source_Functor
+{
+private:
+    size_t len; // stream length per key
+    size_t keys; // number of keys
+    size_t k;
+    size_t sent;
+    vector<uint64_t> ids;
+    uint64_t next_ts;
+    uint64_t wait_start; // wall-clock time when the Source has started to wait for the first result
+
+public:
+    // Constructor
+    Active_Source_Functor(size_t _len,
+                          size_t _keys):
+                          len(_len),
+                          keys(_keys),
+                          k(0),
+                          sent(0),
+                          ids(_keys, 0),
+                          next_ts(0),
+                          wait_start(0) {}
+
+    bool operator()(Shipper<tuple_t> &shipper)
+    {
+        if (sent < len*keys) {
+            tuple_t t;
+            t.setControlFields(k, ids[k], next_ts);
+            t.value = ids[k]++;
+            shipper.push(t);
+            sent++;
+            k = (k+1) % keys;
+            next_ts += 1000;
+            return true;
+        }
+        // the stream is over: the Source waits for the first result (the idle Source is still running)
+        if (wait_start == 0) {
+            wait_start = current_time_usecs();
+        }
+        if (n_results.load() == 0 && current_time_usecs() - wait_start < MAX_WAIT) {
+            this_thread::sleep_for(milliseconds(1));
+            return true;
+        }
+        early_results.store(n_results.load());
+        active_ended.store(true);
+        return false;
+    }
+};
+
+// functor of the second Source (idle until the first Source has terminated)
+class Idle_Source_Functor
+{
+public:
+    bool operator()(Shipper<tuple_t> &shipper)
+    {
+        if (!active_ended.load()) {
+            this_thread::sleep_for(milliseconds(1));
+            return true;
+        }
+        return false;
+    }
+};
+
+// sink functor counting the results while the stream is running
+class Idle_Sink_Functor
+{
+private:
+    size_t received; // counter of received results
+    long totalsum;
+
+public:
+    // constructor
+    Idle_Sink_Functor():
+                      received(0),
+                      totalsum(0) {}
+
+    // operator()
+    void operator()(optional<output_t> &out)
+    {
+        if (out) {
+            received++;
+            n_results++;
+            totalsum += (*out).value;
+        }
+        else {
+            cout << "Received " << received << " results, total sum " << totalsum << endl;
+            global_sum = totalsum;
+        }
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int map1_degree, map2_degree, wf_degree;
+    long last_results = 0;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        map1_degree = dist6(rng);
+        map2_degree = dist6(rng);
+        wf_degree = dist6(rng);
+        n_results = 0;
+        early_results = 0;
+        active_ended = false;
+        cout << "Run " << i << endl;
+        cout << "+-----+   +-----+" << endl;
+        cout << "|  S  |   |  M  |" << endl;
+        cout << "| (1) +-->+ (" << map1_degree << ") +--+" << endl;
+        cout << "+-----+   +-----+  |   +-------+   +-----+" << endl;
+        cout << "                   +-->+ WF_TB |   |  S  |" << endl;
+        cout << "+-----+   +-----+  |   |  (" << wf_degree << ")  +-->+ (1) |" << endl;
+        cout << "|  S  |   |  M  |  |   +-------+   +-----+" << endl;
+        cout << "| (1) +-->+ (" << map2_degree << ") +--+" << endl;
+        cout << "+-----+   +-----+" << endl;
+        // prepare the test
+        PipeGraph graph("test_wf_tb_idle");
+        // first source
+        Active_Source_Functor source_functor1(stream_len, n_keys);
+        Source source1 = Source_Builder(source_functor1)
+                            .withName("source1")
+                            .withParallelism(1)
+                            .withWatermarks(win_slide, 0, IDLE_TIMEOUT)
+                            .build();
+        MultiPipe &mp1 = graph.add_source(source1);
+        Map_Functor map_functor1;
+        Map map1 = Map_Builder(map_functor1)
+                        .withName("map1")
+                        .withParallelism(map1_degree)
+                        .build();
+        mp1.chain(map1);
+        // second source
+        Idle_Source_Functor source_functor2;
+        Source source2 = Source_Builder(source_functor2)
+                            .withName("source2")
+                            .withParallelism(1)
+                            .withWatermarks(win_slide, 0, IDLE_TIMEOUT)
+                            .build();
+        MultiPipe &mp2 = graph.add_source(source2);
+        Map_Functor map_functor2;
+        Map map2 = Map_Builder(map_functor2)
+                        .withName("map2")
+                        .withParallelism(map2_degree)
+                        .build();
+        mp2.chain(map2);
+        MultiPipe &mp = mp1.merge(mp2);
+        // wf
+        Win_Farm wf = WinFarm_Builder(wf_function)
+                            .withName("wf")
+                            .withParallelism(wf_degree)
+                            .withTBWindows(microseconds(win_len), microseconds(win_slide), /* delay */ seconds(1)) // huge delay, the windows are fired by the watermarks
+                            .build();
+        mp.add(wf);
+        // sink
+        Idle_Sink_Functor sink_functor;
+        Sink sink = Sink_Builder(sink_functor)
+                        .withName("sink")
+                        .withParallelism(1)
+                        .build();
+        mp.chain_sink(sink);
+        // run the application
+        graph.run();
+        // the first Source must have received a result before its termination
+        bool fired = (early_results.load() > 0) && (i == 0 || last_results == global_sum);
+        if (i == 0) {
+            last_results = global_sum;
+        }
+        if (fired) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
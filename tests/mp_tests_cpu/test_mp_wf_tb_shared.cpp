@@ -0,0 +1,161 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test of the shared archive of the Win_Farm with time-based windows in DETERMINISTIC
+ *  mode. The first application stores the tuples in the archives of the replicas and it
+ *  is the reference, the second one stores each tuple once in the archive shared by the
+ *  replicas. Both the results and the execution times of the two applications are
+ *  reported, together with the number of tuples appended to the shared archive, copied
+ *  between its segments and still stored at the end of the execution.
+ *  
+ *  +-----+   +-------+   +-----+
+ *  |  S  |   | WF_TB |   |  S  |
+ *  | (1) +-->+  (*)  +-->+ (1) |
+ *  +-----+   +-------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 2;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int wf_degree;
+    size_t source_degree = 1;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        wf_degree = dist6(rng);
+        cout << "Run " << i << " (parallelism " << wf_degree << ")" << endl;
+        // first application with the archives of the replicas
+        long base_result = 0;
+        double base_time = 0;
+        {
+            PipeGraph graph("test_wf_tb_shared_base", Mode::DETERMINISTIC);
+            Source_Functor source_functor(stream_len, n_keys);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Win_Farm wf = WinFarm_Builder(wf_function)
+                                .withName("wf")
+                                .withParallelism(wf_degree)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .build();
+            mp.add(wf);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            auto start = steady_clock::now();
+            graph.run();
+            base_time = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+            base_result = global_sum;
+        }
+        // second application with the shared archive
+        long shared_result = 0;
+        double shared_time = 0;
+        {
+            PipeGraph graph("test_wf_tb_shared_shared", Mode::DETERMINISTIC);
+            Source_Functor source_functor(stream_len, n_keys);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Win_Farm wf = WinFarm_Builder(wf_function)
+                                .withName("wf")
+                                .withParallelism(wf_degree)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .withSharedArchive()
+                                .build();
+            mp.add(wf);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            auto start = steady_clock::now();
+            graph.run();
+            shared_time = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+            shared_result = global_sum;
+            auto archive = wf.getSharedArchive();
+            cout << "Shared archive: " << archive->getNumAppended() << " tuples appended, " << archive->getNumCopied() << " copied, " << archive->getNumStored() << " stored" << endl;
+        }
+        cout << "WF time " << base_time << " ms, WF with shared archive time " << shared_time << " ms" << endl;
+        if (base_result == shared_result) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
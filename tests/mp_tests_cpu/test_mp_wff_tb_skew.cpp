@@ -0,0 +1,206 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test of WFF against KFF with time-based windows on a skewed stream (most of
+ *  the tuples have the same key) in DETERMINISTIC mode. Both the results and the
+ *  execution times of the two operators are reported.
+ *  
+ *  +-----+   +--------+   +-----+
+ *  |  S  |   | KFF_TB |   |  S  |
+ *  | (1) +-->+  (*)   +-->+ (1) |
+ *  +-----+   +--------+   +-----+
+ *  
+ *  +-----+   +--------+   +-----+
+ *  |  S  |   | WFF_TB |   |  S  |
+ *  | (1) +-->+  (*)   +-->+ (1) |
+ *  +-----+   +--------+   +-----+
+ */ 
+
+// includes
+#include<string>
+#include<iostream>
+#include<random>
+#include<math.h>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"mp_common.hpp"
+
+using namespace std;
+using namespace chrono;
+using namespace wf;
+
+// global variable for the result
+extern long global_sum;
+
+// source functor generating a skewed stream (hot_ratio percent of the tuples have key zero)
+class Skewed_Source_Functor
+{
+private:
+    size_t len; // total stream length
+    size_t keys; // number of keys
+    size_t hot_ratio; // percentage of tuples with the hot key
+    size_t sent;
+    vector<uint64_t> ids;
+    uint64_t next_ts;
+
+public:
+    // Constructor
+    Skewed_Source_Functor(size_t _len,
+                          size_t _keys,
+                          size_t _hot_ratio):
+                          len(_len),
+                          keys(_keys),
+                          hot_ratio(_hot_ratio),
+                          sent(0),
+                          ids(_keys, 0),
+                          next_ts(0)
+    {
+        srand(0);
+    }
+
+    bool operator()(tuple_t &t)
+    {
+        size_t k = 0;
+        if (keys > 1 && (size_t) (random() % 100) >= hot_ratio) {
+            k = 1 + (random() % (keys - 1));
+        }
+        t.setControlFields(k, ids[k], next_ts);
+        t.value = ids[k]++;
+        sent++;
+        double x = (1000 * 0.05) / 1.05;
+        next_ts += ceil(pareto(1.05, x));
+        return (sent < len);
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t win_len = 0;
+    size_t win_slide = 0;
+    size_t n_keys = 1;
+    size_t hot_ratio = 80;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 11) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:w:s:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            case 'w': win_len = atoi(optarg);
+                     break;
+            case 's': win_slide = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys] -w [win length usec] -s [win slide usec]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    int par_degree;
+    size_t source_degree = 1;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        par_degree = dist6(rng);
+        // one group of replicas (the window length is greater than the slide multiplied by the parallelism)
+        while (par_degree > 1 && par_degree * win_slide >= win_len) {
+            par_degree--;
+        }
+        cout << "Run " << i << " (hot key ratio " << hot_ratio << "%, parallelism " << par_degree << ")" << endl;
+        // first application with the Key_FFAT operator
+        long kff_result = 0;
+        double kff_time = 0;
+        {
+            PipeGraph graph("test_kff_tb_skew", Mode::DETERMINISTIC);
+            Skewed_Source_Functor source_functor(stream_len, n_keys, hot_ratio);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Key_FFAT kff = KeyFFAT_Builder(liftFunction, combineFunction)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .withParallelism(par_degree)
+                                .withName("kff")
+                                .build();
+            mp.add(kff);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            auto start = steady_clock::now();
+            graph.run();
+            kff_time = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+            kff_result = global_sum;
+        }
+        // second application with the Win_FFAT operator
+        long wff_result = 0;
+        double wff_time = 0;
+        {
+            PipeGraph graph("test_wff_tb_skew", Mode::DETERMINISTIC);
+            Skewed_Source_Functor source_functor(stream_len, n_keys, hot_ratio);
+            Source source = Source_Builder(source_functor)
+                                .withName("source")
+                                .withParallelism(source_degree)
+                                .build();
+            MultiPipe &mp = graph.add_source(source);
+            Win_FFAT wff = WinFFAT_Builder(liftFunction, combineFunction)
+                                .withTBWindows(microseconds(win_len), microseconds(win_slide))
+                                .withParallelism(par_degree)
+                                .withName("wff")
+                                .build();
+            mp.add(wff);
+            Sink_Functor sink_functor(n_keys);
+            Sink sink = Sink_Builder(sink_functor)
+                            .withName("sink")
+                            .withParallelism(1)
+                            .build();
+            mp.chain_sink(sink);
+            auto start = steady_clock::now();
+            graph.run();
+            wff_time = duration_cast<microseconds>(steady_clock::now() - start).count() / 1000.0;
+            wff_result = global_sum;
+        }
+        cout << "KFF time " << kff_time << " ms, WFF time " << wff_time << " ms" << endl;
+        if (kff_result == wff_result) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+    }
+    return 0;
+}
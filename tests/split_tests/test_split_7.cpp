@@ -0,0 +1,329 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/*  
+ *  Test 7 of the split of MultiPipe instances (each input is sent to all the
+ *  branches within a shared envelope). The copies of the inputs are counted:
+ *  the FlatMap operators only read their inputs, so they do not copy them,
+ *  while the in-place Map copies an input only if the other branches still
+ *  refer to it.
+ *  
+ *                      +----------------------+
+ *                      |  +------+   +-----+  |
+ *                      |  |  FM  |   |  S  |  |
+ *                 +--->+  | (*)  +-->+ (1) |  |
+ *                 |    |  +------+   +-----+  |
+ *                 |    +----------------------+
+ *                 |    +----------------------+
+ *                 |    |  +------+   +-----+  |
+ *  +-----------+  |    |  |  FM  |   |  S  |  |
+ *  |  +-----+  |  +--->+  | (*)  +-->+ (1) |  |
+ *  |  |  S  |  |  |    |  +------+   +-----+  |
+ *  |  | (*) |  +--+    +----------------------+
+ *  |  +-----+  |  |    +----------------------+
+ *  +-----------+  |    |  +------+   +-----+  |
+ *                 |    |  |  FM  |   |  S  |  |
+ *                 +--->+  | (*)  +-->+ (1) |  |
+ *                 |    |  +------+   +-----+  |
+ *                 |    +----------------------+
+ *                 |    +---------------------+
+ *                 |    |  +-----+   +-----+  |
+ *                 |    |  |  M  |   |  S  |  |
+ *                 +--->+  | (*) +-->+ (1) |  |
+ *                      |  +-----+   +-----+  |
+ *                      +---------------------+
+ */ 
+
+// include
+#include<random>
+#include<iostream>
+#include<ff/ff.hpp>
+#include<windflow.hpp>
+#include"split_common.hpp"
+
+using namespace std;
+using namespace wf;
+
+// global variable for the result
+extern atomic<long> global_sum;
+
+// struct of the input tuple counting its copies
+struct counted_tuple_t
+{
+    size_t key;
+    uint64_t id;
+    uint64_t ts;
+    int64_t value;
+    static atomic<size_t> copies; // number of copy constructions
+
+    // constructor
+    counted_tuple_t():
+                    key(0),
+                    id(0),
+                    ts(0),
+                    value(0) {}
+
+    // copy constructor
+    counted_tuple_t(const counted_tuple_t &_t):
+                    key(_t.key),
+                    id(_t.id),
+                    ts(_t.ts),
+                    value(_t.value)
+    {
+        copies++;
+    }
+
+    // move constructor
+    counted_tuple_t(counted_tuple_t &&_t):
+                    key(_t.key),
+                    id(_t.id),
+                    ts(_t.ts),
+                    value(_t.value) {}
+
+    // copy assignment operator
+    counted_tuple_t &operator=(const counted_tuple_t &_t) = default;
+
+    // getControlFields method
+    tuple<size_t, uint64_t, uint64_t> getControlFields() const
+    {
+        return tuple<size_t, uint64_t, uint64_t>(key, id, ts);
+    }
+
+    // setControlFields method
+    void setControlFields(size_t _key, uint64_t _id, uint64_t _ts)
+    {
+        key = _key;
+        id = _id;
+        ts = _ts;
+    }
+};
+
+atomic<size_t> counted_tuple_t::copies;
+
+// source functor generating the inputs counting their copies
+class Counted_Source_Functor
+{
+private:
+    size_t len; // stream length per key
+    size_t keys; // number of keys
+    size_t k;
+    size_t sent;
+    vector<uint64_t> ids;
+    uint64_t next_ts;
+
+public:
+    // Constructor
+    Counted_Source_Functor(size_t _len,
+                           size_t _keys):
+                           len(_len),
+                           keys(_keys),
+                           k(0),
+                           sent(0),
+                           ids(_keys, 0),
+                           next_ts(0) {}
+
+    bool operator()(counted_tuple_t &t)
+    {
+        t.setControlFields(k, ids[k], next_ts++);
+        t.value = ids[k]++;
+        sent++;
+        k = (k+1) % keys;
+        return (sent < len*keys);
+    }
+};
+
+// flatmap functor (it only reads its input)
+class Read_FlatMap_Functor
+{
+public:
+    // operator()
+    void operator()(const counted_tuple_t &t, Shipper<tuple_t> &shipper)
+    {
+        shipper.push(tuple_t(t.key, t.id, t.ts, t.value));
+    }
+};
+
+// map functor (it modifies its input in place)
+class Counted_Map_Functor
+{
+public:
+    // operator()
+    void operator()(counted_tuple_t &t)
+    {
+        t.value++;
+    }
+};
+
+// sink functor of the inputs counting their copies
+class Counted_Sink_Functor
+{
+private:
+    size_t received; // counter of received results
+    long totalsum;
+
+public:
+    // constructor
+    Counted_Sink_Functor(): received(0), totalsum(0) {}
+
+    // operator()
+    void operator()(optional<counted_tuple_t> &out)
+    {
+        if (out) {
+            received++;
+            totalsum += (*out).value;
+        }
+        else {
+            cout << "Received " << received << " results, total sum " << totalsum << endl;
+            global_sum.fetch_add(totalsum);
+        }
+    }
+};
+
+// main
+int main(int argc, char *argv[])
+{
+    int option = 0;
+    size_t runs = 1;
+    size_t stream_len = 0;
+    size_t n_keys = 1;
+    // initalize global variable
+    global_sum = 0;
+    // arguments from command line
+    if (argc != 7) {
+        cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys]" << endl;
+        exit(EXIT_SUCCESS);
+    }
+    while ((option = getopt(argc, argv, "r:l:k:")) != -1) {
+        switch (option) {
+            case 'r': runs = atoi(optarg);
+                     break;
+            case 'l': stream_len = atoi(optarg);
+                     break;
+            case 'k': n_keys = atoi(optarg);
+                     break;
+            default: {
+                cout << argv[0] << " -r [runs] -l [stream_length] -k [n_keys]" << endl;
+                exit(EXIT_SUCCESS);
+            }
+        }
+    }
+    // set random seed
+    mt19937 rng;
+    rng.seed(std::random_device()());
+    size_t min = 1;
+    size_t max = 9;
+    std::uniform_int_distribution<std::mt19937::result_type> dist6(min, max);
+    const size_t n_flatmaps = 3;
+    size_t source_degree = 1;
+    // number of inputs and expected result (the Map branch increments the values before summing them)
+    long n_inputs = stream_len * n_keys;
+    long values_sum = n_keys * ((stream_len * (stream_len - 1)) / 2);
+    long expected = (n_flatmaps + 1) * values_sum + n_inputs;
+    // executes the runs
+    for (size_t i=0; i<runs; i++) {
+        vector<int> flatmap_degrees;
+        for (size_t j=0; j<n_flatmaps; j++) {
+            flatmap_degrees.push_back(dist6(rng));
+        }
+        int map_degree = dist6(rng);
+        cout << "Run " << i << endl;
+        cout << "                    +----------------------+" << endl;
+        cout << "                    |  +------+   +-----+  |" << endl;
+        cout << "                    |  |  FM  |   |  S  |  |" << endl;
+        cout << "               +--->+  | (" << flatmap_degrees[0] << ")  +-->+ (1) |  |" << endl;
+        cout << "               |    |  +------+   +-----+  |" << endl;
+        cout << "               |    +----------------------+" << endl;
+        cout << "               |    +----------------------+" << endl;
+        cout << "               |    |  +------+   +-----+  |" << endl;
+        cout << "+-----------+  |    |  |  FM  |   |  S  |  |" << endl;
+        cout << "|  +-----+  |  +--->+  | (" << flatmap_degrees[1] << ")  +-->+ (1) |  |" << endl;
+        cout << "|  |  S  |  |  |    |  +------+   +-----+  |" << endl;
+        cout << "|  | (" << source_degree << ") |  +--+    +----------------------+" << endl;
+        cout << "|  +-----+  |  |    +----------------------+" << endl;
+        cout << "+-----------+  |    |  +------+   +-----+  |" << endl;
+        cout << "               |    |  |  FM  |   |  S  |  |" << endl;
+        cout << "               +--->+  | (" << flatmap_degrees[2] << ")  +-->+ (1) |  |" << endl;
+        cout << "               |    |  +------+   +-----+  |" << endl;
+        cout << "               |    +----------------------+" << endl;
+        cout << "               |    +---------------------+" << endl;
+        cout << "               |    |  +-----+   +-----+  |" << endl;
+        cout << "               |    |  |  M  |   |  S  |  |" << endl;
+        cout << "               +--->+  | (" << map_degree << ") +-->+ (1) |  |" << endl;
+        cout << "                    |  +-----+   +-----+  |" << endl;
+        cout << "                    +---------------------+" << endl;
+        // prepare the test
+        counted_tuple_t::copies = 0;
+        PipeGraph graph("test_split_7", Mode::DETERMINISTIC);
+        // prepare the first MultiPipe
+        // source
+        Counted_Source_Functor source_functor(stream_len, n_keys);
+        Source source = Source_Builder(source_functor)
+                            .withName("source")
+                            .withParallelism(source_degree)
+                            .build();
+        MultiPipe &pipe1 = graph.add_source(source);
+        // split sending each input to all the branches
+        pipe1.split([](const counted_tuple_t &t) {
+            return vector<size_t>({0, 1, 2, 3});
+        }, n_flatmaps + 1);
+        // prepare the MultiPipe instances with the FlatMap operators
+        Read_FlatMap_Functor flatmap_functor;
+        Sink_Functor flatmap_sink_functor(n_keys);
+        for (size_t j=0; j<n_flatmaps; j++) {
+            MultiPipe &pipe = pipe1.select(j);
+            // flatmap
+            FlatMap flatmap = FlatMap_Builder(flatmap_functor)
+                                    .withName("flatmap" + to_string(j))
+                                    .withParallelism(flatmap_degrees[j])
+                                    .build();
+            pipe.add(flatmap);
+            // sink
+            Sink sink = Sink_Builder(flatmap_sink_functor)
+                            .withName("sink" + to_string(j))
+                            .withParallelism(1)
+                            .build();
+            pipe.chain_sink(sink);
+        }
+        // prepare the MultiPipe instance with the in-place Map
+        MultiPipe &pipe2 = pipe1.select(n_flatmaps);
+        // map
+        Counted_Map_Functor map_functor;
+        Map map = Map_Builder(map_functor)
+                        .withName("map")
+                        .withParallelism(map_degree)
+                        .build();
+        pipe2.add(map);
+        // sink
+        Counted_Sink_Functor sink_functor;
+        Sink sink = Sink_Builder(sink_functor)
+                        .withName("sink" + to_string(n_flatmaps))
+                        .withParallelism(1)
+                        .build();
+        pipe2.chain_sink(sink);
+        // run the application
+        graph.run();
+        // only the Map can copy an input, and at most once (instead of one copy for each branch besides the last one)
+        cout << "Copies of the inputs: " << counted_tuple_t::copies << " (inputs " << n_inputs << ")" << endl;
+        if (global_sum == expected && counted_tuple_t::copies <= static_cast<size_t>(n_inputs)) {
+            cout << "Result is --> " << GREEN << "OK" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        else {
+            cout << "Result is --> " << RED << "FAILED" << "!!!" << DEFAULT_COLOR << endl;
+        }
+        global_sum = 0;
+    }
+    return 0;
+}
@@ -42,12 +42,17 @@
 #include<ff/multinode.hpp>
 #include<ff/farm.hpp>
 #include<basic.hpp>
+#include<meta.hpp>
 #include<context.hpp>
+#include<shipper.hpp>
+#include<watermark.hpp>
+#include<key_groups.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
 #endif
 #include<basic_operator.hpp>
 #include<standard_emitter.hpp>
+#include<combining_emitter.hpp>
 
 namespace wf {
 
@@ -67,6 +72,8 @@ public:
     using acc_func_t = std::function<void(const tuple_t &, result_t &)>;
     /// type of the rich reduce/fold function
     using rich_acc_func_t = std::function<void(const tuple_t &, result_t &, RuntimeContext &)>;
+    /// type of the combine function of two partial results (used by the combiner)
+    using comb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
     /// type of the closing function
     using closing_func_t = std::function<void(RuntimeContext &)>;
     /// type of the function to map the key hashcode onto an identifier starting from zero to parallelism-1
@@ -81,18 +88,29 @@ private:
     std::string name; // name of the Accumulator
     size_t parallelism; // internal parallelism of the Accumulator
     bool used; // true if the Accumulator has been added/chained in a MultiPipe
+    routing_func_t routing_func; // routing function of the key-based distribution (empty if not configured with keyBy)
+    bool keyPreserving; // true if the outputs of the Accumulator keep the keys of the corresponding inputs
+    bool orderPreserving; // true if the outputs of each replica of the Accumulator keep the timestamp order of its inputs
+    bool hasCombiner; // true if the tuples are pre-aggregated by the emitter
+    std::shared_ptr<KeyGroup_Manager> kg_manager; // manager of the key groups migrated among the replicas (nullptr if they are not used)
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
     // class Accumulator_Node
     class Accumulator_Node: public ff::ff_minode_t<tuple_t, result_t>
     {
 private:
+        // friendships with other classes in the library
+        friend class Accumulator;
         acc_func_t acc_func; // reduce/fold function
         rich_acc_func_t rich_acc_func; // rich reduce/fold function
+        comb_func_t comb_func; // combine function of the partial results (used if isPreAggregated is true)
+        bool isPreAggregated; // if true, the inputs are partial results of several tuples pre-aggregated by the emitter
         closing_func_t closing_func; // closing function
         std::string name; // name of the operator
         bool isRich; // flag stating whether the function to be used is rich (i.e. it receives the RuntimeContext object)
         RuntimeContext context; // RuntimeContext
         result_t init_value; // initial value of the results
         size_t eos_received; // number of received EOS messages
+        Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
         bool terminated; // true if the replica has finished its work
         // inner struct of a key descriptor
         struct Key_Descriptor
@@ -105,6 +123,9 @@ private:
         };
         // hash table that maps key values onto key descriptors
         std::unordered_map<key_t, Key_Descriptor> keyMap;
+        KeyGroup_Replica<std::unordered_map<key_t, Key_Descriptor>> keyGroups; // key groups of the replica (used if they can be migrated among the replicas)
+        Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the Accumulator is not placed by the PipeGraph)
+        Shipper<result_t> *shipper = nullptr; // shipper object used by the timers of the replica to emit results
 #if defined (TRACE_WINDFLOW)
         Stats_Record stats_record;
         double avg_td_us = 0;
@@ -120,6 +141,7 @@ public:
                         RuntimeContext _context,
                         closing_func_t _closing_func):
                         acc_func(_acc_func),
+                        isPreAggregated(false),
                         closing_func(_closing_func),
                         name(_name),
                         isRich(false),
@@ -135,6 +157,7 @@ public:
                          RuntimeContext _context,
                          closing_func_t _closing_func):
                          rich_acc_func(_rich_acc_func),
+                         isPreAggregated(false),
                          closing_func(_closing_func),
                          name(_name),
                          isRich(true),
@@ -143,18 +166,73 @@ public:
                          eos_received(0),
                          terminated(false) {}
 
+        // method to set the CPU and NUMA node of the replica
+        void setPlacement(Placement_Replica _placement)
+        {
+            placement = _placement;
+        }
+
+        // method to enable the migration of the key groups
+        void enableKeyGroups(std::shared_ptr<KeyGroup_Manager> _manager, size_t _id)
+        {
+            keyGroups.init(_manager, _id, &keyMap,
+                           [this](void *_input) {
+                               result_t *r = svc(reinterpret_cast<tuple_t *>(_input));
+                               if (r != this->GO_ON) {
+                                   this->ff_send_out(r);
+                               }
+                           },
+                           [this](uint64_t _wm) { this->ff_send_out(wm_merger.createPunctuation(_wm)); });
+        }
+
         // svc_init method (utilized by the FastFlow runtime)
         int svc_init() override
         {
+            // bind the replica to its CPU before it allocates its state
+            placement.bind();
 #if defined (TRACE_WINDFLOW)
             stats_record = Stats_Record(name, std::to_string(this->get_my_id()), false, false);
+            stats_record.cpu = placement.getCPU();
+            stats_record.numa_node = placement.getNode();
 #endif
+            // create the shipper object used by the timers of this replica
+            shipper = new Shipper<result_t>(*this);
+            context.setShipper(shipper);
             return 0;
         }
 
         // svc method (utilized by the FastFlow runtime)
         result_t *svc(tuple_t *t) override
         {
+            // execute the callbacks of the expired timers of the replica
+            context.pollTimers();
+            // install the key groups migrated to the replica and release the ones migrated to other replicas
+            if (keyGroups.isEnabled()) {
+                keyGroups.poll();
+                if (isKeyGroupMarker(t)) {
+                    keyGroups.release(getKeyGroup(t), this->get_num_inchannels());
+                    return this->GO_ON;
+                }
+            }
+            // watermarks are merged among the input channels and forwarded (unless a key group is migrating to the replica)
+            if (isWatermark(t)) {
+                if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(t))) {
+                    if (!keyGroups.deferWatermark(wm_merger.get())) {
+                        this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+                    }
+                }
+                return this->GO_ON;
+            }
+            // a shared envelope of a split is owned with copy-on-write (the input can be buffered until its key group is installed)
+            t = ownInput(t);
+            // the tuples of the key groups not installed yet are buffered until their state is received
+            uint64_t sample = 0;
+            if (keyGroups.isEnabled()) {
+                if (!keyGroups.admit(std::get<0>(t->getControlFields()), t)) {
+                    return this->GO_ON;
+                }
+                sample = keyGroups.startSample();
+            }
 #if defined (TRACE_WINDFLOW)
             startTS = current_time_nsecs();
             if (stats_record.inputs_received == 0) {
@@ -165,8 +243,10 @@ public:
             stats_record.outputs_sent++;
             stats_record.bytes_sent += sizeof(result_t);
 #endif
-            // extract key from the input tuple
-            auto key = std::get<0>(t->getControlFields()); // key
+            // the inputs pre-aggregated by the emitter are partial results
+            result_t *partial = isPreAggregated ? reinterpret_cast<result_t *>(t) : nullptr;
+            // extract key from the input
+            auto key = (partial != nullptr) ? std::get<0>(partial->getControlFields()) : std::get<0>(t->getControlFields()); // key
             // find the corresponding key descriptor
             auto it = keyMap.find(key);
             if (it == keyMap.end()) {
@@ -175,8 +255,16 @@ public:
                 it = keyMap.find(key);
             }
             Key_Descriptor &key_d = (*it).second;
+            if (partial != nullptr) {
+                // combine the partial result with the current one
+                result_t combined;
+                combined.setControlFields(std::get<0>(partial->getControlFields()), std::get<1>(partial->getControlFields()), std::get<2>(partial->getControlFields()));
+                comb_func(key_d.result, *partial, combined);
+                key_d.result = combined;
+                delete partial;
+            }
             // call the reduce/fold function on the input
-            if (!isRich) {
+            else if (!isRich) {
                 acc_func(*t, key_d.result);
             }
             else {
@@ -184,6 +272,7 @@ public:
             }
             // copy the result
             result_t *r = new result_t(key_d.result);
+            keyGroups.endSample(sample);
 #if defined (TRACE_WINDFLOW)
             endTS = current_time_nsecs();
             endTD = current_time_nsecs();
@@ -202,10 +291,22 @@ public:
         void eosnotify(ssize_t id) override
         {
             eos_received++;
+            // the watermark can advance when an input channel is terminated
+            if (wm_merger.close(id, this->get_num_inchannels())) {
+                if (!keyGroups.deferWatermark(wm_merger.get())) {
+                    this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+                }
+            }
             // check the number of received EOS messages
             if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
                 return;
             }
+            // wait for the key groups still migrating to the replica
+            if (keyGroups.isEnabled()) {
+                keyGroups.drain();
+            }
+            // last check of the timers of the replica
+            context.pollTimers();
             terminated = true;
 #if defined (TRACE_WINDFLOW)
             stats_record.set_Terminated();
@@ -217,6 +318,8 @@ public:
         {
             // call the closing function
             closing_func(context);
+            // delete the shipper object used by the timers of this replica
+            delete shipper;
         }
 
         // method the check the termination of the replica
@@ -244,6 +347,13 @@ public:
      *  \param _name string with the name of the Accumulator operator
      *  \param _closing_func closing function
      *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to parallelism-1
+     *  \param _keyPreserving true if the outputs keep the keys of the corresponding inputs
+     *  \param _orderPreserving true if the outputs of each replica keep the timestamp order of its inputs
+     *  \param _comb_func function combining two partial results (used by the combiner only)
+     *  \param _combiner_capacity maximum number of keys whose tuples are pre-aggregated by the emitter (zero means no combiner)
+     *  \param _combiner_interval interval (in microseconds) between two flushes of the pre-aggregated results (zero means no time-based flushing)
+     *  \param _kg_manager manager of the key groups migrated among the replicas (nullptr means no migration)
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     template<typename F_t>
     Accumulator(F_t _func,
@@ -251,10 +361,23 @@ public:
                 size_t _parallelism,
                 std::string _name,
                 closing_func_t _closing_func,
-                routing_func_t _routing_func):
+                routing_func_t _routing_func,
+                bool _keyPreserving=false,
+                bool _orderPreserving=false,
+                comb_func_t _comb_func=nullptr,
+                size_t _combiner_capacity=0,
+                uint64_t _combiner_interval=0,
+                std::shared_ptr<KeyGroup_Manager> _kg_manager=nullptr,
+                std::vector<int> _cpus={}):
                 name(_name),
                 parallelism(_parallelism),
-                used(false)
+                used(false),
+                routing_func(_routing_func),
+                keyPreserving(_keyPreserving),
+                orderPreserving(_orderPreserving),
+                hasCombiner(_combiner_capacity > 0),
+                kg_manager(_kg_manager),
+                cpus(_cpus)
     {
         // check the validity of the parallelism value
         if (_parallelism == 0) {
@@ -267,7 +390,41 @@ public:
             auto *seq = new Accumulator_Node(_func, _init_value, _name, RuntimeContext(_parallelism, i), _closing_func);
             w.push_back(seq);
         }
-        ff::ff_farm::add_emitter(new Standard_Emitter<tuple_t>(_routing_func, _parallelism));
+        // the key groups are assigned to the replicas by the manager
+        if (kg_manager != nullptr) {
+            if (hasCombiner) {
+                std::cerr << RED << "WindFlow Error: migration of key groups in Accumulator cannot be used with the combiner" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (kg_manager->getNumReplicas() != _parallelism) {
+                std::cerr << RED << "WindFlow Error: manager of the key groups in Accumulator has a wrong number of replicas" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            for (size_t i=0; i<_parallelism; i++) {
+                static_cast<Accumulator_Node *>(w[i])->enableKeyGroups(kg_manager, i);
+            }
+        }
+        // the emitter pre-aggregates the tuples of the same key if the combiner is used
+        if (hasCombiner) {
+            if (_comb_func == nullptr) {
+                std::cerr << RED << "WindFlow Error: combiner in Accumulator requires a combine function" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if constexpr (std::is_invocable<F_t, const tuple_t &, result_t &>::value) {
+                for (auto *node: w) {
+                    static_cast<Accumulator_Node *>(node)->comb_func = _comb_func;
+                    static_cast<Accumulator_Node *>(node)->isPreAggregated = true;
+                }
+                ff::ff_farm::add_emitter(new Combining_Emitter<tuple_t, result_t>(_func, _init_value, _routing_func, _parallelism, _combiner_capacity, _combiner_interval));
+            }
+            else {
+                std::cerr << RED << "WindFlow Error: combiner in Accumulator cannot be used with a rich function" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        else {
+            ff::ff_farm::add_emitter(new Standard_Emitter<tuple_t>(_routing_func, _parallelism, kg_manager));
+        }
         ff::ff_farm::add_workers(w);
         // add default collector
         ff::ff_farm::add_collector(nullptr);
@@ -311,6 +468,92 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Return the routing function of the key-based distribution to the Accumulator
+     *  \return routing function
+     */ 
+    routing_func_t getRoutingFunction() const override
+    {
+        return routing_func;
+    }
+
+    /** 
+     *  \brief Check whether the outputs of the Accumulator keep the keys of the corresponding inputs
+     *  \return true if the keys are preserved
+     */ 
+    bool isKeyPreserving() const override
+    {
+        // with the migration of the key groups, the outputs are not partitioned by the routing function
+        return keyPreserving && (kg_manager == nullptr);
+    }
+
+    /** 
+     *  \brief Check whether the outputs of each replica of the Accumulator keep the timestamp order of its inputs
+     *  \return true if the timestamp order is preserved
+     */ 
+    bool isOrderPreserving() const override
+    {
+        // the inputs of the migrated keys are processed by another replica
+        return orderPreserving && (kg_manager == nullptr);
+    }
+
+    /** 
+     *  \brief Check whether the tuples are pre-aggregated by a combiner before the key-based distribution
+     *  \return true if the combiner is used
+     */ 
+    bool isCombinerUsed() const
+    {
+        return hasCombiner;
+    }
+
+    /** 
+     *  \brief Check whether the key groups are migrated among the replicas
+     *  \return true if the key groups are used
+     */ 
+    bool hasKeyGroups() const
+    {
+        return kg_manager != nullptr;
+    }
+
+    /** 
+     *  \brief Get the manager of the key groups
+     *  \return pointer to the manager of the key groups (nullptr if they are not used)
+     */ 
+    std::shared_ptr<KeyGroup_Manager> getKeyGroupManager() const
+    {
+        return kg_manager;
+    }
+
+    /** 
+     *  \brief Check whether the Accumulator is elastic
+     *  \return true if the number of active replicas can be changed at runtime (through the key groups)
+     */ 
+    bool isElastic() const
+    {
+        return kg_manager != nullptr && kg_manager->getElasticController() != nullptr;
+    }
+
+    /** 
+     *  \brief Get the controller of the active replicas of the Accumulator
+     *  \return controller of the active replicas (nullptr if the Accumulator is not elastic)
+     */ 
+    std::shared_ptr<Elastic_Controller> getElasticController() const
+    {
+        return (kg_manager != nullptr) ? kg_manager->getElasticController() : nullptr;
+    }
+
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        auto placements = _manager.assign(name, this->getWorkers().size(), cpus);
+        for (size_t i=0; i<placements.size(); i++) {
+            static_cast<Accumulator_Node *>(this->getWorkers()[i])->setPlacement(placements[i]);
+        }
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
@@ -379,13 +622,17 @@ public:
         writer.Uint(parallelism);
         writer.Key("Replicas");
         writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
         // get statistics from all the replicas of the operator
         for(auto *w: this->getWorkers()) {
             auto *node = static_cast<Accumulator_Node *>(w);
             Stats_Record record = node->get_StatsRecord();
             record.append_Stats(writer);
+            inputs.push_back(record.inputs_received);
         }
         writer.EndArray();
+        writer.Key("Replica_imbalance");
+        writer.Double(compute_imbalance(inputs));
         writer.EndObject();
     }
 #endif
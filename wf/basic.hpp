@@ -34,6 +34,7 @@
 #include<deque>
 #include<mutex>
 #include<numeric>
+#include<functional>
 #include<sstream>
 #include<iostream>
 #include<errno.h>
@@ -82,9 +83,69 @@ inline unsigned long current_time_nsecs()
 /// default interval time to update the atomic counter of dropped tuples
 #define DEFAULT_UPDATE_INTERVAL_USEC 100000
 
+/// default number of most recent delays used to estimate the slack in PROBABILISTIC mode
+#define DEFAULT_SLACK_WINDOW 10000
+
+/// initial capacity (power of two) of the per-key rings used to reorder the results of window-based operators
+#define DEFAULT_RING_CAPACITY 16
+
+/// number of tuples observed by the emitter of a Key_Farm before a key can be detected as hot (with hot-key splitting)
+#define DEFAULT_HOTKEY_WARMUP 1000
+
+/// default maximum number of keys pre-aggregated by the emitter of an operator with a combiner
+#define DEFAULT_COMBINER_CAPACITY 1024
+
+/// default interval (in microseconds) between two decisions of the policy migrating the key groups among the replicas
+#define DEFAULT_KEYGROUP_INTERVAL_USEC 100000
+
+/// default relative difference of the busy times of two replicas triggering the migration of a key group
+#define DEFAULT_KEYGROUP_IMBALANCE 0.2
+
+/// number of tuples (power of two) routed by an emitter between two reports of the load of the key groups
+#define DEFAULT_KEYGROUP_REPORT 1024
+
+/// one input every DEFAULT_KEYGROUP_SAMPLING (power of two) is timed to estimate the busy time of a replica
+#define DEFAULT_KEYGROUP_SAMPLING 16
+
+/// default interval (in microseconds) between two evaluations of the autoscaler of an elastic operator
+#define DEFAULT_ELASTIC_INTERVAL_USEC 1000000
+
+/// default utilization of the active replicas of an elastic operator below which a replica is removed
+#define DEFAULT_ELASTIC_LOW_UTILIZATION 0.3
+
+/// default utilization of the active replicas of an elastic operator above which a replica is added
+#define DEFAULT_ELASTIC_HIGH_UTILIZATION 0.8
+
+/// default number of inputs per active replica not processed yet above which a replica is added
+#define DEFAULT_ELASTIC_BACKLOG 4096
+
+/// default number of key groups per replica of a keyed elastic operator (if the key groups are not configured)
+#define DEFAULT_ELASTIC_GROUPS_PER_REPLICA 8
+
+/// number of inputs (power of two) routed by an emitter between two reports to the controller of an elastic operator
+#define DEFAULT_ELASTIC_REPORT 256
+
+/// one input every DEFAULT_ELASTIC_SAMPLING (power of two) is timed to estimate the busy time of a replica of an elastic operator
+#define DEFAULT_ELASTIC_SAMPLING 16
+
+/// default number of credits per replica (inputs sent and not processed yet) of an operator with on-demand scheduling
+#define DEFAULT_ONDEMAND_CREDITS 16
+
+/// number of inputs (power of two) between two reports of the inputs sent to and processed by the replicas of a Win_Farm with the dynamic scheduling
+#define DEFAULT_WIN_SCHEDULER_REPORT 256
+
+/// one input every DEFAULT_WIN_SCHEDULER_SAMPLING (power of two) is timed to estimate the processing cost of the inputs of a Win_Farm with the dynamic scheduling
+#define DEFAULT_WIN_SCHEDULER_SAMPLING 16
+
+/// minimum number of tuples of a segment of the archive of a key shared by the replicas of a Win_Farm
+#define DEFAULT_SEGMENT_CAPACITY 256
+
 /// supported processing modes of the PipeGraph
 enum class Mode { DEFAULT, DETERMINISTIC, PROBABILISTIC };
 
+/// placement policies of the operator replicas on the CPUs (NONE leaves the mapping of the threads to FastFlow)
+enum class Placement { NONE, COMPACT, SPREAD };
+
 /// supported window types of window-based operators
 enum class win_type_t { CB, TB };
 
@@ -94,9 +155,78 @@ enum class opt_level_t { LEVEL0, LEVEL1, LEVEL2 };
 /// enumeration of the routing modes of inputs to operator replicas
 enum class routing_modes_t { NONE, FORWARD, KEYBY, COMPLEX };
 
+/** 
+ *  \brief Function to mix the bits of a 64-bit value (finalizer of MurmurHash3)
+ *  
+ *  This function is used to spread the hashcodes of the keys before mapping them onto
+ *  the replicas. It is needed since std::hash is the identity for the integral types,
+ *  so keys with a stride (e.g., all even) would be mapped onto a few replicas.
+ *  
+ *  \param _x value to be mixed
+ *  \return mixed value
+ */ 
+inline uint64_t mix64(uint64_t _x)
+{
+    _x ^= _x >> 33;
+    _x *= 0xff51afd7ed558ccdULL;
+    _x ^= _x >> 33;
+    _x *= 0xc4ceb9fe1a85ec53ULL;
+    _x ^= _x >> 33;
+    return _x;
+}
+
+/** 
+ *  \brief Default routing function of the key-based distribution
+ *  
+ *  \param _hashcode hashcode of the key
+ *  \param _n_dest number of destinations
+ *  \return identifier of the destination starting from zero to _n_dest-1
+ */ 
+inline size_t default_routing(size_t _hashcode, size_t _n_dest)
+{
+    return mix64(_hashcode) % _n_dest;
+}
+
+//@cond DOXY_IGNORE
+
+// check whether two routing functions are known to be the same function (only plain functions can be compared)
+inline bool isSameRouting(const std::function<size_t(size_t, size_t)> &_f1, const std::function<size_t(size_t, size_t)> &_f2)
+{
+    using routing_ptr_t = size_t (*)(size_t, size_t);
+    const routing_ptr_t *p1 = _f1.template target<routing_ptr_t>();
+    const routing_ptr_t *p2 = _f2.template target<routing_ptr_t>();
+    return (p1 != nullptr) && (p2 != nullptr) && (*p1 == *p2);
+}
+
+//@endcond
+
 /// existing types of window-based operators in the library
 enum class pattern_t { SEQ_CPU, SEQ_GPU, KF_CPU, KFF_CPU, KF_GPU, KFF_GPU, WF_CPU, WF_GPU, PF_CPU, PF_GPU, WMR_CPU, WMR_GPU };
 
+/** 
+ *  \brief Policy of the slack used to reorder inputs in PROBABILISTIC mode
+ *  
+ *  If the target drop rate is zero, the slack K only grows with the maximum delay
+ *  observed so far. Otherwise, K is periodically estimated as the quantile of the
+ *  most recent delays such that the given fraction of inputs is expected to be
+ *  dropped, so it can also shrink. In both cases K never exceeds the maximum
+ *  slack (if it is not zero), which acts as a latency budget of the reordering.
+ */ 
+struct Slack_Policy
+{
+    uint64_t max_slack; // maximum value of K in time units (zero means unbounded)
+    double target_drop_rate; // fraction of inputs that can be dropped (zero means that K never shrinks)
+    size_t window; // number of most recent delays used to estimate K
+
+    // Constructor
+    Slack_Policy(uint64_t _max_slack=0,
+                 double _target_drop_rate=0,
+                 size_t _window=DEFAULT_SLACK_WINDOW):
+                 max_slack(_max_slack),
+                 target_drop_rate(_target_drop_rate),
+                 window(_window) {}
+};
+
 //@cond DOXY_IGNORE
 
 #if __CUDACC__
@@ -210,9 +340,21 @@ template<typename tuple_t, typename result_t, typename input_t=tuple_t>
 class Win_Seq;
 
 /// forward declaration of the Win_SeqFFAT operator
-template<typename tuple_t, typename result_t>
+template<typename tuple_t, typename result_t, typename input_t=tuple_t>
 class Win_SeqFFAT;
 
+/// forward declaration of the Win_SeqMFFAT operator
+template<typename tuple_t, typename result_t>
+class Win_SeqMFFAT;
+
+/// forward declaration of the Win_SeqRollup operator
+template<typename tuple_t, typename result_t>
+class Win_SeqRollup;
+
+/// forward declaration of the Win_SeqSession operator
+template<typename tuple_t, typename result_t>
+class Win_SeqSession;
+
 /// forward declaration of the Win_Farm operator
 template<typename tuple_t, typename result_t, typename input_t=tuple_t>
 class Win_Farm;
@@ -225,6 +367,22 @@ class Key_Farm;
 template<typename tuple_t, typename result_t>
 class Key_FFAT;
 
+/// forward declaration of the Win_FFAT operator
+template<typename tuple_t, typename result_t>
+class Win_FFAT;
+
+/// forward declaration of the Key_MFFAT operator
+template<typename tuple_t, typename result_t>
+class Key_MFFAT;
+
+/// forward declaration of the Key_Rollup operator
+template<typename tuple_t, typename result_t>
+class Key_Rollup;
+
+/// forward declaration of the Key_Session operator
+template<typename tuple_t, typename result_t>
+class Key_Session;
+
 /// forward declaration of the Pane_Farm operator
 template<typename tuple_t, typename result_t, typename input_t=tuple_t>
 class Pane_Farm;
@@ -279,10 +437,22 @@ inline MultiPipe *merge_multipipes_func(PipeGraph *, std::vector<MultiPipe *>);
 // forward declaration of the split_multipipe_func function
 inline std::vector<MultiPipe *> split_multipipe_func(PipeGraph *, MultiPipe *);
 
+// forward declaration of the get_slack_policy_func function
+inline Slack_Policy get_slack_policy_func(PipeGraph *);
+
 #if defined (TRACE_WINDFLOW)
     /// forward declaration of the MonitoringThread class
     class MonitoringThread;
 
+    // forward declaration of the Stats_Record class
+    class Stats_Record;
+
+    // forward declaration of the add_slack_stats_func function
+    inline void add_slack_stats_func(PipeGraph *graph, Stats_Record *record);
+
+    // forward declaration of the add_plan_func function
+    inline void add_plan_func(PipeGraph *graph, std::string op_name, std::string connection, std::string reordering);
+
     // forward declaration of the is_ended_func function
     inline bool is_ended_func(PipeGraph *graph);
 
@@ -32,6 +32,7 @@
 
 /// includes
 #include<basic.hpp>
+#include<placement.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
     #include<rapidjson/prettywriter.h>
@@ -67,6 +68,33 @@ public:
      */ 
     virtual routing_modes_t getRoutingMode() const = 0;
 
+    /** 
+     *  \brief Return the routing function of the key-based distribution to the operator
+     *  \return routing function (empty if the inputs are not distributed on a key basis by a routing function)
+     */ 
+    virtual std::function<size_t(size_t, size_t)> getRoutingFunction() const
+    {
+        return nullptr;
+    }
+
+    /** 
+     *  \brief Check whether the outputs of the operator keep the keys of the corresponding inputs
+     *  \return true if the keys are preserved
+     */ 
+    virtual bool isKeyPreserving() const
+    {
+        return false;
+    }
+
+    /** 
+     *  \brief Check whether the outputs of each replica of the operator keep the timestamp order of its inputs
+     *  \return true if the timestamp order is preserved
+     */ 
+    virtual bool isOrderPreserving() const
+    {
+        return false;
+    }
+
     /** 
      *  \brief Check whether the operator has been used in a MultiPipe
      *  \return true if the operator has been added/chained to an existing MultiPipe
@@ -79,6 +107,19 @@ public:
      */ 
     virtual bool isTerminated() const = 0;
 
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *         (the replicas of the operators not overriding this method, i.e. the GPU ones,
+     *         are mapped by FastFlow)
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    virtual void place(Placement_Manager &_manager)
+    {
+        if (_manager.getPolicy() != Placement::NONE) {
+            std::cerr << YELLOW << "WindFlow Warning: replicas of operator " << this->getName() << " are not placed by the PipeGraph" << DEFAULT_COLOR << std::endl;
+        }
+    }
+
 #if defined (TRACE_WINDFLOW)
     /// Dump the log file (JSON format) in the LOG_DIR directory
     virtual void dump_LogFile() const = 0;
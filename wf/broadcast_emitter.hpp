@@ -34,6 +34,7 @@
 #include<ff/multinode.hpp>
 #include<meta.hpp>
 #include<basic_emitter.hpp>
+#include<watermark.hpp>
 
 namespace wf {
 
@@ -70,6 +71,22 @@ public:
     // svc method (utilized by the FastFlow runtime)
     void *svc(void *in) override
     {
+        // watermarks are broadcast to all the destinations
+        if (isWatermark(in)) {
+            for (size_t i=0; i<n_dest; i++) {
+                if (!isCombined) {
+                    this->ff_send_out_to(in, i);
+                }
+                else {
+                    output_queue.push_back(std::make_pair(in, i));
+                }
+            }
+            return this->GO_ON;
+        }
+        // a shared envelope of a split is owned with copy-on-write before being wrapped
+        if constexpr (std::is_same<tuple_t, input_t>::value) {
+            in = ownInput(reinterpret_cast<tuple_t *>(in));
+        }
         input_t *wt = reinterpret_cast<input_t *>(in);
         wrapper_in_t *out = prepareWrapper<input_t, wrapper_in_t>(wt, n_dest);
         for(size_t i=0; i<n_dest; i++) {
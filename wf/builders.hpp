@@ -35,6 +35,8 @@
 #include<functional>
 #include<meta.hpp>
 #include<basic.hpp>
+#include<key_groups.hpp>
+#include<elastic.hpp>
 
 namespace wf {
 
@@ -64,7 +66,14 @@ private:
     using closing_func_t = std::function<void(RuntimeContext&)>;
     uint64_t pardegree = 1;
     std::string name = "source";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
+    bool wm_enabled = false;
+    uint64_t wm_period = 0;
+    uint64_t wm_lateness = 0;
+    uint64_t wm_idle_timeout = 0;
+    bool align_enabled = false;
+    uint64_t align_delta = 0;
 
 public:
     /** 
@@ -115,6 +124,58 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to enable the generation of watermarks by the Source operator (DEFAULT mode only)
+     *  
+     *  \param _period a watermark is generated each time the highest timestamp produced by a replica
+     *         advances by _period time units (zero means that watermarks are generated only by the
+     *         function through the pushWatermark method of the Shipper)
+     *  \param _lateness the watermarks generated periodically are _lateness time units behind the
+     *         highest timestamp produced by the replica
+     *  \param _idle_timeout a replica whose function has not sent anything for _idle_timeout microseconds
+     *         of wall-clock time is idle, and it does not hold back the watermark until its next output
+     *         (zero means disabled, used only by the functions sending their outputs through the Shipper)
+     *  \return the object itself
+     */ 
+    Source_Builder<F_t> &withWatermarks(uint64_t _period, uint64_t _lateness=0, uint64_t _idle_timeout=0)
+    {
+        wm_enabled = true;
+        wm_period = _period;
+        wm_lateness = _lateness;
+        wm_idle_timeout = _idle_timeout;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to align the replicas of the Source operator in event time. A replica is throttled
+     *         while the timestamp of its next tuple is more than _delta time units ahead of the lowest
+     *         timestamp generated by the other replicas. This bounds the inputs buffered by the nodes
+     *         reordering the stream in the DETERMINISTIC and PROBABILISTIC modes
+     *  
+     *  \param _delta maximum distance (in time units) from the lowest timestamp of the other replicas
+     *  \return the object itself
+     */ 
+    Source_Builder<F_t> &withEventTimeAlignment(uint64_t _delta)
+    {
+        align_enabled = true;
+        align_delta = _delta;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Source operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    Source_Builder<F_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Source operator (only C++17)
@@ -126,7 +187,14 @@ public:
         return source_t(func, 
                         pardegree,
                         name,
-                        closing_func); // guaranteed copy elision in C++17
+                        closing_func,
+                        wm_enabled,
+                        wm_period,
+                        wm_lateness,
+                        align_enabled,
+                        align_delta,
+                        cpus,
+                        wm_idle_timeout); // guaranteed copy elision in C++17
     }
 #endif
 
@@ -140,7 +208,14 @@ public:
         return new source_t(func,
                             pardegree,
                             name,
-                            closing_func);
+                            closing_func,
+                            wm_enabled,
+                            wm_period,
+                            wm_lateness,
+                            align_enabled,
+                            align_delta,
+                            cpus,
+                            wm_idle_timeout);
     }
 
     /** 
@@ -153,7 +228,14 @@ public:
         return std::make_unique<source_t>(func,
                                           pardegree,
                                           name,
-                                          closing_func);
+                                          closing_func,
+                                          wm_enabled,
+                                          wm_period,
+                                          wm_lateness,
+                                          align_enabled,
+                                          align_delta,
+                                          cpus,
+                                          wm_idle_timeout);
     }
 };
 
@@ -188,9 +270,39 @@ private:
     using routing_func_t = std::function<size_t(size_t, size_t)>;
     uint64_t pardegree = 1;
     std::string name = "filter";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     bool isKeyBy = false;
+    bool keyPreserving = false;
+    bool orderPreserving = false;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    routing_func_t routing_func = default_routing;
+
+    size_t elastic_max = 0; // zero means not elastic
+    size_t elastic_min = 1;
+    uint64_t as_interval = 0; // zero means no autoscaler
+    double as_low = DEFAULT_ELASTIC_LOW_UTILIZATION;
+    double as_high = DEFAULT_ELASTIC_HIGH_UTILIZATION;
+    uint64_t as_backlog = DEFAULT_ELASTIC_BACKLOG;
+    size_t od_credits = 0; // zero means the pseudo round-robin distribution
+
+    // get the number of replicas of the operator (the maximum number of active replicas if it is elastic)
+    size_t getNumReplicas() const
+    {
+        return std::max<size_t>(pardegree, elastic_max);
+    }
+
+    // create the controller of the active replicas (nullptr if the operator is not elastic)
+    std::shared_ptr<Elastic_Controller> createElasticController() const
+    {
+        if (elastic_max == 0 && as_interval == 0) {
+            return nullptr;
+        }
+        auto elastic = std::make_shared<Elastic_Controller>(getNumReplicas(), pardegree, elastic_min);
+        if (as_interval > 0) {
+            elastic->enableAutoscaling(as_interval, as_low, as_high, as_backlog);
+        }
+        return elastic;
+    }
 
 public:
     /** 
@@ -235,6 +347,33 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to state that the Filter operator keeps the keys of its inputs in the outputs
+     *         (a following key-based distribution with the same parallelism and routing function
+     *          can be elided by the MultiPipe)
+     *  
+     *  \return the object itself
+     */ 
+    Filter_Builder<F_t> &enable_KeyPreservation()
+    {
+        keyPreserving = true;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to state that each replica of the Filter operator produces its outputs in the
+     *         timestamp order of its inputs (the user function does not change the timestamps in a
+     *         way breaking the order, and a following reordering of the inputs can be elided by the
+     *         MultiPipe in DETERMINISTIC mode)
+     *  
+     *  \return the object itself
+     */ 
+    Filter_Builder<F_t> &enable_OrderPreservation()
+    {
+        orderPreserving = true;
+        return *this;
+    }
+
     /** 
      *  \brief Method to specify the closing logic used by the operator
      *  
@@ -252,6 +391,89 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing (used if the key-based routing is enabled)
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    Filter_Builder<F_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to make the Filter operator elastic (not with the key-based routing). The operator
+     *         has _max_parallelism replicas and the inputs are distributed to the first ones only (initially
+     *         as many as the parallelism, then as set through its Elastic_Controller or by the autoscaler)
+     *  
+     *  \param _max_parallelism maximum number of active replicas
+     *  \param _min_parallelism minimum number of active replicas
+     *  \return the object itself
+     */ 
+    Filter_Builder<F_t> &withElasticity(size_t _max_parallelism,
+                                        size_t _min_parallelism=1)
+    {
+        elastic_max = _max_parallelism;
+        elastic_min = _min_parallelism;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the autoscaler changing the number of active replicas of the Filter operator
+     *         (up to the maximum set with withElasticity, or to the parallelism otherwise). A replica is added
+     *         when the utilization or the backlog of the active replicas is too high, and it is removed when
+     *         the utilization is low enough to be sustained by the remaining ones
+     *  
+     *  \param _interval interval between two evaluations of the autoscaler
+     *  \param _low_util utilization of the active replicas below which a replica is removed
+     *  \param _high_util utilization of the active replicas above which a replica is added
+     *  \param _max_backlog inputs per active replica not processed yet above which a replica is added (zero means no limit)
+     *  \return the object itself
+     */ 
+    Filter_Builder<F_t> &withAutoscaling(std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_ELASTIC_INTERVAL_USEC),
+                                         double _low_util=DEFAULT_ELASTIC_LOW_UTILIZATION,
+                                         double _high_util=DEFAULT_ELASTIC_HIGH_UTILIZATION,
+                                         uint64_t _max_backlog=DEFAULT_ELASTIC_BACKLOG)
+    {
+        as_interval = std::max<uint64_t>(_interval.count(), 1);
+        as_low = _low_util;
+        as_high = _high_util;
+        as_backlog = _max_backlog;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the on-demand scheduling of the inputs (not with the key-based routing
+     *         and not with the elasticity). Each input is sent to the replica with the shortest queue
+     *         among the ones with a free credit, and a credit is released when the replica has processed
+     *         the input (useful when the processing cost of the inputs is highly variable)
+     *  
+     *  \param _credits number of credits per replica (maximum number of inputs queued to a replica)
+     *  \return the object itself
+     */ 
+    Filter_Builder<F_t> &withOnDemandScheduling(size_t _credits=DEFAULT_ONDEMAND_CREDITS)
+    {
+        od_credits = std::max<size_t>(_credits, 1);
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Filter operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    Filter_Builder<F_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Filter operator (only C++17)
@@ -262,16 +484,26 @@ public:
     {
         if (!isKeyBy) {
             return filter_t(func,
-                            pardegree,
+                            getNumReplicas(),
                             name,
-                            closing_func); // guaranteed copy elision in C++17
+                            closing_func,
+                            keyPreserving,
+                            orderPreserving,
+                            createElasticController(),
+                            od_credits,
+                            cpus); // guaranteed copy elision in C++17
         }
         else {
             return filter_t(func,
-                            pardegree,
+                            getNumReplicas(),
                             name,
                             closing_func,
-                            routing_func); // guaranteed copy elision in C++17
+                            routing_func,
+                            keyPreserving,
+                            orderPreserving,
+                            createElasticController(),
+                            od_credits,
+                            cpus); // guaranteed copy elision in C++17
         }
     }
 #endif
@@ -285,16 +517,26 @@ public:
     {
         if (!isKeyBy) {
             return new filter_t(func,
-                                pardegree,
+                                getNumReplicas(),
                                 name,
-                                closing_func);
+                                closing_func,
+                                keyPreserving,
+                                orderPreserving,
+                                createElasticController(),
+                                od_credits,
+                                cpus);
         }
         else {
             return new filter_t(func,
-                                pardegree,
+                                getNumReplicas(),
                                 name,
                                 closing_func,
-                                routing_func);
+                                routing_func,
+                                keyPreserving,
+                                orderPreserving,
+                                createElasticController(),
+                                od_credits,
+                                cpus);
         }
     }
 
@@ -307,16 +549,26 @@ public:
     {
         if (!isKeyBy) {
             return std::make_unique<filter_t>(func,
-                                              pardegree,
+                                              getNumReplicas(),
                                               name,
-                                              closing_func);
+                                              closing_func,
+                                              keyPreserving,
+                                              orderPreserving,
+                                              createElasticController(),
+                                              od_credits,
+                                              cpus);
         }
         else {
             return std::make_unique<filter_t>(func,
-                                              pardegree,
+                                              getNumReplicas(),
                                               name,
                                               closing_func,
-                                              routing_func);
+                                              routing_func,
+                                              keyPreserving,
+                                              orderPreserving,
+                                              createElasticController(),
+                                              od_credits,
+                                              cpus);
         }
     }
 };
@@ -350,9 +602,39 @@ private:
     using routing_func_t = std::function<size_t(size_t, size_t)>;
     uint64_t pardegree = 1;
     std::string name = "map";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     bool isKeyBy = false;
+    bool keyPreserving = false;
+    bool orderPreserving = false;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    routing_func_t routing_func = default_routing;
+
+    size_t elastic_max = 0; // zero means not elastic
+    size_t elastic_min = 1;
+    uint64_t as_interval = 0; // zero means no autoscaler
+    double as_low = DEFAULT_ELASTIC_LOW_UTILIZATION;
+    double as_high = DEFAULT_ELASTIC_HIGH_UTILIZATION;
+    uint64_t as_backlog = DEFAULT_ELASTIC_BACKLOG;
+    size_t od_credits = 0; // zero means the pseudo round-robin distribution
+
+    // get the number of replicas of the operator (the maximum number of active replicas if it is elastic)
+    size_t getNumReplicas() const
+    {
+        return std::max<size_t>(pardegree, elastic_max);
+    }
+
+    // create the controller of the active replicas (nullptr if the operator is not elastic)
+    std::shared_ptr<Elastic_Controller> createElasticController() const
+    {
+        if (elastic_max == 0 && as_interval == 0) {
+            return nullptr;
+        }
+        auto elastic = std::make_shared<Elastic_Controller>(getNumReplicas(), pardegree, elastic_min);
+        if (as_interval > 0) {
+            elastic->enableAutoscaling(as_interval, as_low, as_high, as_backlog);
+        }
+        return elastic;
+    }
 
 public:
     /** 
@@ -397,6 +679,33 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to state that the Map operator keeps the keys of its inputs in the outputs
+     *         (a following key-based distribution with the same parallelism and routing function
+     *          can be elided by the MultiPipe)
+     *  
+     *  \return the object itself
+     */ 
+    Map_Builder<F_t> &enable_KeyPreservation()
+    {
+        keyPreserving = true;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to state that each replica of the Map operator produces its outputs in the
+     *         timestamp order of its inputs (the user function does not change the timestamps in a
+     *         way breaking the order, and a following reordering of the inputs can be elided by the
+     *         MultiPipe in DETERMINISTIC mode)
+     *  
+     *  \return the object itself
+     */ 
+    Map_Builder<F_t> &enable_OrderPreservation()
+    {
+        orderPreserving = true;
+        return *this;
+    }
+
     /** 
      *  \brief Method to specify the closing logic used by the operator
      *  
@@ -414,6 +723,89 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing (used if the key-based routing is enabled)
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    Map_Builder<F_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to make the Map operator elastic (not with the key-based routing). The operator
+     *         has _max_parallelism replicas and the inputs are distributed to the first ones only (initially
+     *         as many as the parallelism, then as set through its Elastic_Controller or by the autoscaler)
+     *  
+     *  \param _max_parallelism maximum number of active replicas
+     *  \param _min_parallelism minimum number of active replicas
+     *  \return the object itself
+     */ 
+    Map_Builder<F_t> &withElasticity(size_t _max_parallelism,
+                                     size_t _min_parallelism=1)
+    {
+        elastic_max = _max_parallelism;
+        elastic_min = _min_parallelism;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the autoscaler changing the number of active replicas of the Map operator
+     *         (up to the maximum set with withElasticity, or to the parallelism otherwise). A replica is added
+     *         when the utilization or the backlog of the active replicas is too high, and it is removed when
+     *         the utilization is low enough to be sustained by the remaining ones
+     *  
+     *  \param _interval interval between two evaluations of the autoscaler
+     *  \param _low_util utilization of the active replicas below which a replica is removed
+     *  \param _high_util utilization of the active replicas above which a replica is added
+     *  \param _max_backlog inputs per active replica not processed yet above which a replica is added (zero means no limit)
+     *  \return the object itself
+     */ 
+    Map_Builder<F_t> &withAutoscaling(std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_ELASTIC_INTERVAL_USEC),
+                                      double _low_util=DEFAULT_ELASTIC_LOW_UTILIZATION,
+                                      double _high_util=DEFAULT_ELASTIC_HIGH_UTILIZATION,
+                                      uint64_t _max_backlog=DEFAULT_ELASTIC_BACKLOG)
+    {
+        as_interval = std::max<uint64_t>(_interval.count(), 1);
+        as_low = _low_util;
+        as_high = _high_util;
+        as_backlog = _max_backlog;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the on-demand scheduling of the inputs (not with the key-based routing
+     *         and not with the elasticity). Each input is sent to the replica with the shortest queue
+     *         among the ones with a free credit, and a credit is released when the replica has processed
+     *         the input (useful when the processing cost of the inputs is highly variable)
+     *  
+     *  \param _credits number of credits per replica (maximum number of inputs queued to a replica)
+     *  \return the object itself
+     */ 
+    Map_Builder<F_t> &withOnDemandScheduling(size_t _credits=DEFAULT_ONDEMAND_CREDITS)
+    {
+        od_credits = std::max<size_t>(_credits, 1);
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Map operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    Map_Builder<F_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Map operator (only C++17)
@@ -424,16 +816,26 @@ public:
     {
         if (!isKeyBy) {
             return map_t(func,
-                         pardegree,
+                         getNumReplicas(),
                          name,
-                         closing_func); // guaranteed copy elision in C++17
+                         closing_func,
+                         keyPreserving,
+                         orderPreserving,
+                         createElasticController(),
+                         od_credits,
+                         cpus); // guaranteed copy elision in C++17
         }
         else {
             return map_t(func,
-                         pardegree,
+                         getNumReplicas(),
                          name,
                          closing_func,
-                         routing_func); // guaranteed copy elision in C++17
+                         routing_func,
+                         keyPreserving,
+                         orderPreserving,
+                         createElasticController(),
+                         od_credits,
+                         cpus); // guaranteed copy elision in C++17
         }
     }
 #endif
@@ -447,16 +849,26 @@ public:
     {
         if (!isKeyBy) {
             return new map_t(func,
-                             pardegree,
+                             getNumReplicas(),
                              name,
-                             closing_func);
+                             closing_func,
+                             keyPreserving,
+                             orderPreserving,
+                             createElasticController(),
+                             od_credits,
+                             cpus);
         }
         else {
             return new map_t(func,
-                             pardegree,
+                             getNumReplicas(),
                              name,
                              closing_func,
-                             routing_func);
+                             routing_func,
+                             keyPreserving,
+                             orderPreserving,
+                             createElasticController(),
+                             od_credits,
+                             cpus);
         }
     }
 
@@ -469,16 +881,26 @@ public:
     {
         if (!isKeyBy) {
             return std::make_unique<map_t>(func,
-                                           pardegree,
+                                           getNumReplicas(),
                                            name,
-                                           closing_func);
+                                           closing_func,
+                                           keyPreserving,
+                                           orderPreserving,
+                                           createElasticController(),
+                                           od_credits,
+                                           cpus);
         }
         else {
             return std::make_unique<map_t>(func,
-                                           pardegree,
+                                           getNumReplicas(),
                                            name,
                                            closing_func,
-                                           routing_func);
+                                           routing_func,
+                                           keyPreserving,
+                                           orderPreserving,
+                                           createElasticController(),
+                                           od_credits,
+                                           cpus);
         }
     }
 };
@@ -510,9 +932,39 @@ private:
     using routing_func_t = std::function<size_t(size_t, size_t)>;
     uint64_t pardegree = 1;
     std::string name = "flatmap";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     bool isKeyBy = false;
+    bool keyPreserving = false;
+    bool orderPreserving = false;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    routing_func_t routing_func = default_routing;
+
+    size_t elastic_max = 0; // zero means not elastic
+    size_t elastic_min = 1;
+    uint64_t as_interval = 0; // zero means no autoscaler
+    double as_low = DEFAULT_ELASTIC_LOW_UTILIZATION;
+    double as_high = DEFAULT_ELASTIC_HIGH_UTILIZATION;
+    uint64_t as_backlog = DEFAULT_ELASTIC_BACKLOG;
+    size_t od_credits = 0; // zero means the pseudo round-robin distribution
+
+    // get the number of replicas of the operator (the maximum number of active replicas if it is elastic)
+    size_t getNumReplicas() const
+    {
+        return std::max<size_t>(pardegree, elastic_max);
+    }
+
+    // create the controller of the active replicas (nullptr if the operator is not elastic)
+    std::shared_ptr<Elastic_Controller> createElasticController() const
+    {
+        if (elastic_max == 0 && as_interval == 0) {
+            return nullptr;
+        }
+        auto elastic = std::make_shared<Elastic_Controller>(getNumReplicas(), pardegree, elastic_min);
+        if (as_interval > 0) {
+            elastic->enableAutoscaling(as_interval, as_low, as_high, as_backlog);
+        }
+        return elastic;
+    }
 
 public:
     /** 
@@ -557,6 +1009,33 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to state that the FlatMap operator keeps the keys of its inputs in the outputs
+     *         (a following key-based distribution with the same parallelism and routing function
+     *          can be elided by the MultiPipe)
+     *  
+     *  \return the object itself
+     */ 
+    FlatMap_Builder<F_t> &enable_KeyPreservation()
+    {
+        keyPreserving = true;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to state that each replica of the FlatMap operator produces its outputs in the
+     *         timestamp order of its inputs (the user function does not change the timestamps in a
+     *         way breaking the order, and a following reordering of the inputs can be elided by the
+     *         MultiPipe in DETERMINISTIC mode)
+     *  
+     *  \return the object itself
+     */ 
+    FlatMap_Builder<F_t> &enable_OrderPreservation()
+    {
+        orderPreserving = true;
+        return *this;
+    }
+
     /** 
      *  \brief Method to specify the closing logic used by the operator
      *  
@@ -574,6 +1053,89 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing (used if the key-based routing is enabled)
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    FlatMap_Builder<F_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to make the FlatMap operator elastic (not with the key-based routing). The operator
+     *         has _max_parallelism replicas and the inputs are distributed to the first ones only (initially
+     *         as many as the parallelism, then as set through its Elastic_Controller or by the autoscaler)
+     *  
+     *  \param _max_parallelism maximum number of active replicas
+     *  \param _min_parallelism minimum number of active replicas
+     *  \return the object itself
+     */ 
+    FlatMap_Builder<F_t> &withElasticity(size_t _max_parallelism,
+                                         size_t _min_parallelism=1)
+    {
+        elastic_max = _max_parallelism;
+        elastic_min = _min_parallelism;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the autoscaler changing the number of active replicas of the FlatMap operator
+     *         (up to the maximum set with withElasticity, or to the parallelism otherwise). A replica is added
+     *         when the utilization or the backlog of the active replicas is too high, and it is removed when
+     *         the utilization is low enough to be sustained by the remaining ones
+     *  
+     *  \param _interval interval between two evaluations of the autoscaler
+     *  \param _low_util utilization of the active replicas below which a replica is removed
+     *  \param _high_util utilization of the active replicas above which a replica is added
+     *  \param _max_backlog inputs per active replica not processed yet above which a replica is added (zero means no limit)
+     *  \return the object itself
+     */ 
+    FlatMap_Builder<F_t> &withAutoscaling(std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_ELASTIC_INTERVAL_USEC),
+                                          double _low_util=DEFAULT_ELASTIC_LOW_UTILIZATION,
+                                          double _high_util=DEFAULT_ELASTIC_HIGH_UTILIZATION,
+                                          uint64_t _max_backlog=DEFAULT_ELASTIC_BACKLOG)
+    {
+        as_interval = std::max<uint64_t>(_interval.count(), 1);
+        as_low = _low_util;
+        as_high = _high_util;
+        as_backlog = _max_backlog;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the on-demand scheduling of the inputs (not with the key-based routing
+     *         and not with the elasticity). Each input is sent to the replica with the shortest queue
+     *         among the ones with a free credit, and a credit is released when the replica has processed
+     *         the input (useful when the processing cost of the inputs is highly variable)
+     *  
+     *  \param _credits number of credits per replica (maximum number of inputs queued to a replica)
+     *  \return the object itself
+     */ 
+    FlatMap_Builder<F_t> &withOnDemandScheduling(size_t _credits=DEFAULT_ONDEMAND_CREDITS)
+    {
+        od_credits = std::max<size_t>(_credits, 1);
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the FlatMap operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    FlatMap_Builder<F_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the FlatMap operator (only C++17)
@@ -584,16 +1146,26 @@ public:
     {
         if (!isKeyBy) {
             return flatmap_t(func,
-                             pardegree,
+                             getNumReplicas(),
                              name,
-                             closing_func); // guaranteed copy elision in C++17
+                             closing_func,
+                             keyPreserving,
+                             orderPreserving,
+                             createElasticController(),
+                             od_credits,
+                             cpus); // guaranteed copy elision in C++17
         }
         else {
             return flatmap_t(func,
-                             pardegree,
+                             getNumReplicas(),
                              name,
                              closing_func,
-                             routing_func); // guaranteed copy elision in C++17
+                             routing_func,
+                             keyPreserving,
+                             orderPreserving,
+                             createElasticController(),
+                             od_credits,
+                             cpus); // guaranteed copy elision in C++17
         }
     }
 #endif
@@ -607,16 +1179,26 @@ public:
     {
         if (!isKeyBy) {
             return new flatmap_t(func,
-                                 pardegree,
+                                 getNumReplicas(),
                                  name,
-                                 closing_func);
+                                 closing_func,
+                                 keyPreserving,
+                                 orderPreserving,
+                                 createElasticController(),
+                                 od_credits,
+                                 cpus);
         }
         else {
             return new flatmap_t(func,
-                                 pardegree,
+                                 getNumReplicas(),
                                  name,
                                  closing_func,
-                                 routing_func);
+                                 routing_func,
+                                 keyPreserving,
+                                 orderPreserving,
+                                 createElasticController(),
+                                 od_credits,
+                                 cpus);
         }
     }
 
@@ -629,16 +1211,26 @@ public:
     {
         if (!isKeyBy) {
             return std::make_unique<flatmap_t>(func,
-                                               pardegree,
+                                               getNumReplicas(),
                                                name,
-                                               closing_func);
+                                               closing_func,
+                                               keyPreserving,
+                                               orderPreserving,
+                                               createElasticController(),
+                                               od_credits,
+                                               cpus);
         }
         else {
             return std::make_unique<flatmap_t>(func,
-                                               pardegree,
+                                               getNumReplicas(),
                                                name,
                                                closing_func,
-                                               routing_func);
+                                               routing_func,
+                                               keyPreserving,
+                                               orderPreserving,
+                                               createElasticController(),
+                                               od_credits,
+                                               cpus);
         }
     }
 };
@@ -670,9 +1262,61 @@ private:
     using routing_func_t = std::function<size_t(size_t, size_t)>;
     uint64_t pardegree = 1;
     std::string name = "accumulator";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     result_t init_value;
+    bool keyPreserving = false;
+    bool orderPreserving = false;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    routing_func_t routing_func = default_routing;
+    // type of the combine function of two partial results
+    using comb_func_t = typename accumulator_t::comb_func_t;
+    comb_func_t comb_func = nullptr;
+    size_t combiner_capacity = 0; // zero means no combiner
+    uint64_t combiner_interval = 0; // zero means no time-based flushing of the combiner
+    size_t kg_groups = 0; // zero means no migration of key groups
+    uint64_t kg_interval = DEFAULT_KEYGROUP_INTERVAL_USEC;
+    double kg_imbalance = DEFAULT_KEYGROUP_IMBALANCE;
+
+    size_t elastic_max = 0; // zero means not elastic
+    size_t elastic_min = 1;
+    uint64_t as_interval = 0; // zero means no autoscaler
+    double as_low = DEFAULT_ELASTIC_LOW_UTILIZATION;
+    double as_high = DEFAULT_ELASTIC_HIGH_UTILIZATION;
+    uint64_t as_backlog = DEFAULT_ELASTIC_BACKLOG;
+
+    // get the number of replicas of the operator (the maximum number of active replicas if it is elastic)
+    size_t getNumReplicas() const
+    {
+        return std::max<size_t>(pardegree, elastic_max);
+    }
+
+    // create the controller of the active replicas (nullptr if the operator is not elastic)
+    std::shared_ptr<Elastic_Controller> createElasticController() const
+    {
+        if (elastic_max == 0 && as_interval == 0) {
+            return nullptr;
+        }
+        auto elastic = std::make_shared<Elastic_Controller>(getNumReplicas(), pardegree, elastic_min);
+        if (as_interval > 0) {
+            elastic->enableAutoscaling(as_interval, as_low, as_high, as_backlog);
+        }
+        return elastic;
+    }
+
+    // create the manager of the key groups (nullptr if they are not used, they are always used by an elastic operator)
+    std::shared_ptr<KeyGroup_Manager> createKeyGroupManager() const
+    {
+        auto elastic = createElasticController();
+        if (kg_groups == 0 && elastic == nullptr) {
+            return nullptr;
+        }
+        size_t n_groups = (kg_groups > 0) ? kg_groups : getNumReplicas() * DEFAULT_ELASTIC_GROUPS_PER_REPLICA;
+        auto manager = std::make_shared<KeyGroup_Manager>(n_groups, getNumReplicas(), routing_func, kg_interval, kg_imbalance);
+        if (elastic != nullptr) {
+            manager->setElasticController(elastic);
+        }
+        return manager;
+    }
 
 public:
     /** 
@@ -721,7 +1365,34 @@ public:
     }
 
     /** 
-     *  \brief Method to specify the closing logic used by the operator
+     *  \brief Method to state that the Accumulator operator keeps the keys of its inputs in the outputs
+     *         (a following key-based distribution with the same parallelism and routing function
+     *          can be elided by the MultiPipe)
+     *  
+     *  \return the object itself
+     */ 
+    Accumulator_Builder<F_t> &enable_KeyPreservation()
+    {
+        keyPreserving = true;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to state that each replica of the Accumulator operator produces its outputs in the
+     *         timestamp order of its inputs (the user function does not change the timestamps in a
+     *         way breaking the order, and a following reordering of the inputs can be elided by the
+     *         MultiPipe in DETERMINISTIC mode)
+     *  
+     *  \return the object itself
+     */ 
+    Accumulator_Builder<F_t> &enable_OrderPreservation()
+    {
+        orderPreserving = true;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the closing logic used by the operator
      *  
      *  \param _closing_func closing logic to be used by the operator
      *  \return the object itself
@@ -737,6 +1408,116 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    Accumulator_Builder<F_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to pre-aggregate the tuples of the same key in the emitter before the key-based
+     *         distribution (only with a reduce/fold logic not rich). Each replica receives the partial
+     *         results folded from the initial value and it combines them with the current result of the key
+     *  
+     *  \param _comb_func logic combining two partial results into a result
+     *  \param _capacity maximum number of keys pre-aggregated before flushing the partial results
+     *  \param _interval maximum time between two flushes of the partial results (zero means no limit)
+     *  \return the object itself
+     */ 
+    Accumulator_Builder<F_t> &withCombiner(comb_func_t _comb_func,
+                                           size_t _capacity=DEFAULT_COMBINER_CAPACITY,
+                                           std::chrono::microseconds _interval=std::chrono::microseconds::zero())
+    {
+        comb_func = _comb_func;
+        combiner_capacity = _capacity;
+        combiner_interval = _interval.count();
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to partition the keys into a fixed number of key groups migrated at runtime among
+     *         the replicas (not with the combiner). A key group of the most loaded replica is moved to
+     *         the least loaded one when their busy times differ by more than the given fraction
+     *  
+     *  \param _n_groups number of key groups (greater than the parallelism)
+     *  \param _interval interval between two decisions of the rebalancing policy
+     *  \param _imbalance relative difference of the busy times of two replicas triggering a migration
+     *  \return the object itself
+     */ 
+    Accumulator_Builder<F_t> &withKeyGroups(size_t _n_groups,
+                                            std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_KEYGROUP_INTERVAL_USEC),
+                                            double _imbalance=DEFAULT_KEYGROUP_IMBALANCE)
+    {
+        kg_groups = _n_groups;
+        kg_interval = _interval.count();
+        kg_imbalance = _imbalance;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to make the Accumulator operator elastic. The operator has _max_parallelism replicas
+     *         and the key groups are assigned to the first ones only (initially as many as the parallelism,
+     *         then as set through its Elastic_Controller or by the autoscaler). The key groups of a parked
+     *         replica are migrated with their state to the active ones (key groups are used with
+     *         DEFAULT_ELASTIC_GROUPS_PER_REPLICA groups per replica if not configured with withKeyGroups)
+     *  
+     *  \param _max_parallelism maximum number of active replicas
+     *  \param _min_parallelism minimum number of active replicas
+     *  \return the object itself
+     */ 
+    Accumulator_Builder<F_t> &withElasticity(size_t _max_parallelism,
+                                             size_t _min_parallelism=1)
+    {
+        elastic_max = _max_parallelism;
+        elastic_min = _min_parallelism;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the autoscaler changing the number of active replicas of the Accumulator operator
+     *         (up to the maximum set with withElasticity, or to the parallelism otherwise). A replica is added
+     *         when the utilization or the backlog of the active replicas is too high, and it is removed when
+     *         the utilization is low enough to be sustained by the remaining ones
+     *  
+     *  \param _interval interval between two evaluations of the autoscaler
+     *  \param _low_util utilization of the active replicas below which a replica is removed
+     *  \param _high_util utilization of the active replicas above which a replica is added
+     *  \param _max_backlog inputs per active replica not processed yet above which a replica is added (zero means no limit)
+     *  \return the object itself
+     */ 
+    Accumulator_Builder<F_t> &withAutoscaling(std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_ELASTIC_INTERVAL_USEC),
+                                              double _low_util=DEFAULT_ELASTIC_LOW_UTILIZATION,
+                                              double _high_util=DEFAULT_ELASTIC_HIGH_UTILIZATION,
+                                              uint64_t _max_backlog=DEFAULT_ELASTIC_BACKLOG)
+    {
+        as_interval = std::max<uint64_t>(_interval.count(), 1);
+        as_low = _low_util;
+        as_high = _high_util;
+        as_backlog = _max_backlog;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Accumulator operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    Accumulator_Builder<F_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Accumulator operator (only C++17)
@@ -747,10 +1528,17 @@ public:
     {
         return accumulator_t(func,
                              init_value,
-                             pardegree,
+                             getNumReplicas(),
                              name,
                              closing_func,
-                             routing_func); // guaranteed copy elision in C++17
+                             routing_func,
+                             keyPreserving,
+                             orderPreserving,
+                             comb_func,
+                             combiner_capacity,
+                             combiner_interval,
+                             createKeyGroupManager(),
+                             cpus); // guaranteed copy elision in C++17
     }
 #endif
 
@@ -763,10 +1551,17 @@ public:
     {
         return new accumulator_t(func,
                                  init_value,
-                                 pardegree,
+                                 getNumReplicas(),
                                  name,
                                  closing_func,
-                                 routing_func);
+                                 routing_func,
+                                 keyPreserving,
+                                 orderPreserving,
+                                 comb_func,
+                                 combiner_capacity,
+                                 combiner_interval,
+                                 createKeyGroupManager(),
+                                 cpus);
     }
 
     /** 
@@ -778,10 +1573,17 @@ public:
     {
         return std::make_unique<accumulator_t>(func,
                                                init_value,
-                                               pardegree,
+                                               getNumReplicas(),
                                                name,
                                                closing_func,
-                                               routing_func);
+                                               routing_func,
+                                               keyPreserving,
+                                               orderPreserving,
+                                               comb_func,
+                                               combiner_capacity,
+                                               combiner_interval,
+                                               createKeyGroupManager(),
+                                               cpus);
     }
 };
 
@@ -815,6 +1617,7 @@ private:
     uint64_t triggering_delay = 0;
     win_type_t winType = win_type_t::CB;
     std::string name = "seq";
+    uint64_t early_interval = 0; // zero means no early firing
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
 
 public:
@@ -859,6 +1662,21 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to enable the early firing: the open windows are periodically evaluated on the
+     *         tuples received so far and their partial results (early results) are emitted without
+     *         closing the windows. Early and final results are distinguished through the setEarly(bool)
+     *         method that the result type must provide
+     *  
+     *  \param _interval interval between two early results of the same window (in microseconds)
+     *  \return the object itself
+     */ 
+    WinSeq_Builder<F_t> &withEarlyFiring(std::chrono::microseconds _interval)
+    {
+        early_interval = _interval.count();
+        return *this;
+    }
+
     /** 
      *  \brief Method to specify the name of the Win_Seq node
      *  
@@ -904,7 +1722,8 @@ public:
                         closing_func,
                         RuntimeContext(1, 0),
                         WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len),
-                        role_t::SEQ); // guaranteed copy elision in C++17
+                        role_t::SEQ,
+                        early_interval); // guaranteed copy elision in C++17
     }
 #endif
 
@@ -923,7 +1742,8 @@ public:
                             closing_func,
                             RuntimeContext(1, 0),
                             WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len),
-                            role_t::SEQ);
+                            role_t::SEQ,
+                            early_interval);
     }
 
     /** 
@@ -942,7 +1762,8 @@ public:
                                           closing_func,
                                           RuntimeContext(1, 0),
                                           WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len),
-                                          role_t::SEQ);
+                                          role_t::SEQ,
+                                          early_interval);
     }
 };
 
@@ -982,6 +1803,7 @@ private:
     uint64_t triggering_delay = 0;
     win_type_t winType = win_type_t::CB;
     std::string name = "seqffat";
+    uint64_t early_interval = 0; // zero means no early firing
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
 
 public:
@@ -1027,6 +1849,21 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to enable the early firing: the open windows are periodically evaluated on the
+     *         tuples received so far and their partial results (early results) are emitted without
+     *         closing the windows. Early and final results are distinguished through the setEarly(bool)
+     *         method that the result type must provide
+     *  
+     *  \param _interval interval between two early results of the same window (in microseconds)
+     *  \return the object itself
+     */ 
+    WinSeqFFAT_Builder<F_t, G_t> &withEarlyFiring(std::chrono::microseconds _interval)
+    {
+        early_interval = _interval.count();
+        return *this;
+    }
+
     /** 
      *  \brief Method to specify the name of the Win_SeqFFAT node
      *  
@@ -1073,7 +1910,8 @@ public:
                          name,
                          closing_func,
                          RuntimeContext(1, 0),
-                         WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len));
+                         WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len),
+                         early_interval);
     }
 #endif
 
@@ -1093,7 +1931,8 @@ public:
                              name,
                              closing_func,
                              RuntimeContext(1, 0),
-                             WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len));
+                             WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len),
+                             early_interval);
     }
 
     /** 
@@ -1112,7 +1951,8 @@ public:
                                            name,
                                            closing_func,
                                            RuntimeContext(1, 0),
-                                           WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len));
+                                           WinOperatorConfig(0, 1, slide_len, 0, 1, slide_len),
+                                           early_interval);
     }
 };
 
@@ -1147,7 +1987,11 @@ private:
     win_type_t winType = win_type_t::CB;
     size_t pardegree = 1;
     std::string name = "wf";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     opt_level_t opt_level = opt_level_t::LEVEL2;
+    bool ordered = true;
+    bool dynamic = false;
+    bool shared = false;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
 
     // window parameters initialization (input is a Pane_Farm)
@@ -1279,6 +2123,58 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to disable the reordering of the results of the same key produced by
+     *         different replicas (to be used when the downstream does not require ordered results)
+     *  
+     *  \return the object itself
+     */ 
+    WinFarm_Builder<T> &withUnorderedResults()
+    {
+        ordered = false;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the dynamic scheduling of the windows (non-incremental queries only).
+     *         Each window is assigned to the replica with the smallest estimated load (windows to be
+     *         evaluated and inputs in its queue), and each tuple is sent to the owners of its windows
+     *  
+     *  \return the object itself
+     */ 
+    WinFarm_Builder<T> &withDynamicScheduling()
+    {
+        dynamic = true;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to store each tuple once in an archive shared by all the replicas (non-incremental
+     *         queries on time-based windows only, in DETERMINISTIC or PROBABILISTIC mode). All the replicas
+     *         receive all the inputs and compute their windows on the shared archive
+     *  
+     *  \return the object itself
+     */ 
+    WinFarm_Builder<T> &withSharedArchive()
+    {
+        shared = true;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Win_Farm operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    WinFarm_Builder<T> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Win_Farm operator (only C++17)
@@ -1295,8 +2191,11 @@ public:
                          pardegree,
                          name,
                          closing_func,
-                         true,
-                         opt_level); // guaranteed copy elision in C++17
+                         ordered,
+                         opt_level,
+                         dynamic,
+                         shared,
+                         cpus); // guaranteed copy elision in C++17
     }
 #endif
 
@@ -1315,8 +2214,11 @@ public:
                              pardegree,
                              name,
                              closing_func,
-                             true,
-                             opt_level);
+                             ordered,
+                             opt_level,
+                             dynamic,
+                             shared,
+                             cpus);
     }
 
     /** 
@@ -1334,8 +2236,11 @@ public:
                                            pardegree,
                                            name,
                                            closing_func,
-                                           true,
-                                           opt_level);
+                                           ordered,
+                                           opt_level,
+                                           dynamic,
+                                           shared,
+                                           cpus);
     }
 };
 
@@ -1366,15 +2271,65 @@ private:
     using closing_func_t = std::function<void(RuntimeContext&)>;
     // type of the function to map the key hashcode onto an identifier starting from zero to pardegree-1
     using routing_func_t = std::function<size_t(size_t, size_t)>;
+    // type of the combine function of the partial results of a hot key
+    using winComb_func_t = typename keyfarm_t::winComb_func_t;
     uint64_t win_len = 1;
     uint64_t slide_len = 1;
     uint64_t triggering_delay = 0;
     win_type_t winType = win_type_t::CB;
     size_t pardegree = 1;
     std::string name = "kf";
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+    uint64_t early_interval = 0; // zero means no early firing
+    size_t split_degree = 0; // zero means no hot-key splitting
+    winComb_func_t winComb_func = nullptr;
+    routing_func_t routing_func = default_routing;
     opt_level_t opt_level = opt_level_t::LEVEL2;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
+    size_t kg_groups = 0; // zero means no migration of key groups
+    uint64_t kg_interval = DEFAULT_KEYGROUP_INTERVAL_USEC;
+    double kg_imbalance = DEFAULT_KEYGROUP_IMBALANCE;
+
+    size_t elastic_max = 0; // zero means not elastic
+    size_t elastic_min = 1;
+    uint64_t as_interval = 0; // zero means no autoscaler
+    double as_low = DEFAULT_ELASTIC_LOW_UTILIZATION;
+    double as_high = DEFAULT_ELASTIC_HIGH_UTILIZATION;
+    uint64_t as_backlog = DEFAULT_ELASTIC_BACKLOG;
+
+    // get the number of replicas of the operator (the maximum number of active replicas if it is elastic)
+    size_t getNumReplicas() const
+    {
+        return std::max<size_t>(pardegree, elastic_max);
+    }
+
+    // create the controller of the active replicas (nullptr if the operator is not elastic)
+    std::shared_ptr<Elastic_Controller> createElasticController() const
+    {
+        if (elastic_max == 0 && as_interval == 0) {
+            return nullptr;
+        }
+        auto elastic = std::make_shared<Elastic_Controller>(getNumReplicas(), pardegree, elastic_min);
+        if (as_interval > 0) {
+            elastic->enableAutoscaling(as_interval, as_low, as_high, as_backlog);
+        }
+        return elastic;
+    }
+
+    // create the manager of the key groups (nullptr if they are not used, they are always used by an elastic operator)
+    std::shared_ptr<KeyGroup_Manager> createKeyGroupManager() const
+    {
+        auto elastic = createElasticController();
+        if (kg_groups == 0 && elastic == nullptr) {
+            return nullptr;
+        }
+        size_t n_groups = (kg_groups > 0) ? kg_groups : getNumReplicas() * DEFAULT_ELASTIC_GROUPS_PER_REPLICA;
+        auto manager = std::make_shared<KeyGroup_Manager>(n_groups, getNumReplicas(), routing_func, kg_interval, kg_imbalance);
+        if (elastic != nullptr) {
+            manager->setElasticController(elastic);
+        }
+        return manager;
+    }
 
     // window parameters initialization (input is a Pane_Farm)
     template<typename ...Args>
@@ -1464,6 +2419,21 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to enable the early firing: the open windows are periodically evaluated on the
+     *         tuples received so far and their partial results (early results) are emitted without
+     *         closing the windows. Early and final results are distinguished through the setEarly(bool)
+     *         method that the result type must provide
+     *  
+     *  \param _interval interval between two early results of the same window (in microseconds)
+     *  \return the object itself
+     */ 
+    KeyFarm_Builder<T> &withEarlyFiring(std::chrono::microseconds _interval)
+    {
+        early_interval = _interval.count();
+        return *this;
+    }
+
     /** 
      *  \brief Method to specify the name of the Key_Farm operator
      *  
@@ -1505,6 +2475,115 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    KeyFarm_Builder<T> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the hot-key splitting (time-based windows only): the keys receiving more
+     *         than a fair share of the tuples are detected online and their tuples are spread over several
+     *         replicas. The partial results of the same window are combined by the operator before being
+     *         emitted, so the results are the ones without splitting if the combine function merges the
+     *         results of two disjoint sets of tuples into the result of their union
+     *  
+     *  \param _winComb_func combine function with signature void(const result_t &, const result_t &, result_t &)
+     *  \param _split_degree number of replicas over which the tuples of each hot key are spread
+     *  \return the object itself
+     */ 
+    KeyFarm_Builder<T> &withHotKeySplitting(winComb_func_t _winComb_func, size_t _split_degree)
+    {
+        winComb_func = _winComb_func;
+        split_degree = _split_degree;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to partition the keys into a fixed number of key groups migrated at runtime among
+     *         the replicas (time-based windows only, not with nested operators and hot-key splitting). A
+     *         key group of the most loaded replica is moved to the least loaded one when their busy times
+     *         differ by more than the given fraction
+     *  
+     *  \param _n_groups number of key groups (greater than the parallelism)
+     *  \param _interval interval between two decisions of the rebalancing policy
+     *  \param _imbalance relative difference of the busy times of two replicas triggering a migration
+     *  \return the object itself
+     */ 
+    KeyFarm_Builder<T> &withKeyGroups(size_t _n_groups,
+                                      std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_KEYGROUP_INTERVAL_USEC),
+                                      double _imbalance=DEFAULT_KEYGROUP_IMBALANCE)
+    {
+        kg_groups = _n_groups;
+        kg_interval = _interval.count();
+        kg_imbalance = _imbalance;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to make the Key_Farm operator elastic (time-based windows only). The operator has _max_parallelism replicas
+     *         and the key groups are assigned to the first ones only (initially as many as the parallelism,
+     *         then as set through its Elastic_Controller or by the autoscaler). The key groups of a parked
+     *         replica are migrated with their state to the active ones (key groups are used with
+     *         DEFAULT_ELASTIC_GROUPS_PER_REPLICA groups per replica if not configured with withKeyGroups)
+     *  
+     *  \param _max_parallelism maximum number of active replicas
+     *  \param _min_parallelism minimum number of active replicas
+     *  \return the object itself
+     */ 
+    KeyFarm_Builder<T> &withElasticity(size_t _max_parallelism,
+                                       size_t _min_parallelism=1)
+    {
+        elastic_max = _max_parallelism;
+        elastic_min = _min_parallelism;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the autoscaler changing the number of active replicas of the Key_Farm operator
+     *         (up to the maximum set with withElasticity, or to the parallelism otherwise). A replica is added
+     *         when the utilization or the backlog of the active replicas is too high, and it is removed when
+     *         the utilization is low enough to be sustained by the remaining ones
+     *  
+     *  \param _interval interval between two evaluations of the autoscaler
+     *  \param _low_util utilization of the active replicas below which a replica is removed
+     *  \param _high_util utilization of the active replicas above which a replica is added
+     *  \param _max_backlog inputs per active replica not processed yet above which a replica is added (zero means no limit)
+     *  \return the object itself
+     */ 
+    KeyFarm_Builder<T> &withAutoscaling(std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_ELASTIC_INTERVAL_USEC),
+                                        double _low_util=DEFAULT_ELASTIC_LOW_UTILIZATION,
+                                        double _high_util=DEFAULT_ELASTIC_HIGH_UTILIZATION,
+                                        uint64_t _max_backlog=DEFAULT_ELASTIC_BACKLOG)
+    {
+        as_interval = std::max<uint64_t>(_interval.count(), 1);
+        as_low = _low_util;
+        as_high = _high_util;
+        as_backlog = _max_backlog;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Key_Farm operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    KeyFarm_Builder<T> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Key_Farm operator (only C++17)
@@ -1518,11 +2597,16 @@ public:
                          slide_len,
                          triggering_delay,
                          winType,
-                         pardegree,
+                         getNumReplicas(),
                          name,
                          closing_func,
                          routing_func,
-                         opt_level); // guaranteed copy elision in C++17
+                         opt_level,
+                         early_interval,
+                         split_degree,
+                         winComb_func,
+                         createKeyGroupManager(),
+                         cpus); // guaranteed copy elision in C++17
     }
 #endif
 
@@ -1538,11 +2622,16 @@ public:
                              slide_len,
                              triggering_delay,
                              winType,
-                             pardegree,
+                             getNumReplicas(),
                              name,
                              closing_func,
                              routing_func,
-                             opt_level);
+                             opt_level,
+                             early_interval,
+                             split_degree,
+                             winComb_func,
+                             createKeyGroupManager(),
+                             cpus);
     }
 
     /** 
@@ -1557,118 +2646,1157 @@ public:
                                            slide_len,
                                            triggering_delay,
                                            winType,
-                                           pardegree,
+                                           getNumReplicas(),
                                            name,
                                            closing_func,
                                            routing_func,
-                                           opt_level);
+                                           opt_level,
+                                           early_interval,
+                                           split_degree,
+                                           winComb_func,
+                                           createKeyGroupManager(),
+                                           cpus);
+    }
+};
+
+/** 
+ *  \class KeyFFAT_Builder
+ *  
+ *  \brief Builder of the Key_FFAT operator
+ *  
+ *  Builder class to ease the creation of the Key_FFAT operator.
+ */ 
+template<typename F_t, typename G_t>
+class KeyFFAT_Builder
+{
+private:
+    F_t lift_func;
+    G_t comb_func;
+    // extract the type of the operator to be generated by this builder (with static checks)
+    using tuple_t = decltype(get_tuple_t_Lift(lift_func));
+    using result_t = decltype(get_result_t_Lift(lift_func));
+    // static asserts to check the signatures
+    static_assert(!(std::is_same<tuple_t, std::false_type>::value || std::is_same<result_t, std::false_type>::value),
+        "WindFlow Compilation Error - unknown signature passed to the KeyFFAT_Builder (first argument, lift logic):\n"
+        "  Candidate 1 : void(const tuple_t &, result_t &)\n"
+        "  Candidate 2 : void(const tuple_t &, result_t &, RuntimeContext &)\n");
+    using result_t2 = decltype(get_result_t_Comb(comb_func));
+    static_assert(!(std::is_same<std::false_type, result_t2>::value),
+        "WindFlow Compilation Error - unknown signature passed to the KeyFFAT_Builder (second argument, combine logic):\n"
+        "  Candidate 1 : void(const result_t &, const result_t &, result_t &)\n"
+        "  Candidate 2 : void(const result_t &, const result_t &, result_t &, RuntimeContext &)\n");
+    static_assert(std::is_same<result_t, result_t2>::value,
+        "WindFlow Compilation Error - type mismatch in the KeyFFAT_Builder (output type of the lift logic must be equal to the input type of the combine logic)\n");
+    using keyffat_t = Key_FFAT<tuple_t, result_t>;
+    // type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext&)>;
+    // type of the function to map the key hashcode onto an identifier starting from zero to pardegree-1
+    using routing_func_t = std::function<size_t(size_t, size_t)>;
+    uint64_t win_len = 1;
+    uint64_t slide_len = 1;
+    uint64_t triggering_delay = 0;
+    win_type_t winType = win_type_t::CB;
+    size_t pardegree = 1;
+    std::string name = "kff";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+    uint64_t early_interval = 0; // zero means no early firing
+    routing_func_t routing_func = default_routing;
+    closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
+    size_t combiner_capacity = 0; // zero means no combiner
+    uint64_t combiner_interval = 0; // zero means no time-based flushing of the combiner
+    size_t kg_groups = 0; // zero means no migration of key groups
+    uint64_t kg_interval = DEFAULT_KEYGROUP_INTERVAL_USEC;
+    double kg_imbalance = DEFAULT_KEYGROUP_IMBALANCE;
+
+    size_t elastic_max = 0; // zero means not elastic
+    size_t elastic_min = 1;
+    uint64_t as_interval = 0; // zero means no autoscaler
+    double as_low = DEFAULT_ELASTIC_LOW_UTILIZATION;
+    double as_high = DEFAULT_ELASTIC_HIGH_UTILIZATION;
+    uint64_t as_backlog = DEFAULT_ELASTIC_BACKLOG;
+
+    // get the number of replicas of the operator (the maximum number of active replicas if it is elastic)
+    size_t getNumReplicas() const
+    {
+        return std::max<size_t>(pardegree, elastic_max);
+    }
+
+    // create the controller of the active replicas (nullptr if the operator is not elastic)
+    std::shared_ptr<Elastic_Controller> createElasticController() const
+    {
+        if (elastic_max == 0 && as_interval == 0) {
+            return nullptr;
+        }
+        auto elastic = std::make_shared<Elastic_Controller>(getNumReplicas(), pardegree, elastic_min);
+        if (as_interval > 0) {
+            elastic->enableAutoscaling(as_interval, as_low, as_high, as_backlog);
+        }
+        return elastic;
+    }
+
+    // create the manager of the key groups (nullptr if they are not used, they are always used by an elastic operator)
+    std::shared_ptr<KeyGroup_Manager> createKeyGroupManager() const
+    {
+        auto elastic = createElasticController();
+        if (kg_groups == 0 && elastic == nullptr) {
+            return nullptr;
+        }
+        size_t n_groups = (kg_groups > 0) ? kg_groups : getNumReplicas() * DEFAULT_ELASTIC_GROUPS_PER_REPLICA;
+        auto manager = std::make_shared<KeyGroup_Manager>(n_groups, getNumReplicas(), routing_func, kg_interval, kg_imbalance);
+        if (elastic != nullptr) {
+            manager->setElasticController(elastic);
+        }
+        return manager;
+    }
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _lift_func the lift logic to translate a tuple into a result
+     *  \param _comb_func the combine logic to combine two results into a result
+     */ 
+    KeyFFAT_Builder(F_t _lift_func, G_t _comb_func): lift_func(_lift_func), comb_func(_comb_func) {}
+
+    /** 
+     *  \brief Method to specify the configuration for count-based windows
+     *  
+     *  \param _win_len window length (in no. of tuples)
+     *  \param _slide_len slide length (in no. of tuples)
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withCBWindows(uint64_t _win_len, uint64_t _slide_len)
+    {
+        win_len = _win_len;
+        slide_len = _slide_len;
+        winType = win_type_t::CB;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the configuration for time-based windows
+     *  
+     *  \param _win_len window length (in microseconds)
+     *  \param _slide_len slide length (in microseconds)
+     *  \param _triggering_delay (in microseconds)
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withTBWindows(std::chrono::microseconds _win_len,
+                                             std::chrono::microseconds _slide_len,
+                                             std::chrono::microseconds _triggering_delay=std::chrono::microseconds::zero())
+    {
+        win_len = _win_len.count();
+        slide_len = _slide_len.count();
+        triggering_delay = _triggering_delay.count();
+        winType = win_type_t::TB;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the parallelism of the Key_FFAT operator
+     *  
+     *  \param _pardegree number of replicas
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withParallelism(size_t _pardegree)
+    {
+        pardegree = _pardegree;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the early firing: the open windows are periodically evaluated on the
+     *         tuples received so far and their partial results (early results) are emitted without
+     *         closing the windows. Early and final results are distinguished through the setEarly(bool)
+     *         method that the result type must provide
+     *  
+     *  \param _interval interval between two early results of the same window (in microseconds)
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withEarlyFiring(std::chrono::microseconds _interval)
+    {
+        early_interval = _interval.count();
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the name of the Key_FFAT operator
+     *  
+     *  \param _name string with the name to be given
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withName(std::string _name)
+    {
+        name = _name;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the closing logic used by the operator
+     *  
+     *  \param _closing_func closing logic to be used by the operator
+     *  \return the object itself
+     */ 
+    template<typename closing_F_t>
+    KeyFFAT_Builder<F_t, G_t> &withClosingFunction(closing_F_t _closing_func)
+    {
+        // static assert to check the signature
+        static_assert(!std::is_same<decltype(check_closing_t(_closing_func)), std::false_type>::value,
+            "WindFlow Compilation Error - unknown signature passed to withClosingFunction (of a Key_FFAT):\n"
+            "  Candidate : void(RuntimeContext &)\n");
+        closing_func = _closing_func;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to pre-aggregate the tuples of the same key in the emitter before the key-based
+     *         distribution (only with time-based windows and with lift and combine logics not rich)
+     *  
+     *  \param _capacity maximum number of keys pre-aggregated before flushing the partial results
+     *  \param _interval maximum time between two flushes of the partial results (zero means no limit)
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withCombiner(size_t _capacity=DEFAULT_COMBINER_CAPACITY,
+                                            std::chrono::microseconds _interval=std::chrono::microseconds::zero())
+    {
+        combiner_capacity = _capacity;
+        combiner_interval = _interval.count();
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to partition the keys into a fixed number of key groups migrated at runtime among
+     *         the replicas (time-based windows only, not with the combiner). A key group of the most
+     *         loaded replica is moved to the least loaded one when their busy times differ by more than
+     *         the given fraction
+     *  
+     *  \param _n_groups number of key groups (greater than the parallelism)
+     *  \param _interval interval between two decisions of the rebalancing policy
+     *  \param _imbalance relative difference of the busy times of two replicas triggering a migration
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withKeyGroups(size_t _n_groups,
+                                             std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_KEYGROUP_INTERVAL_USEC),
+                                             double _imbalance=DEFAULT_KEYGROUP_IMBALANCE)
+    {
+        kg_groups = _n_groups;
+        kg_interval = _interval.count();
+        kg_imbalance = _imbalance;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to make the Key_FFAT operator elastic (time-based windows only). The operator has _max_parallelism replicas
+     *         and the key groups are assigned to the first ones only (initially as many as the parallelism,
+     *         then as set through its Elastic_Controller or by the autoscaler). The key groups of a parked
+     *         replica are migrated with their state to the active ones (key groups are used with
+     *         DEFAULT_ELASTIC_GROUPS_PER_REPLICA groups per replica if not configured with withKeyGroups)
+     *  
+     *  \param _max_parallelism maximum number of active replicas
+     *  \param _min_parallelism minimum number of active replicas
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withElasticity(size_t _max_parallelism,
+                                              size_t _min_parallelism=1)
+    {
+        elastic_max = _max_parallelism;
+        elastic_min = _min_parallelism;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the autoscaler changing the number of active replicas of the Key_FFAT operator
+     *         (up to the maximum set with withElasticity, or to the parallelism otherwise). A replica is added
+     *         when the utilization or the backlog of the active replicas is too high, and it is removed when
+     *         the utilization is low enough to be sustained by the remaining ones
+     *  
+     *  \param _interval interval between two evaluations of the autoscaler
+     *  \param _low_util utilization of the active replicas below which a replica is removed
+     *  \param _high_util utilization of the active replicas above which a replica is added
+     *  \param _max_backlog inputs per active replica not processed yet above which a replica is added (zero means no limit)
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withAutoscaling(std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_ELASTIC_INTERVAL_USEC),
+                                               double _low_util=DEFAULT_ELASTIC_LOW_UTILIZATION,
+                                               double _high_util=DEFAULT_ELASTIC_HIGH_UTILIZATION,
+                                               uint64_t _max_backlog=DEFAULT_ELASTIC_BACKLOG)
+    {
+        as_interval = std::max<uint64_t>(_interval.count(), 1);
+        as_low = _low_util;
+        as_high = _high_util;
+        as_backlog = _max_backlog;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Key_FFAT operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    KeyFFAT_Builder<F_t, G_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
+#if __cplusplus >= 201703L
+    /** 
+     *  \brief Method to create the Key_FFAT operator (only C++17)
+     *  
+     *  \return a copy of the created Key_Farm operator
+     */ 
+    keyffat_t build()
+    {
+        return keyffat_t(lift_func,
+                         comb_func,
+                         win_len,
+                         slide_len,
+                         triggering_delay,
+                         winType,
+                         getNumReplicas(),
+                         name,
+                         closing_func,
+                         routing_func,
+                         early_interval,
+                         combiner_capacity,
+                         combiner_interval,
+                         createKeyGroupManager(),
+                         cpus); // guaranteed copy elision in C++17
+    }
+#endif
+
+    /** 
+     *  \brief Method to create the Key_FFAT operator
+     *  
+     *  \return a pointer to the created Key_FFAT operator (to be explicitly deallocated/destroyed)
+     */ 
+    keyffat_t *build_ptr()
+    {
+        return new keyffat_t(lift_func,
+                             comb_func,
+                             win_len,
+                             slide_len,
+                             triggering_delay,
+                             winType,
+                             getNumReplicas(),
+                             name,
+                             closing_func,
+                             routing_func,
+                             early_interval,
+                             combiner_capacity,
+                             combiner_interval,
+                             createKeyGroupManager(),
+                             cpus);
+    }
+
+    /** 
+     *  \brief Method to create the Key_FFAT operator
+     *  
+     *  \return a unique_ptr to the created Key_FFAT operator
+     */ 
+    std::unique_ptr<keyffat_t> build_unique()
+    {
+        return std::make_unique<keyffat_t>(lift_func,
+                                           comb_func,
+                                           win_len,
+                                           slide_len,
+                                           triggering_delay,
+                                           winType,
+                                           getNumReplicas(),
+                                           name,
+                                           closing_func,
+                                           routing_func,
+                                           early_interval,
+                                           combiner_capacity,
+                                           combiner_interval,
+                                           createKeyGroupManager(),
+                                           cpus);
+    }
+};
+
+/** 
+ *  \class WinFFAT_Builder
+ *  
+ *  \brief Builder of the Win_FFAT operator
+ *  
+ *  Builder class to ease the creation of the Win_FFAT operator.
+ */ 
+template<typename F_t, typename G_t>
+class WinFFAT_Builder
+{
+private:
+    F_t lift_func;
+    G_t comb_func;
+    // extract the type of the operator to be generated by this builder (with static checks)
+    using tuple_t = decltype(get_tuple_t_Lift(lift_func));
+    using result_t = decltype(get_result_t_Lift(lift_func));
+    // static asserts to check the signatures
+    static_assert(!(std::is_same<tuple_t, std::false_type>::value || std::is_same<result_t, std::false_type>::value),
+        "WindFlow Compilation Error - unknown signature passed to the WinFFAT_Builder (first argument, lift logic):\n"
+        "  Candidate 1 : void(const tuple_t &, result_t &)\n"
+        "  Candidate 2 : void(const tuple_t &, result_t &, RuntimeContext &)\n");
+    using result_t2 = decltype(get_result_t_Comb(comb_func));
+    static_assert(!(std::is_same<std::false_type, result_t2>::value),
+        "WindFlow Compilation Error - unknown signature passed to the WinFFAT_Builder (second argument, combine logic):\n"
+        "  Candidate 1 : void(const result_t &, const result_t &, result_t &)\n"
+        "  Candidate 2 : void(const result_t &, const result_t &, result_t &, RuntimeContext &)\n");
+    static_assert(std::is_same<result_t, result_t2>::value,
+        "WindFlow Compilation Error - type mismatch in the WinFFAT_Builder (output type of the lift logic must be equal to the input type of the combine logic)\n");
+    using winffat_t = Win_FFAT<tuple_t, result_t>;
+    // type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext&)>;
+    uint64_t win_len = 1;
+    uint64_t slide_len = 1;
+    uint64_t triggering_delay = 0;
+    win_type_t winType = win_type_t::CB;
+    size_t pardegree = 1;
+    std::string name = "wff";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+    bool ordered = true;
+    closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _lift_func the lift logic to translate a tuple into a result
+     *  \param _comb_func the combine logic to combine two results into a result
+     */ 
+    WinFFAT_Builder(F_t _lift_func, G_t _comb_func): lift_func(_lift_func), comb_func(_comb_func) {}
+
+    /** 
+     *  \brief Method to specify the configuration for count-based windows
+     *  
+     *  \param _win_len window length (in no. of tuples)
+     *  \param _slide_len slide length (in no. of tuples)
+     *  \return the object itself
+     */ 
+    WinFFAT_Builder<F_t, G_t> &withCBWindows(uint64_t _win_len, uint64_t _slide_len)
+    {
+        win_len = _win_len;
+        slide_len = _slide_len;
+        winType = win_type_t::CB;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the configuration for time-based windows
+     *  
+     *  \param _win_len window length (in microseconds)
+     *  \param _slide_len slide length (in microseconds)
+     *  \param _triggering_delay (in microseconds)
+     *  \return the object itself
+     */ 
+    WinFFAT_Builder<F_t, G_t> &withTBWindows(std::chrono::microseconds _win_len,
+                                             std::chrono::microseconds _slide_len,
+                                             std::chrono::microseconds _triggering_delay=std::chrono::microseconds::zero())
+    {
+        win_len = _win_len.count();
+        slide_len = _slide_len.count();
+        triggering_delay = _triggering_delay.count();
+        winType = win_type_t::TB;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the parallelism of the Win_FFAT operator (the replicas are split in
+     *         groups, each computing the windows of a subset of the keys, if the window length is not
+     *         greater than the slide multiplied by the parallelism)
+     *  
+     *  \param _pardegree number of replicas
+     *  \return the object itself
+     */ 
+    WinFFAT_Builder<F_t, G_t> &withParallelism(size_t _pardegree)
+    {
+        pardegree = _pardegree;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the name of the Win_FFAT operator
+     *  
+     *  \param _name string with the name to be given
+     *  \return the object itself
+     */ 
+    WinFFAT_Builder<F_t, G_t> &withName(std::string _name)
+    {
+        name = _name;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the closing logic used by the operator
+     *  
+     *  \param _closing_func closing logic to be used by the operator
+     *  \return the object itself
+     */ 
+    template<typename closing_F_t>
+    WinFFAT_Builder<F_t, G_t> &withClosingFunction(closing_F_t _closing_func)
+    {
+        // static assert to check the signature
+        static_assert(!std::is_same<decltype(check_closing_t(_closing_func)), std::false_type>::value,
+            "WindFlow Compilation Error - unknown signature passed to withClosingFunction (of a Win_FFAT):\n"
+            "  Candidate : void(RuntimeContext &)\n");
+        closing_func = _closing_func;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to disable the reordering of the results of the same key produced by
+     *         different replicas (to be used when the downstream does not require ordered results)
+     *  
+     *  \return the object itself
+     */ 
+    WinFFAT_Builder<F_t, G_t> &withUnorderedResults()
+    {
+        ordered = false;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Win_FFAT operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    WinFFAT_Builder<F_t, G_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
+#if __cplusplus >= 201703L
+    /** 
+     *  \brief Method to create the Win_FFAT operator (only C++17)
+     *  
+     *  \return a copy of the created Win_FFAT operator
+     */ 
+    winffat_t build()
+    {
+        return winffat_t(lift_func,
+                         comb_func,
+                         win_len,
+                         slide_len,
+                         triggering_delay,
+                         winType,
+                         pardegree,
+                         name,
+                         closing_func,
+                         ordered,
+                         cpus); // guaranteed copy elision in C++17
+    }
+#endif
+
+    /** 
+     *  \brief Method to create the Win_FFAT operator
+     *  
+     *  \return a pointer to the created Win_FFAT operator (to be explicitly deallocated/destroyed)
+     */ 
+    winffat_t *build_ptr()
+    {
+        return new winffat_t(lift_func,
+                             comb_func,
+                             win_len,
+                             slide_len,
+                             triggering_delay,
+                             winType,
+                             pardegree,
+                             name,
+                             closing_func,
+                             ordered,
+                             cpus);
+    }
+
+    /** 
+     *  \brief Method to create the Win_FFAT operator
+     *  
+     *  \return a unique_ptr to the created Win_FFAT operator
+     */ 
+    std::unique_ptr<winffat_t> build_unique()
+    {
+        return std::make_unique<winffat_t>(lift_func,
+                                           comb_func,
+                                           win_len,
+                                           slide_len,
+                                           triggering_delay,
+                                           winType,
+                                           pardegree,
+                                           name,
+                                           closing_func,
+                                           ordered,
+                                           cpus);
+    }
+};
+
+/** 
+ *  \class KeyMFFAT_Builder
+ *  
+ *  \brief Builder of the Key_MFFAT operator
+ *  
+ *  Builder class to ease the creation of the Key_MFFAT operator.
+ */ 
+template<typename F_t, typename G_t>
+class KeyMFFAT_Builder
+{
+private:
+    F_t lift_func;
+    G_t comb_func;
+    // extract the type of the operator to be generated by this builder (with static checks)
+    using tuple_t = decltype(get_tuple_t_Lift(lift_func));
+    using result_t = decltype(get_result_t_Lift(lift_func));
+    // static asserts to check the signatures
+    static_assert(!(std::is_same<tuple_t, std::false_type>::value || std::is_same<result_t, std::false_type>::value),
+        "WindFlow Compilation Error - unknown signature passed to the KeyMFFAT_Builder (first argument, lift logic):\n"
+        "  Candidate 1 : void(const tuple_t &, result_t &)\n"
+        "  Candidate 2 : void(const tuple_t &, result_t &, RuntimeContext &)\n");
+    using result_t2 = decltype(get_result_t_Comb(comb_func));
+    static_assert(!(std::is_same<std::false_type, result_t2>::value),
+        "WindFlow Compilation Error - unknown signature passed to the KeyMFFAT_Builder (second argument, combine logic):\n"
+        "  Candidate 1 : void(const result_t &, const result_t &, result_t &)\n"
+        "  Candidate 2 : void(const result_t &, const result_t &, result_t &, RuntimeContext &)\n");
+    static_assert(std::is_same<result_t, result_t2>::value,
+        "WindFlow Compilation Error - type mismatch in the KeyMFFAT_Builder (output type of the lift logic must be equal to the input type of the combine logic)\n");
+    using keymffat_t = Key_MFFAT<tuple_t, result_t>;
+    // type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext&)>;
+    // type of the function to map the key hashcode onto an identifier starting from zero to pardegree-1
+    using routing_func_t = std::function<size_t(size_t, size_t)>;
+    std::vector<std::pair<uint64_t, uint64_t>> specs;
+    uint64_t triggering_delay = 0;
+    size_t pardegree = 1;
+    std::string name = "kmff";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+    routing_func_t routing_func = default_routing;
+    closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _lift_func the lift logic to translate a tuple into a result
+     *  \param _comb_func the combine logic to combine two results into a result
+     */ 
+    KeyMFFAT_Builder(F_t _lift_func, G_t _comb_func): lift_func(_lift_func), comb_func(_comb_func) {}
+
+    /** 
+     *  \brief Method to add a specification of time-based windows (results of the i-th
+     *         added specification are tagged with index i)
+     *  
+     *  \param _win_len window length (in microseconds)
+     *  \param _slide_len slide length (in microseconds)
+     *  \return the object itself
+     */ 
+    KeyMFFAT_Builder<F_t, G_t> &addTBWindows(std::chrono::microseconds _win_len,
+                                             std::chrono::microseconds _slide_len)
+    {
+        specs.push_back(std::make_pair(_win_len.count(), _slide_len.count()));
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the triggering delay shared by all the window specifications
+     *  
+     *  \param _triggering_delay (in microseconds)
+     *  \return the object itself
+     */ 
+    KeyMFFAT_Builder<F_t, G_t> &withTriggeringDelay(std::chrono::microseconds _triggering_delay)
+    {
+        triggering_delay = _triggering_delay.count();
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the parallelism of the Key_MFFAT operator
+     *  
+     *  \param _pardegree number of replicas
+     *  \return the object itself
+     */ 
+    KeyMFFAT_Builder<F_t, G_t> &withParallelism(size_t _pardegree)
+    {
+        pardegree = _pardegree;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the name of the Key_MFFAT operator
+     *  
+     *  \param _name string with the name to be given
+     *  \return the object itself
+     */ 
+    KeyMFFAT_Builder<F_t, G_t> &withName(std::string _name)
+    {
+        name = _name;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the closing logic used by the operator
+     *  
+     *  \param _closing_func closing logic to be used by the operator
+     *  \return the object itself
+     */ 
+    template<typename closing_F_t>
+    KeyMFFAT_Builder<F_t, G_t> &withClosingFunction(closing_F_t _closing_func)
+    {
+        // static assert to check the signature
+        static_assert(!std::is_same<decltype(check_closing_t(_closing_func)), std::false_type>::value,
+            "WindFlow Compilation Error - unknown signature passed to withClosingFunction (of a Key_MFFAT):\n"
+            "  Candidate : void(RuntimeContext &)\n");
+        closing_func = _closing_func;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    KeyMFFAT_Builder<F_t, G_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Key_MFFAT operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    KeyMFFAT_Builder<F_t, G_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
+#if __cplusplus >= 201703L
+    /** 
+     *  \brief Method to create the Key_MFFAT operator (only C++17)
+     *  
+     *  \return a copy of the created Key_MFFAT operator
+     */ 
+    keymffat_t build()
+    {
+        return keymffat_t(lift_func,
+                          comb_func,
+                          specs,
+                          triggering_delay,
+                          pardegree,
+                          name,
+                          closing_func,
+                          routing_func,
+                          cpus); // guaranteed copy elision in C++17
+    }
+#endif
+
+    /** 
+     *  \brief Method to create the Key_MFFAT operator
+     *  
+     *  \return a pointer to the created Key_MFFAT operator (to be explicitly deallocated/destroyed)
+     */ 
+    keymffat_t *build_ptr()
+    {
+        return new keymffat_t(lift_func,
+                              comb_func,
+                              specs,
+                              triggering_delay,
+                              pardegree,
+                              name,
+                              closing_func,
+                              routing_func,
+                              cpus);
+    }
+
+    /** 
+     *  \brief Method to create the Key_MFFAT operator
+     *  
+     *  \return a unique_ptr to the created Key_MFFAT operator
+     */ 
+    std::unique_ptr<keymffat_t> build_unique()
+    {
+        return std::make_unique<keymffat_t>(lift_func,
+                                            comb_func,
+                                            specs,
+                                            triggering_delay,
+                                            pardegree,
+                                            name,
+                                            closing_func,
+                                            routing_func,
+                                            cpus);
+    }
+};
+
+/** 
+ *  \class KeyRollup_Builder
+ *  
+ *  \brief Builder of the Key_Rollup operator
+ *  
+ *  Builder class to ease the creation of the Key_Rollup operator.
+ */ 
+template<typename F_t, typename G_t>
+class KeyRollup_Builder
+{
+private:
+    F_t lift_func;
+    G_t comb_func;
+    // extract the type of the operator to be generated by this builder (with static checks)
+    using tuple_t = decltype(get_tuple_t_Lift(lift_func));
+    using result_t = decltype(get_result_t_Lift(lift_func));
+    // static asserts to check the signatures
+    static_assert(!(std::is_same<tuple_t, std::false_type>::value || std::is_same<result_t, std::false_type>::value),
+        "WindFlow Compilation Error - unknown signature passed to the KeyRollup_Builder (first argument, lift logic):\n"
+        "  Candidate 1 : void(const tuple_t &, result_t &)\n"
+        "  Candidate 2 : void(const tuple_t &, result_t &, RuntimeContext &)\n");
+    using result_t2 = decltype(get_result_t_Comb(comb_func));
+    static_assert(!(std::is_same<std::false_type, result_t2>::value),
+        "WindFlow Compilation Error - unknown signature passed to the KeyRollup_Builder (second argument, combine logic):\n"
+        "  Candidate 1 : void(const result_t &, const result_t &, result_t &)\n"
+        "  Candidate 2 : void(const result_t &, const result_t &, result_t &, RuntimeContext &)\n");
+    static_assert(std::is_same<result_t, result_t2>::value,
+        "WindFlow Compilation Error - type mismatch in the KeyRollup_Builder (output type of the lift logic must be equal to the input type of the combine logic)\n");
+    using keyrollup_t = Key_Rollup<tuple_t, result_t>;
+    // type of the rich combine function
+    using rich_comb_func_t = std::function<void(const result_t &, const result_t &, result_t &, RuntimeContext &)>;
+    // type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext&)>;
+    // type of the function to map the key hashcode onto an identifier starting from zero to pardegree-1
+    using routing_func_t = std::function<size_t(size_t, size_t)>;
+    uint64_t win_len = 1;
+    std::vector<std::pair<uint64_t, rich_comb_func_t>> upper_levels;
+    uint64_t triggering_delay = 0;
+    size_t pardegree = 1;
+    std::string name = "kroll";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+    routing_func_t routing_func = default_routing;
+    closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _lift_func the lift logic to translate a tuple into a result
+     *  \param _comb_func the combine logic of the first level
+     */ 
+    KeyRollup_Builder(F_t _lift_func, G_t _comb_func): lift_func(_lift_func), comb_func(_comb_func) {}
+
+    /** 
+     *  \brief Method to specify the time-based tumbling windows of the first level
+     *  
+     *  \param _win_len window length (in microseconds)
+     *  \param _triggering_delay (in microseconds)
+     *  \return the object itself
+     */ 
+    KeyRollup_Builder<F_t, G_t> &withTBWindows(std::chrono::microseconds _win_len,
+                                               std::chrono::microseconds _triggering_delay=std::chrono::microseconds::zero())
+    {
+        win_len = _win_len.count();
+        triggering_delay = _triggering_delay.count();
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to add a level consuming the results of the previous one with the
+     *         combine logic of the first level
+     *  
+     *  \param _win_len window length (in microseconds, multiple of the one of the previous level)
+     *  \return the object itself
+     */ 
+    KeyRollup_Builder<F_t, G_t> &addLevel(std::chrono::microseconds _win_len)
+    {
+        return addLevel(_win_len, comb_func);
+    }
+
+    /** 
+     *  \brief Method to add a level consuming the results of the previous one
+     *  
+     *  \param _win_len window length (in microseconds, multiple of the one of the previous level)
+     *  \param _comb_func combine logic of the level
+     *  \return the object itself
+     */ 
+    template<typename comb_F_t>
+    KeyRollup_Builder<F_t, G_t> &addLevel(std::chrono::microseconds _win_len, comb_F_t _comb_func)
+    {
+        // static assert to check the signature
+        static_assert(std::is_same<decltype(get_result_t_Comb(_comb_func)), result_t>::value,
+            "WindFlow Compilation Error - unknown signature passed to addLevel (of a Key_Rollup):\n"
+            "  Candidate 1 : void(const result_t &, const result_t &, result_t &)\n"
+            "  Candidate 2 : void(const result_t &, const result_t &, result_t &, RuntimeContext &)\n");
+        upper_levels.push_back(std::make_pair(_win_len.count(), Win_SeqRollup<tuple_t, result_t>::toRichComb(_comb_func)));
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the parallelism of the Key_Rollup operator
+     *  
+     *  \param _pardegree number of replicas
+     *  \return the object itself
+     */ 
+    KeyRollup_Builder<F_t, G_t> &withParallelism(size_t _pardegree)
+    {
+        pardegree = _pardegree;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the name of the Key_Rollup operator
+     *  
+     *  \param _name string with the name to be given
+     *  \return the object itself
+     */ 
+    KeyRollup_Builder<F_t, G_t> &withName(std::string _name)
+    {
+        name = _name;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the closing logic used by the operator
+     *  
+     *  \param _closing_func closing logic to be used by the operator
+     *  \return the object itself
+     */ 
+    template<typename closing_F_t>
+    KeyRollup_Builder<F_t, G_t> &withClosingFunction(closing_F_t _closing_func)
+    {
+        // static assert to check the signature
+        static_assert(!std::is_same<decltype(check_closing_t(_closing_func)), std::false_type>::value,
+            "WindFlow Compilation Error - unknown signature passed to withClosingFunction (of a Key_Rollup):\n"
+            "  Candidate : void(RuntimeContext &)\n");
+        closing_func = _closing_func;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    KeyRollup_Builder<F_t, G_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Key_Rollup operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    KeyRollup_Builder<F_t, G_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
+#if __cplusplus >= 201703L
+    /** 
+     *  \brief Method to create the Key_Rollup operator (only C++17)
+     *  
+     *  \return a copy of the created Key_Rollup operator
+     */ 
+    keyrollup_t build()
+    {
+        return keyrollup_t(lift_func,
+                           comb_func,
+                           win_len,
+                           upper_levels,
+                           triggering_delay,
+                           pardegree,
+                           name,
+                           closing_func,
+                           routing_func,
+                           cpus); // guaranteed copy elision in C++17
+    }
+#endif
+
+    /** 
+     *  \brief Method to create the Key_Rollup operator
+     *  
+     *  \return a pointer to the created Key_Rollup operator (to be explicitly deallocated/destroyed)
+     */ 
+    keyrollup_t *build_ptr()
+    {
+        return new keyrollup_t(lift_func,
+                               comb_func,
+                               win_len,
+                               upper_levels,
+                               triggering_delay,
+                               pardegree,
+                               name,
+                               closing_func,
+                               routing_func,
+                               cpus);
+    }
+
+    /** 
+     *  \brief Method to create the Key_Rollup operator
+     *  
+     *  \return a unique_ptr to the created Key_Rollup operator
+     */ 
+    std::unique_ptr<keyrollup_t> build_unique()
+    {
+        return std::make_unique<keyrollup_t>(lift_func,
+                                             comb_func,
+                                             win_len,
+                                             upper_levels,
+                                             triggering_delay,
+                                             pardegree,
+                                             name,
+                                             closing_func,
+                                             routing_func,
+                                             cpus);
     }
 };
 
 /** 
- *  \class KeyFFAT_Builder
+ *  \class KeySession_Builder
  *  
- *  \brief Builder of the Key_FFAT operator
+ *  \brief Builder of the Key_Session operator
  *  
- *  Builder class to ease the creation of the Key_FFAT operator.
+ *  Builder class to ease the creation of the Key_Session operator.
  */ 
-template<typename F_t, typename G_t>
-class KeyFFAT_Builder
+template<typename F_t>
+class KeySession_Builder
 {
 private:
-    F_t lift_func;
-    G_t comb_func;
+    F_t func;
     // extract the type of the operator to be generated by this builder (with static checks)
-    using tuple_t = decltype(get_tuple_t_Lift(lift_func));
-    using result_t = decltype(get_result_t_Lift(lift_func));
-    // static asserts to check the signatures
+    using tuple_t = decltype(get_tuple_t_Win(func));
+    using result_t = decltype(get_result_t_Win(func));
+    // static assert to check the signature
     static_assert(!(std::is_same<tuple_t, std::false_type>::value || std::is_same<result_t, std::false_type>::value),
-        "WindFlow Compilation Error - unknown signature passed to the KeyFFAT_Builder (first argument, lift logic):\n"
-        "  Candidate 1 : void(const tuple_t &, result_t &)\n"
-        "  Candidate 2 : void(const tuple_t &, result_t &, RuntimeContext &)\n");
-    using result_t2 = decltype(get_result_t_Comb(comb_func));
-    static_assert(!(std::is_same<std::false_type, result_t2>::value),
-        "WindFlow Compilation Error - unknown signature passed to the KeyFFAT_Builder (second argument, combine logic):\n"
-        "  Candidate 1 : void(const result_t &, const result_t &, result_t &)\n"
-        "  Candidate 2 : void(const result_t &, const result_t &, result_t &, RuntimeContext &)\n");
-    static_assert(std::is_same<result_t, result_t2>::value,
-        "WindFlow Compilation Error - type mismatch in the KeyFFAT_Builder (output type of the lift logic must be equal to the input type of the combine logic)\n");
-    using keyffat_t = Key_FFAT<tuple_t, result_t>;
+        "WindFlow Compilation Error - unknown signature passed to the KeySession_Builder:\n"
+        "  Candidate 1 : void(uint64_t, const Iterable<tuple_t> &, result_t &)\n"
+        "  Candidate 2 : void(uint64_t, const Iterable<tuple_t> &, result_t &, RuntimeContext &)\n"
+        "  Candidate 3 : void(uint64_t, const tuple_t &, result_t &)\n"
+        "  Candidate 4 : void(uint64_t, const tuple_t &, result_t &, RuntimeContext &)\n");
+    using keysession_t = Key_Session<tuple_t, result_t>;
+    // type of the rich function combining the partial results of two merged sessions
+    using rich_winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &, RuntimeContext &)>;
     // type of the closing function
     using closing_func_t = std::function<void(RuntimeContext&)>;
     // type of the function to map the key hashcode onto an identifier starting from zero to pardegree-1
     using routing_func_t = std::function<size_t(size_t, size_t)>;
-    uint64_t win_len = 1;
-    uint64_t slide_len = 1;
+    uint64_t gap = 1;
+    uint64_t max_duration = 0;
     uint64_t triggering_delay = 0;
-    win_type_t winType = win_type_t::CB;
     size_t pardegree = 1;
-    std::string name = "kff";
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    std::string name = "ks";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+    routing_func_t routing_func = default_routing;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
+    rich_winComb_func_t comb_func = nullptr;
 
 public:
     /** 
      *  \brief Constructor
      *  
-     *  \param _lift_func the lift logic to translate a tuple into a result
-     *  \param _comb_func the combine logic to combine two results into a result
+     *  \param _func non-incremental/incremental session processing logic
      */ 
-    KeyFFAT_Builder(F_t _lift_func, G_t _comb_func): lift_func(_lift_func), comb_func(_comb_func) {}
+    KeySession_Builder(F_t _func): func(_func) {}
 
     /** 
-     *  \brief Method to specify the configuration for count-based windows
+     *  \brief Method to specify the gap closing a session of a key
      *  
-     *  \param _win_len window length (in no. of tuples)
-     *  \param _slide_len slide length (in no. of tuples)
+     *  \param _gap session gap (in microseconds)
      *  \return the object itself
      */ 
-    KeyFFAT_Builder<F_t, G_t> &withCBWindows(uint64_t _win_len, uint64_t _slide_len)
+    KeySession_Builder<F_t> &withGap(std::chrono::microseconds _gap)
     {
-        win_len = _win_len;
-        slide_len = _slide_len;
-        winType = win_type_t::CB;
+        gap = _gap.count();
         return *this;
     }
 
     /** 
-     *  \brief Method to specify the configuration for time-based windows
+     *  \brief Method to specify the maximum duration of a session
+     *  
+     *  \param _max_duration maximum duration of a session (in microseconds, zero means no limit)
+     *  \return the object itself
+     */ 
+    KeySession_Builder<F_t> &withMaxDuration(std::chrono::microseconds _max_duration)
+    {
+        max_duration = _max_duration.count();
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the triggering delay of the sessions
      *  
-     *  \param _win_len window length (in microseconds)
-     *  \param _slide_len slide length (in microseconds)
      *  \param _triggering_delay (in microseconds)
      *  \return the object itself
      */ 
-    KeyFFAT_Builder<F_t, G_t> &withTBWindows(std::chrono::microseconds _win_len,
-                                             std::chrono::microseconds _slide_len,
-                                             std::chrono::microseconds _triggering_delay=std::chrono::microseconds::zero())
+    KeySession_Builder<F_t> &withTriggeringDelay(std::chrono::microseconds _triggering_delay)
     {
-        win_len = _win_len.count();
-        slide_len = _slide_len.count();
         triggering_delay = _triggering_delay.count();
-        winType = win_type_t::TB;
         return *this;
     }
 
     /** 
-     *  \brief Method to specify the parallelism of the Key_FFAT operator
+     *  \brief Method to specify the function combining the partial results of two sessions of
+     *         a key merged by a tuple received out-of-order (incremental session logic only). It
+     *         is required in the DEFAULT mode with a triggering delay
+     *  
+     *  \param _comb_func combine logic of the partial results
+     *  \return the object itself
+     */ 
+    template<typename comb_F_t>
+    KeySession_Builder<F_t> &withCombine(comb_F_t _comb_func)
+    {
+        // static assert to check the signature
+        static_assert(std::is_same<decltype(get_result_t_Comb(_comb_func)), result_t>::value,
+            "WindFlow Compilation Error - unknown signature passed to withCombine (of a Key_Session):\n"
+            "  Candidate 1 : void(const result_t &, const result_t &, result_t &)\n"
+            "  Candidate 2 : void(const result_t &, const result_t &, result_t &, RuntimeContext &)\n");
+        comb_func = Win_SeqSession<tuple_t, result_t>::toRichComb(_comb_func);
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the parallelism of the Key_Session operator
      *  
      *  \param _pardegree number of replicas
      *  \return the object itself
      */ 
-    KeyFFAT_Builder<F_t, G_t> &withParallelism(size_t _pardegree)
+    KeySession_Builder<F_t> &withParallelism(size_t _pardegree)
     {
         pardegree = _pardegree;
         return *this;
     }
 
     /** 
-     *  \brief Method to specify the name of the Key_FFAT operator
+     *  \brief Method to specify the name of the Key_Session operator
      *  
      *  \param _name string with the name to be given
      *  \return the object itself
      */ 
-    KeyFFAT_Builder<F_t, G_t> &withName(std::string _name)
+    KeySession_Builder<F_t> &withName(std::string _name)
     {
         name = _name;
         return *this;
@@ -1681,73 +3809,99 @@ public:
      *  \return the object itself
      */ 
     template<typename closing_F_t>
-    KeyFFAT_Builder<F_t, G_t> &withClosingFunction(closing_F_t _closing_func)
+    KeySession_Builder<F_t> &withClosingFunction(closing_F_t _closing_func)
     {
         // static assert to check the signature
         static_assert(!std::is_same<decltype(check_closing_t(_closing_func)), std::false_type>::value,
-            "WindFlow Compilation Error - unknown signature passed to withClosingFunction (of a Key_FFAT):\n"
+            "WindFlow Compilation Error - unknown signature passed to withClosingFunction (of a Key_Session):\n"
             "  Candidate : void(RuntimeContext &)\n");
         closing_func = _closing_func;
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    KeySession_Builder<F_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Key_Session operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    KeySession_Builder<F_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
-     *  \brief Method to create the Key_FFAT operator (only C++17)
+     *  \brief Method to create the Key_Session operator (only C++17)
      *  
-     *  \return a copy of the created Key_Farm operator
+     *  \return a copy of the created Key_Session operator
      */ 
-    keyffat_t build()
+    keysession_t build()
     {
-        return keyffat_t(lift_func,
-                         comb_func,
-                         win_len,
-                         slide_len,
-                         triggering_delay,
-                         winType,
-                         pardegree,
-                         name,
-                         closing_func,
-                         routing_func); // guaranteed copy elision in C++17
+        return keysession_t(func,
+                            gap,
+                            max_duration,
+                            triggering_delay,
+                            pardegree,
+                            name,
+                            closing_func,
+                            routing_func,
+                            cpus,
+                            comb_func); // guaranteed copy elision in C++17
     }
 #endif
 
     /** 
-     *  \brief Method to create the Key_FFAT operator
+     *  \brief Method to create the Key_Session operator
      *  
-     *  \return a pointer to the created Key_FFAT operator (to be explicitly deallocated/destroyed)
+     *  \return a pointer to the created Key_Session operator (to be explicitly deallocated/destroyed)
      */ 
-    keyffat_t *build_ptr()
+    keysession_t *build_ptr()
     {
-        return new keyffat_t(lift_func,
-                             comb_func,
-                             win_len,
-                             slide_len,
-                             triggering_delay,
-                             winType,
-                             pardegree,
-                             name,
-                             closing_func,
-                             routing_func);
+        return new keysession_t(func,
+                                gap,
+                                max_duration,
+                                triggering_delay,
+                                pardegree,
+                                name,
+                                closing_func,
+                                routing_func,
+                                cpus,
+                                comb_func);
     }
 
     /** 
-     *  \brief Method to create the Key_FFAT operator
+     *  \brief Method to create the Key_Session operator
      *  
-     *  \return a unique_ptr to the created Key_FFAT operator
+     *  \return a unique_ptr to the created Key_Session operator
      */ 
-    std::unique_ptr<keyffat_t> build_unique()
+    std::unique_ptr<keysession_t> build_unique()
     {
-        return std::make_unique<keyffat_t>(lift_func,
-                                           comb_func,
-                                           win_len,
-                                           slide_len,
-                                           triggering_delay,
-                                           winType,
-                                           pardegree,
-                                           name,
-                                           closing_func,
-                                           routing_func);
+        return std::make_unique<keysession_t>(func,
+                                              gap,
+                                              max_duration,
+                                              triggering_delay,
+                                              pardegree,
+                                              name,
+                                              closing_func,
+                                              routing_func,
+                                              cpus);
     }
 };
 
@@ -1793,6 +3947,7 @@ private:
     size_t plq_degree = 1;
     size_t wlq_degree = 1;
     std::string name = "pf";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     opt_level_t opt_level = opt_level_t::LEVEL0;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
 
@@ -1905,6 +4060,20 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Pane_Farm operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    PaneFarm_Builder<F_t, G_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Pane_Farm operator (only C++17)
@@ -1924,7 +4093,8 @@ public:
                           name,
                           closing_func,
                           true,
-                          opt_level); // guaranteed copy elision in C++17
+                          opt_level,
+                          cpus); // guaranteed copy elision in C++17
     }
 #endif
 
@@ -1946,7 +4116,8 @@ public:
                               name,
                               closing_func,
                               true,
-                              opt_level);
+                              opt_level,
+                              cpus);
     }
 
     /** 
@@ -1967,7 +4138,8 @@ public:
                                             name,
                                             closing_func,
                                             true,
-                                            opt_level);
+                                            opt_level,
+                                            cpus);
     }
 };
 
@@ -2013,6 +4185,7 @@ private:
     size_t map_degree = 2;
     size_t reduce_degree = 1;
     std::string name = "wmr";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     opt_level_t opt_level = opt_level_t::LEVEL0;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
 
@@ -2125,6 +4298,20 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Win_MapReduce operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    WinMapReduce_Builder<F_t, G_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Win_MapReduce operator (only C++17)
@@ -2144,7 +4331,8 @@ public:
                               name,
                               closing_func,
                               true,
-                              opt_level); // guaranteed copy elision in C++17
+                              opt_level,
+                              cpus); // guaranteed copy elision in C++17
     }
 #endif
 
@@ -2166,7 +4354,8 @@ public:
                                   name,
                                   closing_func,
                                   true,
-                                  opt_level);
+                                  opt_level,
+                                  cpus);
     }
 
     /** 
@@ -2187,7 +4376,8 @@ public:
                                                 name,
                                                 closing_func,
                                                 true,
-                                                opt_level);
+                                                opt_level,
+                                                cpus);
     }
 };
 
@@ -2219,9 +4409,37 @@ private:
     using routing_func_t = std::function<size_t(size_t, size_t)>;
     uint64_t pardegree = 1;
     std::string name = "sink";
+    std::vector<int> cpus; // CPUs of the replicas (empty to use the placement policy of the PipeGraph)
     bool isKeyBy = false;
     closing_func_t closing_func = [](RuntimeContext &r) -> void { return; };
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    routing_func_t routing_func = default_routing;
+
+    size_t elastic_max = 0; // zero means not elastic
+    size_t elastic_min = 1;
+    uint64_t as_interval = 0; // zero means no autoscaler
+    double as_low = DEFAULT_ELASTIC_LOW_UTILIZATION;
+    double as_high = DEFAULT_ELASTIC_HIGH_UTILIZATION;
+    uint64_t as_backlog = DEFAULT_ELASTIC_BACKLOG;
+    size_t od_credits = 0; // zero means the pseudo round-robin distribution
+
+    // get the number of replicas of the operator (the maximum number of active replicas if it is elastic)
+    size_t getNumReplicas() const
+    {
+        return std::max<size_t>(pardegree, elastic_max);
+    }
+
+    // create the controller of the active replicas (nullptr if the operator is not elastic)
+    std::shared_ptr<Elastic_Controller> createElasticController() const
+    {
+        if (elastic_max == 0 && as_interval == 0) {
+            return nullptr;
+        }
+        auto elastic = std::make_shared<Elastic_Controller>(getNumReplicas(), pardegree, elastic_min);
+        if (as_interval > 0) {
+            elastic->enableAutoscaling(as_interval, as_low, as_high, as_backlog);
+        }
+        return elastic;
+    }
 
 public:
     /** 
@@ -2283,6 +4501,89 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing (used if the key-based routing is enabled)
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    Sink_Builder<F_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to make the Sink operator elastic (not with the key-based routing). The operator
+     *         has _max_parallelism replicas and the inputs are distributed to the first ones only (initially
+     *         as many as the parallelism, then as set through its Elastic_Controller or by the autoscaler)
+     *  
+     *  \param _max_parallelism maximum number of active replicas
+     *  \param _min_parallelism minimum number of active replicas
+     *  \return the object itself
+     */ 
+    Sink_Builder<F_t> &withElasticity(size_t _max_parallelism,
+                                      size_t _min_parallelism=1)
+    {
+        elastic_max = _max_parallelism;
+        elastic_min = _min_parallelism;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the autoscaler changing the number of active replicas of the Sink operator
+     *         (up to the maximum set with withElasticity, or to the parallelism otherwise). A replica is added
+     *         when the utilization or the backlog of the active replicas is too high, and it is removed when
+     *         the utilization is low enough to be sustained by the remaining ones
+     *  
+     *  \param _interval interval between two evaluations of the autoscaler
+     *  \param _low_util utilization of the active replicas below which a replica is removed
+     *  \param _high_util utilization of the active replicas above which a replica is added
+     *  \param _max_backlog inputs per active replica not processed yet above which a replica is added (zero means no limit)
+     *  \return the object itself
+     */ 
+    Sink_Builder<F_t> &withAutoscaling(std::chrono::microseconds _interval=std::chrono::microseconds(DEFAULT_ELASTIC_INTERVAL_USEC),
+                                       double _low_util=DEFAULT_ELASTIC_LOW_UTILIZATION,
+                                       double _high_util=DEFAULT_ELASTIC_HIGH_UTILIZATION,
+                                       uint64_t _max_backlog=DEFAULT_ELASTIC_BACKLOG)
+    {
+        as_interval = std::max<uint64_t>(_interval.count(), 1);
+        as_low = _low_util;
+        as_high = _high_util;
+        as_backlog = _max_backlog;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to enable the on-demand scheduling of the inputs (not with the key-based routing
+     *         and not with the elasticity). Each input is sent to the replica with the shortest queue
+     *         among the ones with a free credit, and a credit is released when the replica has processed
+     *         the input (useful when the processing cost of the inputs is highly variable)
+     *  
+     *  \param _credits number of credits per replica (maximum number of inputs queued to a replica)
+     *  \return the object itself
+     */ 
+    Sink_Builder<F_t> &withOnDemandScheduling(size_t _credits=DEFAULT_ONDEMAND_CREDITS)
+    {
+        od_credits = std::max<size_t>(_credits, 1);
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the CPUs of the replicas of the Sink operator, used in round-robin by
+     *         the replicas (otherwise they are placed according to the policy of the PipeGraph). Each
+     *         replica is bound to its CPU before allocating its state, which is thus local to its NUMA node
+     *  
+     *  \param _cpus identifiers of the CPUs
+     *  \return the object itself
+     */ 
+    Sink_Builder<F_t> &withCPUs(std::vector<int> _cpus)
+    {
+        cpus = _cpus;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Sink operator (only C++17)
@@ -2293,16 +4594,22 @@ public:
     {
         if (!isKeyBy) {
             return sink_t(func,
-                          pardegree,
+                          getNumReplicas(),
                           name,
-                          closing_func); // guaranteed copy elision in C++17
+                          closing_func,
+                          createElasticController(),
+                          od_credits,
+                          cpus); // guaranteed copy elision in C++17
         }
         else {
             return sink_t(func,
-                          pardegree,
+                          getNumReplicas(),
                           name,
                           closing_func,
-                          routing_func); // guaranteed copy elision in C++17
+                          routing_func,
+                          createElasticController(),
+                          od_credits,
+                          cpus); // guaranteed copy elision in C++17
         }
     }
 #endif
@@ -2316,16 +4623,22 @@ public:
     {
         if (!isKeyBy) {
             return new sink_t(func,
-                              pardegree,
+                              getNumReplicas(),
                               name,
-                              closing_func);
+                              closing_func,
+                              createElasticController(),
+                              od_credits,
+                              cpus);
         }
         else {
             return new sink_t(func,
-                              pardegree,
+                              getNumReplicas(),
                               name,
                               closing_func,
-                              routing_func);
+                              routing_func,
+                              createElasticController(),
+                              od_credits,
+                              cpus);
         }
     }
 
@@ -2338,20 +4651,92 @@ public:
     {
         if (!isKeyBy) {
             return std::make_unique<sink_t>(func,
-                                            pardegree,
+                                            getNumReplicas(),
                                             name,
-                                            closing_func);
+                                            closing_func,
+                                            createElasticController(),
+                                            od_credits,
+                                            cpus);
         }
         else {
             return std::make_unique<sink_t>(func,
-                                            pardegree,
+                                            getNumReplicas(),
                                             name,
                                             closing_func,
-                                            routing_func);
+                                            routing_func,
+                                            createElasticController(),
+                                            od_credits,
+                                            cpus);
         }
     }
 };
 
+/** 
+ *  \class SlackPolicy_Builder
+ *  
+ *  \brief Builder of the policy of the slack used in PROBABILISTIC mode
+ *  
+ *  Builder class to ease the creation of the slack policy to be passed to a PipeGraph.
+ */ 
+class SlackPolicy_Builder
+{
+private:
+    uint64_t max_slack = 0;
+    double target_drop_rate = 0;
+    size_t window = DEFAULT_SLACK_WINDOW;
+
+public:
+    /// Constructor
+    SlackPolicy_Builder() {}
+
+    /** 
+     *  \brief Method to specify the maximum value of the slack (i.e. the latency budget of the reordering)
+     *  
+     *  \param _max_slack maximum slack (in microseconds, zero means unbounded)
+     *  \return the object itself
+     */ 
+    SlackPolicy_Builder &withMaxSlack(std::chrono::microseconds _max_slack)
+    {
+        max_slack = _max_slack.count();
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the fraction of inputs that can be dropped. The slack is
+     *         estimated from the most recent delays and it can shrink
+     *  
+     *  \param _target_drop_rate target drop rate (in [0, 1), zero means that the slack never shrinks)
+     *  \return the object itself
+     */ 
+    SlackPolicy_Builder &withTargetDropRate(double _target_drop_rate)
+    {
+        target_drop_rate = _target_drop_rate;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to specify the number of most recent delays used to estimate the slack
+     *  
+     *  \param _window number of delays
+     *  \return the object itself
+     */ 
+    SlackPolicy_Builder &withWindow(size_t _window)
+    {
+        window = _window;
+        return *this;
+    }
+
+    /** 
+     *  \brief Method to create the slack policy
+     *  
+     *  \return the slack policy
+     */ 
+    Slack_Policy build()
+    {
+        return Slack_Policy(max_slack, target_drop_rate, window);
+    }
+};
+
 } // namespace wf
 
 #endif
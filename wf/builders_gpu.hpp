@@ -734,7 +734,7 @@ private:
     size_t n_thread_block = DEFAULT_CUDA_NUM_THREAD_BLOCK;
     std::string name = "wf_gpu";
     size_t scratchpad_size = 0;
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    routing_func_t routing_func = default_routing;
     opt_level_t opt_level = opt_level_t::LEVEL2;
     bool isComplex=false;
 
@@ -923,6 +923,19 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    KeyFarmGPU_Builder<T> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Key_Farm_GPU operator (only C++17)
@@ -1032,7 +1045,7 @@ private:
     size_t n_thread_block = DEFAULT_CUDA_NUM_THREAD_BLOCK;
     bool rebuild = false;
     std::string name = "kff_gpu";
-    routing_func_t routing_func = [](size_t k, size_t n) { return k%n; };
+    routing_func_t routing_func = default_routing;
 
 public:
     /** 
@@ -1139,6 +1152,19 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Method to specify the partitioner of the key-based routing
+     *  
+     *  \param _partitioner partitioner (or function) mapping the hashcode of a key onto a replica identifier
+     *                      (e.g., Hash_Partitioner, JumpConsistent_Partitioner, Rendezvous_Partitioner or Range_Partitioner)
+     *  \return the object itself
+     */ 
+    KeyFFATGPU_Builder<F_t, G_t> &withPartitioner(routing_func_t _partitioner)
+    {
+        routing_func = _partitioner;
+        return *this;
+    }
+
 #if __cplusplus >= 201703L
     /** 
      *  \brief Method to create the Key_FFAT_GPU operator (only C++17)
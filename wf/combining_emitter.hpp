@@ -0,0 +1,284 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    combining_emitter.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    09/11/2020
+ *  
+ *  @brief Emitter pre-aggregating the inputs of a key-based distribution
+ *  
+ *  @section Combining Emitter (Description)
+ *  
+ *  This file implements the emitter used by the Accumulator and Key_FFAT operators
+ *  configured with a combiner. The emitter is fused with the upstream replicas and
+ *  it keeps a small table with one partial result per key. Each input is folded into
+ *  the partial result of its key (with the lift and combine functions, or with a fold
+ *  function starting from an initial value) and the partial results, instead of the
+ *  inputs, are sent to the replicas of the operator.
+ *  
+ *  All the partial results are flushed in timestamp order when the table is full,
+ *  when the flush interval has elapsed, when an input belongs to a quantum (the time
+ *  granularity of the windows) different from the one of the partial result of its
+ *  key or from the last one seen, and before each watermark and at the end of the
+ *  stream. In this way, each destination receives the partial results of a key in
+ *  timestamp order, and the ones of all the keys in timestamp order if the inputs are
+ *  ordered too.
+ */ 
+
+#ifndef COMBINING_EMITTER_H
+#define COMBINING_EMITTER_H
+
+// includes
+#include<vector>
+#include<algorithm>
+#include<functional>
+#include<unordered_map>
+#include<basic.hpp>
+#include<meta.hpp>
+#include<ff/multinode.hpp>
+#include<basic_emitter.hpp>
+#include<watermark.hpp>
+
+namespace wf {
+
+// class Combining_Emitter
+template<typename tuple_t, typename result_t>
+class Combining_Emitter: public Basic_Emitter
+{
+private:
+    tuple_t tmp; // never used
+    // key data type
+    using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
+    // type of the function to map the key hashcode onto an identifier starting from zero to n_dest-1
+    using routing_func_t = std::function<size_t(size_t, size_t)>;
+    // type of the lift function
+    using lift_func_t = std::function<void(const tuple_t &, result_t &)>;
+    // type of the combine function
+    using comb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
+    // inner struct of the partial result of a key
+    struct Partial
+    {
+        result_t *result; // partial result
+        uint64_t id; // identifier of the last input folded into the partial result
+        uint64_t ts; // highest timestamp of the inputs folded into the partial result
+        uint64_t quantum; // identifier of the quantum of the partial result
+    };
+    lift_func_t lift_func; // lift function (or fold function if isFold is true)
+    comb_func_t comb_func; // combine function (not used if isFold is true)
+    bool isFold; // true if the inputs are folded into the partial results starting from init_value
+    result_t init_value; // initial value of the partial results (used if isFold is true)
+    routing_func_t routing_func; // routing function
+    size_t n_dest; // number of destinations
+    uint64_t quantum; // time granularity of the windows (zero if the partial results do not depend on windows)
+    size_t capacity; // maximum number of partial results in the table
+    uint64_t flush_interval; // interval between two flushes in microseconds (zero means no time-based flushing)
+    uint64_t last_flush; // time of the last flush in microseconds
+    uint64_t max_quantum; // highest quantum received so far
+    bool isCombined; // true if this node is used within a Tree_Emitter node
+    std::vector<std::pair<void *, int>> output_queue; // used in case of Tree_Emitter mode
+    std::unordered_map<key_t, Partial> table; // table of the partial results
+    std::vector<Partial> flushed; // partial results being flushed (reused to avoid allocations)
+
+    // send a message to a destination
+    void send(void *_msg, size_t _dest)
+    {
+        if (!isCombined) {
+            this->ff_send_out_to(_msg, _dest);
+        }
+        else {
+            output_queue.push_back(std::make_pair(_msg, _dest));
+        }
+    }
+
+    // send all the partial results in timestamp order
+    void flush()
+    {
+        last_flush = (flush_interval > 0) ? current_time_usecs() : 0;
+        if (table.empty()) {
+            return;
+        }
+        for (auto &p: table) {
+            flushed.push_back(p.second);
+        }
+        table.clear();
+        std::sort(flushed.begin(), flushed.end(), [](const Partial &a, const Partial &b) { return a.ts < b.ts; });
+        for (auto &p: flushed) {
+            auto key = std::get<0>((p.result)->getControlFields());
+            (p.result)->setControlFields(key, p.id, p.ts);
+            send(p.result, routing_func(std::hash<key_t>()(key), n_dest));
+        }
+        flushed.clear();
+    }
+
+public:
+    // Constructor I (partial results computed with the lift and combine functions)
+    Combining_Emitter(lift_func_t _lift_func,
+                      comb_func_t _comb_func,
+                      routing_func_t _routing_func,
+                      size_t _n_dest,
+                      uint64_t _quantum,
+                      size_t _capacity,
+                      uint64_t _flush_interval):
+                      lift_func(_lift_func),
+                      comb_func(_comb_func),
+                      isFold(false),
+                      routing_func(_routing_func),
+                      n_dest(_n_dest),
+                      quantum(_quantum),
+                      capacity(std::max<size_t>(_capacity, 1)),
+                      flush_interval(_flush_interval),
+                      last_flush(0),
+                      max_quantum(0),
+                      isCombined(false) {}
+
+    // Constructor II (partial results computed with the fold function starting from the initial value)
+    Combining_Emitter(lift_func_t _fold_func,
+                      result_t _init_value,
+                      routing_func_t _routing_func,
+                      size_t _n_dest,
+                      size_t _capacity,
+                      uint64_t _flush_interval):
+                      lift_func(_fold_func),
+                      isFold(true),
+                      init_value(_init_value),
+                      routing_func(_routing_func),
+                      n_dest(_n_dest),
+                      quantum(0),
+                      capacity(std::max<size_t>(_capacity, 1)),
+                      flush_interval(_flush_interval),
+                      last_flush(0),
+                      max_quantum(0),
+                      isCombined(false) {}
+
+    // clone method
+    Basic_Emitter *clone() const override
+    {
+        Combining_Emitter<tuple_t, result_t> *copy = new Combining_Emitter<tuple_t, result_t>(*this);
+        return copy;
+    }
+
+    // svc_init method (utilized by the FastFlow runtime)
+    int svc_init() override
+    {
+        return 0;
+    }
+
+    // svc method (utilized by the FastFlow runtime)
+    void *svc(void *in) override
+    {
+        // watermarks are broadcast to all the destinations after the partial results
+        if (isWatermark(in)) {
+            flush();
+            for (size_t i=0; i<n_dest; i++) {
+                send(in, i);
+            }
+            return this->GO_ON;
+        }
+        // a shared envelope of a split is owned with copy-on-write (the tuple is not forwarded as it is)
+        tuple_t *t = ownInput(reinterpret_cast<tuple_t *>(in));
+        auto key = std::get<0>(t->getControlFields()); // key
+        uint64_t id = std::get<1>(t->getControlFields()); // identifier
+        uint64_t ts = std::get<2>(t->getControlFields()); // timestamp
+        uint64_t q = (quantum > 0) ? ts / quantum : 0;
+        // the partial results of the previous quanta are complete
+        if (q > max_quantum) {
+            max_quantum = q;
+            flush();
+        }
+        auto it = table.find(key);
+        if (it != table.end() && (*it).second.quantum != q) {
+            flush();
+            it = table.end();
+        }
+        if (it == table.end()) {
+            result_t *r = nullptr;
+            if (isFold) {
+                r = new result_t(init_value);
+            }
+            else {
+                r = new result_t();
+                r->setControlFields(key, 0, ts);
+            }
+            lift_func(*t, *r);
+            r->setControlFields(key, id, ts);
+            table.insert(std::make_pair(key, Partial{r, id, ts, q}));
+        }
+        else {
+            Partial &p = (*it).second;
+            if (isFold) {
+                lift_func(*t, *(p.result));
+            }
+            else {
+                result_t lifted;
+                lifted.setControlFields(key, 0, ts);
+                lift_func(*t, lifted);
+                result_t combined;
+                combined.setControlFields(key, 0, std::max(p.ts, ts));
+                comb_func(*(p.result), lifted, combined);
+                *(p.result) = combined;
+            }
+            p.id = id;
+            p.ts = std::max(p.ts, ts);
+        }
+        delete t;
+        // flush by size or by time
+        if (table.size() >= capacity) {
+            flush();
+        }
+        else if (flush_interval > 0) {
+            uint64_t now = current_time_usecs();
+            if (last_flush == 0) {
+                last_flush = now;
+            }
+            else if (now - last_flush >= flush_interval) {
+                flush();
+            }
+        }
+        return this->GO_ON;
+    }
+
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        flush();
+    }
+
+    // svc_end method (FastFlow runtime)
+    void svc_end() override {}
+
+    // get the number of destinations
+    size_t getNDestinations() const override
+    {
+        return n_dest;
+    }
+
+    // set/unset the Tree_Emitter mode
+    void setTree_EmitterMode(bool _val) override
+    {
+        isCombined = _val;
+    }
+
+    // method to get a reference to the internal output queue (used in Tree_Emitter mode)
+    std::vector<std::pair<void *, int>> &getOutputQueue() override
+    {
+        return output_queue;
+    }
+};
+
+} // namespace wf
+
+#endif
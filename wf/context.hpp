@@ -26,17 +26,26 @@
  *  This file implements the RuntimeContext class used to access the run-time system
  *  information used by the functional logic of an operator (static information such
  *  as the parallelism of the operator and which is the current replica invoking
- *  the operator's functional logic).
+ *  the operator's functional logic). It also gives access to the processing-time
+ *  timers of the replica (see timer_service.hpp), whose callbacks can also receive
+ *  the Shipper of the replica to emit results (Source, Map, Filter, FlatMap and
+ *  Accumulator operators).
  */ 
 
 #ifndef CONTEXT_H
 #define CONTEXT_H
 
 /// includes
+#include<iostream>
+#include<typeinfo>
 #include<local_storage.hpp>
+#include<timer_service.hpp>
 
 namespace wf {
 
+template<typename result_t>
+class Shipper;
+
 /** 
  *  \class RuntimeContext
  *  
@@ -52,12 +61,29 @@ private:
     size_t parallelism; // parallelism of the operator
     size_t index; // index of the replica
     LocalStorage storage; // local storage
+    TimerService timers; // processing-time timers of the replica
+    void *shipper; // shipper of the replica used by the timers (nullptr if the replica cannot emit results from the timers)
+    const std::type_info *shipper_type; // type of the shipper of the replica
+
+    // bind a callback receiving the Shipper to the shipper of the replica
+    template<typename result_t>
+    TimerService::timer_func_t bindShipper(std::function<void(Shipper<result_t> &, RuntimeContext &)> _func)
+    {
+        if (shipper == nullptr || *shipper_type != typeid(Shipper<result_t>)) {
+            std::cerr << RED << "WindFlow Error: timer with a Shipper not supported by the operator or with a wrong type of results" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        Shipper<result_t> *s = static_cast<Shipper<result_t> *>(shipper);
+        return [s, _func](RuntimeContext &_context) { _func(*s, _context); };
+    }
 
 public:
     /// Constructor I
     RuntimeContext():
                   parallelism(0),
-                  index(0) {}
+                  index(0),
+                  shipper(nullptr),
+                  shipper_type(nullptr) {}
 
     /** 
      *  \brief Constructor II
@@ -68,7 +94,9 @@ public:
     RuntimeContext(size_t _parallelism,
                    size_t _index):
                    parallelism(_parallelism),
-                   index(_index) {}
+                   index(_index),
+                   shipper(nullptr),
+                   shipper_type(nullptr) {}
 
     /** 
      *  \brief Return the parallelism of the operator
@@ -99,6 +127,98 @@ public:
     {
         return storage;
     }
+
+    /** 
+     *  \brief Return the current processing time (the clock used by the timers)
+     *  
+     *  \return current time in microseconds
+     */ 
+    uint64_t getCurrentTime() const
+    {
+        return current_time_usecs();
+    }
+
+    /** 
+     *  \brief Register a one-shot timer of the replica. The callback is executed by the
+     *         replica itself, as soon as it is active (on the arrival of an input or of a
+     *         punctuation) after the given time. On an idle stream, the replicas are woken
+     *         up by the idle marks repeated by the Sources (see the idle timeout of their
+     *         watermarks), so the delay of the timers is bounded by the idle timeout
+     *  
+     *  \param _time processing time (in microseconds) when the timer fires
+     *  \param _func callback of the timer with signature void(RuntimeContext &)
+     *  \return identifier of the timer
+     */ 
+    uint64_t registerTimer(uint64_t _time, TimerService::timer_func_t _func)
+    {
+        return timers.registerTimer(_time, _func);
+    }
+
+    /** 
+     *  \brief Register a periodic timer of the replica. The callback is executed by the
+     *         replica itself (see registerTimer)
+     *  
+     *  \param _period period of the timer (in microseconds)
+     *  \param _func callback of the timer with signature void(RuntimeContext &)
+     *  \return identifier of the timer
+     */ 
+    uint64_t registerPeriodicTimer(uint64_t _period, TimerService::timer_func_t _func)
+    {
+        return timers.registerPeriodicTimer(_period, _func);
+    }
+
+    /** 
+     *  \brief Register a one-shot timer of the replica whose callback receives the Shipper
+     *         of the replica, used to emit results of type result_t (see registerTimer). The
+     *         emitted results are not ordered with the ones produced by the processing logic
+     *  
+     *  \param _time processing time (in microseconds) when the timer fires
+     *  \param _func callback of the timer with signature void(Shipper<result_t> &, RuntimeContext &)
+     *  \return identifier of the timer
+     */ 
+    template<typename result_t>
+    uint64_t registerTimer(uint64_t _time, std::function<void(Shipper<result_t> &, RuntimeContext &)> _func)
+    {
+        return timers.registerTimer(_time, bindShipper(_func));
+    }
+
+    /** 
+     *  \brief Register a periodic timer of the replica whose callback receives the Shipper
+     *         of the replica (see registerTimer)
+     *  
+     *  \param _period period of the timer (in microseconds)
+     *  \param _func callback of the timer with signature void(Shipper<result_t> &, RuntimeContext &)
+     *  \return identifier of the timer
+     */ 
+    template<typename result_t>
+    uint64_t registerPeriodicTimer(uint64_t _period, std::function<void(Shipper<result_t> &, RuntimeContext &)> _func)
+    {
+        return timers.registerPeriodicTimer(_period, bindShipper(_func));
+    }
+
+    /** 
+     *  \brief Cancel a timer of the replica
+     *  
+     *  \param _id identifier of the timer
+     */ 
+    void cancelTimer(uint64_t _id)
+    {
+        timers.cancelTimer(_id);
+    }
+
+    /// Execute the callbacks of the expired timers (used by the replica)
+    void pollTimers()
+    {
+        timers.poll(*this);
+    }
+
+    /// Set the shipper of the replica passed to the callbacks of the timers (used by the replica)
+    template<typename result_t>
+    void setShipper(Shipper<result_t> *_shipper)
+    {
+        shipper = _shipper;
+        shipper_type = &typeid(Shipper<result_t>);
+    }
 };
 
 } // namespace wf
@@ -0,0 +1,498 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    elastic.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    12/11/2020
+ *  
+ *  @brief Elastic scaling of the replicas of an operator at runtime
+ *  
+ *  @section Elastic_Controller (Description)
+ *  
+ *  This file implements the Elastic_Controller class shared by the emitters and the
+ *  replicas of an elastic operator. Since the FastFlow graph cannot be changed once it
+ *  is running, an elastic operator is created with its maximum parallelism and only
+ *  the first n replicas (the active ones) receive inputs: the other ones are parked.
+ *  The number of active replicas can be changed at any time through the controller,
+ *  either explicitly by the application or by the autoscaler.
+ *  
+ *  Each emitter of a stateless operator sends an idle mark to the replicas parked since
+ *  its last input, and then it stops sending them the watermarks. Once all its input
+ *  channels are idle, a parked replica sleeps on a condition variable of the controller
+ *  instead of polling its input queues, until it is activated again (its emitters then
+ *  send it their last watermark before the new inputs) or its emitters are terminated.
+ *  A parked replica releases its CPU, while it keeps its thread, its input queues and
+ *  its state (e.g., the functor), and its timers do not fire while it sleeps. A replica
+ *  sleeps only after each one of its emitters has received an input after the change,
+ *  and the parked replicas of keyed operators are not put to sleep (they only receive
+ *  the punctuations but they keep polling their queues, unless FastFlow is compiled
+ *  with BLOCKING_MODE).
+ *  
+ *  The autoscaler is evaluated periodically by the emitters. It adds a replica when the
+ *  utilization of the active replicas (sampled busy time over elapsed time) or their
+ *  backlog (inputs sent and not processed yet) is too high, and it removes a replica
+ *  when the utilization is low enough to be sustained by one replica less.
+ *  
+ *  Stateless operators (Map, Filter, FlatMap and Sink without key-based routing) use
+ *  the controller directly. Keyed operators (Accumulator, Key_Farm and Key_FFAT) use it
+ *  through their key groups (see key_groups.hpp): the key groups of a parked replica
+ *  are migrated, with their state, to the active ones, and a new active replica gets
+ *  its key groups from the rebalancing policy.
+ */ 
+
+#ifndef ELASTIC_H
+#define ELASTIC_H
+
+/// includes
+#include<mutex>
+#include<atomic>
+#include<condition_variable>
+#include<memory>
+#include<vector>
+#include<algorithm>
+#include<basic.hpp>
+#include<watermark.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Elastic_Controller
+ *  
+ *  \brief Number of active replicas of an elastic operator and its autoscaler
+ *  
+ *  This class implements the controller of an elastic operator, shared by its emitters
+ *  and replicas. It keeps the number of active replicas, the statistics reported by the
+ *  emitters and the replicas, and the parameters of the autoscaler.
+ */ 
+class Elastic_Controller
+{
+private:
+    // struct of the statistics of a replica (each one in its own cache line)
+    struct alignas(64) Replica_Stats
+    {
+        std::atomic<uint64_t> busy; // estimated busy time of the replica (in nanoseconds)
+        std::atomic<uint64_t> sent; // number of inputs sent to the replica
+        std::atomic<uint64_t> processed; // number of inputs processed by the replica
+        uint64_t last_busy; // busy time at the last evaluation of the autoscaler (protected by mutex)
+
+        // Constructor
+        Replica_Stats(): busy(0), sent(0), processed(0), last_busy(0) {}
+    };
+    size_t min_replicas; // minimum number of active replicas
+    std::atomic<size_t> active; // number of active replicas
+    std::vector<Replica_Stats> stats; // statistics of the replicas
+    bool autoscaling; // true if the autoscaler is enabled
+    uint64_t interval; // interval between two evaluations of the autoscaler (in microseconds)
+    double low_util; // utilization below which a replica is removed
+    double high_util; // utilization above which a replica is added
+    uint64_t max_backlog; // backlog per active replica above which a replica is added (zero means no limit)
+    std::mutex mutex; // mutex protecting the evaluation of the autoscaler
+    std::atomic<uint64_t> last_eval; // time of the last evaluation of the autoscaler (in microseconds)
+    std::atomic<uint64_t> n_scale_out; // number of replicas added so far
+    std::atomic<uint64_t> n_scale_in; // number of replicas removed so far
+    std::mutex park_mutex; // mutex protecting the sleep of the parked replicas
+    std::condition_variable park_cond; // condition variable where the parked replicas sleep
+    size_t n_closed; // number of emitters terminated (protected by park_mutex)
+
+    // wake up the sleeping replicas after a change of the number of active replicas
+    void wakeUp()
+    {
+        {
+            std::lock_guard<std::mutex> lock(park_mutex);
+        }
+        park_cond.notify_all();
+    }
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _max_replicas maximum number of replicas (the ones created in the operator)
+     *  \param _initial initial number of active replicas
+     *  \param _min_replicas minimum number of active replicas
+     */ 
+    Elastic_Controller(size_t _max_replicas,
+                       size_t _initial,
+                       size_t _min_replicas=1):
+                       min_replicas(std::min(std::max<size_t>(_min_replicas, 1), std::max<size_t>(_max_replicas, 1))),
+                       active(std::min(std::max(_initial, min_replicas), std::max<size_t>(_max_replicas, 1))),
+                       stats(std::max<size_t>(_max_replicas, 1)),
+                       autoscaling(false),
+                       interval(DEFAULT_ELASTIC_INTERVAL_USEC),
+                       low_util(DEFAULT_ELASTIC_LOW_UTILIZATION),
+                       high_util(DEFAULT_ELASTIC_HIGH_UTILIZATION),
+                       max_backlog(DEFAULT_ELASTIC_BACKLOG),
+                       last_eval(current_time_usecs()),
+                       n_scale_out(0),
+                       n_scale_in(0),
+                       n_closed(0) {}
+
+    /** 
+     *  \brief Enable the autoscaler
+     *  
+     *  \param _interval interval between two evaluations of the autoscaler (in microseconds)
+     *  \param _low_util utilization of the active replicas below which a replica is removed
+     *  \param _high_util utilization of the active replicas above which a replica is added
+     *  \param _max_backlog inputs per active replica not processed yet above which a replica is added (zero means no limit)
+     */ 
+    void enableAutoscaling(uint64_t _interval,
+                           double _low_util=DEFAULT_ELASTIC_LOW_UTILIZATION,
+                           double _high_util=DEFAULT_ELASTIC_HIGH_UTILIZATION,
+                           uint64_t _max_backlog=DEFAULT_ELASTIC_BACKLOG)
+    {
+        if (_low_util >= _high_util) {
+            std::cerr << RED << "WindFlow Error: low utilization of the autoscaler must be smaller than the high one" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        autoscaling = true;
+        interval = _interval;
+        low_util = _low_util;
+        high_util = _high_util;
+        max_backlog = _max_backlog;
+    }
+
+    /** 
+     *  \brief Check whether the autoscaler is enabled
+     *  
+     *  \return true if the autoscaler is enabled
+     */ 
+    bool isAutoscaling() const
+    {
+        return autoscaling;
+    }
+
+    /** 
+     *  \brief Set the number of active replicas (it can be called at any time by any thread)
+     *  
+     *  \param _n number of active replicas (bounded by the minimum and the maximum number of replicas)
+     */ 
+    void setParallelism(size_t _n)
+    {
+        active.store(std::min(std::max(_n, min_replicas), stats.size()), std::memory_order_release);
+        wakeUp();
+    }
+
+    /** 
+     *  \brief Get the number of active replicas
+     *  
+     *  \return number of active replicas
+     */ 
+    size_t getParallelism() const
+    {
+        return active.load(std::memory_order_acquire);
+    }
+
+    /** 
+     *  \brief Get the minimum number of active replicas
+     *  
+     *  \return minimum number of active replicas
+     */ 
+    size_t getMinParallelism() const
+    {
+        return min_replicas;
+    }
+
+    /** 
+     *  \brief Get the maximum number of active replicas
+     *  
+     *  \return maximum number of active replicas
+     */ 
+    size_t getMaxParallelism() const
+    {
+        return stats.size();
+    }
+
+    /** 
+     *  \brief Get the number of replicas added by the autoscaler so far
+     *  
+     *  \return number of scale-out decisions
+     */ 
+    uint64_t getNumScaleOut() const
+    {
+        return n_scale_out.load(std::memory_order_relaxed);
+    }
+
+    /** 
+     *  \brief Get the number of replicas removed by the autoscaler so far
+     *  
+     *  \return number of scale-in decisions
+     */ 
+    uint64_t getNumScaleIn() const
+    {
+        return n_scale_in.load(std::memory_order_relaxed);
+    }
+
+    /** 
+     *  \brief Get the number of inputs sent to a replica and not processed yet
+     *  
+     *  \param _replica identifier of the replica
+     *  \return estimated backlog of the replica
+     */ 
+    uint64_t getBacklog(size_t _replica) const
+    {
+        uint64_t sent = stats[_replica].sent.load(std::memory_order_relaxed);
+        uint64_t processed = stats[_replica].processed.load(std::memory_order_relaxed);
+        return (sent > processed) ? sent - processed : 0;
+    }
+
+    // add inputs sent to a replica
+    void addSent(size_t _replica, uint64_t _n)
+    {
+        stats[_replica].sent.fetch_add(_n, std::memory_order_relaxed);
+    }
+
+    // add inputs processed by a replica and their busy time (in nanoseconds)
+    void addProcessed(size_t _replica, uint64_t _n, uint64_t _nsecs)
+    {
+        stats[_replica].processed.fetch_add(_n, std::memory_order_relaxed);
+        stats[_replica].busy.fetch_add(_nsecs, std::memory_order_relaxed);
+    }
+
+    // sleep until the replica is active again or all its emitters are terminated
+    void park(size_t _replica, size_t _n_emitters)
+    {
+        std::unique_lock<std::mutex> lock(park_mutex);
+        park_cond.wait(lock, [this, _replica, _n_emitters] { return _replica < getParallelism() || n_closed >= _n_emitters; });
+    }
+
+    // notify the termination of an emitter (the sleeping replicas wake up to receive the EOS)
+    void closeEmitter()
+    {
+        {
+            std::lock_guard<std::mutex> lock(park_mutex);
+            n_closed++;
+        }
+        park_cond.notify_all();
+    }
+
+    // evaluate the autoscaler if its interval has elapsed (called by the emitters)
+    void evaluate()
+    {
+        if (!autoscaling) {
+            return;
+        }
+        uint64_t now = current_time_usecs();
+        if (now - last_eval.load(std::memory_order_relaxed) < interval) {
+            return;
+        }
+        // one emitter at a time evaluates the autoscaler, the other ones go on
+        std::unique_lock<std::mutex> lock(mutex, std::try_to_lock);
+        if (!lock.owns_lock()) {
+            return;
+        }
+        uint64_t elapsed = now - last_eval.load(std::memory_order_relaxed);
+        if (elapsed < interval) {
+            return;
+        }
+        last_eval.store(now, std::memory_order_relaxed);
+        size_t n = active.load(std::memory_order_acquire);
+        // utilization and backlog of the active replicas since the last evaluation
+        uint64_t busy = 0;
+        uint64_t backlog = 0;
+        for (size_t i=0; i<stats.size(); i++) {
+            uint64_t b = stats[i].busy.load(std::memory_order_relaxed);
+            if (i < n) {
+                busy += b - stats[i].last_busy;
+                backlog += getBacklog(i);
+            }
+            stats[i].last_busy = b;
+        }
+        double util = ((double) busy) / (((double) elapsed) * 1000 * n);
+        bool congested = (max_backlog > 0) && (backlog > max_backlog * n);
+        if ((util > high_util || congested) && n < stats.size()) {
+            active.store(n + 1, std::memory_order_release);
+            n_scale_out.fetch_add(1, std::memory_order_relaxed);
+            wakeUp();
+        }
+        // a replica is removed only if the remaining ones are not overloaded by its inputs
+        else if (util < low_util && !congested && n > min_replicas && (util * n) / (n - 1) < high_util) {
+            active.store(n - 1, std::memory_order_release);
+            n_scale_in.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+};
+
+// class Elastic_Router (used by each emitter of a stateless elastic operator)
+class Elastic_Router
+{
+private:
+    std::shared_ptr<Elastic_Controller> controller; // controller of the operator (nullptr if the operator is not elastic)
+    std::vector<uint64_t> sent; // number of inputs sent to each replica and not reported yet
+    uint64_t n_inputs; // number of inputs routed so far
+    size_t dest; // last destination
+    size_t n_active; // number of active replicas seen by the last sync
+    void *last_punct; // last punctuation received (sent to the replicas activated again)
+    bool closed; // true if the termination of the emitter has been notified
+
+public:
+    // Constructor
+    Elastic_Router(std::shared_ptr<Elastic_Controller> _controller=nullptr):
+                   controller(_controller),
+                   n_inputs(0),
+                   dest(0),
+                   n_active(0),
+                   last_punct(createWatermark(0)),
+                   closed(false)
+    {
+        if (controller != nullptr) {
+            sent.resize(controller->getMaxParallelism(), 0);
+            n_active = controller->getMaxParallelism(); // the replicas parked at the start receive the idle mark at the first sync
+        }
+    }
+
+    // check whether the operator is elastic
+    bool isEnabled() const
+    {
+        return controller != nullptr;
+    }
+
+    // apply the change of the number of active replicas (called before each input): the replicas parked
+    // since the last sync receive the idle mark, the ones activated again receive the last punctuation
+    template<typename send_func_t>
+    void sync(send_func_t _send)
+    {
+        size_t n = controller->getParallelism();
+        for (size_t i=n; i<n_active; i++) {
+            _send(createIdleMark(), i);
+        }
+        for (size_t i=n_active; i<n; i++) {
+            _send(last_punct, i);
+        }
+        n_active = n;
+    }
+
+    // get the number of active replicas, the only ones receiving the punctuations (valid after sync)
+    size_t getActive() const
+    {
+        return n_active;
+    }
+
+    // record the last punctuation received
+    void setPunctuation(void *_punct)
+    {
+        last_punct = _punct;
+    }
+
+    // get the destination of the next input (round-robin among the active replicas, valid after sync)
+    size_t route()
+    {
+        size_t n = n_active;
+        dest = (dest + 1 < n) ? dest + 1 : 0;
+        sent[dest]++;
+        if ((++n_inputs & (DEFAULT_ELASTIC_REPORT - 1)) == 0) {
+            flush();
+            controller->evaluate();
+        }
+        return dest;
+    }
+
+    // report the inputs sent and not reported yet
+    void flush()
+    {
+        for (size_t i=0; i<sent.size(); i++) {
+            if (sent[i] > 0) {
+                controller->addSent(i, sent[i]);
+                sent[i] = 0;
+            }
+        }
+    }
+
+    // report the inputs sent and not reported yet and notify the termination of the emitter (once)
+    void close()
+    {
+        flush();
+        if (!closed) {
+            closed = true;
+            controller->closeEmitter();
+        }
+    }
+};
+
+// class Elastic_Replica (used by each replica of a stateless elastic operator to sample its busy time)
+class Elastic_Replica
+{
+private:
+    std::shared_ptr<Elastic_Controller> controller; // controller of the operator (nullptr if the operator is not elastic)
+    size_t id; // identifier of the replica
+    uint64_t n_inputs; // number of inputs received (used to sample the busy time)
+
+public:
+    // Constructor
+    Elastic_Replica(std::shared_ptr<Elastic_Controller> _controller=nullptr,
+                    size_t _id=0):
+                    controller(_controller),
+                    id(_id),
+                    n_inputs(0) {}
+
+    // check whether the operator is elastic
+    bool isEnabled() const
+    {
+        return controller != nullptr;
+    }
+
+    // check whether the replica is parked
+    bool isParked() const
+    {
+        return controller != nullptr && id >= controller->getParallelism();
+    }
+
+    // sleep until the replica is active again or its _n_emitters emitters are terminated
+    void park(size_t _n_emitters)
+    {
+        controller->park(id, _n_emitters);
+    }
+
+    // start the measurement of the busy time (one input every DEFAULT_ELASTIC_SAMPLING), returns zero if the input is not sampled
+    uint64_t startSample()
+    {
+        if (controller == nullptr || (n_inputs++ & (DEFAULT_ELASTIC_SAMPLING - 1)) != 0) {
+            return 0;
+        }
+        return current_time_nsecs();
+    }
+
+    // end the measurement of the busy time of a sampled input
+    void endSample(uint64_t _start)
+    {
+        if (_start > 0) {
+            controller->addProcessed(id, DEFAULT_ELASTIC_SAMPLING, (current_time_nsecs() - _start) * DEFAULT_ELASTIC_SAMPLING);
+        }
+    }
+};
+
+// struct Elastic_Sample (measurement of the busy time of an input ended when it goes out of scope)
+struct Elastic_Sample
+{
+    Elastic_Replica &replica; // replica processing the input
+    uint64_t start; // start time of the measurement (zero if the input is not sampled)
+
+    // Constructor
+    Elastic_Sample(Elastic_Replica &_replica):
+                   replica(_replica),
+                   start(_replica.startSample()) {}
+
+    // Destructor
+    ~Elastic_Sample()
+    {
+        replica.endSample(start);
+    }
+};
+
+} // namespace wf
+
+#endif
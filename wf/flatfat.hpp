@@ -394,6 +394,16 @@ public:
     {
         return isEmpty;
     }
+
+    // method to bind the FlatFAT to the combine functions and the RuntimeContext of another replica (used after its migration)
+    void rebind(winComb_func_t *_winComb_func,
+                rich_winComb_func_t *_rich_winComb_func,
+                RuntimeContext *_context)
+    {
+        winComb_func = _winComb_func;
+        rich_winComb_func = _rich_winComb_func;
+        context = _context;
+    }
 };
 
 } // namespace wf
@@ -41,13 +41,17 @@
 #include<ff/multinode.hpp>
 #include<ff/farm.hpp>
 #include<basic.hpp>
+#include<meta.hpp>
 #include<shipper.hpp>
 #include<context.hpp>
+#include<watermark.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
 #endif
 #include<basic_operator.hpp>
 #include<standard_emitter.hpp>
+#include<elastic.hpp>
+#include<ondemand.hpp>
 
 namespace wf {
 
@@ -79,6 +83,12 @@ private:
     size_t parallelism; // internal parallelism of the FlatMap
     bool keyed; // flag stating whether the FlatMap is configured with keyBy or not
     bool used; // true if the FlatMap has been added/chained in a MultiPipe
+    routing_func_t routing_func; // routing function of the key-based distribution (empty if not configured with keyBy)
+    bool keyPreserving; // true if the outputs of the FlatMap keep the keys of the corresponding inputs
+    bool orderPreserving; // true if the outputs of each replica of the FlatMap keep the timestamp order of its inputs
+    std::shared_ptr<Elastic_Controller> elastic; // controller of the active replicas (nullptr if the FlatMap is not elastic)
+    std::shared_ptr<Credit_Table> ondemand; // credits of the replicas (nullptr if the FlatMap does not use the on-demand scheduling)
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
     // class FlatMap_Node
     class FlatMap_Node: public ff::ff_minode_t<tuple_t, result_t>
     {
@@ -92,7 +102,11 @@ private:
         Shipper<result_t> *shipper = nullptr;
         RuntimeContext context; // RuntimeContext
         size_t eos_received; // number of received EOS messages
+        Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
         bool terminated; // true if the replica has finished its work
+        Elastic_Replica elastic; // sampler of the busy time of the replica (disabled if the FlatMap is not elastic)
+        OnDemand_Replica ondemand; // credits of the replica (disabled if the FlatMap does not use the on-demand scheduling)
+        Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the FlatMap is not placed by the PipeGraph)
 #if defined (TRACE_WINDFLOW)
         Stats_Record stats_record;
         double avg_td_us = 0;
@@ -131,10 +145,15 @@ public:
         // svc_init method (utilized by the FastFlow runtime)
         int svc_init() override
         {
+            // bind the replica to its CPU before it allocates its state
+            placement.bind();
             // create the shipper object used by this replica
             shipper = new Shipper<result_t>(*this);
+            context.setShipper(shipper);
 #if defined (TRACE_WINDFLOW)
             stats_record = Stats_Record(name, std::to_string(this->get_my_id()), false, false);
+            stats_record.cpu = placement.getCPU();
+            stats_record.numa_node = placement.getNode();
 #endif
             return 0;
         }
@@ -142,6 +161,23 @@ public:
         // svc method (utilized by the FastFlow runtime)
         result_t *svc(tuple_t *t) override
         {
+            // execute the callbacks of the expired timers of the replica
+            context.pollTimers();
+            // watermarks are merged among the input channels and forwarded
+            if (isWatermark(t)) {
+                if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(t))) {
+                    this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+                }
+                // a parked replica sleeps once all its input channels are idle (if the FlatMap is elastic)
+                if (wm_merger.isIdle() && elastic.isParked()) {
+                    elastic.park(this->get_num_inchannels());
+                }
+                return this->GO_ON;
+            }
+            // busy time of the replica (one input every DEFAULT_ELASTIC_SAMPLING if the FlatMap is elastic)
+            Elastic_Sample sample(elastic);
+            // the credit of the input is released once it has been processed (if the FlatMap uses the on-demand scheduling)
+            OnDemand_Credit credit(ondemand);
 #if defined (TRACE_WINDFLOW)
             startTS = current_time_nsecs();
             if (stats_record.inputs_received == 0) {
@@ -150,14 +186,15 @@ public:
             stats_record.inputs_received++;
             stats_record.bytes_received += sizeof(tuple_t);
 #endif
-            // call the flatmap function
+            // call the flatmap function (a shared envelope of a split is read without copying the tuple)
+            tuple_t *in = extractTuple<tuple_t, tuple_t>(t);
             if (!isRich) {
-                flatmap_func(*t, *shipper);
+                flatmap_func(*in, *shipper);
             }
             else {
-                rich_flatmap_func(*t, *shipper, context);
+                rich_flatmap_func(*in, *shipper, context);
             }
-            delete t;
+            deleteTuple<tuple_t, tuple_t>(t);
 #if defined (TRACE_WINDFLOW)
             uint64_t delivered = (shipper->delivered() - last_delivered_count);
             last_delivered_count = shipper->delivered();
@@ -180,10 +217,16 @@ public:
         void eosnotify(ssize_t id) override
         {
             eos_received++;
+            // the watermark can advance when an input channel is terminated
+            if (wm_merger.close(id, this->get_num_inchannels())) {
+                this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+            }
             // check the number of received EOS messages
             if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
                 return;
             }
+            // last check of the timers of the replica
+            context.pollTimers();
             terminated = true;
 #if defined (TRACE_WINDFLOW)
             stats_record.set_Terminated();
@@ -199,6 +242,24 @@ public:
             delete shipper;
         }
 
+        // method to make the replica part of an elastic operator
+        void enableElasticity(std::shared_ptr<Elastic_Controller> _elastic, size_t _id)
+        {
+            elastic = Elastic_Replica(_elastic, _id);
+        }
+
+        // method to make the replica part of an operator with on-demand scheduling
+        void enableOnDemand(std::shared_ptr<Credit_Table> _ondemand, size_t _id)
+        {
+            ondemand = OnDemand_Replica(_ondemand, _id);
+        }
+
+        // method to set the CPU and NUMA node of the replica
+        void setPlacement(Placement_Replica _placement)
+        {
+            placement = _placement;
+        }
+
         // method the check the termination of the replica
         bool isTerminated() const
         {
@@ -222,30 +283,57 @@ public:
      *  \param _parallelism internal parallelism of the FlatMap operator
      *  \param _name name of the FlatMap operator
      *  \param _closing_func closing function
+     *  \param _keyPreserving true if the outputs keep the keys of the corresponding inputs
+     *  \param _orderPreserving true if the outputs of each replica keep the timestamp order of its inputs
+     *  \param _elastic controller of the active replicas (nullptr if the FlatMap is not elastic)
+     *  \param _credits number of credits per replica of the on-demand scheduling (zero to use the pseudo round-robin distribution)
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     template<typename F_t>
     FlatMap(F_t _func,
             size_t _parallelism,
             std::string _name,
-            closing_func_t _closing_func):
+            closing_func_t _closing_func,
+            bool _keyPreserving=false,
+            bool _orderPreserving=false,
+            std::shared_ptr<Elastic_Controller> _elastic=nullptr,
+            size_t _credits=0,
+            std::vector<int> _cpus={}):
             name(_name),
             parallelism(_parallelism),
             keyed(false),
-            used(false)
+            used(false),
+            keyPreserving(_keyPreserving),
+            orderPreserving(_orderPreserving),
+            elastic(_elastic),
+            ondemand((_credits > 0) ? std::make_shared<Credit_Table>(_parallelism, _credits) : nullptr),
+            cpus(_cpus)
     {
         // check the validity of the parallelism value
         if (_parallelism == 0) {
             std::cerr << RED << "WindFlow Error: FlatMap has parallelism zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // check the controller of the active replicas
+        if (_elastic != nullptr && _elastic->getMaxParallelism() != _parallelism) {
+            std::cerr << RED << "WindFlow Error: controller of the active replicas of the FlatMap has a wrong number of replicas" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // the replicas of an elastic operator receive the inputs in round-robin
+        if (_elastic != nullptr && _credits > 0) {
+            std::cerr << RED << "WindFlow Error: elastic FlatMap cannot use the on-demand scheduling" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // vector of FlatMap_Node
         std::vector<ff_node *> w;
         for (size_t i=0; i<_parallelism; i++) {
             auto *seq = new FlatMap_Node(_func, _name, RuntimeContext(_parallelism, i), _closing_func);
+            seq->enableElasticity(_elastic, i);
+            seq->enableOnDemand(ondemand, i);
             w.push_back(seq);
         }
         // add emitter
-        ff::ff_farm::add_emitter(new Standard_Emitter<tuple_t>(_parallelism));
+        ff::ff_farm::add_emitter(new Standard_Emitter<tuple_t>(_parallelism, _elastic, ondemand));
         // add workers
         ff::ff_farm::add_workers(w);
         // add default collector
@@ -262,23 +350,49 @@ public:
      *  \param _name name of the FlatMap operator
      *  \param _closing_func closing function
      *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to parallelism-1
+     *  \param _keyPreserving true if the outputs keep the keys of the corresponding inputs
+     *  \param _orderPreserving true if the outputs of each replica keep the timestamp order of its inputs
+     *  \param _elastic controller of the active replicas (nullptr if the FlatMap is not elastic)
+     *  \param _credits number of credits per replica of the on-demand scheduling (must be zero, it is not supported with keyBy)
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
      template<typename F_t>
     FlatMap(F_t _func,
             size_t _parallelism,
             std::string _name,
             closing_func_t _closing_func,
-            routing_func_t _routing_func):
+            routing_func_t _routing_func,
+            bool _keyPreserving=false,
+            bool _orderPreserving=false,
+            std::shared_ptr<Elastic_Controller> _elastic=nullptr,
+            size_t _credits=0,
+            std::vector<int> _cpus={}):
             name(_name),
             parallelism(_parallelism),
             keyed(true),
-            used(false)
+            used(false),
+            routing_func(_routing_func),
+            keyPreserving(_keyPreserving),
+            orderPreserving(_orderPreserving),
+            elastic(_elastic),
+            ondemand(nullptr),
+            cpus(_cpus)
     {
         // check the validity of the parallelism value
         if (_parallelism == 0) {
             std::cerr << RED << "WindFlow Error: FlatMap has parallelism zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the replicas of an elastic operator receive the inputs in round-robin
+        if (_elastic != nullptr) {
+            std::cerr << RED << "WindFlow Error: FlatMap with keyBy cannot be elastic" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // the replicas receive the inputs of their keys only
+        if (_credits > 0) {
+            std::cerr << RED << "WindFlow Error: FlatMap with keyBy cannot use the on-demand scheduling" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // vector of FlatMap_Node
         std::vector<ff_node *> w;
         for (size_t i=0; i<_parallelism; i++) {
@@ -336,6 +450,72 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Return the routing function of the key-based distribution to the FlatMap
+     *  \return routing function (empty if the FlatMap is not configured with keyBy)
+     */ 
+    routing_func_t getRoutingFunction() const override
+    {
+        return routing_func;
+    }
+
+    /** 
+     *  \brief Check whether the outputs of the FlatMap keep the keys of the corresponding inputs
+     *  \return true if the keys are preserved
+     */ 
+    bool isKeyPreserving() const override
+    {
+        return keyPreserving;
+    }
+
+    /** 
+     *  \brief Check whether the outputs of each replica of the FlatMap keep the timestamp order of its inputs
+     *  \return true if the timestamp order is preserved
+     */ 
+    bool isOrderPreserving() const override
+    {
+        return orderPreserving;
+    }
+
+    /** 
+     *  \brief Check whether the FlatMap is elastic
+     *  \return true if the number of active replicas can be changed at runtime
+     */ 
+    bool isElastic() const
+    {
+        return elastic != nullptr;
+    }
+
+    /** 
+     *  \brief Get the controller of the active replicas of the FlatMap
+     *  \return controller of the active replicas (nullptr if the FlatMap is not elastic)
+     */ 
+    std::shared_ptr<Elastic_Controller> getElasticController() const
+    {
+        return elastic;
+    }
+
+    /** 
+     *  \brief Check whether the FlatMap uses the on-demand scheduling
+     *  \return true if the inputs are sent to the replicas with the shortest queues
+     */ 
+    bool isOnDemand() const
+    {
+        return ondemand != nullptr;
+    }
+
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        auto placements = _manager.assign(name, this->getWorkers().size(), cpus);
+        for (size_t i=0; i<placements.size(); i++) {
+            static_cast<FlatMap_Node *>(this->getWorkers()[i])->setPlacement(placements[i]);
+        }
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
@@ -404,13 +584,17 @@ public:
         writer.Uint(parallelism);
         writer.Key("Replicas");
         writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
         // get statistics from all the replicas of the operator
         for(auto *w: this->getWorkers()) {
             auto *node = static_cast<FlatMap_Node *>(w);
             Stats_Record record = node->get_StatsRecord();
             record.append_Stats(writer);
+            inputs.push_back(record.inputs_received);
         }
         writer.EndArray();
+        writer.Key("Replica_imbalance");
+        writer.Double(compute_imbalance(inputs));
         writer.EndObject();
     }
 #endif
@@ -39,6 +39,7 @@
 #define KEY_FARM_H
 
 /// includes
+#include<memory>
 #include<ff/pipeline.hpp>
 #include<ff/all2all.hpp>
 #include<ff/farm.hpp>
@@ -52,6 +53,7 @@
 #include<basic_emitter.hpp>
 #include<basic_operator.hpp>
 #include<transformations.hpp>
+#include<standard_emitter.hpp>
 
 namespace wf {
 
@@ -84,6 +86,8 @@ public:
     using win_mapreduce_t = Win_MapReduce<tuple_t, result_t>;
     /// type of the functionto map the key hashcode onto an identifier starting from zero to parallelism/num_replicas-1
     using routing_func_t = std::function<size_t(size_t, size_t)>;
+    /// type of the combine function of the partial results of a hot key
+    using winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
 
 private:
     // type of the wrapper of input tuples
@@ -94,6 +98,11 @@ private:
     using kf_collector_t = KF_Collector<result_t>;
     // type of the Win_Seq to be created within the regular Constructor
     using win_seq_t = Win_Seq<tuple_t, result_t>;
+    // type of the KF_Merger node
+    using kf_merger_t = KF_Merger<result_t>;
+    tuple_t tmp; // never used
+    // key data type
+    using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
     // friendships with other classes in the library
     template<typename T>
     friend auto get_KF_nested_type(T);
@@ -113,6 +122,9 @@ private:
     uint64_t triggering_delay; // triggering delay in time units (meaningful for TB windows only)
     win_type_t winType; // type of windows (count-based or time-based)
     std::vector<ff_node *> kf_workers; // vector of pointers to the Key_Farm workers (Win_Seq or Pane_Farm or Win_MapReduce instances)
+    std::unique_ptr<ff::ff_farm> merge_stage; // stage merging the partial results of the hot keys in a MultiPipe (nullptr if the hot-key splitting is disabled)
+    std::shared_ptr<KeyGroup_Manager> kg_manager; // manager of the key groups migrated among the replicas (nullptr if they are not used)
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
 
     // Private Constructor
     template<typename F_t>
@@ -127,7 +139,12 @@ private:
              routing_func_t _routing_func,
              opt_level_t _opt_level,
              WinOperatorConfig _config,
-             role_t _role):
+             role_t _role,
+             uint64_t _early_interval,
+             size_t _split_degree,
+             winComb_func_t _winComb_func,
+             std::shared_ptr<KeyGroup_Manager> _kg_manager,
+             std::vector<int> _cpus):
              name(_name),
              parallelism(_parallelism),
              used(false),
@@ -141,7 +158,9 @@ private:
              win_len(_win_len),
              slide_len(_slide_len),
              triggering_delay(_triggering_delay),
-             winType(_winType)
+             winType(_winType),
+             kg_manager(_kg_manager),
+             cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
@@ -163,14 +182,62 @@ private:
         // create the Win_Seq
         for (size_t i = 0; i < _parallelism; i++) {
             WinOperatorConfig configSeq(0, 1, _slide_len, 0, 1, _slide_len);
-            auto *seq = new win_seq_t(_func, _win_len, _slide_len, _triggering_delay, _winType, _name, _closing_func, RuntimeContext(_parallelism, i), configSeq, role_t::SEQ);
+            auto *seq = new win_seq_t(_func, _win_len, _slide_len, _triggering_delay, _winType, _name, _closing_func, RuntimeContext(_parallelism, i), configSeq, role_t::SEQ, _early_interval);
             w[i] = seq;
             kf_workers.push_back(seq);
         }
         ff::ff_farm::add_workers(w);
-        ff::ff_farm::add_collector(nullptr);
-        // create the Emitter node
-        ff::ff_farm::add_emitter(new kf_emitter_t(_routing_func, _parallelism));
+        // the key groups are assigned to the replicas by the manager
+        if (kg_manager != nullptr) {
+            // the per-key counters renumbering the inputs of CB windows are not migrated with the key groups
+            if (_winType != win_type_t::TB) {
+                std::cerr << RED << "WindFlow Error: migration of key groups in Key_Farm is supported with time-based windows only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (_split_degree > 1) {
+                std::cerr << RED << "WindFlow Error: migration of key groups in Key_Farm cannot be used with hot-key splitting" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (kg_manager->getNumReplicas() != _parallelism) {
+                std::cerr << RED << "WindFlow Error: manager of the key groups in Key_Farm has a wrong number of replicas" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            for (size_t i = 0; i < _parallelism; i++) {
+                static_cast<win_seq_t *>(w[i])->enableKeyGroups(kg_manager, i);
+            }
+        }
+        // hot-key splitting: the partial results of the hot keys are combined by the KF_Merger nodes
+        if (_split_degree > 1) {
+            if (_winType != win_type_t::TB) {
+                std::cerr << RED << "WindFlow Error: hot-key splitting in Key_Farm is supported with time-based windows only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (_early_interval > 0) {
+                std::cerr << RED << "WindFlow Error: hot-key splitting in Key_Farm cannot be used with early firing" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (_winComb_func == nullptr) {
+                std::cerr << RED << "WindFlow Error: hot-key splitting in Key_Farm requires a combine function" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            auto registry = std::make_shared<HotKey_Registry<key_t>>();
+            ff::ff_farm::add_collector(new kf_merger_t(_winComb_func, registry, _win_len, _slide_len));
+            ff::ff_farm::add_emitter(new kf_emitter_t(_routing_func, _parallelism, registry, _split_degree));
+            // stage used in place of the collector when the Key_Farm is added to a MultiPipe
+            std::vector<ff_node *> m(_parallelism);
+            for (size_t i = 0; i < _parallelism; i++) {
+                m[i] = new kf_merger_t(_winComb_func, registry, _win_len, _slide_len);
+            }
+            merge_stage = std::make_unique<ff::ff_farm>();
+            merge_stage->add_workers(m);
+            merge_stage->add_emitter(new Standard_Emitter<result_t>(_routing_func, _parallelism));
+            merge_stage->cleanup_all();
+        }
+        else {
+            ff::ff_farm::add_collector(nullptr);
+            // create the Emitter node
+            ff::ff_farm::add_emitter(new kf_emitter_t(_routing_func, _parallelism, nullptr, 1, kg_manager));
+        }
         // when the Key_Farm will be destroyed we need aslo to destroy the emitter, workers and collector
         ff::ff_farm::cleanup_all();
     }
@@ -236,6 +303,11 @@ public:
      *  \param _closing_func closing function
      *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to parallelism-1
      *  \param _opt_level optimization level used to build the operator
+     *  \param _early_interval interval (in microseconds) between two early results of the open windows (zero means no early firing)
+     *  \param _split_degree number of replicas over which the tuples of each hot key are spread (zero or one means no hot-key splitting)
+     *  \param _winComb_func combine function of two partial results of the same window of a hot key (used with hot-key splitting only)
+     *  \param _kg_manager manager of the key groups migrated among the replicas (nullptr means no migration)
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     template<typename F_t>
     Key_Farm(F_t _win_func,
@@ -247,8 +319,13 @@ public:
              std::string _name,
              closing_func_t _closing_func,
              routing_func_t _routing_func,
-             opt_level_t _opt_level):
-             Key_Farm(_win_func, _win_len, _slide_len, _triggering_delay, _winType, _parallelism, _name, _closing_func, _routing_func, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), role_t::SEQ) {}
+             opt_level_t _opt_level,
+             uint64_t _early_interval=0,
+             size_t _split_degree=0,
+             winComb_func_t _winComb_func=nullptr,
+             std::shared_ptr<KeyGroup_Manager> _kg_manager=nullptr,
+             std::vector<int> _cpus={}):
+             Key_Farm(_win_func, _win_len, _slide_len, _triggering_delay, _winType, _parallelism, _name, _closing_func, _routing_func, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), role_t::SEQ, _early_interval, _split_degree, _winComb_func, _kg_manager, _cpus) {}
 
     /** 
      *  \brief Constructor II (Nesting with Pane_Farm)
@@ -263,6 +340,11 @@ public:
      *  \param _closing_func closing function
      *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to _num_replicas-1
      *  \param _opt_level optimization level used to build the operator
+     *  \param _early_interval must be zero (early firing is not supported with nested operators)
+     *  \param _split_degree must be zero or one (hot-key splitting is not supported with nested operators)
+     *  \param _winComb_func not used (hot-key splitting is not supported with nested operators)
+     *  \param _kg_manager must be nullptr (migration of key groups is not supported with nested operators)
+     *  \param _cpus CPUs of the replicas of the nested operators (empty to use the placement policy of the PipeGraph)
      */ 
     Key_Farm(pane_farm_t &_pf,
              uint64_t _win_len,
@@ -273,7 +355,12 @@ public:
              std::string _name,
              closing_func_t _closing_func,
              routing_func_t _routing_func,
-             opt_level_t _opt_level):
+             opt_level_t _opt_level,
+             uint64_t _early_interval=0,
+             size_t _split_degree=0,
+             winComb_func_t _winComb_func=nullptr,
+             std::shared_ptr<KeyGroup_Manager> _kg_manager=nullptr,
+             std::vector<int> _cpus={}):
              name(_name),
              parallelism(_num_replicas * (_pf.plq_parallelism + _pf.wlq_parallelism)),
              used(false),
@@ -287,7 +374,8 @@ public:
              win_len(_win_len),
              slide_len(_slide_len),
              triggering_delay(_triggering_delay),
-             winType(_winType)
+             winType(_winType),
+             cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
@@ -299,6 +387,26 @@ public:
             std::cerr << RED << "WindFlow Error: number of replicas of the Pane_Farm within the Key_Farm is zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // check the use of early firing
+        if (_early_interval > 0) {
+            std::cerr << RED << "WindFlow Error: early firing in Key_Farm is not supported with a nested Pane_Farm" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the use of hot-key splitting
+        if (_split_degree > 1) {
+            std::cerr << RED << "WindFlow Error: hot-key splitting in Key_Farm is not supported with a nested Pane_Farm" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the use of the migration of key groups
+        if (_kg_manager != nullptr) {
+            std::cerr << RED << "WindFlow Error: migration of key groups in Key_Farm is not supported with a nested Pane_Farm" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // the replicas of the nested operators are placed by the Key_Farm
+        if (!_pf.cpus.empty()) {
+            std::cerr << RED << "WindFlow Error: CPUs of a Pane_Farm nested in a Key_Farm must be given to the Key_Farm" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // check that the Pane_Farm has not already been used in a nested structure
         if (_pf.isUsed4Nesting()) {
             std::cerr << RED << "WindFlow Error: Pane_Farm has already been used in a nested structure" << DEFAULT_COLOR << std::endl;
@@ -378,6 +486,11 @@ public:
      *  \param _closing_func closing function
      *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to _num_replicas-1
      *  \param _opt_level optimization level used to build the operator
+     *  \param _early_interval must be zero (early firing is not supported with nested operators)
+     *  \param _split_degree must be zero or one (hot-key splitting is not supported with nested operators)
+     *  \param _winComb_func not used (hot-key splitting is not supported with nested operators)
+     *  \param _kg_manager must be nullptr (migration of key groups is not supported with nested operators)
+     *  \param _cpus CPUs of the replicas of the nested operators (empty to use the placement policy of the PipeGraph)
      */ 
     Key_Farm(win_mapreduce_t &_wmr,
              uint64_t _win_len,
@@ -388,7 +501,12 @@ public:
              std::string _name,
              closing_func_t _closing_func,
              routing_func_t _routing_func,
-             opt_level_t _opt_level):
+             opt_level_t _opt_level,
+             uint64_t _early_interval=0,
+             size_t _split_degree=0,
+             winComb_func_t _winComb_func=nullptr,
+             std::shared_ptr<KeyGroup_Manager> _kg_manager=nullptr,
+             std::vector<int> _cpus={}):
              name(_name),
              parallelism(_num_replicas * (_wmr.map_parallelism + _wmr.reduce_parallelism)),
              used(false),
@@ -402,7 +520,8 @@ public:
              win_len(_win_len),
              slide_len(_slide_len),
              triggering_delay(_triggering_delay),
-             winType(_winType)
+             winType(_winType),
+             cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
@@ -414,6 +533,26 @@ public:
             std::cerr << RED << "WindFlow Error: number of replicas of the Win_MapReduce within the Key_Farm is zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // check the use of early firing
+        if (_early_interval > 0) {
+            std::cerr << RED << "WindFlow Error: early firing in Key_Farm is not supported with a nested Win_MapReduce" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the use of hot-key splitting
+        if (_split_degree > 1) {
+            std::cerr << RED << "WindFlow Error: hot-key splitting in Key_Farm is not supported with a nested Win_MapReduce" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the use of the migration of key groups
+        if (_kg_manager != nullptr) {
+            std::cerr << RED << "WindFlow Error: migration of key groups in Key_Farm is not supported with a nested Win_MapReduce" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // the replicas of the nested operators are placed by the Key_Farm
+        if (!_wmr.cpus.empty()) {
+            std::cerr << RED << "WindFlow Error: CPUs of a Win_MapReduce nested in a Key_Farm must be given to the Key_Farm" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // check that the Win_MapReduce has not already been used in a nested structure
         if (_wmr.isUsed4Nesting()) {
             std::cerr << RED << "WindFlow Error: Win_MapReduce has already been used in a nested structure" << DEFAULT_COLOR << std::endl;
@@ -546,6 +685,51 @@ public:
         return winType;
     }
 
+    /** 
+     *  \brief Check whether the hot-key splitting is enabled in the Key_Farm
+     *  \return true if the tuples of the hot keys are spread over several replicas
+     */ 
+    bool isHotKeySplitting() const
+    {
+        return (merge_stage != nullptr);
+    }
+
+    /** 
+     *  \brief Check whether the key groups are migrated among the replicas of the Key_Farm
+     *  \return true if the key groups are used
+     */ 
+    bool hasKeyGroups() const
+    {
+        return kg_manager != nullptr;
+    }
+
+    /** 
+     *  \brief Get the manager of the key groups
+     *  \return pointer to the manager of the key groups (nullptr if they are not used)
+     */ 
+    std::shared_ptr<KeyGroup_Manager> getKeyGroupManager() const
+    {
+        return kg_manager;
+    }
+
+    /** 
+     *  \brief Check whether the Key_Farm is elastic
+     *  \return true if the number of active replicas can be changed at runtime (through the key groups)
+     */ 
+    bool isElastic() const
+    {
+        return kg_manager != nullptr && kg_manager->getElasticController() != nullptr;
+    }
+
+    /** 
+     *  \brief Get the controller of the active replicas of the Key_Farm
+     *  \return controller of the active replicas (nullptr if the Key_Farm is not elastic)
+     */ 
+    std::shared_ptr<Elastic_Controller> getElasticController() const
+    {
+        return (kg_manager != nullptr) ? kg_manager->getElasticController() : nullptr;
+    }
+
     /** 
      *  \brief Get the number of ignored tuples by the Key_Farm
      *  \return number of tuples ignored during the processing by the Key_Farm
@@ -613,6 +797,33 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *         (with nested operators, the replicas of their stages are placed one replica after the other)
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        if (this->getInnerType() == pattern_t::SEQ_CPU) {
+            auto placements = _manager.assign(name, kf_workers.size(), cpus);
+            for (size_t i=0; i<placements.size(); i++) {
+                static_cast<win_seq_t *>(kf_workers[i])->setPlacement(placements[i]);
+            }
+        }
+        else {
+            size_t inner_parallelism = inner_parallelism_1 + inner_parallelism_2;
+            auto placements = _manager.assign(name, kf_workers.size() * inner_parallelism, cpus);
+            for (size_t i=0; i<kf_workers.size(); i++) {
+                if (this->getInnerType() == pattern_t::PF_CPU) {
+                    static_cast<pane_farm_t *>(kf_workers[i])->set_Placements(placements, i * inner_parallelism);
+                }
+                else {
+                    static_cast<win_mapreduce_t *>(kf_workers[i])->set_Placements(placements, i * inner_parallelism);
+                }
+            }
+        }
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
@@ -718,11 +929,13 @@ public:
         }
         writer.Key("Replicas");
         writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
         if (this->getInnerType() == pattern_t::SEQ_CPU) {
             for (auto *w: kf_workers) {
                 auto *seq = static_cast<win_seq_t *>(w);
                 Stats_Record record = seq->get_StatsRecord();
                 record.append_Stats(writer);
+                inputs.push_back(record.inputs_received);
             }
         }
         else if (this->getInnerType() == pattern_t::PF_CPU) {
@@ -738,6 +951,10 @@ public:
             }
         }
         writer.EndArray();
+        if (!inputs.empty()) {
+            writer.Key("Replica_imbalance");
+            writer.Double(compute_imbalance(inputs));
+        }
         writer.EndObject();
     }
 #endif
@@ -715,11 +715,13 @@ public:
         }
         writer.Key("Replicas");
         writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
         if (this->getInnerType() == pattern_t::SEQ_GPU) {
             for (auto *w: kf_workers) {
                 auto *seq = static_cast<win_seq_gpu_t *>(w);
                 Stats_Record record = seq->get_StatsRecord();
                 record.append_Stats(writer);
+                inputs.push_back(record.inputs_received);
             }
         }
         else if (this->getInnerType() == pattern_t::PF_GPU) {
@@ -735,6 +737,10 @@ public:
             }
         }
         writer.EndArray();
+        if (!inputs.empty()) {
+            writer.Key("Replica_imbalance");
+            writer.Double(compute_imbalance(inputs));
+        }
         writer.EndObject();
     }
 #endif
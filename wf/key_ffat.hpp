@@ -47,6 +47,7 @@
 #include<win_seqffat.hpp>
 #include<kf_nodes.hpp>
 #include<basic_operator.hpp>
+#include<combining_emitter.hpp>
 
 namespace wf {
 
@@ -85,6 +86,8 @@ private:
     using kf_emitter_t = KF_Emitter<tuple_t>;
     // type of the KF_Collector node
     using kf_collector_t = KF_Collector<result_t>;
+    // type of the Combining_Emitter node
+    using combining_emitter_t = Combining_Emitter<tuple_t, result_t>;
     // friendships with other classes in the library
     friend class MultiPipe;
     std::string name; // name of the Key_FFAT
@@ -94,6 +97,9 @@ private:
     uint64_t slide_len; // slide length (no. of tuples or in time units)
     uint64_t triggering_delay; // triggering delay in time units (meaningful for TB windows only)
     win_type_t winType; // type of windows (count-based or time-based)
+    bool hasCombiner; // true if the tuples are pre-aggregated by the emitter
+    std::shared_ptr<KeyGroup_Manager> kg_manager; // manager of the key groups migrated among the replicas (nullptr if they are not used)
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
 
     // method to set the isRenumbering mode of the internal nodes
     void set_isRenumbering()
@@ -119,6 +125,11 @@ public:
      *  \param _name string with the unique name of the operator
      *  \param _closing_func closing function
      *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to parallelism-1
+     *  \param _early_interval interval (in microseconds) between two early results of the open windows (zero means no early firing)
+     *  \param _combiner_capacity maximum number of keys whose tuples are pre-aggregated by the emitter (zero means no combiner)
+     *  \param _combiner_interval interval (in microseconds) between two flushes of the pre-aggregated results (zero means no time-based flushing)
+     *  \param _kg_manager manager of the key groups migrated among the replicas (nullptr means no migration)
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     template<typename lift_F_t, typename comb_F_t>
     Key_FFAT(lift_F_t _winLift_func,
@@ -130,14 +141,22 @@ public:
              size_t _parallelism,
              std::string _name,
              closing_func_t _closing_func,
-             routing_func_t _routing_func):
+             routing_func_t _routing_func,
+             uint64_t _early_interval=0,
+             size_t _combiner_capacity=0,
+             uint64_t _combiner_interval=0,
+             std::shared_ptr<KeyGroup_Manager> _kg_manager=nullptr,
+             std::vector<int> _cpus={}):
              name(_name),
              parallelism(_parallelism),
              used(false),
              win_len(_win_len),
              slide_len(_slide_len),
              triggering_delay(_triggering_delay),
-             winType(_winType)     
+             winType(_winType),
+             hasCombiner(_combiner_capacity > 0),
+             kg_manager(_kg_manager),
+             cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
@@ -159,13 +178,51 @@ public:
         // create the Win_SeqFFAT
         for (size_t i = 0; i < _parallelism; i++) {
             WinOperatorConfig configSeq(0, 1, _slide_len, 0, 1, _slide_len);
-            auto *ffat = new win_seqffat_t(_winLift_func, _winComb_func, _win_len, _slide_len, _triggering_delay, _winType, _name, _closing_func, RuntimeContext(_parallelism, i), configSeq);
+            auto *ffat = new win_seqffat_t(_winLift_func, _winComb_func, _win_len, _slide_len, _triggering_delay, _winType, _name, _closing_func, RuntimeContext(_parallelism, i), configSeq, _early_interval);
             w[i] = ffat;
         }
         ff::ff_farm::add_workers(w);
         ff::ff_farm::add_collector(nullptr);
-        // create the Emitter node
-        ff::ff_farm::add_emitter(new kf_emitter_t(_routing_func, _parallelism));
+        // the key groups are assigned to the replicas by the manager
+        if (kg_manager != nullptr) {
+            // the per-key counters renumbering the inputs of CB windows are not migrated with the key groups
+            if (_winType != win_type_t::TB) {
+                std::cerr << RED << "WindFlow Error: migration of key groups in Key_FFAT is supported with time-based windows only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (hasCombiner) {
+                std::cerr << RED << "WindFlow Error: migration of key groups in Key_FFAT cannot be used with the combiner" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (kg_manager->getNumReplicas() != _parallelism) {
+                std::cerr << RED << "WindFlow Error: manager of the key groups in Key_FFAT has a wrong number of replicas" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            for (size_t i=0; i<_parallelism; i++) {
+                static_cast<win_seqffat_t *>(w[i])->enableKeyGroups(kg_manager, i);
+            }
+        }
+        // create the Emitter node (pre-aggregating the tuples of the same quantum if the combiner is used)
+        if (hasCombiner) {
+            if (_winType != win_type_t::TB) {
+                std::cerr << RED << "WindFlow Error: combiner in Key_FFAT is supported with time-based windows only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if constexpr (std::is_invocable<lift_F_t, const tuple_t &, result_t &>::value && std::is_invocable<comb_F_t, const result_t &, const result_t &, result_t &>::value) {
+                for (auto *node: w) {
+                    static_cast<win_seqffat_t *>(node)->isPreAggregated = true;
+                }
+                uint64_t quantum = static_cast<win_seqffat_t *>(w[0])->quantum;
+                ff::ff_farm::add_emitter(new combining_emitter_t(_winLift_func, _winComb_func, _routing_func, _parallelism, quantum, _combiner_capacity, _combiner_interval));
+            }
+            else {
+                std::cerr << RED << "WindFlow Error: combiner in Key_FFAT cannot be used with rich lift or combine functions" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        else {
+            ff::ff_farm::add_emitter(new kf_emitter_t(_routing_func, _parallelism, nullptr, 1, kg_manager));
+        }
         // when the Key_FFAT will be destroyed we need aslo to destroy the emitter, workers and collector
         ff::ff_farm::cleanup_all();
     }
@@ -179,6 +236,51 @@ public:
         return winType;
     }
 
+    /** 
+     *  \brief Check whether the tuples are pre-aggregated by a combiner before the key-based distribution
+     *  \return true if the combiner is used
+     */ 
+    bool isCombinerUsed() const
+    {
+        return hasCombiner;
+    }
+
+    /** 
+     *  \brief Check whether the key groups are migrated among the replicas
+     *  \return true if the key groups are used
+     */ 
+    bool hasKeyGroups() const
+    {
+        return kg_manager != nullptr;
+    }
+
+    /** 
+     *  \brief Get the manager of the key groups
+     *  \return pointer to the manager of the key groups (nullptr if they are not used)
+     */ 
+    std::shared_ptr<KeyGroup_Manager> getKeyGroupManager() const
+    {
+        return kg_manager;
+    }
+
+    /** 
+     *  \brief Check whether the Key_FFAT is elastic
+     *  \return true if the number of active replicas can be changed at runtime (through the key groups)
+     */ 
+    bool isElastic() const
+    {
+        return kg_manager != nullptr && kg_manager->getElasticController() != nullptr;
+    }
+
+    /** 
+     *  \brief Get the controller of the active replicas of the Key_FFAT
+     *  \return controller of the active replicas (nullptr if the Key_FFAT is not elastic)
+     */ 
+    std::shared_ptr<Elastic_Controller> getElasticController() const
+    {
+        return (kg_manager != nullptr) ? kg_manager->getElasticController() : nullptr;
+    }
+
     /** 
      *  \brief Get the number of ignored tuples by the Key_FFAT
      *  \return number of tuples ignored during the processing by the Key_FFAT
@@ -230,6 +332,18 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        auto placements = _manager.assign(name, this->getWorkers().size(), cpus);
+        for (size_t i=0; i<placements.size(); i++) {
+            static_cast<win_seqffat_t *>(this->getWorkers()[i])->setPlacement(placements[i]);
+        }
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
@@ -311,13 +425,17 @@ public:
         writer.Uint(parallelism);
         writer.Key("Replicas");
         writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
         // get statistics from all the replicas of the operator
         for(auto *w: this->getWorkers()) {
             auto *seq = static_cast<win_seqffat_t *>(w);
             Stats_Record record = seq->get_StatsRecord();
             record.append_Stats(writer);
+            inputs.push_back(record.inputs_received);
         }
         writer.EndArray();
+        writer.Key("Replica_imbalance");
+        writer.Double(compute_imbalance(inputs));
         writer.EndObject();
     }
 #endif
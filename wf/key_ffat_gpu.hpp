@@ -322,13 +322,17 @@ public:
         writer.Uint(parallelism);
         writer.Key("Replicas");
         writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
         // get statistics from all the replicas of the operator
         for(auto *w: this->getWorkers()) {
             auto *seq = static_cast<win_seqffat_gpu_t *>(w);
             Stats_Record record = seq->get_StatsRecord();
             record.append_Stats(writer);
+            inputs.push_back(record.inputs_received);
         }
         writer.EndArray();
+        writer.Key("Replica_imbalance");
+        writer.Double(compute_imbalance(inputs));
         writer.EndObject();
     }
 #endif
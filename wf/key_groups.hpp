@@ -0,0 +1,700 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    key_groups.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    10/11/2020
+ *  
+ *  @brief Key groups and their live migration between the replicas of keyed operators
+ *  
+ *  @section Key Groups (Description)
+ *  
+ *  This file implements the partitioning by key groups used by the Key_Farm, Key_FFAT
+ *  and Accumulator operators. The keys are mapped onto a fixed number of key groups
+ *  (with the routing function of the operator), and the key groups are assigned to the
+ *  replicas by a table shared by all the emitters of the operator (KeyGroup_Manager).
+ *  The table is changed at runtime by a rebalancing policy driven by the busy times of
+ *  the replicas: a key group of the most loaded replica is moved to the least loaded one.
+ *  
+ *  The migration of a key group works as a barrier. Each emitter applies the new table
+ *  by sending a release marker to the old replica of the group before any further tuple
+ *  of that group is sent to the new replica. The old replica moves the key descriptors
+ *  of the group (without copying them) to the new replica once it has received the
+ *  marker from all its input channels, i.e. after all the tuples of the group sent to
+ *  it. The new replica buffers the tuples of the group until it receives the state, and
+ *  it holds back its watermarks until all the groups migrating to it are installed.
+ *  Emitters apply the new table when they route a tuple and also when they forward a
+ *  watermark or an idle mark, so an emitter whose input is idle releases the groups
+ *  within the idle timeout of the Sources (idle Sources repeat their idle mark).
+ *  Markers are not allocated in the heap: like watermarks, they are encoded in the
+ *  pointers exchanged between the nodes (the lowest and the highest bits are set).
+ *  
+ *  Key_Farm and Key_FFAT migrate key groups with time-based windows only. With
+ *  count-based windows the inputs are renumbered per key by the ordering nodes in
+ *  front of the replicas, and those counters are not part of the migrated state.
+ *  
+ *  If the operator is elastic (see elastic.hpp), the key groups of the replicas parked
+ *  by the Elastic_Controller are migrated to the active ones, and an active replica
+ *  without key groups receives one from the most loaded replica, both without waiting
+ *  for the interval of the rebalancing policy.
+ */ 
+
+#ifndef KEY_GROUPS_H
+#define KEY_GROUPS_H
+
+/// includes
+#include<mutex>
+#include<atomic>
+#include<memory>
+#include<thread>
+#include<vector>
+#include<algorithm>
+#include<functional>
+#include<unordered_map>
+#include<basic.hpp>
+#include<elastic.hpp>
+
+namespace wf {
+
+// function createKeyGroupMarker: encode the release marker of a key group into a pointer
+inline void *createKeyGroupMarker(size_t _group)
+{
+    return reinterpret_cast<void *>((((uintptr_t) 1) << 63) | (static_cast<uintptr_t>(_group) << 1) | 1);
+}
+
+// function isKeyGroupMarker: check whether a pointer received by a node is the release marker of a key group
+inline bool isKeyGroupMarker(const void *_p)
+{
+    uintptr_t v = reinterpret_cast<uintptr_t>(_p);
+    return ((v & 1) != 0) && ((v >> 62) == 2);
+}
+
+// function getKeyGroup: decode the key group of a release marker
+inline size_t getKeyGroup(const void *_p)
+{
+    return static_cast<size_t>((reinterpret_cast<uintptr_t>(_p) & ~(((uintptr_t) 1) << 63)) >> 1);
+}
+
+/** 
+ *  \class KeyGroup_Manager
+ *  
+ *  \brief Assignment of the key groups to the replicas of a keyed operator
+ *  
+ *  This class implements the table mapping the key groups onto the replicas of an
+ *  operator, shared by its emitters and replicas. It keeps the migrations decided by
+ *  the rebalancing policy, the busy times reported by the replicas and the states of
+ *  the key groups being migrated.
+ */ 
+class KeyGroup_Manager
+{
+public:
+    /// type of the function to map the key hashcode onto a key group
+    using routing_func_t = std::function<size_t(size_t, size_t)>;
+
+    /// struct of the migration of a key group
+    struct Migration
+    {
+        size_t group; ///< key group
+        size_t from; ///< replica releasing the key group
+        size_t to; ///< replica receiving the key group
+    };
+
+private:
+    // struct of the state of a replica (each one in its own cache line)
+    struct alignas(64) Replica_State
+    {
+        std::atomic<uint64_t> busy; // estimated busy time of the replica (in nanoseconds)
+        std::atomic<size_t> incoming; // number of key groups migrating to the replica and not installed yet
+        std::atomic<size_t> ready; // number of states published for the replica and not taken yet
+        uint64_t last_busy; // busy time at the last decision of the policy (protected by mutex)
+        std::vector<std::pair<size_t, std::shared_ptr<void>>> mailbox; // states published for the replica (protected by mutex)
+
+        // Constructor
+        Replica_State(): busy(0), incoming(0), ready(0), last_busy(0) {}
+    };
+    routing_func_t routing_func; // function mapping the hashcode of a key onto its key group
+    size_t n_groups; // number of key groups
+    uint64_t interval; // interval between two decisions of the policy (in microseconds)
+    double imbalance; // relative difference of the busy times of the replicas triggering a migration
+    std::mutex mutex; // mutex protecting the assignment and the policy
+    std::vector<size_t> assignment; // assignment[g] is the replica of the key group g
+    std::vector<Migration> migrations; // migrations decided so far (the version of the assignment is their number)
+    std::atomic<uint64_t> version; // number of migrations decided so far
+    std::vector<Replica_State> replicas; // states of the replicas
+    std::vector<uint64_t> group_counts; // number of tuples of each key group since the last decision
+    uint64_t last_decision; // time of the last decision of the policy (in microseconds)
+    bool closed; // true if an emitter is terminated (no further migration is decided)
+    std::shared_ptr<Elastic_Controller> elastic; // controller of the active replicas (nullptr if the operator is not elastic)
+
+    // migrate a key group (called with the mutex acquired)
+    void migrate(size_t _group, size_t _to)
+    {
+        size_t from = assignment[_group];
+        assignment[_group] = _to;
+        migrations.push_back(Migration{_group, from, _to});
+        replicas[_to].incoming.fetch_add(1, std::memory_order_release);
+        version.store(migrations.size(), std::memory_order_release);
+    }
+
+    // migrate a key group to or from a replica changed by the elastic controller, returns true if a migration is decided (called with the mutex acquired)
+    bool rescale(size_t _n_active)
+    {
+        // number of tuples and of key groups of each replica since the last decision
+        std::vector<uint64_t> loads(replicas.size(), 0);
+        std::vector<size_t> owned(replicas.size(), 0);
+        for (size_t g=0; g<n_groups; g++) {
+            loads[assignment[g]] += group_counts[g];
+            owned[assignment[g]]++;
+        }
+        size_t min_r = 0;
+        size_t max_r = 0;
+        for (size_t i=0; i<_n_active; i++) {
+            if (loads[i] < loads[min_r] || (loads[i] == loads[min_r] && owned[i] < owned[min_r])) {
+                min_r = i;
+            }
+            if (owned[i] > 1 && (owned[max_r] <= 1 || loads[i] > loads[max_r])) {
+                max_r = i;
+            }
+        }
+        // the heaviest key group of a parked replica is moved to the least loaded active replica
+        size_t best = n_groups;
+        for (size_t g=0; g<n_groups; g++) {
+            if (assignment[g] >= _n_active && (best == n_groups || group_counts[g] > group_counts[best])) {
+                best = g;
+            }
+        }
+        if (best != n_groups) {
+            migrate(best, min_r);
+            return true;
+        }
+        // an active replica without key groups receives the heaviest one of the most loaded replica
+        for (size_t i=0; i<_n_active; i++) {
+            if (owned[i] == 0 && owned[max_r] > 1) {
+                for (size_t g=0; g<n_groups; g++) {
+                    if (assignment[g] == max_r && (best == n_groups || group_counts[g] > group_counts[best])) {
+                        best = g;
+                    }
+                }
+                migrate(best, i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // decide whether a key group must be migrated (called with the mutex acquired)
+    void decide()
+    {
+        uint64_t now = current_time_usecs();
+        if (closed) {
+            return;
+        }
+        // one migration at a time
+        for (auto &r: replicas) {
+            if (r.incoming.load(std::memory_order_acquire) > 0) {
+                return;
+            }
+        }
+        size_t n_active = (elastic != nullptr) ? elastic->getParallelism() : replicas.size();
+        if (elastic != nullptr && rescale(n_active)) {
+            return;
+        }
+        if (now - last_decision < interval) {
+            return;
+        }
+        last_decision = now;
+        // busy times of the active replicas since the last decision
+        std::vector<uint64_t> loads(replicas.size());
+        size_t max_r = 0;
+        size_t min_r = 0;
+        for (size_t i=0; i<replicas.size(); i++) {
+            uint64_t busy = replicas[i].busy.load(std::memory_order_relaxed);
+            loads[i] = busy - replicas[i].last_busy;
+            replicas[i].last_busy = busy;
+            if (i >= n_active) {
+                continue;
+            }
+            if (loads[i] > loads[max_r]) {
+                max_r = i;
+            }
+            if (loads[i] < loads[min_r]) {
+                min_r = i;
+            }
+        }
+        std::vector<uint64_t> counts(n_groups, 0);
+        counts.swap(group_counts);
+        if (loads[max_r] == 0 || (loads[max_r] - loads[min_r]) <= imbalance * loads[max_r]) {
+            return;
+        }
+        // cost of a tuple on the most loaded replica
+        uint64_t max_count = 0;
+        for (size_t g=0; g<n_groups; g++) {
+            if (assignment[g] == max_r) {
+                max_count += counts[g];
+            }
+        }
+        if (max_count == 0) {
+            return;
+        }
+        double cost = ((double) loads[max_r]) / max_count;
+        // the heaviest key group not reversing the imbalance is migrated
+        double target = ((double) (loads[max_r] - loads[min_r])) / 2;
+        size_t best = n_groups;
+        for (size_t g=0; g<n_groups; g++) {
+            if (assignment[g] == max_r && counts[g] > 0 && counts[g] * cost <= target && (best == n_groups || counts[g] > counts[best])) {
+                best = g;
+            }
+        }
+        if (best == n_groups) {
+            return;
+        }
+        migrate(best, min_r);
+    }
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _n_groups number of key groups
+     *  \param _n_replicas number of replicas of the operator
+     *  \param _routing_func function mapping the hashcode of a key onto a key group
+     *  \param _interval interval between two decisions of the rebalancing policy (in microseconds)
+     *  \param _imbalance relative difference of the busy times of the replicas triggering a migration
+     */ 
+    KeyGroup_Manager(size_t _n_groups,
+                     size_t _n_replicas,
+                     routing_func_t _routing_func=default_routing,
+                     uint64_t _interval=DEFAULT_KEYGROUP_INTERVAL_USEC,
+                     double _imbalance=DEFAULT_KEYGROUP_IMBALANCE):
+                     routing_func(_routing_func),
+                     n_groups(std::max<size_t>(_n_groups, 1)),
+                     interval(_interval),
+                     imbalance(_imbalance),
+                     assignment(n_groups),
+                     version(0),
+                     replicas(std::max<size_t>(_n_replicas, 1)),
+                     group_counts(n_groups, 0),
+                     last_decision(current_time_usecs()),
+                     closed(false)
+    {
+        for (size_t g=0; g<n_groups; g++) {
+            assignment[g] = g % replicas.size();
+        }
+    }
+
+    /** 
+     *  \brief Get the number of key groups
+     *  
+     *  \return number of key groups
+     */ 
+    size_t getNumGroups() const
+    {
+        return n_groups;
+    }
+
+    /** 
+     *  \brief Get the number of replicas
+     *  
+     *  \return number of replicas
+     */ 
+    size_t getNumReplicas() const
+    {
+        return replicas.size();
+    }
+
+    /** 
+     *  \brief Get the key group of a key
+     *  
+     *  \param _hashcode hashcode of the key
+     *  \return identifier of the key group starting from zero
+     */ 
+    size_t getGroup(size_t _hashcode) const
+    {
+        return routing_func(_hashcode, n_groups);
+    }
+
+    /** 
+     *  \brief Make the operator elastic (to be called before the operator is used)
+     *  
+     *  \param _elastic controller of the active replicas (with the same number of replicas)
+     */ 
+    void setElasticController(std::shared_ptr<Elastic_Controller> _elastic)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        elastic = _elastic;
+        // the key groups are initially assigned to the active replicas only
+        for (size_t g=0; g<n_groups; g++) {
+            assignment[g] = g % elastic->getParallelism();
+        }
+    }
+
+    /** 
+     *  \brief Get the controller of the active replicas
+     *  
+     *  \return controller of the active replicas (nullptr if the operator is not elastic)
+     */ 
+    std::shared_ptr<Elastic_Controller> getElasticController() const
+    {
+        return elastic;
+    }
+
+    /** 
+     *  \brief Get the number of migrations decided so far
+     *  
+     *  \return number of migrations
+     */ 
+    uint64_t getNumMigrations() const
+    {
+        return version.load(std::memory_order_acquire);
+    }
+
+    // get a copy of the current assignment and its version
+    std::vector<size_t> getAssignment(uint64_t &_version)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        _version = migrations.size();
+        return assignment;
+    }
+
+    // get the migrations decided after the given version, returns the current version
+    uint64_t getMigrations(uint64_t _from, std::vector<Migration> &_out)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        _out.insert(_out.end(), migrations.begin() + _from, migrations.end());
+        return migrations.size();
+    }
+
+    // report the number of tuples of each key group routed by an emitter (and run the policy)
+    void report(std::vector<uint64_t> &_counts)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t g=0; g<n_groups; g++) {
+            group_counts[g] += _counts[g];
+            if (elastic != nullptr && _counts[g] > 0) {
+                elastic->addSent(assignment[g], _counts[g]);
+            }
+            _counts[g] = 0;
+        }
+        decide();
+        if (elastic != nullptr) {
+            elastic->evaluate();
+        }
+    }
+
+    // notify the termination of an emitter (no further migration is decided)
+    void close()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        closed = true;
+    }
+
+    // add busy time to a replica (in nanoseconds)
+    void addBusyTime(size_t _replica, uint64_t _nsecs)
+    {
+        replicas[_replica].busy.fetch_add(_nsecs, std::memory_order_relaxed);
+        if (elastic != nullptr) {
+            elastic->addProcessed(_replica, DEFAULT_KEYGROUP_SAMPLING, _nsecs);
+        }
+    }
+
+    // publish the state of a key group released by its old replica
+    void publish(size_t _group, std::shared_ptr<void> _state)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Replica_State &r = replicas[assignment[_group]];
+        (r.mailbox).push_back(std::make_pair(_group, _state));
+        r.ready.fetch_add(1, std::memory_order_release);
+    }
+
+    // check whether some states have been published for a replica
+    bool hasStates(size_t _replica) const
+    {
+        return replicas[_replica].ready.load(std::memory_order_acquire) > 0;
+    }
+
+    // take the states published for a replica
+    std::vector<std::pair<size_t, std::shared_ptr<void>>> takeStates(size_t _replica)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Replica_State &r = replicas[_replica];
+        std::vector<std::pair<size_t, std::shared_ptr<void>>> states;
+        states.swap(r.mailbox);
+        r.ready.store(0, std::memory_order_release);
+        return states;
+    }
+
+    // notify that a key group has been installed by its new replica
+    void installed(size_t _replica)
+    {
+        replicas[_replica].incoming.fetch_sub(1, std::memory_order_release);
+    }
+
+    // get the number of key groups migrating to a replica and not installed yet
+    size_t getIncoming(size_t _replica) const
+    {
+        return replicas[_replica].incoming.load(std::memory_order_acquire);
+    }
+};
+
+// class KeyGroup_Router (used by each emitter of the operator)
+class KeyGroup_Router
+{
+private:
+    std::shared_ptr<KeyGroup_Manager> manager; // manager of the key groups (nullptr if the key groups are not used)
+    std::vector<size_t> assignment; // local copy of the assignment of the key groups
+    uint64_t version; // version of the local copy
+    std::vector<uint64_t> counts; // number of tuples of each key group not reported yet
+    uint64_t n_tuples; // number of tuples routed so far
+    std::vector<KeyGroup_Manager::Migration> pending; // migrations to be applied (reused to avoid allocations)
+
+    // apply the migrations decided after the version of the local copy
+    template<typename send_func_t>
+    void refresh(send_func_t &&_send)
+    {
+        version = manager->getMigrations(version, pending);
+        for (auto &m: pending) {
+            _send(createKeyGroupMarker(m.group), m.from);
+            assignment[m.group] = m.to;
+        }
+        pending.clear();
+    }
+
+public:
+    // Constructor I
+    KeyGroup_Router(): version(0), n_tuples(0) {}
+
+    // Constructor II
+    KeyGroup_Router(std::shared_ptr<KeyGroup_Manager> _manager):
+                    manager(_manager),
+                    version(0),
+                    n_tuples(0)
+    {
+        if (manager != nullptr) {
+            assignment = manager->getAssignment(version);
+            counts.resize(manager->getNumGroups(), 0);
+        }
+    }
+
+    // check whether the key groups are used
+    bool isEnabled() const
+    {
+        return manager != nullptr;
+    }
+
+    // apply the migrations decided after the version of the local copy, if any (release markers are sent with _send)
+    template<typename send_func_t>
+    void sync(send_func_t &&_send)
+    {
+        if (manager->getNumMigrations() != version) {
+            refresh(_send);
+        }
+    }
+
+    // get the replica of a key (release markers are sent with _send)
+    template<typename send_func_t>
+    size_t route(size_t _hashcode, send_func_t &&_send)
+    {
+        sync(_send);
+        size_t group = manager->getGroup(_hashcode);
+        counts[group]++;
+        if ((++n_tuples & (DEFAULT_KEYGROUP_REPORT - 1)) == 0) {
+            manager->report(counts);
+        }
+        return assignment[group];
+    }
+
+    // apply all the migrations before the termination of the emitter (release markers are sent with _send)
+    template<typename send_func_t>
+    void close(send_func_t &&_send)
+    {
+        manager->close();
+        refresh(_send);
+    }
+};
+
+// class KeyGroup_Replica (used by each replica of the operator to manage its hash table of the key descriptors)
+template<typename map_t>
+class KeyGroup_Replica
+{
+private:
+    using key_t = typename map_t::key_type;
+    using node_t = typename map_t::node_type;
+    using descriptor_t = typename map_t::mapped_type;
+    // type of the state of a key group (nodes extracted from the hash table)
+    using state_t = std::vector<node_t>;
+    std::shared_ptr<KeyGroup_Manager> manager; // manager of the key groups (nullptr if the key groups are not used)
+    size_t id; // identifier of the replica
+    map_t *keyMap; // hash table of the key descriptors of the replica
+    std::function<void(void *)> process_func; // function processing an input buffered by the replica
+    std::function<void(uint64_t)> watermark_func; // function processing a watermark held back by the replica
+    std::function<void(descriptor_t &)> rebind_func; // function binding an installed key descriptor to the replica
+    std::vector<bool> owned; // owned[g] is true if the key group g is installed in the replica
+    std::unordered_map<size_t, size_t> releases; // number of release markers received for each key group
+    std::unordered_map<size_t, std::vector<void *>> buffered; // inputs of the key groups not installed yet
+    bool deferred; // true if a watermark has been held back
+    uint64_t deferred_wm; // watermark held back
+    uint64_t n_inputs; // number of inputs received (used to sample the busy time)
+
+public:
+    // Constructor
+    KeyGroup_Replica():
+                     id(0),
+                     keyMap(nullptr),
+                     deferred(false),
+                     deferred_wm(0),
+                     n_inputs(0) {}
+
+    // initialize the management of the key groups
+    void init(std::shared_ptr<KeyGroup_Manager> _manager,
+              size_t _id,
+              map_t *_keyMap,
+              std::function<void(void *)> _process_func,
+              std::function<void(uint64_t)> _watermark_func,
+              std::function<void(descriptor_t &)> _rebind_func=nullptr)
+    {
+        manager = _manager;
+        id = _id;
+        keyMap = _keyMap;
+        process_func = _process_func;
+        watermark_func = _watermark_func;
+        rebind_func = _rebind_func;
+        uint64_t version = 0;
+        std::vector<size_t> assignment = manager->getAssignment(version);
+        owned.resize(assignment.size());
+        for (size_t g=0; g<assignment.size(); g++) {
+            owned[g] = (assignment[g] == id);
+        }
+    }
+
+    // check whether the key groups are used
+    bool isEnabled() const
+    {
+        return manager != nullptr;
+    }
+
+    // check whether an input of a key can be processed (otherwise it is buffered until the state of its group is installed)
+    bool admit(const key_t &_key, void *_input)
+    {
+        size_t group = manager->getGroup(std::hash<key_t>()(_key));
+        if (owned[group]) {
+            return true;
+        }
+        buffered[group].push_back(_input);
+        return false;
+    }
+
+    // receive the release marker of a key group from one of the input channels
+    void release(size_t _group, size_t _n_channels)
+    {
+        size_t &count = releases[_group];
+        count++;
+        if (count < std::max<size_t>(_n_channels, 1)) {
+            return;
+        }
+        releases.erase(_group);
+        // all the tuples of the group have been received: its key descriptors are moved to the new replica
+        auto state = std::make_shared<state_t>();
+        for (auto it=keyMap->begin(); it!=keyMap->end();) {
+            if (manager->getGroup(std::hash<key_t>()(it->first)) == _group) {
+                auto next = std::next(it);
+                state->push_back(keyMap->extract(it));
+                it = next;
+            }
+            else {
+                it++;
+            }
+        }
+        owned[_group] = false;
+        manager->publish(_group, state);
+    }
+
+    // install the states of the key groups received by the replica and process their buffered inputs
+    void poll()
+    {
+        if (!manager->hasStates(id)) {
+            return;
+        }
+        auto states = manager->takeStates(id);
+        for (auto &s: states) {
+            state_t *state = static_cast<state_t *>((s.second).get());
+            for (auto &node: *state) {
+                auto result = keyMap->insert(std::move(node));
+                if (rebind_func) {
+                    rebind_func((result.position)->second);
+                }
+            }
+            owned[s.first] = true;
+            manager->installed(id);
+            // the buffered inputs of the group are processed in arrival order
+            auto it = buffered.find(s.first);
+            if (it != buffered.end()) {
+                std::vector<void *> inputs;
+                inputs.swap(it->second);
+                buffered.erase(it);
+                for (auto *input: inputs) {
+                    process_func(input);
+                }
+            }
+        }
+        if (deferred && manager->getIncoming(id) == 0) {
+            deferred = false;
+            watermark_func(deferred_wm);
+        }
+    }
+
+    // hold back a watermark while some key groups are migrating to the replica, returns true if the watermark is held back
+    bool deferWatermark(uint64_t _wm)
+    {
+        if (manager == nullptr || manager->getIncoming(id) == 0) {
+            return false;
+        }
+        deferred = true;
+        deferred_wm = _wm;
+        return true;
+    }
+
+    // wait for the key groups migrating to the replica (used at the end of the stream)
+    void drain()
+    {
+        while (manager->getIncoming(id) > 0) {
+            poll();
+            std::this_thread::yield();
+        }
+        poll();
+    }
+
+    // start the measurement of the busy time (one input every DEFAULT_KEYGROUP_SAMPLING), returns zero if the input is not sampled
+    uint64_t startSample()
+    {
+        if ((n_inputs++ & (DEFAULT_KEYGROUP_SAMPLING - 1)) != 0) {
+            return 0;
+        }
+        return current_time_nsecs();
+    }
+
+    // end the measurement of the busy time of a sampled input
+    void endSample(uint64_t _start)
+    {
+        if (_start > 0) {
+            manager->addBusyTime(id, (current_time_nsecs() - _start) * DEFAULT_KEYGROUP_SAMPLING);
+        }
+    }
+};
+
+} // namespace wf
+
+#endif
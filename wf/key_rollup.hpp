@@ -0,0 +1,354 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/** 
+ *  @file    key_rollup.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    21/10/2020
+ *  
+ *  @brief Key_Rollup operator executing a chain of rollup windows in parallel
+ *         on multi-core CPUs
+ *  
+ *  @section Key_Rollup (Description)
+ *  
+ *  This file implements the Key_Rollup operator able to execute a chain of time-based
+ *  tumbling windows (e.g., per-second, per-minute and per-hour) on a multicore. Only
+ *  sub-streams with different keys are processed in parallel. All the levels of a key
+ *  are computed by the same replica, and each level combines the results of the previous
+ *  one in-process with its own combine function. Each result is tagged with the index of
+ *  its level (see getLevel() and getWindowId()).
+ *  
+ *  The template parameters tuple_t and result_t must be default constructible, with
+ *  a copy constructor and copy assignment operator, and they must provide and implement
+ *  the setControlFields() and getControlFields() methods.
+ */ 
+
+#ifndef KEY_ROLLUP_H
+#define KEY_ROLLUP_H
+
+/// includes
+#include<ff/pipeline.hpp>
+#include<ff/all2all.hpp>
+#include<ff/farm.hpp>
+#include<ff/optimize.hpp>
+#include<basic.hpp>
+#include<win_seqrollup.hpp>
+#include<kf_nodes.hpp>
+#include<basic_operator.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Key_Rollup
+ *  
+ *  \brief Key_Rollup operator executing a chain of rollup windows in parallel on
+ *         multi-core CPUs
+ *  
+ *  This class implements the Key_Rollup operator executing a chain of time-based tumbling
+ *  windows in parallel on a multicore. The identifier of each result is wid * n + l, where
+ *  wid is the index of the window in the l-th level and n is the number of levels.
+ */ 
+template<typename tuple_t, typename result_t>
+class Key_Rollup: public ff::ff_farm, public Basic_Operator
+{
+public:
+    /// type of the lift function
+    using winLift_func_t = std::function<void(const tuple_t &, result_t &)>;
+    /// type of the rich lift function
+    using rich_winLift_func_t = std::function<void(const tuple_t &, result_t &, RuntimeContext &)>;
+    /// type of the combine function
+    using winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
+    /// type of the rich combine function
+    using rich_winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &, RuntimeContext &)>;
+    /// type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext &)>;
+    /// type of the functionto map the key hashcode onto an identifier starting from zero to parallelism-1
+    using routing_func_t = std::function<size_t(size_t, size_t)>;
+
+private:
+    // type of the Win_SeqRollup to be created
+    using win_seqrollup_t = Win_SeqRollup<tuple_t, result_t>;
+    // type of the KF_Emitter node
+    using kf_emitter_t = KF_Emitter<tuple_t>;
+    // friendships with other classes in the library
+    friend class MultiPipe;
+    std::string name; // name of the Key_Rollup
+    size_t parallelism; // internal parallelism of the Key_Rollup
+    bool used; // true if the Key_Rollup has been added/chained in a MultiPipe
+    std::vector<uint64_t> lengths; // window lengths of the levels (in time units)
+    uint64_t triggering_delay; // triggering delay in time units
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _winLift_func the (riched or not) lift function to translate a tuple into a result (with a signature accepted by the Key_Rollup operator)
+     *  \param _winComb_func the (riched or not) combine function of the first level (with a signature accepted by the Key_Rollup operator)
+     *  \param _win_len window length of the first level in time units
+     *  \param _upper_levels std::vector of the other levels (pairs of window length in time units and rich combine function)
+     *  \param _triggering_delay triggering delay in time units
+     *  \param _parallelism internal parallelism of the Key_Rollup operator
+     *  \param _name string with the unique name of the operator
+     *  \param _closing_func closing function
+     *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to parallelism-1
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+     */ 
+    template<typename lift_F_t, typename comb_F_t>
+    Key_Rollup(lift_F_t _winLift_func,
+               comb_F_t _winComb_func,
+               uint64_t _win_len,
+               std::vector<std::pair<uint64_t, rich_winComb_func_t>> _upper_levels,
+               uint64_t _triggering_delay,
+               size_t _parallelism,
+               std::string _name,
+               closing_func_t _closing_func,
+               routing_func_t _routing_func,
+               std::vector<int> _cpus={}):
+               name(_name),
+               parallelism(_parallelism),
+               used(false),
+               triggering_delay(_triggering_delay),
+               cpus(_cpus)
+    {
+        // check the validity of the parallelism value
+        if (_parallelism == 0) {
+            std::cerr << RED << "WindFlow Error: Key_Rollup has parallelism zero" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        lengths.push_back(_win_len);
+        for (auto &l: _upper_levels) {
+            lengths.push_back(l.first);
+        }
+        // std::vector of Win_SeqRollup (the levels are checked by them)
+        std::vector<ff_node *> w(_parallelism);
+        // create the Win_SeqRollup
+        for (size_t i = 0; i < _parallelism; i++) {
+            auto *rollup = new win_seqrollup_t(_winLift_func, _winComb_func, _win_len, _upper_levels, _triggering_delay, _name, _closing_func, RuntimeContext(_parallelism, i));
+            w[i] = rollup;
+        }
+        ff::ff_farm::add_workers(w);
+        ff::ff_farm::add_collector(nullptr);
+        // create the Emitter node
+        ff::ff_farm::add_emitter(new kf_emitter_t(_routing_func, _parallelism));
+        // when the Key_Rollup will be destroyed we need aslo to destroy the emitter, workers and collector
+        ff::ff_farm::cleanup_all();
+    }
+
+    /** 
+     *  \brief Get the window type utilized by the Key_Rollup
+     *  \return adopted windowing semantics (always time-based)
+     */ 
+    win_type_t getWinType() const
+    {
+        return win_type_t::TB;
+    }
+
+    /** 
+     *  \brief Get the number of levels computed by the Key_Rollup
+     *  \return number of levels
+     */ 
+    size_t getNumLevels() const
+    {
+        return lengths.size();
+    }
+
+    /** 
+     *  \brief Get the level of a result
+     *  \param _id identifier of a result produced by the Key_Rollup
+     *  \return index of the level (zero is the level consuming the input tuples)
+     */ 
+    size_t getLevel(uint64_t _id) const
+    {
+        return _id % lengths.size();
+    }
+
+    /** 
+     *  \brief Get the index of the window of a result within its level
+     *  \param _id identifier of a result produced by the Key_Rollup
+     *  \return index of the window (its starting time divided by the length of its level)
+     */ 
+    uint64_t getWindowId(uint64_t _id) const
+    {
+        return _id / lengths.size();
+    }
+
+    /** 
+     *  \brief Get the number of ignored tuples by the Key_Rollup
+     *  \return number of tuples ignored during the processing by the Key_Rollup
+     */ 
+    size_t getNumIgnoredTuples() const
+    {
+        size_t count = 0;
+        auto workers = this->getWorkers();
+        for (auto *w: workers) {
+            auto *seq = static_cast<win_seqrollup_t *>(w);
+            count += seq->getNumIgnoredTuples();
+        }
+        return count;
+    }
+
+    /** 
+     *  \brief Get the name of the Key_Rollup
+     *  \return string representing the name of the Key_Rollup
+     */ 
+    std::string getName() const override
+    {
+        return name;
+    }
+
+    /** 
+     *  \brief Get the total parallelism within the Key_Rollup
+     *  \return total parallelism within the Key_Rollup
+     */ 
+    size_t getParallelism() const override
+    {
+        return parallelism;
+    }
+
+    /** 
+     *  \brief Return the routing mode of inputs to the Key_Rollup
+     *  \return routing mode (always KEYBY for the Key_Rollup)
+     */ 
+    routing_modes_t getRoutingMode() const override
+    {
+        return routing_modes_t::KEYBY;
+    }
+
+    /** 
+     *  \brief Check whether the Key_Rollup has been used in a MultiPipe
+     *  \return true if the Key_Rollup has been added/chained to an existing MultiPipe
+     */ 
+    bool isUsed() const override
+    {
+        return used;
+    }
+
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        auto placements = _manager.assign(name, this->getWorkers().size(), cpus);
+        for (size_t i=0; i<placements.size(); i++) {
+            static_cast<win_seqrollup_t *>(this->getWorkers()[i])->setPlacement(placements[i]);
+        }
+    }
+
+    /** 
+     *  \brief Check whether the operator has been terminated
+     *  \return true if the operator has finished its work
+     */ 
+    virtual bool isTerminated() const override
+    {
+        bool terminated = true;
+        // scan all the replicas to check their termination
+        for(auto *w: this->getWorkers()) {
+            auto *seq = static_cast<win_seqrollup_t *>(w);
+            terminated = terminated && seq->isTerminated();
+        }
+        return terminated;
+    }
+
+#if defined (TRACE_WINDFLOW)
+    /// Dump the log file (JSON format) in the LOG_DIR directory
+    void dump_LogFile() const override
+    {
+        // create and open the log file in the LOG_DIR directory
+        std::ofstream logfile;
+#if defined (LOG_DIR)
+        std::string log_dir = std::string(STRINGIFY(LOG_DIR));
+        std::string filename = std::string(STRINGIFY(LOG_DIR)) + "/" + std::to_string(getpid()) + "_" + name + ".json";
+#else
+        std::string log_dir = std::string("log");
+        std::string filename = "log/" + std::to_string(getpid()) + "_" + name + ".json";
+#endif
+        // create the log directory
+        if (mkdir(log_dir.c_str(), 0777) != 0) {
+            struct stat st;
+            if((stat(log_dir.c_str(), &st) != 0) || !S_ISDIR(st.st_mode)) {
+                std::cerr << RED << "WindFlow Error: directory for log files cannot be created" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        logfile.open(filename);
+        // create the rapidjson writer
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        // append the statistics of this operator
+        this->append_Stats(writer);
+        // serialize the object to file
+        logfile << buffer.GetString();
+        logfile.close();
+    }
+
+    /// append the statistics (JSON format) of this operator
+    void append_Stats(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) const override
+    {
+        // create the header of the JSON file
+        writer.StartObject();
+        writer.Key("Operator_name");
+        writer.String(name.c_str());
+        writer.Key("Operator_type");
+        writer.String("Key_Rollup");
+        writer.Key("Distribution");
+        writer.String("KEYBY");
+        writer.Key("isTerminated");
+        writer.Bool(this->isTerminated());
+        writer.Key("isWindowed");
+        writer.Bool(true);
+        writer.Key("isGPU");
+        writer.Bool(false);
+        writer.Key("Window_type");
+        writer.String("time-based");
+        writer.Key("Window_delay");
+        writer.Uint(triggering_delay);
+        writer.Key("Window_lengths");
+        writer.StartArray();
+        for (auto l: lengths) {
+            writer.Uint(l);
+        }
+        writer.EndArray();
+        writer.Key("Parallelism");
+        writer.Uint(parallelism);
+        writer.Key("Replicas");
+        writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
+        // get statistics from all the replicas of the operator
+        for(auto *w: this->getWorkers()) {
+            auto *seq = static_cast<win_seqrollup_t *>(w);
+            Stats_Record record = seq->get_StatsRecord();
+            record.append_Stats(writer);
+            inputs.push_back(record.inputs_received);
+        }
+        writer.EndArray();
+        writer.Key("Replica_imbalance");
+        writer.Double(compute_imbalance(inputs));
+        writer.EndObject();
+    }
+#endif
+
+    /// deleted constructors/operators
+    Key_Rollup(const Key_Rollup &) = delete; // copy constructor
+    Key_Rollup(Key_Rollup &&) = delete; // move constructor
+    Key_Rollup &operator=(const Key_Rollup &) = delete; // copy assignment operator
+    Key_Rollup &operator=(Key_Rollup &&) = delete; // move assignment operator
+};
+
+} // namespace wf
+
+#endif
@@ -0,0 +1,336 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/** 
+ *  @file    key_session.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    22/10/2020
+ *  
+ *  @brief Key_Session operator executing keyed session windows in parallel
+ *         on multi-core CPUs
+ *  
+ *  @section Key_Session (Description)
+ *  
+ *  This file implements the Key_Session operator able to execute session windows on a
+ *  multicore. A session of a key ends when no tuple of that key is received for a gap
+ *  of time (or when it reaches an optional maximum duration). Only sessions of different
+ *  keys are executed in parallel. The session function can be non-incremental or
+ *  incremental, as for the Key_Farm operator.
+ *  
+ *  A tuple received out-of-order can fill the gap between two open sessions of its key,
+ *  which are then merged. With an incremental function this requires a combine function
+ *  of the partial results, which can be omitted only if the inputs of the operator are
+ *  ordered (DETERMINISTIC and PROBABILISTIC modes, or no triggering delay).
+ *  
+ *  The template parameters tuple_t and result_t must be default constructible, with
+ *  a copy constructor and copy assignment operator, and they must provide and implement
+ *  the setControlFields() and getControlFields() methods.
+ */ 
+
+#ifndef KEY_SESSION_H
+#define KEY_SESSION_H
+
+/// includes
+#include<ff/pipeline.hpp>
+#include<ff/all2all.hpp>
+#include<ff/farm.hpp>
+#include<ff/optimize.hpp>
+#include<basic.hpp>
+#include<win_seqsession.hpp>
+#include<kf_nodes.hpp>
+#include<basic_operator.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Key_Session
+ *  
+ *  \brief Key_Session operator executing keyed session windows in parallel on multi-core CPUs
+ *  
+ *  This class implements the Key_Session operator executing session windows in parallel on
+ *  a multicore. The identifier of each result is the timestamp of the first tuple of the
+ *  session, while its timestamp is the one of the last tuple of the session.
+ */ 
+template<typename tuple_t, typename result_t>
+class Key_Session: public ff::ff_farm, public Basic_Operator
+{
+public:
+    /// type of the non-incremental session processing function
+    using win_func_t = std::function<void(uint64_t, const Iterable<tuple_t> &, result_t &)>;
+    /// type of the rich non-incremental session processing function
+    using rich_win_func_t = std::function<void(uint64_t, const Iterable<tuple_t> &, result_t &, RuntimeContext &)>;
+    /// type of the incremental session processing function
+    using winupdate_func_t = std::function<void(uint64_t, const tuple_t &, result_t &)>;
+    /// type of the rich incremental session processing function
+    using rich_winupdate_func_t = std::function<void(uint64_t, const tuple_t &, result_t &, RuntimeContext &)>;
+    /// type of the rich function combining the partial results of two merged sessions (incremental functions only)
+    using rich_winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &, RuntimeContext &)>;
+    /// type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext &)>;
+    /// type of the functionto map the key hashcode onto an identifier starting from zero to parallelism-1
+    using routing_func_t = std::function<size_t(size_t, size_t)>;
+
+private:
+    // type of the Win_SeqSession to be created
+    using win_seqsession_t = Win_SeqSession<tuple_t, result_t>;
+    // type of the KF_Emitter node
+    using kf_emitter_t = KF_Emitter<tuple_t>;
+    // friendships with other classes in the library
+    friend class MultiPipe;
+    std::string name; // name of the Key_Session
+    size_t parallelism; // internal parallelism of the Key_Session
+    bool used; // true if the Key_Session has been added/chained in a MultiPipe
+    uint64_t gap; // session gap in time units
+    uint64_t max_duration; // maximum duration of a session in time units (zero means no limit)
+    uint64_t triggering_delay; // triggering delay in time units
+    bool mergeable; // true if the open sessions bridged by a tuple received out-of-order can be merged
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _func the (riched or not, incremental or not) session function (with a signature accepted by the Key_Session operator)
+     *  \param _gap session gap in time units
+     *  \param _max_duration maximum duration of a session in time units (zero means no limit)
+     *  \param _triggering_delay triggering delay in time units
+     *  \param _parallelism internal parallelism of the Key_Session operator
+     *  \param _name string with the unique name of the operator
+     *  \param _closing_func closing function
+     *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to parallelism-1
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+     *  \param _comb_func function combining the partial results of two merged sessions (incremental functions only)
+     */ 
+    template<typename F_t>
+    Key_Session(F_t _func,
+                uint64_t _gap,
+                uint64_t _max_duration,
+                uint64_t _triggering_delay,
+                size_t _parallelism,
+                std::string _name,
+                closing_func_t _closing_func,
+                routing_func_t _routing_func,
+                std::vector<int> _cpus={},
+                rich_winComb_func_t _comb_func=nullptr):
+                name(_name),
+                parallelism(_parallelism),
+                used(false),
+                gap(_gap),
+                max_duration(_max_duration),
+                triggering_delay(_triggering_delay),
+                mergeable(true),
+                cpus(_cpus)
+    {
+        // check the validity of the session parameters
+        if (_gap == 0) {
+            std::cerr << RED << "WindFlow Error: session gap in Key_Session cannot be zero" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the validity of the parallelism value
+        if (_parallelism == 0) {
+            std::cerr << RED << "WindFlow Error: Key_Session has parallelism zero" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // std::vector of Win_SeqSession
+        std::vector<ff_node *> w(_parallelism);
+        // create the Win_SeqSession
+        for (size_t i = 0; i < _parallelism; i++) {
+            auto *session = new win_seqsession_t(_func, _gap, _max_duration, _triggering_delay, _name, _closing_func, RuntimeContext(_parallelism, i));
+            session->setCombineFunction(_comb_func);
+            mergeable = session->canMerge();
+            w[i] = session;
+        }
+        ff::ff_farm::add_workers(w);
+        ff::ff_farm::add_collector(nullptr);
+        // create the Emitter node
+        ff::ff_farm::add_emitter(new kf_emitter_t(_routing_func, _parallelism));
+        // when the Key_Session will be destroyed we need aslo to destroy the emitter, workers and collector
+        ff::ff_farm::cleanup_all();
+    }
+
+    /** 
+     *  \brief Get the session gap of the Key_Session
+     *  \return session gap in time units
+     */ 
+    uint64_t getGap() const
+    {
+        return gap;
+    }
+
+    /** 
+     *  \brief Get the number of ignored tuples by the Key_Session
+     *  \return number of tuples ignored during the processing by the Key_Session
+     */ 
+    size_t getNumIgnoredTuples() const
+    {
+        size_t count = 0;
+        auto workers = this->getWorkers();
+        for (auto *w: workers) {
+            auto *seq = static_cast<win_seqsession_t *>(w);
+            count += seq->getNumIgnoredTuples();
+        }
+        return count;
+    }
+
+    /** 
+     *  \brief Get the name of the Key_Session
+     *  \return string representing the name of the Key_Session
+     */ 
+    std::string getName() const override
+    {
+        return name;
+    }
+
+    /** 
+     *  \brief Get the total parallelism within the Key_Session
+     *  \return total parallelism within the Key_Session
+     */ 
+    size_t getParallelism() const override
+    {
+        return parallelism;
+    }
+
+    /** 
+     *  \brief Return the routing mode of inputs to the Key_Session
+     *  \return routing mode (always KEYBY for the Key_Session)
+     */ 
+    routing_modes_t getRoutingMode() const override
+    {
+        return routing_modes_t::KEYBY;
+    }
+
+    /** 
+     *  \brief Check whether the Key_Session has been used in a MultiPipe
+     *  \return true if the Key_Session has been added/chained to an existing MultiPipe
+     */ 
+    bool isUsed() const override
+    {
+        return used;
+    }
+
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        auto placements = _manager.assign(name, this->getWorkers().size(), cpus);
+        for (size_t i=0; i<placements.size(); i++) {
+            static_cast<win_seqsession_t *>(this->getWorkers()[i])->setPlacement(placements[i]);
+        }
+    }
+
+    /** 
+     *  \brief Check whether the operator has been terminated
+     *  \return true if the operator has finished its work
+     */ 
+    virtual bool isTerminated() const override
+    {
+        bool terminated = true;
+        // scan all the replicas to check their termination
+        for(auto *w: this->getWorkers()) {
+            auto *seq = static_cast<win_seqsession_t *>(w);
+            terminated = terminated && seq->isTerminated();
+        }
+        return terminated;
+    }
+
+#if defined (TRACE_WINDFLOW)
+    /// Dump the log file (JSON format) in the LOG_DIR directory
+    void dump_LogFile() const override
+    {
+        // create and open the log file in the LOG_DIR directory
+        std::ofstream logfile;
+#if defined (LOG_DIR)
+        std::string log_dir = std::string(STRINGIFY(LOG_DIR));
+        std::string filename = std::string(STRINGIFY(LOG_DIR)) + "/" + std::to_string(getpid()) + "_" + name + ".json";
+#else
+        std::string log_dir = std::string("log");
+        std::string filename = "log/" + std::to_string(getpid()) + "_" + name + ".json";
+#endif
+        // create the log directory
+        if (mkdir(log_dir.c_str(), 0777) != 0) {
+            struct stat st;
+            if((stat(log_dir.c_str(), &st) != 0) || !S_ISDIR(st.st_mode)) {
+                std::cerr << RED << "WindFlow Error: directory for log files cannot be created" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        logfile.open(filename);
+        // create the rapidjson writer
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        // append the statistics of this operator
+        this->append_Stats(writer);
+        // serialize the object to file
+        logfile << buffer.GetString();
+        logfile.close();
+    }
+
+    /// append the statistics (JSON format) of this operator
+    void append_Stats(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) const override
+    {
+        // create the header of the JSON file
+        writer.StartObject();
+        writer.Key("Operator_name");
+        writer.String(name.c_str());
+        writer.Key("Operator_type");
+        writer.String("Key_Session");
+        writer.Key("Distribution");
+        writer.String("KEYBY");
+        writer.Key("isTerminated");
+        writer.Bool(this->isTerminated());
+        writer.Key("isWindowed");
+        writer.Bool(true);
+        writer.Key("isGPU");
+        writer.Bool(false);
+        writer.Key("Window_type");
+        writer.String("session");
+        writer.Key("Window_delay");
+        writer.Uint(triggering_delay);
+        writer.Key("Session_gap");
+        writer.Uint(gap);
+        writer.Key("Session_max_duration");
+        writer.Uint(max_duration);
+        writer.Key("Parallelism");
+        writer.Uint(parallelism);
+        writer.Key("Replicas");
+        writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
+        // get statistics from all the replicas of the operator
+        for(auto *w: this->getWorkers()) {
+            auto *seq = static_cast<win_seqsession_t *>(w);
+            Stats_Record record = seq->get_StatsRecord();
+            record.append_Stats(writer);
+            inputs.push_back(record.inputs_received);
+        }
+        writer.EndArray();
+        writer.Key("Replica_imbalance");
+        writer.Double(compute_imbalance(inputs));
+        writer.EndObject();
+    }
+#endif
+
+    /// deleted constructors/operators
+    Key_Session(const Key_Session &) = delete; // copy constructor
+    Key_Session(Key_Session &&) = delete; // move constructor
+    Key_Session &operator=(const Key_Session &) = delete; // copy assignment operator
+    Key_Session &operator=(Key_Session &&) = delete; // move assignment operator
+};
+
+} // namespace wf
+
+#endif
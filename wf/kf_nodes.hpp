@@ -26,37 +26,208 @@
  *  
  *  This file implements the emitter and the collector nodes used by the Key_Farm,
  *  Key_Farm_GPU, Key_FFAT and Key_FFAT_GPU operators.
+ *  
+ *  It also implements the nodes of the hot-key splitting of the Key_Farm. The emitter
+ *  detects the heavy hitters with a Space-Saving sketch and spreads the tuples of each
+ *  of them over a set of replicas. Each replica joins a hot key from the timestamp of
+ *  the first tuple of that key it receives, and the joins are published in a registry
+ *  shared with the KF_Merger nodes. A KF_Merger combines the partial results of the
+ *  same window of a hot key computed by the replicas which joined that key before the
+ *  end of the window, and it emits the results of each key in order.
  */ 
 
 #ifndef KF_NODES_H
 #define KF_NODES_H
 
 // includes
+#include<map>
+#include<mutex>
+#include<limits>
+#include<memory>
 #include<vector>
+#include<atomic>
+#include<unordered_map>
 #include<ff/multinode.hpp>
+#include<basic.hpp>
+#include<meta.hpp>
 #include<basic_emitter.hpp>
+#include<watermark.hpp>
+#include<key_groups.hpp>
 
 namespace wf {
 
+// class HotKey_Registry
+template<typename key_t>
+class HotKey_Registry
+{
+private:
+    // type of the joins of a hot key (replica identifier and timestamp from which it receives the tuples of that key)
+    using joins_t = std::vector<std::pair<size_t, uint64_t>>;
+    std::mutex mutex; // mutex protecting the joins
+    std::unordered_map<key_t, joins_t> keyMap; // hash table that maps hot keys onto their joins
+    std::atomic<uint64_t> version; // number of joins registered so far
+
+public:
+    // Constructor
+    HotKey_Registry(): version(0) {}
+
+    // register a replica receiving the tuples of a hot key starting from the given timestamp, returns the timestamp
+    // of the first join of that replica (the emitters of the operator can join the same replica to the same key)
+    uint64_t join(const key_t &_key, size_t _replica, uint64_t _ts)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        joins_t &joins = keyMap[_key];
+        for (auto &j: joins) {
+            if (j.first == _replica) {
+                return j.second;
+            }
+        }
+        joins.push_back(std::make_pair(_replica, _ts));
+        version.fetch_add(1, std::memory_order_release);
+        return _ts;
+    }
+
+    // get the number of joins registered so far (it changes when a copy of the joins must be refreshed)
+    uint64_t getVersion() const
+    {
+        return version.load(std::memory_order_acquire);
+    }
+
+    // get a copy of the joins of all the hot keys
+    std::unordered_map<key_t, joins_t> getJoins()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return keyMap;
+    }
+};
+
 // class KF_Emitter
 template<typename tuple_t>
 class KF_Emitter: public Basic_Emitter
 {
 private:
+    tuple_t tmp; // never used
+    // key data type
+    using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
     // type of the function to map the key hashcode onto an identifier starting from zero to parallelism-1
     using routing_func_t = std::function<size_t(size_t, size_t)>;
+    // inner struct of a counter of the Space-Saving sketch
+    struct Counter
+    {
+        key_t key; // key monitored by the counter
+        uint64_t count; // estimated frequency of the key
+        uint64_t error; // maximum overestimation of the frequency
+    };
+    // inner struct of the descriptor of a hot key
+    struct Hot_Descriptor
+    {
+        size_t home; // replica of the key without splitting
+        size_t next; // index of the next replica (round robin) among the ones of the key
+        std::vector<uint64_t> joined; // timestamps of the joins of the replicas of the key (max if not joined yet)
+    };
     routing_func_t routing_func; // routing function
     size_t parallelism; // parallelism degree (number of inner operators)
     bool isCombined; // true if this node is used within a Tree_Emitter node
     std::vector<std::pair<void *, int>> output_queue; // used in case of Tree_Emitter mode
+    std::shared_ptr<HotKey_Registry<key_t>> registry; // registry of the hot keys (nullptr if the hot-key splitting is disabled)
+    size_t split_degree; // number of replicas over which the tuples of a hot key are spread
+    std::vector<Counter> counters; // counters of the Space-Saving sketch
+    std::unordered_map<key_t, size_t> counterMap; // hash table that maps the monitored keys onto their counters
+    uint64_t n_tuples; // number of tuples observed by the sketch
+    std::unordered_map<key_t, Hot_Descriptor> hotMap; // hash table that maps the hot keys onto their descriptors
+    uint64_t last_wm; // last watermark received
+    KeyGroup_Router router; // router of the key groups (disabled if the key groups are not used)
+
+    // send a message to a destination
+    void send(void *_msg, size_t _dest)
+    {
+        if (!isCombined) {
+            this->ff_send_out_to(_msg, _dest);
+        }
+        else {
+            output_queue.push_back(std::make_pair(_msg, _dest));
+        }
+    }
+
+    // update the sketch with a tuple of a key, returns the lower bound of the frequency of the key
+    uint64_t updateSketch(const key_t &_key)
+    {
+        n_tuples++;
+        auto it = counterMap.find(_key);
+        if (it != counterMap.end()) {
+            Counter &c = counters[it->second];
+            c.count++;
+            return c.count - c.error;
+        }
+        size_t capacity = std::max<size_t>(4 * parallelism, 16);
+        if (counters.size() < capacity) {
+            counterMap[_key] = counters.size();
+            counters.push_back(Counter{_key, 1, 0});
+            return 1;
+        }
+        // the counter with the minimum frequency is assigned to the new key
+        size_t min_idx = 0;
+        for (size_t i=1; i<counters.size(); i++) {
+            if (counters[i].count < counters[min_idx].count) {
+                min_idx = i;
+            }
+        }
+        counterMap.erase(counters[min_idx].key);
+        counterMap[_key] = min_idx;
+        uint64_t min = counters[min_idx].count;
+        counters[min_idx] = Counter{_key, min + 1, min};
+        return 1;
+    }
+
+    // select the replica of a tuple of a key whose replica without splitting is _home
+    size_t routeHotKey(const key_t &_key, uint64_t _ts, size_t _home)
+    {
+        auto it = hotMap.find(_key);
+        if (it == hotMap.end()) {
+            // a key is hot if it exceeds the fair share of a replica (it stays hot afterwards)
+            uint64_t freq = updateSketch(_key);
+            if (n_tuples < DEFAULT_HOTKEY_WARMUP || freq * parallelism <= n_tuples) {
+                return _home;
+            }
+            Hot_Descriptor hot_d;
+            hot_d.home = _home;
+            hot_d.next = 0;
+            hot_d.joined.resize(std::min(split_degree, parallelism), std::numeric_limits<uint64_t>::max());
+            hot_d.joined[0] = registry->join(_key, _home, 0);
+            it = hotMap.insert(std::make_pair(_key, hot_d)).first;
+        }
+        Hot_Descriptor &hot_d = (*it).second;
+        size_t idx = hot_d.next;
+        hot_d.next = (hot_d.next + 1) % (hot_d.joined).size();
+        // late tuples are sent to the replica without splitting
+        if (_ts < last_wm) {
+            return _home;
+        }
+        if ((hot_d.joined)[idx] == std::numeric_limits<uint64_t>::max()) {
+            (hot_d.joined)[idx] = registry->join(_key, (_home + idx) % parallelism, _ts);
+        }
+        // tuples older than the join of the replica are sent to the replica without splitting
+        if (_ts < (hot_d.joined)[idx]) {
+            return _home;
+        }
+        return (_home + idx) % parallelism;
+    }
 
 public:
     // Constructor
     KF_Emitter(routing_func_t _routing_func,
-               size_t _parallelism):
+               size_t _parallelism,
+               std::shared_ptr<HotKey_Registry<key_t>> _registry=nullptr,
+               size_t _split_degree=1,
+               std::shared_ptr<KeyGroup_Manager> _kg_manager=nullptr):
                routing_func(_routing_func),
                parallelism(_parallelism),
-               isCombined(false) {}
+               isCombined(false),
+               registry(_registry),
+               split_degree(std::max<size_t>(_split_degree, 1)),
+               n_tuples(0),
+               last_wm(0),
+               router(_kg_manager) {}
 
     // clone method
     Basic_Emitter *clone() const override
@@ -74,21 +245,49 @@ public:
     // svc method (utilized by the FastFlow runtime)
     void *svc(void *in) override
     {
-        tuple_t *t = reinterpret_cast<tuple_t *>(in);
+        // watermarks are broadcast to all the destinations (after the release markers of the migrated key groups)
+        if (isWatermark(in)) {
+            if (router.isEnabled()) {
+                router.sync([this](void *_msg, size_t _dest) { send(_msg, _dest); });
+            }
+            if (!isIdleMark(in)) {
+                last_wm = std::max(last_wm, getWatermark(in));
+            }
+            for (size_t i=0; i<parallelism; i++) {
+                send(in, i);
+            }
+            return this->GO_ON;
+        }
+        // a shared envelope of a split is owned with copy-on-write (the tuple is not forwarded as it is)
+        tuple_t *t = ownInput(reinterpret_cast<tuple_t *>(in));
         // extract the key from the input tuple
         auto key = std::get<0>(t->getControlFields()); // key
         size_t hashcode = std::hash<decltype(key)>()(key); // compute the hashcode of the key
-        // evaluate the routing function
-        size_t dest_w = routing_func(hashcode, parallelism);
-        if (!isCombined) {
-            this->ff_send_out_to(t, dest_w);
+        // evaluate the routing function (through the assignment of the key groups if they are used)
+        size_t dest_w = 0;
+        if (router.isEnabled()) {
+            dest_w = router.route(hashcode, [this](void *_msg, size_t _dest) { send(_msg, _dest); });
         }
         else {
-            output_queue.push_back(std::make_pair(t, dest_w));
+            dest_w = routing_func(hashcode, parallelism);
         }
+        // the tuples of the hot keys are spread over several replicas
+        if (registry != nullptr) {
+            dest_w = routeHotKey(key, std::get<2>(t->getControlFields()), dest_w);
+        }
+        send(t, dest_w);
         return this->GO_ON;
     }
 
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        // the release markers of the migrations not applied yet are sent before the EOS
+        if (router.isEnabled()) {
+            router.close([this](void *_msg, size_t _dest) { send(_msg, _dest); });
+        }
+    }
+
     // svc_end method (FastFlow runtime)
     void svc_end() override {}
 
@@ -123,14 +322,38 @@ private:
     struct Key_Descriptor
     {
         uint64_t next_win; // next window to be transmitted of that key
-        std::deque<result_t *> resultsSet; // std::deque of buffered results of that key
+        std::vector<result_t *> ring; // circular buffer of the results of that key (indexed by wid - next_win starting from head)
+        size_t head; // position in the ring of the result of the window next_win
 
         // Constructor
-        Key_Descriptor(): next_win(0) {}
-
+        Key_Descriptor(): next_win(0), ring(DEFAULT_RING_CAPACITY, nullptr), head(0) {}
     };
     // hash table that maps key identifiers onto key descriptors
     std::unordered_map<key_t, Key_Descriptor> keyMap;
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+
+    // move the head of the ring of a key to the next window
+    void advanceRing(Key_Descriptor &_key_d)
+    {
+        _key_d.next_win++;
+        _key_d.head = (_key_d.head + 1) & ((_key_d.ring).size() - 1);
+    }
+
+    // enlarge the ring of a key (the capacity is kept a power of two) to buffer at least _size results
+    void growRing(Key_Descriptor &_key_d, uint64_t _size)
+    {
+        size_t capacity = (_key_d.ring).size();
+        while (capacity < _size) {
+            capacity <<= 1;
+        }
+        std::vector<result_t *> ring(capacity, nullptr);
+        size_t mask = (_key_d.ring).size() - 1;
+        for (size_t i=0; i<(_key_d.ring).size(); i++) {
+            ring[i] = (_key_d.ring)[(_key_d.head + i) & mask];
+        }
+        (_key_d.ring).swap(ring);
+        _key_d.head = 0;
+    }
 
 public:
     // svc_init method (utilized by the FastFlow runtime)
@@ -142,39 +365,256 @@ public:
     // svc method (utilized by the FastFlow runtime)
     result_t *svc(result_t *r) override
     {
+        // watermarks are merged among the input channels and forwarded
+        if (isWatermark(r)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(r))) {
+                this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+            }
+            return this->GO_ON;
+        }
         // extract key and identifier from the result
         auto key = std::get<0>(r->getControlFields()); // key
         uint64_t wid = std::get<1>(r->getControlFields()); // identifier
-        // find the corresponding key descriptor
-        auto it = keyMap.find(key);
-        if (it == keyMap.end()) {
-            // create the descriptor of that key
-            keyMap.insert(std::make_pair(key, Key_Descriptor()));
-            it = keyMap.find(key);
+        // find the corresponding key descriptor (created if not present)
+        Key_Descriptor &key_d = keyMap[key];
+        uint64_t dist = wid - key_d.next_win;
+        // the result is not the next one of its key: it is buffered at the correct place
+        if (dist > 0) {
+            if (dist >= (key_d.ring).size()) {
+                growRing(key_d, dist + 1);
+            }
+            (key_d.ring)[(key_d.head + dist) & ((key_d.ring).size() - 1)] = r;
+            return this->GO_ON;
+        }
+        // the result is the next one of its key: it is emitted with the following ones already buffered
+        this->ff_send_out(r);
+        advanceRing(key_d);
+        while ((key_d.ring)[key_d.head] != nullptr) {
+            this->ff_send_out((key_d.ring)[key_d.head]);
+            (key_d.ring)[key_d.head] = nullptr;
+            advanceRing(key_d);
+        }
+        return this->GO_ON;
+    }
+
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+        }
+    }
+
+    // svc_end method (utilized by the FastFlow runtime)
+    void svc_end() override {}
+};
+
+// class KF_Merger
+template<typename result_t>
+class KF_Merger: public ff::ff_minode_t<result_t>
+{
+private:
+    result_t tmp; // never used
+    // key data type
+    using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
+    // type of the combine function
+    using winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
+    // inner struct of a replica joined to a hot key
+    struct Member
+    {
+        size_t channel; // identifier of the replica (input channel)
+        uint64_t first_win; // identifier of the first window computed with the tuples received by the replica
+        int64_t last_win; // identifier of the last window received from the replica (-1 if none)
+    };
+    // inner struct of the descriptor of a hot key
+    struct Key_Descriptor
+    {
+        uint64_t next_win; // identifier of the next window to be emitted
+        std::vector<Member> members; // replicas joined to the key
+        std::map<uint64_t, result_t *> pending; // results of the windows not complete yet
+
+        // Constructor
+        Key_Descriptor(): next_win(0) {}
+    };
+    winComb_func_t winComb_func; // combine function
+    std::shared_ptr<HotKey_Registry<key_t>> registry; // registry of the hot keys
+    uint64_t win_len; // window length (in time units)
+    uint64_t slide_len; // slide length (in time units)
+    uint64_t version; // version of the registry used to build the descriptors of the hot keys
+    std::unordered_map<key_t, Key_Descriptor> hotMap; // hash table that maps the hot keys onto their descriptors
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+    uint64_t last_wm; // last watermark sent
+    bool idle_sent; // true if an idle mark has been sent after the last watermark
+    size_t eos_received; // number of EOS received
+
+    // get the identifier of the first window ending after a timestamp (the first one which can contain it)
+    uint64_t getFirstWindow(uint64_t _ts) const
+    {
+        return (_ts < win_len) ? 0 : ((_ts - win_len) / slide_len) + 1;
+    }
+
+    // align the descriptors of the hot keys with the joins published in the registry
+    void refreshHotKeys()
+    {
+        uint64_t v = registry->getVersion();
+        if (v == version) {
+            return;
+        }
+        version = v;
+        for (auto &k: registry->getJoins()) {
+            Key_Descriptor &key_d = hotMap[k.first];
+            for (size_t i=(key_d.members).size(); i<(k.second).size(); i++) {
+                (key_d.members).push_back(Member{(k.second)[i].first, getFirstWindow((k.second)[i].second), -1});
+            }
+        }
+    }
+
+    // check whether all the replicas computing a window of a hot key have sent their results of that window
+    bool isComplete(const Key_Descriptor &_key_d, uint64_t _wid) const
+    {
+        for (auto &m: _key_d.members) {
+            if (m.first_win <= _wid && m.last_win < (int64_t) _wid) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // emit the next result of a hot key
+    void emitNext(Key_Descriptor &_key_d)
+    {
+        auto it = (_key_d.pending).begin();
+        this->ff_send_out((*it).second);
+        _key_d.next_win = (*it).first + 1;
+        (_key_d.pending).erase(it);
+    }
+
+    // send the watermark (not greater than the timestamp of the results not emitted yet)
+    void sendWatermark()
+    {
+        if (!wm_merger.isActive()) {
+            return;
+        }
+        uint64_t wm = wm_merger.get();
+        for (auto &k: hotMap) {
+            if (!((k.second).pending).empty()) {
+                wm = std::min(wm, std::get<2>((((k.second).pending).begin())->second->getControlFields()));
+            }
+        }
+        // the idle mark is sent only if no result is pending
+        if (wm_merger.isIdle() && wm == wm_merger.get()) {
+            idle_sent = true;
+            this->ff_send_out(createIdleMark());
+            return;
+        }
+        if (wm > last_wm || idle_sent) {
+            last_wm = std::max(last_wm, wm);
+            idle_sent = false;
+            this->ff_send_out(createWatermark(last_wm));
+        }
+    }
+
+public:
+    // Constructor
+    KF_Merger(winComb_func_t _winComb_func,
+              std::shared_ptr<HotKey_Registry<key_t>> _registry,
+              uint64_t _win_len,
+              uint64_t _slide_len):
+              winComb_func(_winComb_func),
+              registry(_registry),
+              win_len(_win_len),
+              slide_len(_slide_len),
+              version(0),
+              last_wm(0),
+              idle_sent(false),
+              eos_received(0) {}
+
+    // svc_init method (utilized by the FastFlow runtime)
+    int svc_init() override
+    {
+        return 0;
+    }
+
+    // svc method (utilized by the FastFlow runtime)
+    result_t *svc(result_t *r) override
+    {
+        // watermarks are merged among the input channels and forwarded
+        if (isWatermark(r)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(r))) {
+                sendWatermark();
+            }
+            return this->GO_ON;
+        }
+        // the joins are published before the tuples reach the replicas, so they are known here before their results
+        refreshHotKeys();
+        auto key = std::get<0>(r->getControlFields()); // key
+        uint64_t wid = std::get<1>(r->getControlFields()); // identifier
+        auto it = hotMap.find(key);
+        // the results of the keys not split are emitted directly
+        if (it == hotMap.end()) {
+            this->ff_send_out(r);
+            return this->GO_ON;
         }
         Key_Descriptor &key_d = (*it).second;
-        uint64_t &next_win = key_d.next_win;
-        std::deque<result_t *> &resultsSet = key_d.resultsSet;
-        // add the new result at the correct place
-        if ((wid - next_win) >= resultsSet.size()) {
-            size_t new_size = (wid - next_win) + 1;
-            resultsSet.resize(new_size, nullptr);
-        }
-        resultsSet[wid - next_win] = r;
-        // scan all the buffered results and emit the ones in order
-        auto itr = resultsSet.begin();
-        for (; itr < resultsSet.end(); itr++) {
-            if (*itr != nullptr) {
-                this->ff_send_out(*itr);
-                next_win++;
-            }
-            else break;
-        }
-        // delete the entries of the emitted results
-        resultsSet.erase(resultsSet.begin(), itr);
+        size_t channel = this->get_channel_id();
+        bool counted = true;
+        for (auto &m: key_d.members) {
+            if (m.channel == channel) {
+                m.last_win = std::max(m.last_win, (int64_t) wid);
+                counted = (wid >= m.first_win);
+                break;
+            }
+        }
+        // the results of the windows ending before the join of the replica are empty and they are discarded
+        if (!counted || wid < key_d.next_win) {
+            delete r;
+        }
+        else {
+            auto p = (key_d.pending).find(wid);
+            if (p == (key_d.pending).end()) {
+                (key_d.pending)[wid] = r;
+            }
+            else {
+                result_t *out = new result_t();
+                winComb_func(*((*p).second), *r, *out);
+                out->setControlFields(key, wid, std::max(std::get<2>(r->getControlFields()), std::get<2>(((*p).second)->getControlFields())));
+                delete (*p).second;
+                delete r;
+                (*p).second = out;
+            }
+        }
+        // emit the complete results of the key in order
+        bool emitted = false;
+        while (!(key_d.pending).empty() && isComplete(key_d, ((key_d.pending).begin())->first)) {
+            emitNext(key_d);
+            emitted = true;
+        }
+        // the watermark can advance when the results of a hot key are emitted
+        if (emitted) {
+            sendWatermark();
+        }
         return this->GO_ON;
     }
 
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        eos_received++;
+        wm_merger.close(id, this->get_num_inchannels());
+        if (eos_received < this->get_num_inchannels()) {
+            sendWatermark();
+            return;
+        }
+        // all the results have been received: the pending ones are emitted in order
+        for (auto &k: hotMap) {
+            while (!((k.second).pending).empty()) {
+                emitNext(k.second);
+            }
+        }
+        sendWatermark();
+    }
+
     // svc_end method (utilized by the FastFlow runtime)
     void svc_end() override {}
 };
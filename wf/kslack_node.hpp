@@ -27,18 +27,34 @@
  *  into an internal queue. Data items are dequeued from the queue and emitted in
  *  increasing ordering of timestamp. To enforce this ordering, the node can drop
  *  inputs.
+ *  
+ *  The queue is a radix heap over the timestamps: since the emitted timestamps are
+ *  non-decreasing, inputs older than the last emitted one are dropped when received,
+ *  and the remaining ones are inserted in O(1) and extracted in O(log T) amortized
+ *  time (with T the range of the timestamps).
+ *  
+ *  The slack K is configured by a Slack_Policy: it can either grow with the maximum
+ *  delay observed so far, or it can be periodically estimated (and shrunk) from a
+ *  sliding histogram of the most recent delays given a target drop rate. In both
+ *  cases K can be bounded by a maximum value.
  */ 
 
 #ifndef KSLACK_NODE_H
 #define KSLACK_NODE_H
 
 // includes
-#include<deque>
+#include<array>
+#include<cmath>
+#include<limits>
 #include<vector>
 #include<unordered_map>
 #include<ff/multinode.hpp>
 #include<meta.hpp>
 #include<basic.hpp>
+#include<key_groups.hpp>
+#if defined (TRACE_WINDFLOW)
+    #include<stats_record.hpp>
+#endif
 
 namespace wf {
 
@@ -50,35 +66,154 @@ private:
     tuple_t tmp; // never used
     // key data type
     using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
-    uint64_t K = 0; // K parameter of the slack (of the same time unit of the timestamps)
-    uint64_t tcurr = 0; // highest application timestamp of the inputs seen so far
-    std::deque<input_t *> bufferedInputs; // buffer of inputs waiting to be emitted
-    std::vector<uint64_t> ts_vect; // vector of the last timestamps
-    bool toEmit = false; // true if some inputs must be emitted, false otherwise
-    typename std::deque<input_t *>::iterator first; // iterator to the first input to emit
-    typename std::deque<input_t *>::iterator last; // iterator to the last input to emit
-    // comparator functor (returns true if A comes before B in the ordering)
-    struct Comparator {
-
-        // operator()
-        bool operator() (input_t *wA, input_t *wB) {
-            tuple_t *A = extractTuple<tuple_t, input_t>(wA);
-            tuple_t *B = extractTuple<tuple_t, input_t>(wB);
-            uint64_t ts_A = std::get<2>(A->getControlFields());
-            uint64_t ts_B = std::get<2>(B->getControlFields());
-            if (ts_A < ts_B) {
-                return true;
+    // inner struct of the radix heap of the buffered inputs (keys are timestamps not smaller than the last extracted one)
+    struct Radix_Heap
+    {
+        std::array<std::vector<std::pair<uint64_t, input_t *>>, 65> buckets; // the i-th bucket contains the inputs whose timestamp differs from last in the i-th bit (the highest one)
+        std::array<uint64_t, 65> mins; // smallest timestamp in each bucket
+        uint64_t mask; // bit i-1 is set if the i-th bucket is not empty (for i>0)
+        uint64_t last; // last extracted timestamp
+        size_t size; // number of inputs in the heap
+
+        // Constructor
+        Radix_Heap(): mask(0), last(0), size(0)
+        {
+            mins.fill(std::numeric_limits<uint64_t>::max());
+        }
+
+        // compute the bucket of a timestamp
+        size_t bucket(uint64_t _ts) const
+        {
+            return (_ts == last) ? 0 : 64 - __builtin_clzll(_ts ^ last);
+        }
+
+        // insert an input with a timestamp not smaller than last
+        void push(uint64_t _ts, input_t *_wt)
+        {
+            size_t b = bucket(_ts);
+            buckets[b].push_back(std::make_pair(_ts, _wt));
+            if (_ts < mins[b]) {
+                mins[b] = _ts;
             }
-            else if (ts_A > ts_B) {
-                return false;
+            if (b > 0) {
+                mask |= (((uint64_t) 1) << (b-1));
             }
-            else {
-                assert(A != B);
-                return (A < B); // compare the memory pointers to have a unique ordering!!!
+            size++;
+        }
+
+        // return the smallest timestamp in the heap (the heap must not be empty)
+        uint64_t top() const
+        {
+            return !buckets[0].empty() ? last : mins[__builtin_ctzll(mask) + 1];
+        }
+
+        // remove and return an input with the smallest timestamp (the heap must not be empty)
+        input_t *pop()
+        {
+            if (buckets[0].empty()) {
+                // redistribute the first non-empty bucket around its smallest timestamp
+                size_t b = __builtin_ctzll(mask) + 1;
+                last = mins[b];
+                std::vector<std::pair<uint64_t, input_t *>> items;
+                items.swap(buckets[b]);
+                mins[b] = std::numeric_limits<uint64_t>::max();
+                mask &= ~(((uint64_t) 1) << (b-1));
+                size -= items.size();
+                for (auto &item: items) {
+                    push(item.first, item.second);
+                }
+                // reuse the memory of the bucket
+                items.clear();
+                if (buckets[b].empty()) {
+                    buckets[b].swap(items);
+                }
             }
+            input_t *wt = (buckets[0].back()).second;
+            buckets[0].pop_back();
+            if (buckets[0].empty()) {
+                mins[0] = std::numeric_limits<uint64_t>::max();
+            }
+            size--;
+            return wt;
         }
     };
-    Comparator comparator;
+    // inner struct estimating the quantiles of the most recent delays (log-linear histogram split in two halves of the window)
+    struct Delay_Sketch
+    {
+        std::vector<uint64_t> current; // counters of the delays in the current half of the window
+        std::vector<uint64_t> previous; // counters of the delays in the previous half of the window
+        size_t count_current; // number of delays in the current half
+        size_t count_previous; // number of delays in the previous half
+        size_t half; // number of delays in each half of the window
+
+        // Constructor
+        Delay_Sketch(size_t _window=DEFAULT_SLACK_WINDOW):
+                     current(496, 0),
+                     previous(496, 0),
+                     count_current(0),
+                     count_previous(0),
+                     half(std::max<size_t>(_window/2, 1)) {}
+
+        // compute the bucket of a delay (exact below 16, then eight buckets per power of two)
+        static size_t bucket(uint64_t _d)
+        {
+            if (_d < 16) {
+                return _d;
+            }
+            size_t e = 63 - __builtin_clzll(_d);
+            return 16 + (e-4)*8 + ((_d >> (e-3)) & 7);
+        }
+
+        // return the greatest delay of a bucket
+        static uint64_t upperBound(size_t _b)
+        {
+            if (_b < 16) {
+                return _b;
+            }
+            size_t e = (_b-16)/8 + 4;
+            uint64_t sub = (_b-16) % 8;
+            return ((8 + sub + 1) << (e-3)) - 1; // wraps around to the greatest value for the last bucket
+        }
+
+        // add a delay to the current half (it returns true if the current half is full)
+        bool add(uint64_t _d)
+        {
+            current[bucket(_d)]++;
+            count_current++;
+            return (count_current == half);
+        }
+
+        // estimate the q-quantile of the delays in the window
+        uint64_t quantile(double _q) const
+        {
+            size_t total = count_current + count_previous;
+            size_t target = (size_t) std::ceil(_q * total);
+            size_t seen = 0;
+            for (size_t b=0; b<current.size(); b++) {
+                seen += current[b] + previous[b];
+                if (seen >= target && seen > 0) {
+                    return upperBound(b);
+                }
+            }
+            return upperBound(current.size()-1);
+        }
+
+        // slide the window by discarding the previous half
+        void rotate()
+        {
+            current.swap(previous);
+            std::fill(current.begin(), current.end(), 0);
+            count_previous = count_current;
+            count_current = 0;
+        }
+    };
+    uint64_t K = 0; // K parameter of the slack (of the same time unit of the timestamps)
+    Slack_Policy policy; // policy used to compute K
+    Delay_Sketch sketch; // histogram of the most recent delays (used if the target drop rate is not zero)
+    bool estimated = false; // true if K has been estimated from the histogram at least once
+    uint64_t tcurr = 0; // highest application timestamp of the inputs seen so far
+    uint64_t min_ts = std::numeric_limits<uint64_t>::max(); // smallest timestamp received since tcurr was updated last time
+    Radix_Heap bufferedInputs; // buffer of inputs waiting to be emitted
     long dropped_sample = 0; // number of dropped inputs during the last sample
     long dropped_inputs = 0; // number of dropped inputs during the whole processing
     long received_inputs = 0; // number of received inputs during the whole processing
@@ -88,23 +223,38 @@ private:
     std::atomic<unsigned long> *atomic_num_dropped; // pointer to the atomic counter with the total number of dropped tuples
     std::unordered_map<key_t, long> keyMap; // hash table to map keys onto progressive counters
     volatile long last_update_atomic_usec; // time of the last update of the atomic counter
+    std::unordered_map<size_t, size_t> markers; // number of release markers received for each key group
+    std::vector<std::pair<size_t, uint64_t>> pending_markers; // release markers to be forwarded after the inputs with timestamp not greater than the given one
+#if defined (TRACE_WINDFLOW)
+    Stats_Record stats_record;
+    std::string nameOP = "N/A"; // name of the operator whose replica is preceded by this node
+    std::string nameReplica = "N/A"; // identifier of the replica preceded by this node
+#endif
 
-    // method to insert a new input into the buffer
+    // method to insert a new input into the buffer (it returns true if some inputs can be emitted)
     bool insertInput(input_t *wt)
     {
         // extract the tuple from the input
         tuple_t *t = extractTuple<tuple_t, input_t>(wt);
-        // insert the timestamp of the tuple in the vector
         auto ts = std::get<2>(t->getControlFields());
-        ts_vect.push_back(ts);
-        // insertion of the input in the buffer
-        auto it = std::lower_bound(bufferedInputs.begin(), bufferedInputs.end(), wt, comparator);
-        // add the input in the proper position of the buffer
-        if (it == bufferedInputs.end()) {
-            bufferedInputs.push_back(wt);
+        if (ts < min_ts) {
+            min_ts = ts;
+        }
+        // estimate K from the recent delays (if required by the policy)
+        if (policy.target_drop_rate > 0 && sketch.add((ts < tcurr) ? tcurr - ts : 0)) {
+            K = sketch.quantile(1 - policy.target_drop_rate);
+            sketch.rotate();
+            estimated = true;
+            if (policy.max_slack > 0 && K > policy.max_slack) {
+                K = policy.max_slack;
+            }
+        }
+        // the input cannot be emitted in order, so we drop it
+        if (ts < last_timestamp) {
+            dropInput(wt);
         }
         else {
-            bufferedInputs.insert(it, wt);
+            bufferedInputs.push(ts, wt);
         }
         // check if we can emit some buffered inputs or not
         if (ts <= tcurr) {
@@ -112,56 +262,96 @@ private:
         }
         else {
             tcurr = ts; // update tcurr
-            // find the maximum delay
-            uint64_t max_d = 0;
-            for (auto const &ts_i: ts_vect) {
-                assert(tcurr >= ts_i);
-                uint64_t diff = tcurr - ts_i;
-                if (max_d < diff) {
-                    max_d = diff;
-                }
-            }
-            if (max_d > K) {
+            // the maximum delay is the one of the oldest input received since the last update of tcurr
+            uint64_t max_d = tcurr - min_ts;
+            if (!estimated && max_d > K) {
                 K = max_d; // update K;
+                if (policy.max_slack > 0 && K > policy.max_slack) {
+                    K = policy.max_slack;
+                }
             }
-            // determine the iterator to the last input to emit
-            tuple_t *tmp = new tuple_t(*t);
-            tmp->setControlFields(std::get<0>(t->getControlFields()), std::get<1>(t->getControlFields()), tcurr - K);
-            input_t *tmp_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(tmp, 1);
-            ts_vect.clear(); // empty the vector of timestamps
-            first = bufferedInputs.begin();
-            last = std::lower_bound(bufferedInputs.begin(), bufferedInputs.end(), tmp_wt, comparator);
-            // delete the temporary values created
-            deleteTuple<tuple_t, input_t>(tmp_wt);
-            toEmit = true;
+            min_ts = std::numeric_limits<uint64_t>::max();
             return true;
         }
     }
 
-    // method to get the next input from the buffer
-    input_t *extractInput()
+    // method to emit the buffered input with the smallest timestamp
+    void emitInput()
     {
-        if (!toEmit) {
-            return nullptr;
-        }
-        else if (first == last) {
-            // remove the emitted inputs from the buffer
-            bufferedInputs.erase(bufferedInputs.begin(), last);
-            toEmit = false;
-            return nullptr;
+        uint64_t ts = bufferedInputs.top();
+        input_t *input = bufferedInputs.pop();
+        last_timestamp = ts;
+#if defined (TRACE_WINDFLOW)
+        stats_record.outputs_sent++;
+        stats_record.bytes_sent += sizeof(tuple_t);
+#endif
+        if (mode == ordering_mode_t::TS_RENUMBERING) {
+            tuple_t *t = extractTuple<tuple_t, input_t>(input);
+            auto key = std::get<0>(t->getControlFields()); // key
+            // initialize the corresponding counter
+            auto it = keyMap.find(key);
+            if (it == keyMap.end()) {
+                // create the descriptor of that key
+                it = keyMap.insert(std::make_pair(key, 0)).first;
+            }
+            auto &counter = (*it).second;
+            if (!isSharedTuple<tuple_t, input_t>(input)) {
+                // renumbering in place (no other node still refers to the tuple)
+                t->setControlFields(key, counter++, ts);
+                this->ff_send_out(input);
+            }
+            else {
+                // create the copy of the input
+                tuple_t *copy = new tuple_t(*t);
+                deleteTuple<tuple_t, input_t>(input);
+                copy->setControlFields(key, counter++, ts);
+                auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1);
+                this->ff_send_out(copy_wt);
+            }
         }
         else {
-            input_t *wt = *first;
-            first++;
-            return wt;
+            this->ff_send_out(input);
         }
     }
 
-    // method to prepare the flush of the buffer
-    void prepareToFlush() {
-        toEmit = true;
-        first = bufferedInputs.begin();
-        last = bufferedInputs.end();
+    // method to receive the release marker of a key group (forwarded once received from all the input streams)
+    void insertMarker(input_t *wt)
+    {
+        size_t group = getKeyGroup(wt);
+        size_t &count = markers[group];
+        if (++count == this->get_num_inchannels()) {
+            markers.erase(group);
+            // the buffered tuples of the group have timestamp not greater than tcurr
+            pending_markers.push_back(std::make_pair(group, tcurr));
+        }
+    }
+
+    // method to forward the release markers whose preceding inputs have been emitted
+    void forwardMarkers()
+    {
+        size_t j = 0;
+        for (size_t i=0; i<pending_markers.size(); i++) {
+            if (bufferedInputs.size == 0 || bufferedInputs.top() > pending_markers[i].second) {
+                this->ff_send_out(reinterpret_cast<input_t *>(createKeyGroupMarker(pending_markers[i].first)));
+            }
+            else {
+                pending_markers[j++] = pending_markers[i];
+            }
+        }
+        pending_markers.resize(j);
+    }
+
+    // method to drop an input
+    void dropInput(input_t *wt)
+    {
+#if defined (TRACE_WINDFLOW)
+        stats_record.inputs_ignored++;
+#endif
+        dropped_inputs++;
+        dropped_sample++;
+        updateAtomicDroppedCounter();
+        // delete the input to be dropped
+        deleteTuple<tuple_t, input_t>(wt);
     }
 
 public:
@@ -175,55 +365,63 @@ public:
         last_update_atomic_usec = current_time_usecs();
     }
 
+    // method to set the policy used to compute the slack
+    void setSlackPolicy(Slack_Policy _policy)
+    {
+        policy = _policy;
+        sketch = Delay_Sketch(policy.window);
+    }
+
+#if defined (TRACE_WINDFLOW)
+    // method to set the names used in the statistics of the node
+    void setStatsNames(std::string _nameOP, std::string _nameReplica)
+    {
+        nameOP = _nameOP;
+        nameReplica = _nameReplica;
+    }
+
+    // method to get a pointer to the statistics of the node
+    Stats_Record *get_StatsRecordPtr()
+    {
+        return &stats_record;
+    }
+#endif
+
     // svc_init method (utilized by the FastFlow runtime)
     int svc_init() override {
+#if defined (TRACE_WINDFLOW)
+        stats_record = Stats_Record(nameOP, nameReplica, false, false);
+        stats_record.isSlackNode = true;
+#endif
         return 0;
     }
 
     // svc method (utilized by the FastFlow runtime)
     input_t *svc(input_t *wt) override
     {
-        // add the input to the buffer
-        this->insertInput(wt);
+        if (isKeyGroupMarker(wt)) {
+            insertMarker(wt);
+            forwardMarkers();
+            return this->GO_ON;
+        }
         received_inputs++;
-        // extract tuples from the buffer (likely in order)
-        input_t *input = this->extractInput();
-        while (input != nullptr) {
-            tuple_t *t = extractTuple<tuple_t, input_t>(input);
-            // if the input is not emitted in order we drop it
-            if (std::get<2>(t->getControlFields()) < last_timestamp) {
-                dropped_inputs++;
-                dropped_sample++;
-                updateAtomicDroppedCounter();
-                // delete the input to be dropped
-                deleteTuple<tuple_t, input_t>(input);
+#if defined (TRACE_WINDFLOW)
+        stats_record.inputs_received++;
+        stats_record.bytes_received += sizeof(tuple_t);
+#endif
+        // add the input to the buffer and emit the inputs older than tcurr-K (in order, nothing is older while tcurr is not greater than K)
+        if (this->insertInput(wt)) {
+            while (bufferedInputs.size > 0 && tcurr > K && bufferedInputs.top() < tcurr - K) {
+                this->emitInput();
             }
-            // otherwise, we can send the input
-            else {
-                last_timestamp = std::get<2>(t->getControlFields());
-                if (mode == ordering_mode_t::TS_RENUMBERING) {
-                    auto key = std::get<0>(t->getControlFields()); // key
-                    // initialize the corresponding counter
-                    auto it = keyMap.find(key);
-                    if (it == keyMap.end()) {
-                        // create the descriptor of that key
-                        keyMap.insert(std::make_pair(key, 0));
-                        it = keyMap.find(key);
-                    }
-                    auto &counter = (*it).second;
-                    // create the copy of the input
-                    tuple_t *copy = new tuple_t(*t);
-                    deleteTuple<tuple_t, input_t>(input);
-                    copy->setControlFields(key, counter++, std::get<2>(copy->getControlFields()));
-                    auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1);
-                    this->ff_send_out(copy_wt);
-                }
-                else {
-                    this->ff_send_out(input);
-                }
+            if (!pending_markers.empty()) {
+                forwardMarkers();
             }
-            input = this->extractInput();
         }
+#if defined (TRACE_WINDFLOW)
+        stats_record.slack_K = K;
+        stats_record.slack_buffer_size = bufferedInputs.size;
+#endif
         return this->GO_ON;
     }
 
@@ -236,44 +434,15 @@ public:
             return;
         }
         else {
-            // prepare the buffer to be flushed
-            this->prepareToFlush();
-            input_t *input = this->extractInput();
-            while (input != nullptr) {
-                tuple_t *t = extractTuple<tuple_t, input_t>(input);
-                // if the input is not emitted in order we discard it
-                if (std::get<2>(t->getControlFields()) < last_timestamp) {
-                    dropped_inputs++;
-                    dropped_sample++;
-                    updateAtomicDroppedCounter();
-                    // delete the input to be dropped
-                    deleteTuple<tuple_t, input_t>(input);
-                }
-                else {
-                    last_timestamp = std::get<2>(t->getControlFields());
-                    if (mode == ordering_mode_t::TS_RENUMBERING) {
-                        auto key = std::get<0>(t->getControlFields()); // key
-                        // initialize the corresponding counter
-                        auto it = keyMap.find(key);
-                        if (it == keyMap.end()) {
-                            // create the descriptor of that key
-                            keyMap.insert(std::make_pair(key, 0));
-                            it = keyMap.find(key);
-                        }
-                        auto &counter = (*it).second;
-                        // create the copy of the input
-                        tuple_t *copy = new tuple_t(*t);
-                        deleteTuple<tuple_t, input_t>(input);
-                        copy->setControlFields(key, counter++, std::get<2>(copy->getControlFields()));
-                        auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1);
-                        this->ff_send_out(copy_wt);
-                    }
-                    else {
-                        this->ff_send_out(input);
-                    }
-                }
-                input = this->extractInput();
+            // flush the buffer (in order)
+            while (bufferedInputs.size > 0) {
+                this->emitInput();
             }
+            forwardMarkers();
+#if defined (TRACE_WINDFLOW)
+            stats_record.slack_buffer_size = 0;
+            stats_record.set_Terminated();
+#endif
         }
     }
 
@@ -41,12 +41,17 @@
 #include<ff/multinode.hpp>
 #include<ff/farm.hpp>
 #include<basic.hpp>
+#include<meta.hpp>
 #include<context.hpp>
+#include<shipper.hpp>
+#include<watermark.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
 #endif
 #include<basic_operator.hpp>
 #include<standard_emitter.hpp>
+#include<elastic.hpp>
+#include<ondemand.hpp>
 
 namespace wf {
 
@@ -82,6 +87,12 @@ private:
     size_t parallelism; // internal parallelism of the Map
     bool keyed; // flag stating whether the Map is configured with keyBy or not
     bool used; // true if the Map has been added/chained in a MultiPipe
+    routing_func_t routing_func; // routing function of the key-based distribution (empty if not configured with keyBy)
+    bool keyPreserving; // true if the outputs of the Map keep the keys of the corresponding inputs
+    bool orderPreserving; // true if the outputs of each replica of the Map keep the timestamp order of its inputs
+    std::shared_ptr<Elastic_Controller> elastic; // controller of the active replicas (nullptr if the Map is not elastic)
+    std::shared_ptr<Credit_Table> ondemand; // credits of the replicas (nullptr if the Map does not use the on-demand scheduling)
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
     // class Map_Node
     class Map_Node: public ff::ff_minode_t<tuple_t, result_t>
     {
@@ -96,7 +107,12 @@ private:
         bool isRich; // flag stating whether the function to be used is rich (i.e. it receives the RuntimeContext object)
         RuntimeContext context; // RuntimeContext
         size_t eos_received; // number of received EOS messages
+        Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
         bool terminated; // true if the replica has finished its work
+        Elastic_Replica elastic; // sampler of the busy time of the replica (disabled if the Map is not elastic)
+        OnDemand_Replica ondemand; // credits of the replica (disabled if the Map does not use the on-demand scheduling)
+        Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the Map is not placed by the PipeGraph)
+        Shipper<result_t> *shipper = nullptr; // shipper object used by the timers of the replica to emit results
 #if defined (TRACE_WINDFLOW)
         Stats_Record stats_record;
         double avg_td_us = 0;
@@ -168,15 +184,39 @@ public:
         // svc_init method (utilized by the FastFlow runtime)
         int svc_init() override
         {
+            // bind the replica to its CPU before it allocates its state
+            placement.bind();
 #if defined (TRACE_WINDFLOW)
             stats_record = Stats_Record(name, std::to_string(this->get_my_id()), false, false);
+            stats_record.cpu = placement.getCPU();
+            stats_record.numa_node = placement.getNode();
 #endif
+            // create the shipper object used by the timers of this replica
+            shipper = new Shipper<result_t>(*this);
+            context.setShipper(shipper);
             return 0;
         }
 
         // svc method (utilized by the FastFlow runtime)
         result_t *svc(tuple_t *t) override
         {
+            // execute the callbacks of the expired timers of the replica
+            context.pollTimers();
+            // watermarks are merged among the input channels and forwarded
+            if (isWatermark(t)) {
+                if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(t))) {
+                    this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+                }
+                // a parked replica sleeps once all its input channels are idle (if the Map is elastic)
+                if (wm_merger.isIdle() && elastic.isParked()) {
+                    elastic.park(this->get_num_inchannels());
+                }
+                return this->GO_ON;
+            }
+            // busy time of the replica (one input every DEFAULT_ELASTIC_SAMPLING if the Map is elastic)
+            Elastic_Sample sample(elastic);
+            // the credit of the input is released once it has been processed (if the Map uses the on-demand scheduling)
+            OnDemand_Credit credit(ondemand);
 #if defined (TRACE_WINDFLOW)
             startTS = current_time_nsecs();
             if (stats_record.inputs_received == 0) {
@@ -188,8 +228,9 @@ public:
             stats_record.bytes_sent += sizeof(result_t);
 #endif
             result_t *r;
-            // in-place version
+            // in-place version (a shared envelope of a split is owned with copy-on-write)
             if (isIP) {
+                t = ownInput(t);
                 if (!isRich) {
                     func_ip(*t);
                 }
@@ -198,15 +239,17 @@ public:
                 }
                 r = reinterpret_cast<result_t *>(t);
             }
+            // not in-place version (a shared envelope of a split is read without copying the tuple)
             else {
                 r = new result_t();
+                tuple_t *in = extractTuple<tuple_t, tuple_t>(t);
                 if (!isRich) {
-                    func_nip(*t, *r);
+                    func_nip(*in, *r);
                 }
                 else {
-                    rich_func_nip(*t, *r, context);
+                    rich_func_nip(*in, *r, context);
                 }
-                delete t;
+                deleteTuple<tuple_t, tuple_t>(t);
             }
 #if defined (TRACE_WINDFLOW)
             endTS = current_time_nsecs();
@@ -226,10 +269,16 @@ public:
         void eosnotify(ssize_t id) override
         {
             eos_received++;
+            // the watermark can advance when an input channel is terminated
+            if (wm_merger.close(id, this->get_num_inchannels())) {
+                this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+            }
             // check the number of received EOS messages
             if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
                 return;
             }
+            // last check of the timers of the replica
+            context.pollTimers();
             terminated = true;
 #if defined (TRACE_WINDFLOW)
             stats_record.set_Terminated();
@@ -241,6 +290,26 @@ public:
         {
             // call the closing function
             closing_func(context);
+            // delete the shipper object used by the timers of this replica
+            delete shipper;
+        }
+
+        // method to make the replica part of an elastic operator
+        void enableElasticity(std::shared_ptr<Elastic_Controller> _elastic, size_t _id)
+        {
+            elastic = Elastic_Replica(_elastic, _id);
+        }
+
+        // method to make the replica part of an operator with on-demand scheduling
+        void enableOnDemand(std::shared_ptr<Credit_Table> _ondemand, size_t _id)
+        {
+            ondemand = OnDemand_Replica(_ondemand, _id);
+        }
+
+        // method to set the CPU and NUMA node of the replica
+        void setPlacement(Placement_Replica _placement)
+        {
+            placement = _placement;
         }
 
         // method the check the termination of the replica
@@ -266,30 +335,57 @@ public:
      *  \param _parallelism internal parallelism of the Map operator
      *  \param _name name of the Map operator
      *  \param _closing_func closing function
+     *  \param _keyPreserving true if the outputs keep the keys of the corresponding inputs
+     *  \param _orderPreserving true if the outputs of each replica keep the timestamp order of its inputs
+     *  \param _elastic controller of the active replicas (nullptr if the Map is not elastic)
+     *  \param _credits number of credits per replica of the on-demand scheduling (zero to use the pseudo round-robin distribution)
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     template<typename F_t>
     Map(F_t _func,
         size_t _parallelism,
         std::string _name, 
-        closing_func_t _closing_func):
+        closing_func_t _closing_func,
+        bool _keyPreserving=false,
+        bool _orderPreserving=false,
+        std::shared_ptr<Elastic_Controller> _elastic=nullptr,
+        size_t _credits=0,
+        std::vector<int> _cpus={}):
         name(_name),
         parallelism(_parallelism),
         keyed(false),
-        used(false)
+        used(false),
+        keyPreserving(_keyPreserving),
+        orderPreserving(_orderPreserving),
+        elastic(_elastic),
+        ondemand((_credits > 0) ? std::make_shared<Credit_Table>(_parallelism, _credits) : nullptr),
+        cpus(_cpus)
     {
         // check the validity of the parallelism value
         if (_parallelism == 0) {
             std::cerr << RED << "WindFlow Error: Map has parallelism zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // check the controller of the active replicas
+        if (_elastic != nullptr && _elastic->getMaxParallelism() != _parallelism) {
+            std::cerr << RED << "WindFlow Error: controller of the active replicas of the Map has a wrong number of replicas" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // the replicas of an elastic operator receive the inputs in round-robin
+        if (_elastic != nullptr && _credits > 0) {
+            std::cerr << RED << "WindFlow Error: elastic Map cannot use the on-demand scheduling" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // vector of Map_Node
         std::vector<ff_node *> w;
         for (size_t i=0; i<_parallelism; i++) {
             auto *seq = new Map_Node(_func, _name, RuntimeContext(_parallelism, i), _closing_func);
+            seq->enableElasticity(_elastic, i);
+            seq->enableOnDemand(ondemand, i);
             w.push_back(seq);
         }
         // add emitter
-        ff::ff_farm::add_emitter(new Standard_Emitter<tuple_t>(_parallelism));
+        ff::ff_farm::add_emitter(new Standard_Emitter<tuple_t>(_parallelism, _elastic, ondemand));
         // add workers
         ff::ff_farm::add_workers(w);
         // add default collector
@@ -306,23 +402,49 @@ public:
      *  \param _name name of the Map operator
      *  \param _closing_func closing function
      *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to parallelism-1
+     *  \param _keyPreserving true if the outputs keep the keys of the corresponding inputs
+     *  \param _orderPreserving true if the outputs of each replica keep the timestamp order of its inputs
+     *  \param _elastic controller of the active replicas (nullptr if the Map is not elastic)
+     *  \param _credits number of credits per replica of the on-demand scheduling (must be zero, it is not supported with keyBy)
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     template<typename F_t>
     Map(F_t _func,
         size_t _parallelism,
         std::string _name,
         closing_func_t _closing_func, 
-        routing_func_t _routing_func):
+        routing_func_t _routing_func,
+        bool _keyPreserving=false,
+        bool _orderPreserving=false,
+        std::shared_ptr<Elastic_Controller> _elastic=nullptr,
+        size_t _credits=0,
+        std::vector<int> _cpus={}):
         name(_name),
         parallelism(_parallelism),
         keyed(true),
-        used(false)
+        used(false),
+        routing_func(_routing_func),
+        keyPreserving(_keyPreserving),
+        orderPreserving(_orderPreserving),
+        elastic(_elastic),
+        ondemand(nullptr),
+        cpus(_cpus)
     {
         // check the validity of the parallelism value
         if (_parallelism == 0) {
             std::cerr << RED << "WindFlow Error: Map has parallelism zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the replicas of an elastic operator receive the inputs in round-robin
+        if (_elastic != nullptr) {
+            std::cerr << RED << "WindFlow Error: Map with keyBy cannot be elastic" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // the replicas receive the inputs of their keys only
+        if (_credits > 0) {
+            std::cerr << RED << "WindFlow Error: Map with keyBy cannot use the on-demand scheduling" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // vector of Map_Node
         std::vector<ff_node *> w;
         for (size_t i=0; i<_parallelism; i++) {
@@ -380,6 +502,72 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Return the routing function of the key-based distribution to the Map
+     *  \return routing function (empty if the Map is not configured with keyBy)
+     */ 
+    routing_func_t getRoutingFunction() const override
+    {
+        return routing_func;
+    }
+
+    /** 
+     *  \brief Check whether the outputs of the Map keep the keys of the corresponding inputs
+     *  \return true if the keys are preserved
+     */ 
+    bool isKeyPreserving() const override
+    {
+        return keyPreserving;
+    }
+
+    /** 
+     *  \brief Check whether the outputs of each replica of the Map keep the timestamp order of its inputs
+     *  \return true if the timestamp order is preserved
+     */ 
+    bool isOrderPreserving() const override
+    {
+        return orderPreserving;
+    }
+
+    /** 
+     *  \brief Check whether the Map is elastic
+     *  \return true if the number of active replicas can be changed at runtime
+     */ 
+    bool isElastic() const
+    {
+        return elastic != nullptr;
+    }
+
+    /** 
+     *  \brief Get the controller of the active replicas of the Map
+     *  \return controller of the active replicas (nullptr if the Map is not elastic)
+     */ 
+    std::shared_ptr<Elastic_Controller> getElasticController() const
+    {
+        return elastic;
+    }
+
+    /** 
+     *  \brief Check whether the Map uses the on-demand scheduling
+     *  \return true if the inputs are sent to the replicas with the shortest queues
+     */ 
+    bool isOnDemand() const
+    {
+        return ondemand != nullptr;
+    }
+
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        auto placements = _manager.assign(name, this->getWorkers().size(), cpus);
+        for (size_t i=0; i<placements.size(); i++) {
+            static_cast<Map_Node *>(this->getWorkers()[i])->setPlacement(placements[i]);
+        }
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
@@ -448,13 +636,17 @@ public:
         writer.Uint(parallelism);
         writer.Key("Replicas");
         writer.StartArray();
+        std::vector<uint64_t> inputs; // inputs received by the replicas
         // get statistics from all the replicas of the operator
         for(auto *w: this->getWorkers()) {
             auto *node = static_cast<Map_Node *>(w);
             Stats_Record record = node->get_StatsRecord();
             record.append_Stats(writer);
+            inputs.push_back(record.inputs_received);
         }
         writer.EndArray();
+        writer.Key("Replica_imbalance");
+        writer.Double(compute_imbalance(inputs));
         writer.EndObject();
     }
 #endif
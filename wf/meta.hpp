@@ -31,6 +31,7 @@
 
 // includes
 #include<atomic>
+#include<bitset>
 #if __cplusplus < 201703L // not C++17
     #include<experimental/optional>
     namespace std { using namespace experimental; } // ugly but necessary until CUDA will support C++17!
@@ -494,6 +495,24 @@ typename std::enable_if<std::is_integral<Ret>::value, Arg>::type get_tuple_t_Spl
 template<typename Ret, typename Arg> // non-const version
 typename std::enable_if<std::is_integral<Ret>::value, Arg>::type get_tuple_t_Split(std::vector<Ret> (*)(Arg&));
 
+template<typename F_t, size_t N, typename Arg> // const version
+Arg get_tuple_t_Split(std::bitset<N> (F_t::*)(const Arg&) const);
+
+template<typename F_t, size_t N, typename Arg> // const version
+Arg get_tuple_t_Split(std::bitset<N> (F_t::*)(const Arg&));
+
+template<size_t N, typename Arg> // const version
+Arg get_tuple_t_Split(std::bitset<N> (*)(const Arg&));
+
+template<typename F_t, size_t N, typename Arg> // non-const version
+Arg get_tuple_t_Split(std::bitset<N> (F_t::*)(Arg&) const);
+
+template<typename F_t, size_t N, typename Arg> // non-const version
+Arg get_tuple_t_Split(std::bitset<N> (F_t::*)(Arg&));
+
+template<size_t N, typename Arg> // non-const version
+Arg get_tuple_t_Split(std::bitset<N> (*)(Arg&));
+
 template<typename F_t>
 decltype(get_tuple_t_Split(&F_t::operator())) get_tuple_t_Split(F_t);
 
@@ -536,6 +555,24 @@ typename std::enable_if<std::is_integral<Ret>::value, std::vector<Ret>>::type ge
 template<typename Ret, typename Arg> // non-const version
 typename std::enable_if<std::is_integral<Ret>::value, std::vector<Ret>>::type get_result_t_Split(std::vector<Ret> (*)(Arg&));
 
+template<typename F_t, size_t N, typename Arg> // const version
+std::bitset<N> get_result_t_Split(std::bitset<N> (F_t::*)(const Arg&) const);
+
+template<typename F_t, size_t N, typename Arg> // const version
+std::bitset<N> get_result_t_Split(std::bitset<N> (F_t::*)(const Arg&));
+
+template<size_t N, typename Arg> // const version
+std::bitset<N> get_result_t_Split(std::bitset<N> (*)(const Arg&));
+
+template<typename F_t, size_t N, typename Arg> // non-const version
+std::bitset<N> get_result_t_Split(std::bitset<N> (F_t::*)(Arg&) const);
+
+template<typename F_t, size_t N, typename Arg> // non-const version
+std::bitset<N> get_result_t_Split(std::bitset<N> (F_t::*)(Arg&));
+
+template<size_t N, typename Arg> // non-const version
+std::bitset<N> get_result_t_Split(std::bitset<N> (*)(Arg&));
+
 template<typename F_t>
 decltype(get_result_t_Split(&F_t::operator())) get_result_t_Split(F_t);
 
@@ -724,6 +761,25 @@ decltype(get_result_t_Comb(&F_t::operator())) get_result_t_Comb(F_t);
 std::false_type get_result_t_Comb(...); // black hole
 /*****************************************************************************************************************************/
 
+/****************************************************** EARLY RESULTS ********************************************************/
+// declaration of functions to check whether the result type provides the setEarly(bool) method
+template<typename T>
+auto check_early_t(T *_r) -> decltype(_r->setEarly(true), std::true_type());
+
+std::false_type check_early_t(...); // black hole
+
+// function markResult: definition valid if the result type provides the setEarly(bool) method
+template<typename result_t>
+typename std::enable_if<decltype(check_early_t((result_t *) nullptr))::value, void>::type markResult(result_t &_r, bool _early)
+{
+    _r.setEarly(_early);
+}
+
+// function markResult: definition valid if the result type does not provide the setEarly(bool) method
+template<typename result_t>
+typename std::enable_if<!decltype(check_early_t((result_t *) nullptr))::value, void>::type markResult(result_t &_r, bool _early) {}
+/*****************************************************************************************************************************/
+
 /***************************************** SPECIAL FUNCTIONS FOR NESTING OF OPERATORS ****************************************/
 // declaration of functions to extract the type of Win_Farm from the Pane_Farm operator provided to the builder
 template<typename ...Args>
@@ -781,6 +837,49 @@ struct wrapper_tuple_t
                     counter(_counter),
                     eos(_eos) {}
 };
+
+// function createSharedInput: wrap a tuple sent to several destinations into a shared envelope (encoded with the second lowest bit of the pointer set)
+template<typename tuple_t>
+tuple_t *createSharedInput(tuple_t *_t, size_t _n_dest)
+{
+    wrapper_tuple_t<tuple_t> *wt = new wrapper_tuple_t<tuple_t>(_t, _n_dest);
+    return reinterpret_cast<tuple_t *>(reinterpret_cast<uintptr_t>(wt) | 2);
+}
+
+// function isSharedInput: check whether a pointer received by a node is a shared envelope
+inline bool isSharedInput(const void *_p)
+{
+    uintptr_t v = reinterpret_cast<uintptr_t>(_p);
+    return ((v & 3) == 2) && ((v >> 63) == 0);
+}
+
+// function getSharedInput: decode the wrapper of a shared envelope
+template<typename tuple_t>
+wrapper_tuple_t<tuple_t> *getSharedInput(const void *_p)
+{
+    return reinterpret_cast<wrapper_tuple_t<tuple_t> *>(reinterpret_cast<uintptr_t>(_p) & ~((uintptr_t) 2));
+}
+
+// function ownInput: take the ownership of an input that can be modified (a shared envelope is copied only if other destinations still refer to it)
+template<typename tuple_t>
+tuple_t *ownInput(tuple_t *_t)
+{
+    if (!isSharedInput(_t)) {
+        return _t;
+    }
+    wrapper_tuple_t<tuple_t> *wt = getSharedInput<tuple_t>(_t);
+    tuple_t *t = wt->tuple;
+    // the last holder takes the tuple, the other ones a copy of it
+    if ((wt->counter).load() > 1) {
+        t = new tuple_t(*t);
+        if ((wt->counter).fetch_sub(1) > 1) {
+            return t;
+        }
+        delete wt->tuple;
+    }
+    delete wt;
+    return t;
+}
 /*****************************************************************************************************************************/
 
 /***************************************************** UTILITY FUNCTIONS *****************************************************/
@@ -795,7 +894,8 @@ T1 *extractTuple(typename std::enable_if<!std::is_same<T1,T2>::value, T2>::type
 template <typename T1, typename T2>
 T1 *extractTuple(typename std::enable_if<std::is_same<T1,T2>::value, T2>::type *t)
 {
-    return t;
+    // the input can be a shared envelope sent by a splitting emitter
+    return isSharedInput(t) ? getSharedInput<T1>(t)->tuple : t;
 }
 
 // function deleteTuple: definition valid if T1 != T2
@@ -815,7 +915,27 @@ void deleteTuple(typename std::enable_if<!std::is_same<T1,T2>::value, T2>::type
 template <typename T1, typename T2>
 void deleteTuple(typename std::enable_if<std::is_same<T1,T2>::value, T2>::type *t)
 {
-    delete t;
+    if (isSharedInput(t)) {
+        deleteTuple<T1, wrapper_tuple_t<T1>>(getSharedInput<T1>(t));
+    }
+    else {
+        delete t;
+    }
+}
+
+// function isSharedTuple: definition valid if T1 != T2
+template <typename T1, typename T2>
+bool isSharedTuple(typename std::enable_if<!std::is_same<T1,T2>::value, T2>::type *wt)
+{
+    // the tuple is shared if other holders of the wrapper still have to delete it
+    return (wt->counter).load() > 1;
+}
+
+// function isSharedTuple: definition valid if T1 == T2
+template <typename T1, typename T2>
+bool isSharedTuple(typename std::enable_if<std::is_same<T1,T2>::value, T2>::type *t)
+{
+    return isSharedInput(t) && isSharedTuple<T1, wrapper_tuple_t<T1>>(getSharedInput<T1>(t));
 }
 
 // function createWrapper: definition valid if T2 != T3
@@ -58,6 +58,7 @@
 #include<basic_operator.hpp>
 #include<transformations.hpp>
 #include<standard_emitter.hpp>
+#include<combining_emitter.hpp>
 #include<splitting_emitter.hpp>
 #include<broadcast_emitter.hpp>
 
@@ -116,12 +117,17 @@ private:
     std::vector<MultiPipe *> splittingChildren; // vector of children MultiPipe instances (meaningful if isSplit is true)
     bool forceShuffling; // true if the next operator that will be added to the MultiPipe is forced to generate a shuffle connection
     size_t lastParallelism; // parallelism of the last operator added to the MultiPipe (0 if not defined)
+    size_t partitioningDegree; // number of key-based partitions of the stream produced by the last operator (0 if the stream is not partitioned)
+    std::function<size_t(size_t, size_t)> partitioningFunc; // routing function of the key-based partitioning (meaningful if partitioningDegree > 0)
+    bool orderedByTS; // true if each replica of the last operator produces its outputs in timestamp order
     std::string outputType; // string representing the type of the outputs from this MultiPipe (the empty string if not defined yet)
 #if defined (TRACE_WINDFLOW)
     Agraph_t *gv_graph = nullptr; // pointer to the graphviz representation of the sorrounding PipeGraph
     std::vector<std::string> gv_last_typeOPs; // list of the last chained operator types
     std::vector<std::string> gv_last_nameOPs; // list of the last chained operator names
     std::vector<Agnode_t *> gv_last_vertices; // list of the last graphviz vertices
+    bool gv_elidedShuffle = false; // true if the key-based distribution to the last added operator has been elided
+    bool gv_elidedReordering = false; // true if the reordering of the inputs of the last added operator has been elided
 #endif
 
     // Private Constructor I (to create an empty MultiPipe)
@@ -143,6 +149,8 @@ private:
               splittingBranches(0),
               forceShuffling(false),
               lastParallelism(0),
+              partitioningDegree(0),
+              orderedByTS(false),
               outputType("") {}
 
     // Private Constructor II (to create a MultiPipe resulting from the merge of other MultiPipe instances)
@@ -163,6 +171,8 @@ private:
               splittingBranches(0),
               forceShuffling(true), // <-- we force a shuffle connection for the next operator
               lastParallelism(0),
+              partitioningDegree(0),
+              orderedByTS(false),
               outputType("")
     {
         // create the initial matrioska
@@ -199,6 +209,11 @@ private:
             std::cerr << RED << "WindFlow Error: Source has already been defined for the MultiPipe" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // check the use of watermarks
+        if (_source.withWatermarks && mode != Mode::DEFAULT) {
+            std::cerr << RED << "WindFlow Error: watermarks can be generated by a Source only in DEFAULT mode" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // create the initial matrioska
         ff::ff_a2a *matrioska = new ff::ff_a2a();
         std::vector<ff::ff_node *> first_set;
@@ -219,6 +234,8 @@ private:
         last = matrioska;
         // save parallelism of the operator
         lastParallelism = workers.size();
+        // in DETERMINISTIC mode each Source replica generates its outputs in timestamp order
+        orderedByTS = (mode == Mode::DETERMINISTIC);
         // save the output type from this MultiPipe
         tuple_t t;
         outputType = typeid(t).name();
@@ -231,9 +248,25 @@ private:
         return *this;
     }
 
-    // method to add an operator to the MultiPipe
+    // method to configure the node preceding a replica of an operator (generic node)
+    template<typename collector_t>
+    void configure_collector(collector_t *_collector, ff::ff_farm *_op, size_t _idx) {}
+
+    // method to configure the node preceding a replica of an operator (KSlack_Node)
+    template<typename tuple_t, typename input_t>
+    void configure_collector(KSlack_Node<tuple_t, input_t> *_collector, ff::ff_farm *_op, size_t _idx)
+    {
+        _collector->setSlackPolicy(get_slack_policy_func(graph));
+#if defined (TRACE_WINDFLOW)
+        Basic_Operator *op = dynamic_cast<Basic_Operator *>(_op);
+        _collector->setStatsNames((op != nullptr) ? op->getName() : "N/A", std::to_string(_idx));
+        add_slack_stats_func(graph, _collector->get_StatsRecordPtr());
+#endif
+    }
+
+    // method to add an operator to the MultiPipe (_reordering is false if the workers must receive the inputs as produced, e.g. the KF_Merger nodes)
     template<typename emitter_t, typename collector_t=dummy_mi>
-    void add_operator(ff::ff_farm *_op, routing_modes_t _type, ordering_mode_t _ordering=ordering_mode_t::TS)
+    void add_operator(ff::ff_farm *_op, routing_modes_t _type, ordering_mode_t _ordering=ordering_mode_t::TS, bool _reordering=true)
         {
         // check the Source presence
         if (!has_source) {
@@ -264,8 +297,9 @@ private:
             for (size_t i=0; i<workers.size(); i++) {
                 ff::ff_pipeline *stage = new ff::ff_pipeline();
                 stage->add_stage(workers[i], false);
-                if (mode != Mode::DEFAULT) {
+                if (mode != Mode::DEFAULT && _reordering) {
                     collector_t *collector = new collector_t(_ordering, atomic_num_dropped);
+                    configure_collector(collector, _op, i);
                     combine_with_firststage(*stage, collector, true); // add the ordering_node / kslack_node
                 }
                 first_set.push_back(stage);
@@ -280,6 +314,11 @@ private:
             last = matrioska;
             // save parallelism of the operator
             lastParallelism = workers.size();
+            // update the properties of the stream (the splitting emitter uses the emitter of the operator)
+            update_properties(_op, _type, (mode != Mode::DEFAULT), (_type == routing_modes_t::KEYBY));
+#if defined (TRACE_WINDFLOW)
+            add_plan_func(graph, get_operator_name(_op), "SPLITTING", (mode != Mode::DEFAULT && _reordering) ? "INSERTED" : "NONE");
+#endif
             // save what is needed for splitting with the parent MultiPipe
             Basic_Emitter *be = static_cast<Basic_Emitter *>(_op->getEmitter());
             assert(splittingParent != nullptr); // redundant check
@@ -288,8 +327,16 @@ private:
         }
         size_t n1 = (last->getFirstSet()).size();
         size_t n2 = (_op->getWorkers()).size();
+        // the key-based distribution is redundant if the stream is already partitioned in the same way
+        bool elideShuffle = (_type == routing_modes_t::KEYBY) && isPartitionedAs(_op, n2);
+        // the reordering is redundant if the inputs come from a single replica producing them in timestamp order
+        bool elideReordering = (mode != Mode::DEFAULT) && (_ordering == ordering_mode_t::TS) && (n1 == 1) && orderedByTS && (!forceShuffling);
+#if defined (TRACE_WINDFLOW)
+        gv_elidedShuffle = false;
+        gv_elidedReordering = false;
+#endif
         // Case 2: direct connection
-        if ((n1 == n2) && (_type == routing_modes_t::FORWARD) && (!forceShuffling)) {
+        if ((n1 == n2) && (_type == routing_modes_t::FORWARD || elideShuffle) && (!forceShuffling)) {
             auto first_set = last->getFirstSet();
             auto worker_set = _op->getWorkers();
             // add the operator's workers to the pipelines in the first set of the matrioska
@@ -297,6 +344,12 @@ private:
                 ff::ff_pipeline *stage = static_cast<ff::ff_pipeline *>(first_set[i]);
                 stage->add_stage(worker_set[i], false);
             }
+            // update the properties of the stream (the inputs of the operator are the ones of the stream)
+            update_properties(_op, _type, orderedByTS, true);
+#if defined (TRACE_WINDFLOW)
+            gv_elidedShuffle = elideShuffle;
+            add_plan_func(graph, get_operator_name(_op), elideShuffle ? "DIRECT (KEYBY elided)" : "DIRECT", "NONE");
+#endif
         }
         // Case 3: shuffle connection
         else {
@@ -314,8 +367,9 @@ private:
             for (size_t i=0; i<n2; i++) {
                 ff::ff_pipeline *stage = new ff::ff_pipeline();
                 stage->add_stage(worker_set[i], false);
-                if (mode != Mode::DEFAULT || _ordering == ordering_mode_t::ID) {
+                if ((mode != Mode::DEFAULT || _ordering == ordering_mode_t::ID) && !elideReordering && _reordering) {
                     collector_t *collector = new collector_t(_ordering, atomic_num_dropped);
+                    configure_collector(collector, _op, i);
                     combine_with_firststage(*stage, collector, true); // add the ordering_node / kslack_node
                 }
                 first_set.push_back(stage);
@@ -335,11 +389,71 @@ private:
             if (forceShuffling) {
                 forceShuffling = false;
             }
+            // update the properties of the stream (the inputs of the operator are partitioned by its emitter if it is key-based)
+            update_properties(_op, _type, (mode != Mode::DEFAULT), (_type == routing_modes_t::KEYBY));
+#if defined (TRACE_WINDFLOW)
+            gv_elidedReordering = elideReordering;
+            std::string reordering = "NONE";
+            if (elideReordering) {
+                reordering = "ELIDED";
+            }
+            else if ((mode != Mode::DEFAULT || _ordering == ordering_mode_t::ID) && _reordering) {
+                reordering = "INSERTED";
+            }
+            add_plan_func(graph, get_operator_name(_op), "SHUFFLE", reordering);
+#endif
         }
         // save parallelism of the operator
         lastParallelism = n2;   
     }
 
+    // method to check whether the stream is partitioned as required by the key-based distribution to an operator
+    bool isPartitionedAs(ff::ff_farm *_op, size_t _n)
+    {
+        Basic_Operator *op = dynamic_cast<Basic_Operator *>(_op);
+        if (op == nullptr || forceShuffling || partitioningDegree != _n) {
+            return false;
+        }
+        // the reordering cannot be skipped if the stream is not already ordered
+        if (mode != Mode::DEFAULT && !orderedByTS) {
+            return false;
+        }
+        return isSameRouting(partitioningFunc, op->getRoutingFunction());
+    }
+
+    // method to update the properties of the stream after the addition of an operator
+    void update_properties(ff::ff_farm *_op, routing_modes_t _type, bool _orderedInputs, bool _partitionedInputs)
+    {
+        Basic_Operator *op = dynamic_cast<Basic_Operator *>(_op);
+        // window-based operators do not produce their results in timestamp order and with the keys of the inputs
+        if (op == nullptr || _type == routing_modes_t::COMPLEX) {
+            partitioningDegree = 0;
+            orderedByTS = false;
+            return;
+        }
+        // the user functions can change the timestamps, so the order is kept only if the operator declares it
+        orderedByTS = _orderedInputs && op->isOrderPreserving();
+        if (!op->isKeyPreserving()) {
+            partitioningDegree = 0;
+        }
+        else if (_type == routing_modes_t::KEYBY && _partitionedInputs) {
+            partitioningDegree = (_op->getWorkers()).size();
+            partitioningFunc = op->getRoutingFunction();
+        }
+        else if (_type != routing_modes_t::FORWARD || !_partitionedInputs) {
+            partitioningDegree = 0;
+        }
+    }
+
+#if defined (TRACE_WINDFLOW)
+    // method to get the name of an operator
+    std::string get_operator_name(ff::ff_farm *_op)
+    {
+        Basic_Operator *op = dynamic_cast<Basic_Operator *>(_op);
+        return (op != nullptr) ? op->getName() : "N/A";
+    }
+#endif
+
     // method to chain an operator with the previous one in the MultiPipe
     template<typename worker_t>
     bool chain_operator(ff::ff_farm *_op)
@@ -382,6 +496,11 @@ private:
             }
             // save parallelism of the operator (not necessary: n1 is equal to n2)
             lastParallelism = n2;
+            // update the properties of the stream
+            update_properties(_op, routing_modes_t::FORWARD, orderedByTS, true);
+#if defined (TRACE_WINDFLOW)
+            add_plan_func(graph, get_operator_name(_op), "CHAINED", "NONE");
+#endif
             return true;
         }
         else {
@@ -548,16 +667,27 @@ private:
         for (auto *vertex: this->gv_last_vertices) {
             Agedge_t *e = agedge(gv_graph, vertex, node, 0, 1);
             // set the label of the edge
+            std::string label;
             if (routing_type == routing_modes_t::FORWARD) {
-                agset(e, const_cast<char *>("label"), const_cast<char *>("FW"));
+                label = "FW";
             }
             else if (routing_type == routing_modes_t::KEYBY) {
-                agset(e, const_cast<char *>("label"), const_cast<char *>("KB"));
+                label = gv_elidedShuffle ? "KB (FW)" : "KB";
             }
             else if (routing_type == routing_modes_t::COMPLEX) {
-                agset(e, const_cast<char *>("label"), const_cast<char *>("CMX"));
+                label = "CMX";
+            }
+            if (gv_elidedReordering) {
+                label = label + " (no reorder)";
+            }
+            agset(e, const_cast<char *>("label"), const_cast<char *>(label.c_str()));
+            // elided shuffles and reorderings are shown with dashed edges
+            if (gv_elidedShuffle || gv_elidedReordering) {
+                agset(e, const_cast<char *>("style"), const_cast<char *>("dashed"));
             }
         }
+        gv_elidedShuffle = false;
+        gv_elidedReordering = false;
         // adjust gv_last_* vectors
         (this->gv_last_vertices).clear();
         (this->gv_last_typeOPs).clear();
@@ -693,6 +823,24 @@ public:
             std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the Filter operator" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the parked replicas of an elastic operator do not produce outputs, which would hold back the reordering in the other modes
+        if (_filter.isElastic()) {
+            if (mode != Mode::DEFAULT) {
+                std::cerr << RED << "WindFlow Error: elastic Filter operator can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            // the inputs are distributed to the active replicas by the emitter of the operator
+            forceShuffling = true;
+        }
+        // the replicas with an Ordering_Node in front of them could keep the credits of their inputs while waiting for the other channels
+        if (_filter.isOnDemand()) {
+            if (mode != Mode::DEFAULT) {
+                std::cerr << RED << "WindFlow Error: Filter operator with on-demand scheduling can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            // the inputs are distributed to the replicas by the emitter of the operator
+            forceShuffling = true;
+        }
         // call the generic method to add the operator to the MultiPipe
         if (mode == Mode::DETERMINISTIC) {
             add_operator<Standard_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_filter, _filter.getRoutingMode(), ordering_mode_t::TS);
@@ -738,7 +886,7 @@ public:
             exit(EXIT_FAILURE);
         }
         // try to chain the operator with the MultiPipe
-        if (_filter.getRoutingMode() != routing_modes_t::KEYBY) {
+        if (_filter.getRoutingMode() != routing_modes_t::KEYBY && !_filter.isElastic() && !_filter.isOnDemand()) {
             bool chained = chain_operator<typename Filter<tuple_t, result_t>::Filter_Node>(&_filter);
             if (!chained) {
                 add(_filter);
@@ -783,6 +931,24 @@ public:
             std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the Map operator" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the parked replicas of an elastic operator do not produce outputs, which would hold back the reordering in the other modes
+        if (_map.isElastic()) {
+            if (mode != Mode::DEFAULT) {
+                std::cerr << RED << "WindFlow Error: elastic Map operator can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            // the inputs are distributed to the active replicas by the emitter of the operator
+            forceShuffling = true;
+        }
+        // the replicas with an Ordering_Node in front of them could keep the credits of their inputs while waiting for the other channels
+        if (_map.isOnDemand()) {
+            if (mode != Mode::DEFAULT) {
+                std::cerr << RED << "WindFlow Error: Map operator with on-demand scheduling can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            // the inputs are distributed to the replicas by the emitter of the operator
+            forceShuffling = true;
+        }
         // call the generic method to add the operator to the MultiPipe
         if (mode == Mode::DETERMINISTIC) {
             add_operator<Standard_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_map, _map.getRoutingMode(), ordering_mode_t::TS);
@@ -828,7 +994,7 @@ public:
             exit(EXIT_FAILURE);
         }
         // try to chain the operator with the MultiPipe
-        if (_map.getRoutingMode() != routing_modes_t::KEYBY) {
+        if (_map.getRoutingMode() != routing_modes_t::KEYBY && !_map.isElastic() && !_map.isOnDemand()) {
             bool chained = chain_operator<typename Map<tuple_t, result_t>::Map_Node>(&_map);
             if (!chained) {
                 add(_map);
@@ -873,6 +1039,24 @@ public:
             std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the FlatMap operator" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the parked replicas of an elastic operator do not produce outputs, which would hold back the reordering in the other modes
+        if (_flatmap.isElastic()) {
+            if (mode != Mode::DEFAULT) {
+                std::cerr << RED << "WindFlow Error: elastic FlatMap operator can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            // the inputs are distributed to the active replicas by the emitter of the operator
+            forceShuffling = true;
+        }
+        // the replicas with an Ordering_Node in front of them could keep the credits of their inputs while waiting for the other channels
+        if (_flatmap.isOnDemand()) {
+            if (mode != Mode::DEFAULT) {
+                std::cerr << RED << "WindFlow Error: FlatMap operator with on-demand scheduling can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            // the inputs are distributed to the replicas by the emitter of the operator
+            forceShuffling = true;
+        }
         // call the generic method to add the operator
         if (mode == Mode::DETERMINISTIC) {
             add_operator<Standard_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_flatmap, _flatmap.getRoutingMode(), ordering_mode_t::TS);
@@ -917,7 +1101,7 @@ public:
             std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the FlatMap operator" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
-        if (_flatmap.getRoutingMode() != routing_modes_t::KEYBY) {
+        if (_flatmap.getRoutingMode() != routing_modes_t::KEYBY && !_flatmap.isElastic() && !_flatmap.isOnDemand()) {
             bool chained = chain_operator<typename FlatMap<tuple_t, result_t>::FlatMap_Node>(&_flatmap);
             if (!chained) {
                 add(_flatmap);
@@ -962,8 +1146,30 @@ public:
             std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the Accumulator operator" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the key groups are assigned to the replicas at runtime, so the shuffle cannot be elided
+        if (_acc.hasKeyGroups()) {
+            forceShuffling = true;
+        }
+        // the parked replicas of an elastic operator do not produce outputs, which would hold back the reordering in the other modes
+        if (_acc.isElastic() && mode != Mode::DEFAULT) {
+            std::cerr << RED << "WindFlow Error: elastic Accumulator operator can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // call the generic method to add the operator to the MultiPipe
-        if (mode == Mode::DETERMINISTIC) {
+        if (_acc.isCombinerUsed()) {
+            // the replicas receive the partial results from the combiners, so the shuffle cannot be elided
+            forceShuffling = true;
+            if (mode == Mode::DETERMINISTIC) {
+                add_operator<Combining_Emitter<tuple_t, result_t>, Ordering_Node<result_t>>(&_acc, routing_modes_t::KEYBY, ordering_mode_t::TS);
+            }
+            else if (mode == Mode::PROBABILISTIC) {
+                add_operator<Combining_Emitter<tuple_t, result_t>, KSlack_Node<result_t>>(&_acc, routing_modes_t::KEYBY, ordering_mode_t::TS);
+            }
+            else {
+                add_operator<Combining_Emitter<tuple_t, result_t>>(&_acc, routing_modes_t::KEYBY);
+            }
+        }
+        else if (mode == Mode::DETERMINISTIC) {
             add_operator<Standard_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_acc, routing_modes_t::KEYBY, ordering_mode_t::TS);
         }
         else if (mode == Mode::PROBABILISTIC) {
@@ -1004,6 +1210,11 @@ public:
             std::cerr << RED << "WindFlow Error: Win_Farm cannot use count-based windows in DEFAULT mode" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the owners append the tuples to the shared archive in timestamp order
+        if (_wf.isSharedArchive() && mode == Mode::DEFAULT) {
+            std::cerr << RED << "WindFlow Error: Win_Farm with the shared archive cannot be used in DEFAULT mode" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // check the type compatibility
         tuple_t t;
         std::string opInType = typeid(t).name();
@@ -1373,6 +1584,11 @@ public:
             std::cerr << RED << "WindFlow Error: Key_Farm operator has already been used in a MultiPipe" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the parked replicas of an elastic operator do not produce outputs, which would hold back the reordering in the other modes
+        if (_kf.isElastic() && mode != Mode::DEFAULT) {
+            std::cerr << RED << "WindFlow Error: elastic Key_Farm operator can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // count-based windows and DEFAULT mode possible only without complex nested structures
         if (_kf.getWinType() == win_type_t::CB && mode == Mode::DEFAULT) {
             if (!_kf.isComplexNesting()) {
@@ -1555,6 +1771,11 @@ public:
             // update the graphviz representation
             gv_add_vertex("KF (" + std::to_string(_kf.getParallelism()) + ")", _kf.getName(), true, false, routing_modes_t::KEYBY);
 #endif
+            // hot-key splitting: the partial results are combined by the KF_Merger nodes (each key by the same node), which
+            // identify the replicas of the Key_Farm by their input channels, so no reordering node is inserted before them
+            if (_kf.isHotKeySplitting()) {
+                add_operator<Standard_Emitter<result_t>>((_kf.merge_stage).get(), routing_modes_t::KEYBY, ordering_mode_t::TS, false);
+            }
         }
         // save the new output type from this MultiPipe
         result_t r;
@@ -1784,6 +2005,11 @@ public:
             std::cerr << RED << "WindFlow Error: Key_FFAT operator has already been used in a MultiPipe" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the parked replicas of an elastic operator do not produce outputs, which would hold back the reordering in the other modes
+        if (_kff.isElastic() && mode != Mode::DEFAULT) {
+            std::cerr << RED << "WindFlow Error: elastic Key_FFAT operator can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // prepare the operator for count-based windows
         if (_kff.getWinType() == win_type_t::CB) {
             // set the isRenumbering mode of the input operator
@@ -1797,7 +2023,19 @@ public:
             exit(EXIT_FAILURE);
         }
         // call the generic method to add the operator to the MultiPipe
-        if (_kff.getWinType() == win_type_t::TB) {
+        if (_kff.isCombinerUsed()) {
+            // the replicas receive the partial results from the combiners
+            if (mode == Mode::DETERMINISTIC) {
+                add_operator<Combining_Emitter<tuple_t, result_t>, Ordering_Node<result_t>>(&_kff, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+            }
+            else if (mode == Mode::PROBABILISTIC) {
+                add_operator<Combining_Emitter<tuple_t, result_t>, KSlack_Node<result_t>>(&_kff, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+            }
+            else {
+                add_operator<Combining_Emitter<tuple_t, result_t>>(&_kff, routing_modes_t::COMPLEX);
+            }
+        }
+        else if (_kff.getWinType() == win_type_t::TB) {
             if (mode == Mode::DETERMINISTIC) {
                 add_operator<KF_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_kff, routing_modes_t::COMPLEX, ordering_mode_t::TS);
             }
@@ -1833,6 +2071,205 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Add a Win_FFAT to the MultiPipe
+     *  \param _wff Win_FFAT operator to be added
+     *  \return the modified MultiPipe
+     */ 
+    template<typename tuple_t, typename result_t>
+    MultiPipe &add(Win_FFAT<tuple_t, result_t> &_wff)
+    {
+        // check whether the operator has already been used in a MultiPipe
+        if (_wff.isUsed()) {
+            std::cerr << RED << "WindFlow Error: Win_FFAT operator has already been used in a MultiPipe" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // count-based windows with Win_FFAT cannot be used in DEFAULT mode
+        if (_wff.getWinType() == win_type_t::CB && mode == Mode::DEFAULT) {
+            std::cerr << RED << "WindFlow Error: Win_FFAT cannot use count-based windows in DEFAULT mode" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the type compatibility
+        tuple_t t;
+        std::string opInType = typeid(t).name();
+        if (!outputType.empty() && outputType.compare(opInType) != 0) {
+            std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the Win_FFAT operator" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // call the generic method to add the operator to the MultiPipe
+        if (_wff.getWinType() == win_type_t::TB) {
+            if (mode == Mode::DETERMINISTIC) {
+                add_operator<WF_Emitter<tuple_t>, Ordering_Node<tuple_t, wrapper_tuple_t<tuple_t>>>(&_wff, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+            }
+            else if (mode == Mode::PROBABILISTIC) {
+                add_operator<WF_Emitter<tuple_t>, KSlack_Node<tuple_t, wrapper_tuple_t<tuple_t>>>(&_wff, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+            }
+            else {
+                add_operator<WF_Emitter<tuple_t>>(&_wff, routing_modes_t::COMPLEX);
+            }
+        }
+        else {
+            // special case count-based windows
+            _wff.change_emitter(new Broadcast_Emitter<tuple_t>(_wff.getParallelism()), true);
+            // call the generic method to add the operator to the MultiPipe
+            if (mode == Mode::DETERMINISTIC) {
+                add_operator<Broadcast_Emitter<tuple_t>, Ordering_Node<tuple_t, wrapper_tuple_t<tuple_t>>>(&_wff, routing_modes_t::COMPLEX, ordering_mode_t::TS_RENUMBERING);
+            }
+            else {
+                add_operator<Broadcast_Emitter<tuple_t>, KSlack_Node<tuple_t, wrapper_tuple_t<tuple_t>>>(&_wff, routing_modes_t::COMPLEX, ordering_mode_t::TS_RENUMBERING);
+            }
+        }
+        // save the new output type from this MultiPipe
+        result_t r;
+        outputType = typeid(r).name();
+        // the Win_FFAT operator is now used
+        _wff.used = true;
+        // add this operator to listOperators
+        listOperators->push_back(std::ref(static_cast<Basic_Operator &>(_wff)));
+#if defined (TRACE_WINDFLOW)
+        // update the graphviz representation
+        gv_add_vertex("WFF (" + std::to_string(_wff.getParallelism()) + ")", _wff.getName(), true, false, routing_modes_t::COMPLEX);
+#endif
+        return *this;
+    }
+
+    /** 
+     *  \brief Add a Key_MFFAT to the MultiPipe
+     *  \param _kmff Key_MFFAT operator to be added
+     *  \return the modified MultiPipe
+     */ 
+    template<typename tuple_t, typename result_t>
+    MultiPipe &add(Key_MFFAT<tuple_t, result_t> &_kmff)
+    {
+        // check whether the operator has already been used in a MultiPipe
+        if (_kmff.isUsed()) {
+            std::cerr << RED << "WindFlow Error: Key_MFFAT operator has already been used in a MultiPipe" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the type compatibility
+        tuple_t t;
+        std::string opInType = typeid(t).name();
+        if (!outputType.empty() && outputType.compare(opInType) != 0) {
+            std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the Key_MFFAT operator" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // call the generic method to add the operator to the MultiPipe (time-based windows only)
+        if (mode == Mode::DETERMINISTIC) {
+            add_operator<KF_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_kmff, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+        }
+        else if (mode == Mode::PROBABILISTIC) {
+            add_operator<KF_Emitter<tuple_t>, KSlack_Node<tuple_t>>(&_kmff, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+        }
+        else {
+            add_operator<KF_Emitter<tuple_t>>(&_kmff, routing_modes_t::COMPLEX);
+        }
+        // save the new output type from this MultiPipe
+        result_t r;
+        outputType = typeid(r).name();
+        // the Key_MFFAT operator is now used
+        _kmff.used = true;
+        // add this operator to listOperators
+        listOperators->push_back(std::ref(static_cast<Basic_Operator &>(_kmff)));
+#if defined (TRACE_WINDFLOW)
+        // update the graphviz representation
+        gv_add_vertex("KMFF (" + std::to_string(_kmff.getParallelism()) + ")", _kmff.getName(), true, false, routing_modes_t::KEYBY);
+#endif
+        return *this;
+    }
+
+    /** 
+     *  \brief Add a Key_Rollup to the MultiPipe
+     *  \param _kr Key_Rollup operator to be added
+     *  \return the modified MultiPipe
+     */ 
+    template<typename tuple_t, typename result_t>
+    MultiPipe &add(Key_Rollup<tuple_t, result_t> &_kr)
+    {
+        // check whether the operator has already been used in a MultiPipe
+        if (_kr.isUsed()) {
+            std::cerr << RED << "WindFlow Error: Key_Rollup operator has already been used in a MultiPipe" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the type compatibility
+        tuple_t t;
+        std::string opInType = typeid(t).name();
+        if (!outputType.empty() && outputType.compare(opInType) != 0) {
+            std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the Key_Rollup operator" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // call the generic method to add the operator to the MultiPipe (time-based windows only)
+        if (mode == Mode::DETERMINISTIC) {
+            add_operator<KF_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_kr, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+        }
+        else if (mode == Mode::PROBABILISTIC) {
+            add_operator<KF_Emitter<tuple_t>, KSlack_Node<tuple_t>>(&_kr, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+        }
+        else {
+            add_operator<KF_Emitter<tuple_t>>(&_kr, routing_modes_t::COMPLEX);
+        }
+        // save the new output type from this MultiPipe
+        result_t r;
+        outputType = typeid(r).name();
+        // the Key_Rollup operator is now used
+        _kr.used = true;
+        // add this operator to listOperators
+        listOperators->push_back(std::ref(static_cast<Basic_Operator &>(_kr)));
+#if defined (TRACE_WINDFLOW)
+        // update the graphviz representation
+        gv_add_vertex("KROLL (" + std::to_string(_kr.getParallelism()) + ")", _kr.getName(), true, false, routing_modes_t::KEYBY);
+#endif
+        return *this;
+    }
+
+    /** 
+     *  \brief Add a Key_Session to the MultiPipe
+     *  \param _ks Key_Session operator to be added
+     *  \return the modified MultiPipe
+     */ 
+    template<typename tuple_t, typename result_t>
+    MultiPipe &add(Key_Session<tuple_t, result_t> &_ks)
+    {
+        // check whether the operator has already been used in a MultiPipe
+        if (_ks.isUsed()) {
+            std::cerr << RED << "WindFlow Error: Key_Session operator has already been used in a MultiPipe" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the type compatibility
+        tuple_t t;
+        std::string opInType = typeid(t).name();
+        if (!outputType.empty() && outputType.compare(opInType) != 0) {
+            std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the Key_Session operator" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // with out-of-order inputs, the sessions bridged by a tuple must be merged
+        if (mode == Mode::DEFAULT && _ks.triggering_delay > 0 && !_ks.mergeable) {
+            std::cerr << RED << "WindFlow Error: Key_Session with an incremental function needs a combine function (withCombine) in the DEFAULT mode with a triggering delay" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // call the generic method to add the operator to the MultiPipe (time-based sessions only)
+        if (mode == Mode::DETERMINISTIC) {
+            add_operator<KF_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_ks, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+        }
+        else if (mode == Mode::PROBABILISTIC) {
+            add_operator<KF_Emitter<tuple_t>, KSlack_Node<tuple_t>>(&_ks, routing_modes_t::COMPLEX, ordering_mode_t::TS);
+        }
+        else {
+            add_operator<KF_Emitter<tuple_t>>(&_ks, routing_modes_t::COMPLEX);
+        }
+        // save the new output type from this MultiPipe
+        result_t r;
+        outputType = typeid(r).name();
+        // the Key_Session operator is now used
+        _ks.used = true;
+        // add this operator to listOperators
+        listOperators->push_back(std::ref(static_cast<Basic_Operator &>(_ks)));
+#if defined (TRACE_WINDFLOW)
+        // update the graphviz representation
+        gv_add_vertex("KS (" + std::to_string(_ks.getParallelism()) + ")", _ks.getName(), true, false, routing_modes_t::KEYBY);
+#endif
+        return *this;
+    }
+
     /** 
      *  \brief Add a Key_FFAT_GPU to the MultiPipe
      *  \param _kff Key_FFAT_GPU operator to be added
@@ -2399,6 +2836,19 @@ public:
             std::cerr << RED << "WindFlow Error: output type from MultiPipe is not the input type of the Sink operator" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the inputs are distributed to the active replicas of an elastic Sink by its emitter
+        if (_sink.isElastic()) {
+            forceShuffling = true;
+        }
+        // the replicas with an Ordering_Node in front of them could keep the credits of their inputs while waiting for the other channels
+        if (_sink.isOnDemand()) {
+            if (mode != Mode::DEFAULT) {
+                std::cerr << RED << "WindFlow Error: Sink operator with on-demand scheduling can be used in DEFAULT mode only" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            // the inputs are distributed to the replicas by the emitter of the Sink
+            forceShuffling = true;
+        }
         // call the generic method to add the operator to the MultiPipe
         if (mode == Mode::DETERMINISTIC) {
             add_operator<Standard_Emitter<tuple_t>, Ordering_Node<tuple_t>>(&_sink, _sink.getRoutingMode(), ordering_mode_t::TS);
@@ -2444,7 +2894,7 @@ public:
             exit(EXIT_FAILURE);
         }
         // try to chain the Sink with the MultiPipe
-        if (_sink.getRoutingMode() != routing_modes_t::KEYBY) {
+        if (_sink.getRoutingMode() != routing_modes_t::KEYBY && !_sink.isElastic() && !_sink.isOnDemand()) {
             bool chained = chain_operator<typename Sink<tuple_t>::Sink_Node>(&_sink);
             if (!chained) {
                 return add_sink(_sink);
@@ -2512,7 +2962,8 @@ public:
     }
 
     /** 
-     *  \brief Split of this into a set of MultiPipe instances
+     *  \brief Split of this into a set of MultiPipe instances (an input sent to several MultiPipe
+     *         instances is shared by them, and it is copied only by the ones modifying it)
      *  \param _splitting_func splitting logic
      *  \param _cardinality number of splitting MultiPipe instances to generate from this
      *  \return the MultiPipe this after the splitting
@@ -2552,6 +3003,18 @@ public:
         return *this;
     }
 
+    /** 
+     *  \brief Split of this into a set of MultiPipe instances based on the key of the inputs
+     *  \param _cardinality number of splitting MultiPipe instances to generate from this
+     *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to _cardinality-1
+     *  \return the MultiPipe this after the splitting
+     */ 
+    template<typename tuple_t>
+    MultiPipe &split_by_key(size_t _cardinality, std::function<size_t(size_t, size_t)> _routing_func=default_routing)
+    {
+        return split(Key_Splitter<tuple_t>(_cardinality, _routing_func), _cardinality);
+    }
+
     /** 
      *  \brief Select a MultiPipe upon the splitting of this
      *  \param _idx index of the MultiPipe to be selected
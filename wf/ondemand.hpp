@@ -0,0 +1,243 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+
+/** 
+ *  @file    ondemand.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    13/11/2020
+ *  
+ *  @brief On-demand scheduling of the inputs of a stateless operator
+ *  
+ *  @section Credit_Table (Description)
+ *  
+ *  This file implements the Credit_Table class shared by the emitters and the replicas
+ *  of a stateless operator (Map, Filter, FlatMap and Sink without key-based routing)
+ *  configured with the on-demand scheduling. Each replica has a bounded number of
+ *  credits, and an input can be sent to a replica only by acquiring one of its credits,
+ *  which is released by the replica once the input has been processed. The number of
+ *  credits in use is the length of the queue of the replica (plus the input being
+ *  processed).
+ *  
+ *  The emitters send each input to the replica with the shortest queue among the ones
+ *  with a free credit (ties are broken in round-robin), and they wait only when all the
+ *  credits are in use. In this way, a replica slowed down by costly inputs does not
+ *  accumulate a queue while the other ones are idle, as it happens with the pseudo
+ *  round-robin distribution of FastFlow.
+ */ 
+
+#ifndef ONDEMAND_H
+#define ONDEMAND_H
+
+/// includes
+#include<atomic>
+#include<memory>
+#include<thread>
+#include<vector>
+#include<basic.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Credit_Table
+ *  
+ *  \brief Credits of the replicas of an operator with on-demand scheduling
+ *  
+ *  This class implements the table of the credits of the replicas of an operator with
+ *  on-demand scheduling, shared by its emitters and replicas.
+ */ 
+class Credit_Table
+{
+private:
+    // struct of the credits of a replica (each one in its own cache line)
+    struct alignas(64) Replica_Credits
+    {
+        std::atomic<uint64_t> used; // number of credits in use (inputs sent and not processed yet)
+
+        // Constructor
+        Replica_Credits(): used(0) {}
+    };
+    std::vector<Replica_Credits> replicas; // credits of the replicas
+    uint64_t credits; // number of credits per replica
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _n_replicas number of replicas of the operator
+     *  \param _credits number of credits per replica
+     */ 
+    Credit_Table(size_t _n_replicas,
+                 uint64_t _credits=DEFAULT_ONDEMAND_CREDITS):
+                 replicas(std::max<size_t>(_n_replicas, 1)),
+                 credits(std::max<uint64_t>(_credits, 1)) {}
+
+    /** 
+     *  \brief Get the number of replicas
+     *  
+     *  \return number of replicas of the operator
+     */ 
+    size_t getNumReplicas() const
+    {
+        return replicas.size();
+    }
+
+    /** 
+     *  \brief Get the number of credits per replica
+     *  
+     *  \return number of credits per replica
+     */ 
+    uint64_t getCredits() const
+    {
+        return credits;
+    }
+
+    /** 
+     *  \brief Get the number of credits in use of a replica
+     *  
+     *  \param _replica identifier of the replica
+     *  \return number of inputs sent to the replica and not processed yet
+     */ 
+    uint64_t getUsed(size_t _replica) const
+    {
+        return replicas[_replica].used.load(std::memory_order_relaxed);
+    }
+
+    // try to acquire a credit of a replica
+    bool tryAcquire(size_t _replica)
+    {
+        uint64_t used = replicas[_replica].used.load(std::memory_order_relaxed);
+        while (used < credits) {
+            if (replicas[_replica].used.compare_exchange_weak(used, used + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // release a credit of a replica
+    void release(size_t _replica)
+    {
+        replicas[_replica].used.fetch_sub(1, std::memory_order_release);
+    }
+};
+
+// class OnDemand_Router (used by each emitter of an operator with on-demand scheduling)
+class OnDemand_Router
+{
+private:
+    std::shared_ptr<Credit_Table> table; // table of the credits (nullptr if the on-demand scheduling is not used)
+    size_t dest; // last destination
+    uint64_t n_waits; // number of times all the credits were in use
+
+public:
+    // Constructor
+    OnDemand_Router(std::shared_ptr<Credit_Table> _table=nullptr):
+                    table(_table),
+                    dest(0),
+                    n_waits(0) {}
+
+    // check whether the on-demand scheduling is used
+    bool isEnabled() const
+    {
+        return table != nullptr;
+    }
+
+    // get the destination of the next input (the replica with the shortest queue among the ones with a free credit)
+    size_t route()
+    {
+        size_t n = table->getNumReplicas();
+        while (true) {
+            // the scan starts after the last destination to break the ties in round-robin
+            size_t best = n;
+            uint64_t best_used = table->getCredits();
+            for (size_t i=1; i<=n; i++) {
+                size_t r = (dest + i) % n;
+                uint64_t used = table->getUsed(r);
+                if (used < best_used) {
+                    best = r;
+                    best_used = used;
+                    if (used == 0) {
+                        break;
+                    }
+                }
+            }
+            // the credit can be taken by another emitter in the meanwhile
+            if (best < n && table->tryAcquire(best)) {
+                dest = best;
+                return dest;
+            }
+            if (best == n) {
+                n_waits++;
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // get the number of times all the credits were in use
+    uint64_t getNumWaits() const
+    {
+        return n_waits;
+    }
+};
+
+// class OnDemand_Replica (used by each replica of an operator with on-demand scheduling)
+class OnDemand_Replica
+{
+private:
+    std::shared_ptr<Credit_Table> table; // table of the credits (nullptr if the on-demand scheduling is not used)
+    size_t id; // identifier of the replica
+
+public:
+    // Constructor
+    OnDemand_Replica(std::shared_ptr<Credit_Table> _table=nullptr,
+                     size_t _id=0):
+                     table(_table),
+                     id(_id) {}
+
+    // check whether the on-demand scheduling is used
+    bool isEnabled() const
+    {
+        return table != nullptr;
+    }
+
+    // release the credit of a processed input
+    void release()
+    {
+        if (table != nullptr) {
+            table->release(id);
+        }
+    }
+};
+
+// struct OnDemand_Credit (credit of an input released when it goes out of scope)
+struct OnDemand_Credit
+{
+    OnDemand_Replica &replica; // replica processing the input
+
+    // Constructor
+    OnDemand_Credit(OnDemand_Replica &_replica): replica(_replica) {}
+
+    // Destructor
+    ~OnDemand_Credit()
+    {
+        replica.release();
+    }
+};
+
+} // namespace wf
+
+#endif
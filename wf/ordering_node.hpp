@@ -27,18 +27,25 @@
  *  in order from each distinct input stream. The node reorders items and emits
  *  them in increasing order. The node can be configured to order either by unique
  *  identifiers or by timestamps.
+ *  
+ *  Since each input stream is already sorted, the node performs a k-way merge of
+ *  per-stream FIFO queues driven by a tournament tree, which costs O(log k) for
+ *  each emitted item (with k the number of input streams).
  */ 
 
 #ifndef ORDERING_NODE_H
 #define ORDERING_NODE_H
 
 // includes
-#include<deque>
-#include<queue>
+#include<limits>
+#include<memory>
+#include<vector>
 #include<unordered_map>
 #include<ff/multinode.hpp>
 #include<meta.hpp>
 #include<basic.hpp>
+#include<watermark.hpp>
+#include<key_groups.hpp>
 
 namespace wf {
 
@@ -50,29 +57,154 @@ private:
     tuple_t tmp; // never used
     // key data type
     using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
-    // comparator functor (returns true if A comes before B in the ordering)
-    struct Comparator {
-        // ordering mode
-        ordering_mode_t mode;
+    // inner struct of the FIFO queue of the inputs received from an input stream
+    struct Channel_Queue
+    {
+        std::vector<std::pair<uint64_t, input_t *>> buffer; // circular buffer of identifiers/timestamps and inputs (capacity is a power of two)
+        size_t head; // position of the first input in the buffer
+        size_t size; // number of inputs in the buffer
+        uint64_t max; // greatest identifier/timestamp received from the input stream
+
+        // Constructor
+        Channel_Queue(): head(0), size(0), max(0) {}
+
+        // append an input (its identifier/timestamp cannot be smaller than the ones already in the queue)
+        void push(uint64_t _id, input_t *_wt)
+        {
+            if (size == buffer.size()) {
+                // double the capacity by moving the inputs in a new buffer
+                std::vector<std::pair<uint64_t, input_t *>> tmp_buffer(std::max<size_t>(2 * buffer.size(), 4));
+                for (size_t i=0; i<size; i++) {
+                    tmp_buffer[i] = buffer[(head + i) & (buffer.size() - 1)];
+                }
+                buffer.swap(tmp_buffer);
+                head = 0;
+            }
+            buffer[(head + size) & (buffer.size() - 1)] = std::make_pair(_id, _wt);
+            size++;
+        }
+
+        // return the identifier/timestamp of the first input in the queue
+        uint64_t front_id() const
+        {
+            return buffer[head].first;
+        }
+
+        // return the first input of the queue
+        input_t *front() const
+        {
+            return buffer[head].second;
+        }
+
+        // remove and return the first input of the queue
+        input_t *pop()
+        {
+            input_t *wt = buffer[head].second;
+            head = (head + 1) & (buffer.size() - 1);
+            size--;
+            return wt;
+        }
+    };
+    // inner struct merging the input streams with a tournament tree
+    struct KWay_Merger
+    {
+        std::vector<Channel_Queue> channels; // one FIFO queue per input stream
+        std::vector<size_t> tree; // tree[1] is the winner, tree[n..2n-1] are the leaves (one per input stream)
 
         // Constructor
-        Comparator(ordering_mode_t _mode): mode(_mode) {}
+        KWay_Merger(size_t _n):
+                    channels(_n),
+                    tree(2 * _n, 0)
+        {
+            for (size_t i=0; i<_n; i++) {
+                tree[_n + i] = i;
+            }
+            for (size_t i=_n; i>1; i--) {
+                tree[i-1] = winner(tree[2*(i-1)], tree[2*(i-1)+1]);
+            }
+        }
 
-        // operator()
-        bool operator() (input_t *wA, input_t *wB) {
-            tuple_t *A = extractTuple<tuple_t, input_t>(wA);
-            tuple_t *B = extractTuple<tuple_t, input_t>(wB);
-            uint64_t id_A = (mode == ordering_mode_t::ID) ? std::get<1>(A->getControlFields()) : std::get<2>(A->getControlFields());
-            uint64_t id_B = (mode == ordering_mode_t::ID) ? std::get<1>(B->getControlFields()) : std::get<2>(B->getControlFields());
-            if (id_A > id_B) {
-                return true;
+        // return the stream to be considered first between the two ones (a stream with an empty queue
+        // is represented by its greatest identifier/timestamp, and it loses ties with non-empty queues)
+        size_t winner(size_t a, size_t b) const
+        {
+            const Channel_Queue &A = channels[a];
+            const Channel_Queue &B = channels[b];
+            uint64_t id_A = (A.size > 0) ? A.front_id() : A.max;
+            uint64_t id_B = (B.size > 0) ? B.front_id() : B.max;
+            if (id_A != id_B) {
+                return (id_A < id_B) ? a : b;
             }
-            else if (id_A < id_B) {
-                return false;
+            else if ((A.size > 0) != (B.size > 0)) {
+                return (A.size > 0) ? a : b;
             }
             else {
-                assert(A != B);
-                return (A > B); // compare the memory pointers to have a unique ordering!!!
+                return (a < b) ? a : b;
+            }
+        }
+
+        // replay the matches from the leaf of a stream up to the root
+        void replay(size_t _ch)
+        {
+            size_t n = channels.size();
+            for (size_t i=(n + _ch)/2; i>=1; i/=2) {
+                tree[i] = winner(tree[2*i], tree[2*i+1]);
+            }
+        }
+
+        // add an input received from a stream
+        void push(size_t _ch, uint64_t _id, input_t *_wt)
+        {
+            Channel_Queue &q = channels[_ch];
+            q.max = _id;
+            q.push(_id, _wt);
+            // the key of the leaf changes only if the queue was empty
+            if (q.size == 1) {
+                replay(_ch);
+            }
+        }
+
+        // check whether the first input in the merged order can be emitted
+        bool hasNext() const
+        {
+            return channels[tree[1]].size > 0;
+        }
+
+        // remove and return the first input in the merged order
+        input_t *pop()
+        {
+            size_t ch = tree[1];
+            input_t *wt = channels[ch].pop();
+            replay(ch);
+            return wt;
+        }
+
+        // return the non-empty stream with the smallest identifier/timestamp in front of its queue (-1 if all the queues are empty)
+        ssize_t firstNonEmpty() const
+        {
+            ssize_t first = -1;
+            for (size_t i=0; i<channels.size(); i++) {
+                if (channels[i].size > 0 && (first < 0 || channels[i].front_id() < channels[first].front_id())) {
+                    first = i;
+                }
+            }
+            return first;
+        }
+
+        // remove and return the first input of a given stream
+        input_t *pop(size_t _ch)
+        {
+            input_t *wt = channels[_ch].pop();
+            replay(_ch);
+            return wt;
+        }
+
+        // all the streams are terminated, so all the buffered inputs can be emitted
+        void close()
+        {
+            for (size_t i=0; i<channels.size(); i++) {
+                channels[i].max = std::numeric_limits<uint64_t>::max();
+                replay(i);
             }
         }
     };
@@ -80,39 +212,98 @@ private:
     struct Key_Descriptor
     {
         uint64_t emit_counter; // progressive counter (used if mode is TS_RENUMBERING)
-        std::vector<uint64_t> maxs; // maxs[i] contains the greatest identifier/timestamp received from the i-th input stream
         input_t *eos_marker; // pointer to the most recent EOS marker of this key
-        // ordered queue of tuples of the given key received by the node
-        std::priority_queue<input_t *, std::deque<input_t *>, Comparator> queue;
+        KWay_Merger merger; // merger of the tuples of the given key received by the node (used if mode is ID)
 
         // Constructor
-        Key_Descriptor(size_t _n,
-                       ordering_mode_t _mode):
+        Key_Descriptor(size_t _n):
                        emit_counter(0),
-                       maxs(_n, 0),
                        eos_marker(nullptr),
-                       queue(Comparator(_mode)) {}
+                       merger(_n) {}
     };
     // hash table that maps key identifiers onto key descriptors
     std::unordered_map<key_t, Key_Descriptor> keyMap;
     size_t eos_received; // number of received EOS messages
     ordering_mode_t mode; // ordering mode
-    // variables for correcting the bug (temporarily)
-    std::priority_queue<input_t *, std::deque<input_t *>, Comparator> globalQueue;
-    std::vector<uint64_t> globalMaxs;
+    std::unique_ptr<KWay_Merger> globalMerger; // merger of all the tuples regardless the key (used if mode is TS or TS_RENUMBERING)
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input streams
+    std::unordered_map<size_t, size_t> markers; // number of release markers of each key group emitted in the merged order
+
+    // emit an input (renumbering it if required)
+    void emit(input_t *wnext, bool isEOS=false)
+    {
+        // the release marker of a key group is forwarded once, after the tuples preceding it in all the streams
+        if (isKeyGroupMarker(wnext)) {
+            size_t &count = markers[getKeyGroup(wnext)];
+            if (++count == this->get_num_inchannels()) {
+                markers.erase(getKeyGroup(wnext));
+                this->ff_send_out(wnext);
+            }
+            return;
+        }
+        if (mode != ordering_mode_t::TS_RENUMBERING) {
+            this->ff_send_out(wnext);
+            return;
+        }
+        tuple_t *next = extractTuple<tuple_t, input_t>(wnext);
+        auto key = std::get<0>(next->getControlFields());
+        Key_Descriptor &key_d = (*(keyMap.find(key))).second;
+        uint64_t ts = std::get<2>(next->getControlFields());
+        if (!isSharedTuple<tuple_t, input_t>(wnext)) {
+            // renumbering in place (no other node still refers to the tuple)
+            next->setControlFields(key, key_d.emit_counter++, ts);
+            this->ff_send_out(wnext);
+        }
+        else {
+            tuple_t *copy = new tuple_t(*next); // copy of the tuple
+            deleteTuple<tuple_t, input_t>(wnext);
+            copy->setControlFields(key, key_d.emit_counter++, ts);
+            auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1, isEOS);
+            this->ff_send_out(copy_wt);
+        }
+    }
+
+    // emit the buffered inputs with timestamp smaller than the watermark: all the streams have already delivered
+    // the inputs preceding them, since identifiers and timestamps of the inputs of the same key grow together
+    void releaseUntil(KWay_Merger &_merger, uint64_t _wm)
+    {
+        ssize_t ch = _merger.firstNonEmpty();
+        while (ch >= 0) {
+            input_t *front = (_merger.channels[ch]).front();
+            uint64_t ts = isKeyGroupMarker(front) ? (_merger.channels[ch]).front_id() : std::get<2>(extractTuple<tuple_t, input_t>(front)->getControlFields());
+            if (ts >= _wm) {
+                break;
+            }
+            emit(_merger.pop(ch));
+            ch = _merger.firstNonEmpty();
+        }
+    }
+
+    // manage the advance of the watermark
+    void processWatermark(uint64_t _wm)
+    {
+        if (mode == ordering_mode_t::ID) {
+            for (auto &k: keyMap) {
+                releaseUntil((k.second).merger, _wm);
+            }
+        }
+        else {
+            releaseUntil(*globalMerger, _wm);
+        }
+        this->ff_send_out(reinterpret_cast<input_t *>(wm_merger.createPunctuation(_wm)));
+    }
 
 public:
     // Constructor
     Ordering_Node(ordering_mode_t _mode=ordering_mode_t::ID, std::atomic<unsigned long> *_atomic_num_dropped=nullptr):
                   eos_received(0),
-                  mode(_mode),
-                  globalQueue(Comparator(_mode)) {}
+                  mode(_mode) {}
 
     // svc_init method (utilized by the FastFlow runtime)
     int svc_init() override
     {
-        for (size_t i=0; i<this->get_num_inchannels(); i++) {
-            globalMaxs.push_back(0);
+        if (mode != ordering_mode_t::ID) {
+            globalMerger = std::make_unique<KWay_Merger>(this->get_num_inchannels());
         }
         return 0;
     }
@@ -120,6 +311,27 @@ public:
     // svc method (utilized by the FastFlow runtime)
     input_t *svc(input_t *wr) override
     {
+        // watermarks are merged among the input streams and forwarded
+        if (isWatermark(wr)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(wr))) {
+                processWatermark(wm_merger.get());
+            }
+            return this->GO_ON;
+        }
+        // release markers of the key groups follow the inputs already received from their stream
+        if (isKeyGroupMarker(wr)) {
+            if (mode != ordering_mode_t::ID) {
+                size_t source_id = this->get_channel_id();
+                globalMerger->push(source_id, (globalMerger->channels[source_id]).max, wr);
+                while (globalMerger->hasNext()) {
+                    emit(globalMerger->pop());
+                }
+            }
+            else {
+                emit(wr);
+            }
+            return this->GO_ON;
+        }
         // extract the key and id/ts from the input tuple
         tuple_t *r = extractTuple<tuple_t, input_t>(wr);
         auto key = std::get<0>(r->getControlFields()); // key
@@ -127,9 +339,9 @@ public:
         // find the corresponding key descriptor
         auto it = keyMap.find(key);
         if (it == keyMap.end()) {
-            // create the descriptor of that key
-            keyMap.insert(std::make_pair(key, Key_Descriptor(this->get_num_inchannels(), mode)));
-            it = keyMap.find(key);
+            // create the descriptor of that key (the merger of the key is used only in ID mode)
+            size_t n = (mode == ordering_mode_t::ID) ? this->get_num_inchannels() : 1;
+            it = keyMap.insert(std::make_pair(key, Key_Descriptor(n))).first;
         }
         Key_Descriptor &key_d = (*it).second;
         // update the most recent EOS marker of this key
@@ -150,44 +362,12 @@ public:
         }
         // get the index of the source's stream
         size_t source_id = this->get_channel_id();
-        uint64_t min_id = 0;
-        auto &queue = (mode == ordering_mode_t::ID) ? key_d.queue : globalQueue;
-        if (mode == ordering_mode_t::ID) { // ordering on a key-basis
-            key_d.maxs[source_id] = wid;
-            min_id = *(std::min_element((key_d.maxs).begin(), (key_d.maxs).end()));
-        }
-        else { // ordering regardless the key
-            globalMaxs[source_id] = wid;
-            min_id = *(std::min_element(globalMaxs.begin(), globalMaxs.end()));
-        }
-        // add the new input item in the priority queue
-        queue.push(wr);
-        // check if buffered tuples can be emitted in order
-        while (!queue.empty()) {
-            // emit all the buffered tuples with identifier/timestamp lower or equal than min_i
-            input_t *wnext = queue.top();
-            tuple_t *next = extractTuple<tuple_t, input_t>(wnext);
-            uint64_t id = (mode == ordering_mode_t::ID) ? std::get<1>(next->getControlFields()) : std::get<2>(next->getControlFields());
-            if (id > min_id)
-                break;
-            else {
-                // deque the tuple
-                queue.pop();
-                // emit the tuple
-                if (mode == ordering_mode_t::TS_RENUMBERING) { // check if renumbering is required
-                    tuple_t *copy = new tuple_t(*next); // copy of the tuple
-                    deleteTuple<tuple_t, input_t>(wnext);
-                    auto tmp_key = std::get<0>(copy->getControlFields());
-                    auto tmp_it = keyMap.find(tmp_key);
-                    Key_Descriptor &tmp_key_d = (*tmp_it).second;
-                    copy->setControlFields(tmp_key, tmp_key_d.emit_counter++, std::get<2>(copy->getControlFields()));
-                    auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1);
-                    this->ff_send_out(copy_wt);
-                }
-                else {
-                    this->ff_send_out(wnext);
-                }
-            }
+        // ordering on a key-basis (ID mode) or regardless the key (TS and TS_RENUMBERING modes)
+        KWay_Merger &merger = (mode == ordering_mode_t::ID) ? key_d.merger : *globalMerger;
+        merger.push(source_id, wid, wr);
+        // emit all the buffered tuples with identifier/timestamp lower or equal than the ones received from all the streams
+        while (merger.hasNext()) {
+            emit(merger.pop());
         }
         return this->GO_ON;
     }
@@ -196,85 +376,38 @@ public:
     void eosnotify(ssize_t id) override
     {
         eos_received++;
+        // the watermark can advance when an input stream is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            processWatermark(wm_merger.get());
+        }
         // check the number of received EOS messages
         if (eos_received != this->get_num_inchannels()) {
             return;
         }
         if (mode != ordering_mode_t::ID) {
-            while (!globalQueue.empty()) {
-                // extract the next tuple
-                input_t *wnext = globalQueue.top();
-                tuple_t *next = extractTuple<tuple_t, input_t>(wnext);
-                globalQueue.pop();
-                // emit the tuple
-                if (mode == ordering_mode_t::TS_RENUMBERING) { // check if renumbering is required
-                    tuple_t *copy = new tuple_t(*next); // copy of the tuple
-                    deleteTuple<tuple_t, input_t>(wnext);
-                    auto key = std::get<0>(copy->getControlFields());
-                    auto it = keyMap.find(key);
-                    Key_Descriptor &key_d = (*it).second;
-                    copy->setControlFields(key, key_d.emit_counter++, std::get<2>(copy->getControlFields()));
-                    auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1);
-                    this->ff_send_out(copy_wt);
-                }
-                else {
-                    this->ff_send_out(wnext);
-                }
+            // send (in order) all the queued tuples
+            globalMerger->close();
+            while (globalMerger->hasNext()) {
+                emit(globalMerger->pop());
             }
+            // send the most recent EOS marker of each key (if it exists)
             for (auto &k: keyMap) {
-                auto key = k.first;
-                auto &key_d = (k.second);
-                // send the most recent EOS marker of this key (if it exists)
-                if(key_d.eos_marker != nullptr) {
-                    if (mode == ordering_mode_t::TS_RENUMBERING) { // check if renumbering is required
-                        tuple_t *next = extractTuple<tuple_t, input_t>(key_d.eos_marker);
-                        tuple_t *copy = new tuple_t(*next); // copy of the tuple
-                        deleteTuple<tuple_t, input_t>(key_d.eos_marker);
-                        copy->setControlFields(key, key_d.emit_counter++, std::get<2>(copy->getControlFields()));
-                        auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1, true);
-                        this->ff_send_out(copy_wt);
-                    }
-                    else {
-                        this->ff_send_out(key_d.eos_marker);
-                    }
+                if((k.second).eos_marker != nullptr) {
+                    emit((k.second).eos_marker, true);
                 }
             }
         }
         else {
             // send (in order) all the queued tuples of all the keys
             for (auto &k: keyMap) {
-                auto key = k.first;
                 auto &key_d = (k.second);
-                while (!(key_d.queue).empty()) {
-                    // extract the next tuple
-                    input_t *wnext = (key_d.queue).top();
-                    tuple_t *next = extractTuple<tuple_t, input_t>(wnext);
-                    (key_d.queue).pop();
-                    // emit the tuple
-                    if (mode == ordering_mode_t::TS_RENUMBERING) { // check if renumbering is required
-                        tuple_t *copy = new tuple_t(*next); // copy of the tuple
-                        deleteTuple<tuple_t, input_t>(wnext);
-                        copy->setControlFields(key, key_d.emit_counter++, std::get<2>(copy->getControlFields()));
-                        auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1);
-                        this->ff_send_out(copy_wt);
-                    }
-                    else {
-                        this->ff_send_out(wnext);
-                    }
+                (key_d.merger).close();
+                while ((key_d.merger).hasNext()) {
+                    emit((key_d.merger).pop());
                 }
                 // send the most recent EOS marker of this key (if it exists)
                 if(key_d.eos_marker != nullptr) {
-                    if (mode == ordering_mode_t::TS_RENUMBERING) { // check if renumbering is required
-                        tuple_t *next = extractTuple<tuple_t, input_t>(key_d.eos_marker);
-                        tuple_t *copy = new tuple_t(*next); // copy of the tuple
-                        deleteTuple<tuple_t, input_t>(key_d.eos_marker);
-                        copy->setControlFields(key, key_d.emit_counter++, std::get<2>(copy->getControlFields()));
-                        auto *copy_wt = createWrapper<tuple_t, input_t, wrapper_tuple_t<tuple_t>>(copy, 1, true);
-                        this->ff_send_out(copy_wt);
-                    }
-                    else {
-                        this->ff_send_out(key_d.eos_marker);
-                    }
+                    emit(key_d.eos_marker, true);
                 }
             }
         }
@@ -126,6 +126,7 @@ private:
     WinOperatorConfig config;
     std::vector<ff_node *> plq_workers; // vector of pointers to the Win_Seq instances in the PLQ stage
     std::vector<ff_node *> wlq_workers; // vector of pointers to the Win_Seq instances in the WLQ stage
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
 
     // Private Constructor
     template<typename F_t, typename G_t>
@@ -141,7 +142,8 @@ private:
               closing_func_t _closing_func,
               bool _ordered,
               opt_level_t _opt_level,
-              WinOperatorConfig _config):
+              WinOperatorConfig _config,
+              std::vector<int> _cpus={}):
               name(_name),
               parallelism(_plq_parallelism + _wlq_parallelism),
               used(false),
@@ -155,7 +157,8 @@ private:
               wlq_parallelism(_wlq_parallelism),
               ordered(_ordered),
               opt_level(_opt_level),
-              config(WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              config(WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len)),
+              cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
@@ -274,6 +277,17 @@ private:
         return u;
     };
 
+    // set the placement of the Win_Seq instances of the PLQ and WLQ stages (starting from the given one of the vector)
+    void set_Placements(const std::vector<Placement_Replica> &_placements, size_t _first)
+    {
+        for (size_t i=0; i<plq_workers.size(); i++) {
+            static_cast<Win_Seq<tuple_t, result_t, input_t> *>(plq_workers[i])->setPlacement(_placements[_first + i]);
+        }
+        for (size_t i=0; i<wlq_workers.size(); i++) {
+            static_cast<Win_Seq<result_t, result_t> *>(wlq_workers[i])->setPlacement(_placements[_first + plq_workers.size() + i]);
+        }
+    }
+
 public:
     /** 
      *  \brief Constructor I
@@ -290,6 +304,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(plq_func_t _plq_func,
               wlq_func_t _wlq_func,
@@ -302,8 +317,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_plq_func, _wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_plq_func, _wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         plq_func = _plq_func;
         wlq_func = _wlq_func;
@@ -328,6 +344,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(rich_plq_func_t _rich_plq_func,
               wlq_func_t _wlq_func,
@@ -340,8 +357,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_rich_plq_func, _wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_rich_plq_func, _wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_plq_func = _rich_plq_func;
         wlq_func = _wlq_func;
@@ -366,6 +384,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(plq_func_t _plq_func,
               rich_wlq_func_t _rich_wlq_func,
@@ -378,8 +397,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_plq_func, _rich_wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_plq_func, _rich_wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         plq_func = _plq_func;
         rich_wlq_func = _rich_wlq_func;
@@ -404,6 +424,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(rich_plq_func_t _rich_plq_func,
               rich_wlq_func_t _rich_wlq_func,
@@ -416,8 +437,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_rich_plq_func, _rich_wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_rich_plq_func, _rich_wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_plq_func = _rich_plq_func;
         rich_wlq_func = _rich_wlq_func;
@@ -442,6 +464,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(plqupdate_funct_t _plqupdate_func,
               wlqupdate_func_t _wlqupdate_func,
@@ -454,8 +477,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_plqupdate_func, _wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_plqupdate_func, _wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         plqupdate_func = _plqupdate_func;
         wlqupdate_func = _wlqupdate_func;
@@ -480,6 +504,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(rich_plqupdate_funct_t _rich_plqupdate_func,
               wlqupdate_func_t _wlqupdate_func,
@@ -492,8 +517,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_rich_plqupdate_func, _wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_rich_plqupdate_func, _wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_plqupdate_func = _rich_plqupdate_func;
         wlqupdate_func = _wlqupdate_func;
@@ -518,6 +544,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(plqupdate_funct_t _plqupdate_func,
               rich_wlqupdate_func_t _rich_wlqupdate_func,
@@ -530,8 +557,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_plqupdate_func, _rich_wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_plqupdate_func, _rich_wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         plqupdate_func = _plqupdate_func;
         rich_wlqupdate_func = _rich_wlqupdate_func;
@@ -556,6 +584,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(rich_plqupdate_funct_t _rich_plqupdate_func,
               rich_wlqupdate_func_t _rich_wlqupdate_func,
@@ -568,8 +597,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_rich_plqupdate_func, _rich_wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_rich_plqupdate_func, _rich_wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_plqupdate_func = rich_plqupdate_func;
         rich_wlqupdate_func = _rich_wlqupdate_func;
@@ -594,6 +624,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(plq_func_t _plq_func,
               wlqupdate_func_t _wlqupdate_func,
@@ -606,8 +637,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_plq_func, _wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_plq_func, _wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         plq_func = _plq_func;
         wlqupdate_func = _wlqupdate_func;
@@ -632,6 +664,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(rich_plq_func_t _rich_plq_func,
               wlqupdate_func_t _wlqupdate_func,
@@ -644,8 +677,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_rich_plq_func, _wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_rich_plq_func, _wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_plq_func = _rich_plq_func;
         wlqupdate_func = _wlqupdate_func;
@@ -670,6 +704,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(plq_func_t _plq_func,
               rich_wlqupdate_func_t _rich_wlqupdate_func,
@@ -682,8 +717,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_plq_func, _rich_wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_plq_func, _rich_wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         plq_func = _plq_func;
         rich_wlqupdate_func = _rich_wlqupdate_func;
@@ -708,6 +744,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(rich_plq_func_t _rich_plq_func,
               rich_wlqupdate_func_t _rich_wlqupdate_func,
@@ -720,8 +757,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_rich_plq_func, _rich_wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_rich_plq_func, _rich_wlqupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_plq_func = _rich_plq_func;
         rich_wlqupdate_func = _rich_wlqupdate_func;
@@ -746,6 +784,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(plqupdate_funct_t _plqupdate_func,
               wlq_func_t _wlq_func,
@@ -758,8 +797,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_plqupdate_func, _wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_plqupdate_func, _wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         plqupdate_func = _plqupdate_func;
         wlq_func = _wlq_func;
@@ -784,6 +824,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(rich_plqupdate_funct_t _rich_plqupdate_func,
               wlq_func_t _wlq_func,
@@ -796,8 +837,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_rich_plqupdate_func, _wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_rich_plqupdate_func, _wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_plqupdate_func = _rich_plqupdate_func;
         wlq_func = _wlq_func;
@@ -822,6 +864,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(plqupdate_funct_t _plqupdate_func,
               rich_wlq_func_t _rich_wlq_func,
@@ -834,8 +877,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_plqupdate_func, _rich_wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_plqupdate_func, _rich_wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         plqupdate_func = _plqupdate_func;
         rich_wlq_func = _rich_wlq_func;
@@ -860,6 +904,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Pane_Farm(rich_plqupdate_funct_t _rich_plqupdate_func,
               rich_wlq_func_t _rich_wlq_func,
@@ -872,8 +917,9 @@ public:
               std::string _name,
               closing_func_t _closing_func,
               bool _ordered,
-              opt_level_t _opt_level):
-              Pane_Farm(_rich_plqupdate_func, _rich_wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+              opt_level_t _opt_level,
+              std::vector<int> _cpus={}):
+              Pane_Farm(_rich_plqupdate_func, _rich_wlq_func, _win_len, _slide_len, _triggering_delay, _winType, _plq_parallelism, _wlq_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_plqupdate_func = _rich_plqupdate_func;
         rich_wlq_func = _rich_wlq_func;
@@ -978,6 +1024,15 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        set_Placements(_manager.assign(name, plq_workers.size() + wlq_workers.size(), cpus), 0);
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
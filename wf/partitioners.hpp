@@ -0,0 +1,220 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    partitioners.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    07/11/2020
+ *  
+ *  @brief Partitioners of the key-based distribution
+ *  
+ *  @section Partitioners (Description)
+ *  
+ *  This file implements the partitioners that can be used as routing functions of the
+ *  key-based distribution (see the withPartitioner() method of the builders). They map
+ *  the hashcode of a key onto the identifier of a replica starting from zero, and they
+ *  can be passed wherever a function size_t(size_t, size_t) is accepted (e.g., by the
+ *  Standard_Emitter and the KF_Emitter).
+ *  
+ *  Hash_Partitioner mixes the hashcode before the modulo (like the default routing),
+ *  JumpConsistent_Partitioner moves only 1/n of the keys when the number of replicas
+ *  changes from n-1 to n, Rendezvous_Partitioner does the same with any set of replicas
+ *  at the cost of a linear scan, and Range_Partitioner assigns contiguous ranges of
+ *  hashcodes (i.e. of keys for integral types) to the replicas.
+ */ 
+
+#ifndef PARTITIONERS_H
+#define PARTITIONERS_H
+
+/// includes
+#include<vector>
+#include<algorithm>
+#include<basic.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Hash_Partitioner
+ *  
+ *  \brief Partitioner based on the modulo of the mixed hashcode
+ *  
+ *  This class implements a partitioner mapping the hashcode of a key onto a replica
+ *  with the modulo of the hashcode mixed with a seed.
+ */ 
+class Hash_Partitioner
+{
+private:
+    uint64_t seed; // seed of the mixing
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _seed seed of the mixing
+     */ 
+    Hash_Partitioner(uint64_t _seed=0): seed(_seed) {}
+
+    /** 
+     *  \brief Map a hashcode onto a replica
+     *  
+     *  \param _hashcode hashcode of the key
+     *  \param _n_dest number of destinations
+     *  \return identifier of the destination starting from zero to _n_dest-1
+     */ 
+    size_t operator()(size_t _hashcode, size_t _n_dest) const
+    {
+        return mix64(_hashcode ^ seed) % _n_dest;
+    }
+};
+
+/** 
+ *  \class JumpConsistent_Partitioner
+ *  
+ *  \brief Partitioner based on the jump consistent hashing
+ *  
+ *  This class implements a partitioner based on the jump consistent hashing of Lamping
+ *  and Veach. When the number of replicas changes from n-1 to n, only 1/n of the keys
+ *  are mapped onto a different replica (the new one). It runs in O(log(n)) time.
+ */ 
+class JumpConsistent_Partitioner
+{
+private:
+    uint64_t seed; // seed of the mixing
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _seed seed of the mixing
+     */ 
+    JumpConsistent_Partitioner(uint64_t _seed=0): seed(_seed) {}
+
+    /** 
+     *  \brief Map a hashcode onto a replica
+     *  
+     *  \param _hashcode hashcode of the key
+     *  \param _n_dest number of destinations
+     *  \return identifier of the destination starting from zero to _n_dest-1
+     */ 
+    size_t operator()(size_t _hashcode, size_t _n_dest) const
+    {
+        uint64_t key = mix64(_hashcode ^ seed);
+        int64_t b = -1;
+        int64_t j = 0;
+        while (j < (int64_t) _n_dest) {
+            b = j;
+            key = key * 2862933555777941757ULL + 1;
+            j = (b + 1) * (((double) (1LL << 31)) / ((double) ((key >> 33) + 1)));
+        }
+        return b;
+    }
+};
+
+/** 
+ *  \class Rendezvous_Partitioner
+ *  
+ *  \brief Partitioner based on the rendezvous hashing
+ *  
+ *  This class implements a partitioner based on the rendezvous (highest random weight)
+ *  hashing. Each key is mapped onto the replica with the highest weight mixed from the
+ *  hashcode and the replica identifier. Adding or removing any replica moves only the
+ *  keys mapped onto it. It runs in O(n) time.
+ */ 
+class Rendezvous_Partitioner
+{
+private:
+    uint64_t seed; // seed of the mixing
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _seed seed of the mixing
+     */ 
+    Rendezvous_Partitioner(uint64_t _seed=0): seed(_seed) {}
+
+    /** 
+     *  \brief Map a hashcode onto a replica
+     *  
+     *  \param _hashcode hashcode of the key
+     *  \param _n_dest number of destinations
+     *  \return identifier of the destination starting from zero to _n_dest-1
+     */ 
+    size_t operator()(size_t _hashcode, size_t _n_dest) const
+    {
+        uint64_t key = mix64(_hashcode ^ seed);
+        size_t dest = 0;
+        uint64_t max_weight = 0;
+        for (size_t i=0; i<_n_dest; i++) {
+            uint64_t weight = mix64(key ^ mix64(i + 1));
+            if (i == 0 || weight > max_weight) {
+                max_weight = weight;
+                dest = i;
+            }
+        }
+        return dest;
+    }
+};
+
+/** 
+ *  \class Range_Partitioner
+ *  
+ *  \brief Partitioner based on ranges of hashcodes
+ *  
+ *  This class implements a partitioner assigning contiguous ranges of hashcodes to the
+ *  replicas. The hashcodes are not mixed, so with integral keys (whose hashcode is the
+ *  key itself) the ranges are ranges of keys. The i-th replica receives the hashcodes
+ *  smaller than the i-th split point and not smaller than the previous one, while the
+ *  last replica receives all the hashcodes not smaller than the last split point.
+ */ 
+class Range_Partitioner
+{
+private:
+    std::vector<size_t> splits; // split points of the ranges (sorted)
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _splits split points of the ranges in increasing order (n-1 values for n replicas)
+     */ 
+    Range_Partitioner(std::vector<size_t> _splits): splits(_splits)
+    {
+        if (!std::is_sorted(splits.begin(), splits.end())) {
+            std::cerr << RED << "WindFlow Error: split points of the Range_Partitioner must be sorted" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    /** 
+     *  \brief Map a hashcode onto a replica
+     *  
+     *  \param _hashcode hashcode of the key
+     *  \param _n_dest number of destinations
+     *  \return identifier of the destination starting from zero to _n_dest-1 (with fewer
+     *          split points than n-1, the last replicas receive nothing, with more split
+     *          points the last ranges are all assigned to the last replica)
+     */ 
+    size_t operator()(size_t _hashcode, size_t _n_dest) const
+    {
+        size_t dest = std::upper_bound(splits.begin(), splits.end(), _hashcode) - splits.begin();
+        return std::min(dest, _n_dest - 1);
+    }
+};
+
+} // namespace wf
+
+#endif
@@ -35,6 +35,7 @@
 #include<map>
 #include<string>
 #include<vector>
+#include<tuple>
 #include<random>
 #include<thread>
 #include<typeinfo>
@@ -94,6 +95,10 @@ private:
     friend class MultiPipe;
     friend inline MultiPipe *merge_multipipes_func(PipeGraph *, std::vector<MultiPipe *>);
     friend inline std::vector<MultiPipe *> split_multipipe_func(PipeGraph *, MultiPipe *);
+#if defined (TRACE_WINDFLOW)
+    friend inline void add_slack_stats_func(PipeGraph *, Stats_Record *);
+    friend inline void add_plan_func(PipeGraph *, std::string, std::string, std::string);
+#endif
     std::string name; // name of the PipeGraph
     AppNode *root; // pointer to the root of the Application Tree
     std::vector<MultiPipe *> toBeDeteled; // vector of MultiPipe instances to be deleted
@@ -102,7 +107,11 @@ private:
     bool ended; // flag stating whether the PipeGraph has completed its processing
     std::vector<std::reference_wrapper<Basic_Operator>> listOperators;// sequence of operators that have been added/chained within this PipeGraph
     std::atomic<unsigned long> atomic_num_dropped;
+    Slack_Policy slack_policy; // policy of the slack used in PROBABILISTIC mode
+    Placement placement; // placement policy of the replicas without a list of CPUs
 #if defined (TRACE_WINDFLOW)
+    std::vector<Stats_Record *> slackRecords; // statistics of the KSlack_Node instances (PROBABILISTIC mode)
+    std::vector<std::tuple<std::string, std::string, std::string>> planRecords; // connection and reordering of the inputs of each added/chained operator
     GVC_t *gvc; // pointer to the GVC environment
     Agraph_t *gv_graph; // pointer to the graphviz representation of the PipeGraph
     std::thread mt_thread; // object representing the monitoring thread
@@ -508,15 +517,28 @@ public:
      *  
      *  \param _name name of the PipeGraph
      *  \param _mode processing mode of the PipeGraph
+     *  \param _slack_policy policy of the slack used to reorder inputs (meaningful in PROBABILISTIC mode only)
+     *  \param _placement placement policy of the replicas on the CPUs (used for the operators without a list of CPUs)
      */ 
-    PipeGraph(std::string _name, Mode _mode=Mode::DEFAULT):
+    PipeGraph(std::string _name, Mode _mode=Mode::DEFAULT, Slack_Policy _slack_policy=Slack_Policy(), Placement _placement=Placement::NONE):
               name(_name),
               mode(_mode),
               started(false),
               ended(false),
               root(new AppNode()),
-              atomic_num_dropped(0)
+              atomic_num_dropped(0),
+              slack_policy(_slack_policy),
+              placement(_placement)
     {
+        // check the validity of the slack policy
+        if (slack_policy.target_drop_rate < 0 || slack_policy.target_drop_rate >= 1) {
+            std::cerr << RED << "WindFlow Error: target drop rate of the slack policy must be in [0, 1)" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (slack_policy.window < 2) {
+            std::cerr << RED << "WindFlow Error: window of the slack policy must contain at least two delays" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
 #if defined (TRACE_WINDFLOW)
         gvc = gvContext(); // set up a graphviz context
         gv_graph = agopen(const_cast<char *>(name.c_str()), Agdirected, 0); // create the graphviz representation
@@ -533,6 +555,7 @@ public:
         agattr(gv_graph, AGEDGE, const_cast<char *>("label"), const_cast<char *>("")); // default edge labels
         agattr(gv_graph, AGEDGE, const_cast<char *>("fontname"), const_cast<char *>("helvetica bold")); // font of the edge labels
         agattr(gv_graph, AGEDGE, const_cast<char *>("fontsize"), const_cast<char *>("10")); // font size of the edge labels
+        agattr(gv_graph, AGEDGE, const_cast<char *>("style"), const_cast<char *>("solid")); // default style of the edges
 #endif
     }
 
@@ -635,6 +658,12 @@ public:
 #else
         std::cout << "--> Pinning of threads " << RED << "disabled" << DEFAULT_COLOR << std::endl;
 #endif
+        if (placement == Placement::COMPACT) {
+            std::cout << "--> COMPACT placement of replicas " << GREEN << "enabled" << DEFAULT_COLOR << std::endl;
+        }
+        else if (placement == Placement::SPREAD) {
+            std::cout << "--> SPREAD placement of replicas " << GREEN << "enabled" << DEFAULT_COLOR << std::endl;
+        }
 #if defined (TRACE_FASTFLOW)
         std::cout << "--> FastFlow tracing " << GREEN << "enabled" << DEFAULT_COLOR << std::endl;
 #endif
@@ -644,6 +673,11 @@ public:
         MonitoringThread mt(this);
         mt_thread = std::thread(mt);
 #endif
+        // place the replicas in the order in which the operators have been added (before their threads start)
+        Placement_Manager placement_manager(placement);
+        for (auto op: listOperators) {
+            (op.get()).place(placement_manager);
+        }
         // run all the topmost MultiPipe instances
         for (auto *an: root->children) {
             int status = (an->mp)->run();
@@ -765,6 +799,24 @@ public:
         return atomic_num_dropped.load();
     }
 
+    /** 
+     *  \brief Method to get the policy of the slack used in PROBABILISTIC mode
+     *  \return slack policy of the PipeGraph
+     */ 
+    Slack_Policy getSlackPolicy() const
+    {
+        return slack_policy;
+    }
+
+    /** 
+     *  \brief Method to get the placement policy of the replicas on the CPUs
+     *  \return placement policy of the PipeGraph
+     */ 
+    Placement getPlacement() const
+    {
+        return placement;
+    }
+
     /** 
      *  \brief Check whether the PipeGraph has been started
      *  \return true if the PipeGraph has been started, false otherwise
@@ -827,6 +879,16 @@ public:
 #else
         writer.String("ON");
 #endif
+        writer.Key("Placement");
+        if (placement == Placement::COMPACT) {
+            writer.String("COMPACT");
+        }
+        else if (placement == Placement::SPREAD) {
+            writer.String("SPREAD");
+        }
+        else {
+            writer.String("NONE");
+        }
         writer.Key("Dropped_tuples");
         writer.Uint64(this->get_NumDroppedTuples());
         writer.Key("Operator_number");
@@ -844,6 +906,30 @@ public:
             (op.get()).append_Stats(writer);
         }
         writer.EndArray();
+        // get statistics from all the KSlack_Node instances (if any)
+        if (!slackRecords.empty()) {
+            writer.Key("Slack_nodes");
+            writer.StartArray();
+            for (auto *record: slackRecords) {
+                Stats_Record copy = *record;
+                copy.append_Stats(writer);
+            }
+            writer.EndArray();
+        }
+        // get the plan of the connections between the operators
+        writer.Key("Plan");
+        writer.StartArray();
+        for (auto &record: planRecords) {
+            writer.StartObject();
+            writer.Key("Operator_name");
+            writer.String(std::get<0>(record).c_str());
+            writer.Key("Input_connection");
+            writer.String(std::get<1>(record).c_str());
+            writer.Key("Input_reordering");
+            writer.String(std::get<2>(record).c_str());
+            writer.EndObject();
+        }
+        writer.EndArray();
         writer.EndObject();
         // serialize the object to file
         std::string json_stats(buffer.GetString());
@@ -888,7 +974,25 @@ inline std::vector<MultiPipe *> split_multipipe_func(PipeGraph *graph, MultiPipe
     return graph->execute_Split(_mp);
 }
 
+// implementation of the get_slack_policy_func function
+inline Slack_Policy get_slack_policy_func(PipeGraph *graph)
+{
+    return graph->getSlackPolicy();
+}
+
 #if defined (TRACE_WINDFLOW)
+    // implementation of the add_slack_stats_func function
+    inline void add_slack_stats_func(PipeGraph *graph, Stats_Record *record)
+    {
+        (graph->slackRecords).push_back(record);
+    }
+
+    // implementation of the add_plan_func function
+    inline void add_plan_func(PipeGraph *graph, std::string op_name, std::string connection, std::string reordering)
+    {
+        (graph->planRecords).push_back(std::make_tuple(op_name, connection, reordering));
+    }
+
     // implementation of the is_ended_func function
     inline bool is_ended_func(PipeGraph *graph)
     {
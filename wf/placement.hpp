@@ -0,0 +1,362 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    placement.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    16/11/2020
+ *  
+ *  @brief Placement of the operator replicas on the CPUs and NUMA nodes
+ *  
+ *  @section Placement (Description)
+ *  
+ *  This file implements the classes used to place the replicas of the operators on
+ *  the CPUs of the machine. The Topology class reads the NUMA nodes and their CPUs
+ *  from sysfs. The Placement_Manager assigns a CPU to each replica, either from the
+ *  list given to the operator builder (see the withCPUs() method of the builders) or
+ *  according to the placement policy of the PipeGraph: COMPACT fills the CPUs of a
+ *  NUMA node before moving to the next one, so chained stages added one after the
+ *  other share the node, while SPREAD distributes the replicas of each operator over
+ *  the nodes in round-robin, so the i-th replicas of different operators share one.
+ *  
+ *  Each replica binds itself to its CPU at the beginning of its execution. The state
+ *  allocated later by the replica (e.g., the archives and the descriptors of its keys)
+ *  is thus first touched, and then allocated, on the local NUMA node.
+ *  
+ *  The replicas of all the CPU operators are placed, including the ones of the stages
+ *  of Pane_Farm and Win_MapReduce instances nested in a Win_Farm or in a Key_Farm. The
+ *  emitters and collectors of the operators, the FastFlow queues and the replicas of
+ *  the GPU operators are not placed (they keep the mapping of FastFlow).
+ */ 
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+/// includes
+#include<string>
+#include<vector>
+#include<utility>
+#include<fstream>
+#include<sstream>
+#include<algorithm>
+#include<thread>
+#include<iostream>
+#if defined(__linux__)
+    #include<sched.h>
+#endif
+#include<basic.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Topology
+ *  
+ *  \brief NUMA nodes and CPUs of the machine
+ *  
+ *  This class reads from sysfs the online NUMA nodes with at least one CPU and the
+ *  online CPUs of each of them. Only the CPUs in the affinity mask of the process
+ *  are considered (e.g., the ones given by taskset or allowed by the cgroup). Without
+ *  NUMA information, all these CPUs are considered as belonging to a single node with
+ *  identifier zero.
+ */ 
+class Topology
+{
+private:
+    std::vector<int> node_ids; // identifiers of the NUMA nodes
+    std::vector<std::vector<int>> cpus; // CPUs of each NUMA node
+
+    // read the first line of a file (empty string if the file cannot be read)
+    static std::string read_Line(const std::string &_path)
+    {
+        std::ifstream file(_path);
+        std::string line;
+        if (file.is_open()) {
+            std::getline(file, line);
+        }
+        return line;
+    }
+
+    // parse a list in the sysfs format (e.g., 0-3,8-11)
+    static std::vector<int> parse_List(const std::string &_list)
+    {
+        std::vector<int> result;
+        std::stringstream ss(_list);
+        std::string range;
+        while (std::getline(ss, range, ',')) {
+            size_t sep = range.find('-');
+            try {
+                int first = std::stoi(range.substr(0, sep));
+                int last = (sep == std::string::npos) ? first : std::stoi(range.substr(sep + 1));
+                for (int i=first; i<=last; i++) {
+                    result.push_back(i);
+                }
+            }
+            catch (const std::exception &) {} // malformed ranges are skipped
+        }
+        return result;
+    }
+
+    // remove the CPUs not in the affinity mask of the process (e.g., set by taskset or by a cgroup)
+    static void filter_Allowed(std::vector<int> &_list)
+    {
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+            return;
+        }
+        _list.erase(std::remove_if(_list.begin(), _list.end(), [&set](int c) { return (c < 0 || c >= CPU_SETSIZE || !CPU_ISSET(c, &set)); }), _list.end());
+#endif
+    }
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _sysfs_dir directory of sysfs containing the node and cpu directories
+     */ 
+    Topology(const std::string &_sysfs_dir="/sys/devices/system")
+    {
+        for (int id: parse_List(read_Line(_sysfs_dir + "/node/online"))) {
+            auto list = parse_List(read_Line(_sysfs_dir + "/node/node" + std::to_string(id) + "/cpulist"));
+            filter_Allowed(list);
+            if (!list.empty()) { // nodes with memory only, or without allowed CPUs, are not used
+                node_ids.push_back(id);
+                cpus.push_back(list);
+            }
+        }
+        if (cpus.empty()) {
+            auto list = parse_List(read_Line(_sysfs_dir + "/cpu/online"));
+            filter_Allowed(list);
+            if (list.empty()) {
+                for (size_t i=0; i<std::max<size_t>(std::thread::hardware_concurrency(), 1); i++) {
+                    list.push_back(i);
+                }
+            }
+            node_ids.push_back(0);
+            cpus.push_back(list);
+        }
+    }
+
+    /** 
+     *  \brief Get the number of NUMA nodes
+     *  \return number of NUMA nodes with at least one CPU
+     */ 
+    size_t getNumNodes() const
+    {
+        return cpus.size();
+    }
+
+    /** 
+     *  \brief Get the identifier of a NUMA node
+     *  \param _idx index of the node starting from zero to getNumNodes()-1
+     *  \return identifier of the node in sysfs
+     */ 
+    int getNodeId(size_t _idx) const
+    {
+        return node_ids[_idx];
+    }
+
+    /** 
+     *  \brief Get the CPUs of a NUMA node
+     *  \param _idx index of the node starting from zero to getNumNodes()-1
+     *  \return identifiers of the CPUs of the node
+     */ 
+    const std::vector<int> &getCPUs(size_t _idx) const
+    {
+        return cpus[_idx];
+    }
+
+    /** 
+     *  \brief Get the NUMA node of a CPU
+     *  \param _cpu identifier of the CPU
+     *  \return identifier of the node in sysfs (-1 if the CPU is not online or not allowed)
+     */ 
+    int getNodeOf(int _cpu) const
+    {
+        for (size_t i=0; i<cpus.size(); i++) {
+            if (std::find(cpus[i].begin(), cpus[i].end(), _cpu) != cpus[i].end()) {
+                return node_ids[i];
+            }
+        }
+        return -1;
+    }
+};
+
+//@cond DOXY_IGNORE
+
+// class Placement_Replica
+class Placement_Replica
+{
+private:
+    int cpu; // CPU of the replica (-1 if the replica is not placed)
+    int node; // NUMA node of the CPU (-1 if the replica is not placed)
+
+public:
+    // Constructor
+    Placement_Replica(int _cpu=-1,
+                      int _node=-1):
+                      cpu(_cpu),
+                      node(_node) {}
+
+    // CPU and NUMA node to which the calling thread has been bound by a replica (-1 if not bound)
+    static std::pair<int, int> &thread_Binding()
+    {
+        static thread_local std::pair<int, int> binding(-1, -1);
+        return binding;
+    }
+
+    // bind the calling thread to the CPU of the replica (called at the beginning of the replica execution)
+    void bind()
+    {
+        auto &binding = thread_Binding();
+        // replicas chained in the same thread keep the CPU of the first one
+        if (binding.first >= 0) {
+            cpu = binding.first;
+            node = binding.second;
+            return;
+        }
+        if (cpu < 0) {
+            return;
+        }
+#if defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        if (sched_setaffinity(0, sizeof(cpu_set_t), &set) != 0) {
+            std::cerr << YELLOW << "WindFlow Warning: replica cannot be bound to CPU " << cpu << DEFAULT_COLOR << std::endl;
+            cpu = -1; // the replica is not placed
+            node = -1;
+            return;
+        }
+#endif
+        binding = std::make_pair(cpu, node);
+    }
+
+    // get the CPU of the replica
+    int getCPU() const
+    {
+        return cpu;
+    }
+
+    // get the NUMA node of the replica
+    int getNode() const
+    {
+        return node;
+    }
+};
+
+//@endcond
+
+/** 
+ *  \class Placement_Manager
+ *  
+ *  \brief Assignment of the CPUs to the replicas of the operators
+ *  
+ *  This class assigns the CPUs to the replicas of the operators of a PipeGraph, in the
+ *  order in which the operators have been added to it.
+ */ 
+class Placement_Manager
+{
+private:
+    Placement policy; // placement policy of the replicas without a list of CPUs
+    Topology topology; // NUMA nodes and CPUs of the machine
+    std::vector<int> all_cpus; // CPUs of all the NUMA nodes (node by node)
+    size_t next_cpu; // next CPU of all_cpus (COMPACT policy)
+    std::vector<size_t> next_node_cpu; // next CPU of each NUMA node (SPREAD policy)
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _policy placement policy of the replicas without a list of CPUs
+     *  \param _topology NUMA nodes and CPUs of the machine
+     */ 
+    Placement_Manager(Placement _policy,
+                      Topology _topology=Topology()):
+                      policy(_policy),
+                      topology(_topology),
+                      next_cpu(0),
+                      next_node_cpu(_topology.getNumNodes(), 0)
+    {
+        for (size_t i=0; i<topology.getNumNodes(); i++) {
+            all_cpus.insert(all_cpus.end(), topology.getCPUs(i).begin(), topology.getCPUs(i).end());
+        }
+    }
+
+    /** 
+     *  \brief Assign the CPUs to the replicas of an operator
+     *  
+     *  \param _name name of the operator
+     *  \param _parallelism number of replicas of the operator
+     *  \param _cpus CPUs given to the operator builder (used in round-robin by the replicas if not empty)
+     *  \return placement of each replica
+     */ 
+    std::vector<Placement_Replica> assign(const std::string &_name,
+                                          size_t _parallelism,
+                                          const std::vector<int> &_cpus)
+    {
+        std::vector<Placement_Replica> result(_parallelism);
+        if (!_cpus.empty()) {
+            for (size_t i=0; i<_parallelism; i++) {
+                int cpu = _cpus[i % _cpus.size()];
+                int node = topology.getNodeOf(cpu);
+                if (node < 0) {
+                    std::cerr << RED << "WindFlow Error: CPU " << cpu << " of operator " << _name << " is not online or not available to the process" << DEFAULT_COLOR << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                result[i] = Placement_Replica(cpu, node);
+            }
+        }
+        else if (policy == Placement::COMPACT) {
+            for (size_t i=0; i<_parallelism; i++) {
+                int cpu = all_cpus[next_cpu++ % all_cpus.size()];
+                result[i] = Placement_Replica(cpu, topology.getNodeOf(cpu));
+            }
+        }
+        else if (policy == Placement::SPREAD) {
+            for (size_t i=0; i<_parallelism; i++) {
+                size_t idx = i % topology.getNumNodes();
+                const std::vector<int> &node_cpus = topology.getCPUs(idx);
+                int cpu = node_cpus[next_node_cpu[idx]++ % node_cpus.size()];
+                result[i] = Placement_Replica(cpu, topology.getNodeId(idx));
+            }
+        }
+        return result;
+    }
+
+    /** 
+     *  \brief Get the placement policy of the replicas without a list of CPUs
+     *  \return placement policy
+     */ 
+    Placement getPolicy() const
+    {
+        return policy;
+    }
+
+    /** 
+     *  \brief Get the topology used by the manager
+     *  \return NUMA nodes and CPUs of the machine
+     */ 
+    const Topology &getTopology() const
+    {
+        return topology;
+    }
+};
+
+} // namespace wf
+
+#endif
@@ -0,0 +1,190 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    quanta_ring.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    22/10/2020
+ *  
+ *  @brief Bounded ring of the open quanta of a key
+ *  
+ *  @section Quanta_Ring (Description)
+ *  
+ *  This file implements the Quanta_Ring class used by the time-based operators that
+ *  pre-aggregate the tuples of a key in quanta (Win_SeqFFAT, Win_SeqMFFAT and
+ *  Win_SeqRollup). The ring keeps the partial results of the open quanta, i.e. the
+ *  ones still within the triggering delay, so that out-of-order tuples are combined
+ *  in place. Its size grows on demand up to a maximum given by the triggering delay.
+ *  
+ *  Quanta are closed in order. Used quanta are passed one by one to the operator,
+ *  while each sequence of consecutive empty quanta is passed as a whole (identifier
+ *  of the first one and length), so that the operator can coalesce long gaps of a key
+ *  instead of materializing each empty quantum.
+ *  
+ *  The template parameter result_t must be default constructible, with a move
+ *  assignment operator.
+ */ 
+
+#ifndef QUANTA_RING_H
+#define QUANTA_RING_H
+
+// includes
+#include<vector>
+#include<assert.h>
+#include<algorithm>
+
+namespace wf {
+
+// class Quanta_Ring
+template<typename result_t>
+class Quanta_Ring
+{
+private:
+    std::vector<result_t> slots; // slots of the ring
+    std::vector<bool> used; // used[i] is true if the i-th slot of the ring has received at least one input
+    size_t head; // position in the ring of the oldest open quantum
+    size_t used_count; // number of used slots in the ring
+    uint64_t first; // identifier of the oldest open quantum
+    uint64_t last; // identifier of the most recent quantum that received an input
+    size_t max_size; // maximum number of slots of the ring
+
+    // grow the ring to contain at least n_slots open quanta
+    void grow(size_t n_slots)
+    {
+        size_t old_size = slots.size();
+        size_t new_size = std::min(std::max(std::max(2 * old_size, n_slots), (size_t) 4), max_size);
+        assert(new_size >= n_slots);
+        std::vector<result_t> new_slots(new_size);
+        std::vector<bool> new_used(new_size, false);
+        // copy the slots in order starting from the one of the oldest open quantum
+        for (size_t i=0; i<old_size; i++) {
+            size_t pos = (head + i) % old_size;
+            new_slots[i] = std::move(slots[pos]);
+            new_used[i] = used[pos];
+        }
+        slots = std::move(new_slots);
+        used = std::move(new_used);
+        head = 0;
+    }
+
+public:
+    // Constructor
+    Quanta_Ring():
+                head(0),
+                used_count(0),
+                first(0),
+                last(0),
+                max_size(0) {}
+
+    // set the first open quantum and the maximum number of slots of an empty ring
+    void start(uint64_t _first, size_t _max_size)
+    {
+        assert(used_count == 0);
+        first = last = _first;
+        max_size = _max_size;
+    }
+
+    // get the identifier of the oldest open quantum
+    uint64_t getFirst() const
+    {
+        return first;
+    }
+
+    // get the identifier of the most recent quantum that received an input
+    uint64_t getLast() const
+    {
+        return last;
+    }
+
+    // get the number of open quanta that received at least one input
+    size_t getUsedCount() const
+    {
+        return used_count;
+    }
+
+    // check whether a quantum has already been closed
+    bool isClosed(uint64_t _id) const
+    {
+        return _id < first;
+    }
+
+    // get the slot of an open quantum (_opened is set to true if the quantum was empty)
+    result_t &getSlot(uint64_t _id, bool &_opened)
+    {
+        assert(_id >= first);
+        size_t distance = _id - first;
+        if (distance >= slots.size()) {
+            grow(distance + 1);
+        }
+        size_t pos = (head + distance) % slots.size();
+        _opened = !used[pos];
+        if (_opened) {
+            used[pos] = true;
+            used_count++;
+        }
+        if (_id > last) {
+            last = _id;
+        }
+        return slots[pos];
+    }
+
+    // get the i-th open quantum starting from the oldest one (nullptr if it is empty)
+    const result_t *peek(size_t _i) const
+    {
+        if (_i >= slots.size()) {
+            return nullptr;
+        }
+        size_t pos = (head + _i) % slots.size();
+        return (used[pos]) ? &slots[pos] : nullptr;
+    }
+
+    // close the open quanta with identifier lower than _up_to (_quantum_func(result) is called
+    // for each used quantum, _empty_func(id, count) for each sequence of consecutive empty quanta)
+    template<typename quantum_func_t, typename empty_func_t>
+    void close(uint64_t _up_to, quantum_func_t &&_quantum_func, empty_func_t &&_empty_func)
+    {
+        while (first < _up_to) {
+            // the remaining quanta to be closed are empty
+            if (used_count == 0) {
+                uint64_t id = first;
+                first = _up_to;
+                head = 0;
+                _empty_func(id, _up_to - id);
+                return;
+            }
+            if (used[head]) {
+                result_t r = std::move(slots[head]);
+                used[head] = false;
+                used_count--;
+                first++;
+                head = (head + 1) % slots.size();
+                _quantum_func(r);
+            }
+            else {
+                uint64_t id = first;
+                while (first < _up_to && !used[head]) {
+                    first++;
+                    head = (head + 1) % slots.size();
+                }
+                _empty_func(id, first - id);
+            }
+        }
+    }
+};
+
+} // namespace wf
+
+#endif
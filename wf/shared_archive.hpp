@@ -0,0 +1,338 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+
+/** 
+ *  @file    shared_archive.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    15/11/2020
+ *  
+ *  @brief Archive of the tuples shared by the replicas of a Win_Farm
+ *  
+ *  @section Shared_Archive (Description)
+ *  
+ *  This file implements the Shared_Archive class used by the replicas (Win_Seq nodes)
+ *  of a Win_Farm with time-based windows and non-incremental queries configured with
+ *  the shared archive. Without it, each replica copies the tuples of its windows into
+ *  its own archive, so with sliding windows the same tuple is stored by up to n replicas.
+ *  
+ *  With the shared archive, the tuples of a key are appended once, in timestamp order,
+ *  by the replica owning the key, and all the replicas compute their windows on ranges
+ *  of them. The archive of a key is a list of segments whose slots are allocated when
+ *  the segment is created and never moved, so the readers can iterate over the tuples
+ *  published in a segment while the owner appends new ones. When a segment is full, the
+ *  tuples of the last window length are copied at the beginning of the next one, thus
+ *  each window is entirely contained in a segment.
+ *  
+ *  Each replica publishes the timestamp of the input it is processing: the tuples of
+ *  the keys owned by the replica with smaller timestamp have already been appended. A
+ *  replica firing a window waits for the owner of the key to reach the end of the
+ *  window. Each replica also publishes the sequence number of the oldest segment it can
+ *  still read (its epoch), and a segment is freed by the owner when all the replicas
+ *  have passed it.
+ */ 
+
+#ifndef SHARED_ARCHIVE_H
+#define SHARED_ARCHIVE_H
+
+/// includes
+#include<deque>
+#include<mutex>
+#include<atomic>
+#include<memory>
+#include<thread>
+#include<vector>
+#include<limits>
+#include<algorithm>
+#include<unordered_map>
+#include<basic.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Shared_Archive
+ *  
+ *  \brief Archive of the tuples shared by the replicas of a Win_Farm
+ *  
+ *  This class implements the archives of the keys shared by the replicas of a Win_Farm
+ *  with the shared archive, and the statistics of the tuples stored by them.
+ */ 
+template<typename tuple_t, typename key_t>
+class Shared_Archive
+{
+public:
+    /// iterator type for accessing the tuples of a segment
+    using iterator_t = typename std::deque<tuple_t>::iterator;
+
+private:
+    // struct of a segment of the archive of a key
+    struct Segment
+    {
+        std::deque<tuple_t> tuples; // slots of the segment (allocated once, the deque is never resized)
+        std::atomic<size_t> size; // number of tuples published in the segment
+        uint64_t covered; // the tuples with timestamp not smaller than covered are in this segment or in the next ones
+        uint64_t seq; // sequence number of the segment
+        std::atomic<Segment *> next; // next segment (nullptr if this is the last one)
+
+        // Constructor
+        Segment(size_t _capacity,
+                uint64_t _covered,
+                uint64_t _seq):
+                tuples(_capacity),
+                size(0),
+                covered(_covered),
+                seq(_seq),
+                next(nullptr) {}
+    };
+
+public:
+    // struct of the archive of a key
+    struct Key_Archive
+    {
+        Segment *head; // oldest segment not freed yet (used by the owner only)
+        Segment *tail; // segment where the tuples are appended (used by the owner only)
+        Segment *first; // first segment (it is not freed before all the replicas have passed it)
+        std::unique_ptr<std::atomic<uint64_t>[]> epochs; // sequence number of the oldest segment still read by each replica
+
+        // Constructor
+        Key_Archive(size_t _n_replicas):
+                    head(new Segment(DEFAULT_SEGMENT_CAPACITY, 0, 0)),
+                    tail(head),
+                    first(head),
+                    epochs(new std::atomic<uint64_t>[_n_replicas])
+        {
+            for (size_t i=0; i<_n_replicas; i++) {
+                epochs[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        // Destructor
+        ~Key_Archive()
+        {
+            while (head != nullptr) {
+                Segment *next = (head->next).load(std::memory_order_relaxed);
+                delete head;
+                head = next;
+            }
+        }
+    };
+
+    // struct of the handle of a replica to the archive of a key
+    struct Key_Handle
+    {
+        Key_Archive *archive = nullptr; // archive of the key
+        Segment *cursor = nullptr; // oldest segment still read by the replica
+    };
+
+private:
+    // struct of the state of a replica (each one in its own cache line)
+    struct alignas(64) Replica_State
+    {
+        std::atomic<uint64_t> progress; // the tuples of the keys owned by the replica with smaller timestamp have been appended
+        std::atomic<uint64_t> appended; // number of tuples appended by the replica
+        std::atomic<uint64_t> copied; // number of tuples copied by the replica at the beginning of a new segment
+        std::atomic<uint64_t> freed; // number of tuples of the segments freed by the replica
+
+        // Constructor
+        Replica_State(): progress(0), appended(0), copied(0), freed(0) {}
+    };
+    size_t n_replicas; // number of replicas of the Win_Farm
+    uint64_t win_len; // window length in time units
+    std::mutex mutex; // mutex protecting the table of the archives
+    std::unordered_map<key_t, std::unique_ptr<Key_Archive>> archives; // archives of the keys
+    std::vector<Replica_State> states; // states of the replicas
+
+    // get the timestamp of a tuple
+    static uint64_t getTS(const tuple_t &_t)
+    {
+        return std::get<2>(_t.getControlFields());
+    }
+
+    // move the cursor of a replica to the last segment with the tuples from the given timestamp, and publish its epoch
+    void advance(Key_Handle &_handle, size_t _replica, uint64_t _ts)
+    {
+        Segment *next = ((_handle.cursor)->next).load(std::memory_order_acquire);
+        if (next == nullptr || next->covered > _ts) {
+            return;
+        }
+        while (next != nullptr && next->covered <= _ts) {
+            _handle.cursor = next;
+            next = (next->next).load(std::memory_order_acquire);
+        }
+        ((_handle.archive)->epochs[_replica]).store((_handle.cursor)->seq, std::memory_order_release);
+    }
+
+    // free the oldest segments of a key already passed by all the replicas
+    void reclaim(Key_Archive &_archive, size_t _owner)
+    {
+        uint64_t min_epoch = std::numeric_limits<uint64_t>::max();
+        for (size_t i=0; i<n_replicas; i++) {
+            min_epoch = std::min(min_epoch, (_archive.epochs[i]).load(std::memory_order_acquire));
+        }
+        while ((_archive.head)->seq < min_epoch) {
+            Segment *old = _archive.head;
+            _archive.head = (old->next).load(std::memory_order_relaxed);
+            states[_owner].freed.fetch_add((old->size).load(std::memory_order_relaxed), std::memory_order_relaxed);
+            delete old;
+        }
+    }
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _n_replicas number of replicas of the Win_Farm
+     *  \param _win_len window length in time units
+     */ 
+    Shared_Archive(size_t _n_replicas,
+                   uint64_t _win_len):
+                   n_replicas(std::max<size_t>(_n_replicas, 1)),
+                   win_len(_win_len),
+                   states(n_replicas) {}
+
+    // get the identifier of the replica owning a key (the one appending its tuples)
+    size_t getOwner(size_t _hashcode) const
+    {
+        return _hashcode % n_replicas;
+    }
+
+    // get the handle of a replica to the archive of a key (created if not present)
+    Key_Handle getHandle(const key_t &_key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &a = archives[_key];
+        if (a == nullptr) {
+            a = std::make_unique<Key_Archive>(n_replicas);
+        }
+        Key_Handle handle;
+        handle.archive = a.get();
+        handle.cursor = a->first;
+        return handle;
+    }
+
+    // append a tuple to the archive of a key (called by the owner of the key only, with tuples in timestamp order)
+    void append(Key_Handle &_handle, const tuple_t &_t, size_t _owner)
+    {
+        Key_Archive &archive = *(_handle.archive);
+        Segment *tail = archive.tail;
+        size_t size = (tail->size).load(std::memory_order_relaxed);
+        // the segment is full: the tuples of the last window length are copied at the beginning of a new one
+        if (size == (tail->tuples).size()) {
+            uint64_t ts = getTS(_t);
+            uint64_t covered = (ts > win_len) ? ts - win_len : 0;
+            auto first = std::lower_bound((tail->tuples).begin(), (tail->tuples).begin() + size, covered, [](const tuple_t &t, uint64_t v) { return getTS(t) < v; });
+            size_t n_copied = std::distance(first, (tail->tuples).begin() + size);
+            Segment *next = new Segment(std::max<size_t>(DEFAULT_SEGMENT_CAPACITY, 2 * (n_copied + 1)), covered, tail->seq + 1);
+            std::copy(first, (tail->tuples).begin() + size, (next->tuples).begin());
+            (next->size).store(n_copied, std::memory_order_relaxed);
+            (tail->next).store(next, std::memory_order_release);
+            archive.tail = next;
+            tail = next;
+            size = n_copied;
+            states[_owner].copied.fetch_add(n_copied, std::memory_order_relaxed);
+            reclaim(archive, _owner);
+        }
+        (tail->tuples)[size] = _t;
+        (tail->size).store(size + 1, std::memory_order_release);
+        states[_owner].appended.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // publish the timestamp of the input processed by a replica (the timestamps of the inputs of a replica never decrease)
+    void publish(size_t _replica, uint64_t _ts)
+    {
+        if (_ts > states[_replica].progress.load(std::memory_order_relaxed)) {
+            states[_replica].progress.store(_ts, std::memory_order_release);
+        }
+    }
+
+    // notify the termination of a replica (all the tuples of the keys it owns have been appended)
+    void terminate(size_t _replica)
+    {
+        states[_replica].progress.store(std::numeric_limits<uint64_t>::max(), std::memory_order_release);
+    }
+
+    // wait until all the tuples with timestamp smaller than the given one have been appended by a replica
+    void waitFor(size_t _owner, uint64_t _ts) const
+    {
+        while (states[_owner].progress.load(std::memory_order_acquire) < _ts) {
+            std::this_thread::yield();
+        }
+    }
+
+    // get the range of the tuples of a key with timestamp in [_start, _end) (the replica does not read the tuples before _start anymore)
+    std::pair<iterator_t, iterator_t> getWinRange(Key_Handle &_handle, size_t _replica, uint64_t _start, uint64_t _end)
+    {
+        advance(_handle, _replica, _start);
+        Segment *segment = _handle.cursor;
+        auto last = (segment->tuples).begin() + (segment->size).load(std::memory_order_acquire);
+        std::pair<iterator_t, iterator_t> its;
+        its.first = std::lower_bound((segment->tuples).begin(), last, _start, [](const tuple_t &t, uint64_t v) { return getTS(t) < v; });
+        its.second = std::lower_bound(its.first, last, _end, [](const tuple_t &t, uint64_t v) { return getTS(t) < v; });
+        return its;
+    }
+
+    // notify that a replica does not read the tuples of a key with timestamp smaller than the given one anymore
+    void release(Key_Handle &_handle, size_t _replica, uint64_t _ts)
+    {
+        advance(_handle, _replica, _ts);
+    }
+
+    /** 
+     *  \brief Get the number of tuples appended to the archive
+     *  
+     *  \return number of tuples appended to the archive by all the replicas
+     */ 
+    uint64_t getNumAppended() const
+    {
+        uint64_t count = 0;
+        for (auto &s: states) {
+            count += s.appended.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    /** 
+     *  \brief Get the number of tuples copied at the beginning of the segments
+     *  
+     *  \return number of tuples copied from a segment to the next one
+     */ 
+    uint64_t getNumCopied() const
+    {
+        uint64_t count = 0;
+        for (auto &s: states) {
+            count += s.copied.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+
+    /** 
+     *  \brief Get the number of tuples stored in the archive
+     *  
+     *  \return number of tuples in the segments not freed yet
+     */ 
+    uint64_t getNumStored() const
+    {
+        uint64_t count = 0;
+        for (auto &s: states) {
+            count += s.appended.load(std::memory_order_relaxed) + s.copied.load(std::memory_order_relaxed) - s.freed.load(std::memory_order_relaxed);
+        }
+        return count;
+    }
+};
+
+} // namespace wf
+
+#endif
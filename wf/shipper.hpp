@@ -36,6 +36,9 @@
 
 /// includes
 #include<ff/node.hpp>
+#include<basic.hpp>
+#include<watermark.hpp>
+#include<time_aligner.hpp>
 
 namespace wf {
 
@@ -51,10 +54,92 @@ template<typename result_t>
 class Shipper
 {
 private:
+    // friendships with other classes in the library
+    template<typename T>
+    friend class Source;
     // ff_node to be used for the delivery
     ff::ff_node *node;
     // counter of the delivered results
     uint64_t n_delivered;
+    // true if the shipper can deliver watermarks (only in the Source operator)
+    bool withWatermarks;
+    // period of the watermarks generated automatically (zero means disabled)
+    uint64_t wm_period;
+    // lateness of the watermarks generated automatically
+    uint64_t wm_lateness;
+    // highest timestamp delivered so far
+    uint64_t max_ts;
+    // last watermark delivered
+    uint64_t last_wm;
+    // wall-clock time (in microseconds) without deliveries after which the idle mark is sent (zero means disabled)
+    uint64_t idle_timeout;
+    // wall-clock time (in microseconds) of the last check finding new deliveries
+    uint64_t last_active;
+    // number of deliveries at the last check of the idleness
+    uint64_t last_checked;
+    // true if the idle mark has been sent and nothing has been delivered since then
+    bool idle;
+    // aligner shared with the other replicas of the Source (nullptr if the event-time alignment is disabled)
+    Time_Aligner *aligner;
+    // identifier of the replica in the aligner
+    size_t aligner_id;
+
+    // generate a periodic watermark (if needed) after the delivery of a result
+    void checkPeriodicWatermark(uint64_t ts)
+    {
+        if (ts > max_ts) {
+            max_ts = ts;
+        }
+        if ((max_ts >= wm_lateness) && (max_ts - wm_lateness >= last_wm + wm_period)) {
+            pushWatermark(max_ts - wm_lateness);
+        }
+    }
+
+    // leave the idle state before a delivery (the last watermark is sent again to reactivate the channel)
+    void resume()
+    {
+        idle = false;
+        node->ff_send_out(createWatermark(last_wm));
+    }
+
+    // send the idle mark if nothing has been delivered for idle_timeout microseconds, and again after
+    // each further idle_timeout while the replica is idle (called by the Source after each call of its
+    // function). The repeated marks let the emitters of the downstream operators run while the stream
+    // is idle (e.g., to release the migrated key groups)
+    void checkIdleness()
+    {
+        if (idle_timeout == 0) {
+            return;
+        }
+        uint64_t now = current_time_usecs();
+        if (n_delivered != last_checked) {
+            last_checked = n_delivered;
+            last_active = now;
+        }
+        else if (now - last_active >= idle_timeout) {
+            idle = true;
+            last_active = now;
+            node->ff_send_out(createIdleMark());
+        }
+    }
+
+    // enable the delivery of watermarks (periodic ones are generated each time the highest timestamp
+    // delivered advances by wm_period time units, zero means that they are only delivered by pushWatermark)
+    void setWatermarks(uint64_t _period, uint64_t _lateness, uint64_t _idle_timeout)
+    {
+        withWatermarks = true;
+        wm_period = _period;
+        wm_lateness = _lateness;
+        idle_timeout = _idle_timeout;
+        last_active = current_time_usecs();
+    }
+
+    // enable the event-time alignment with the other replicas of the Source
+    void setAligner(Time_Aligner *_aligner, size_t _id)
+    {
+        aligner = _aligner;
+        aligner_id = _id;
+    }
 
 public:
     /** 
@@ -64,7 +149,18 @@ public:
      */ 
     Shipper(ff::ff_node &_node):
             node(&_node),
-            n_delivered(0) {}
+            n_delivered(0),
+            withWatermarks(false),
+            wm_period(0),
+            wm_lateness(0),
+            max_ts(0),
+            last_wm(0),
+            idle_timeout(0),
+            last_active(0),
+            last_checked(0),
+            idle(false),
+            aligner(nullptr),
+            aligner_id(0) {}
 
     /** 
      *  \brief Return the number of results delivered
@@ -86,8 +182,18 @@ public:
     {
         result_t *out = new result_t();
         *out = r; // copy of the message!
+        if (idle) {
+            resume();
+        }
         n_delivered++;
-        return node->ff_send_out(out);
+        if (aligner != nullptr) {
+            aligner->align(aligner_id, std::get<2>(r.getControlFields()));
+        }
+        bool done = node->ff_send_out(out);
+        if (wm_period > 0) {
+            checkPeriodicWatermark(std::get<2>(r.getControlFields()));
+        }
+        return done;
     }
 
     /** 
@@ -98,8 +204,42 @@ public:
      */  
     bool push(result_t *r)
     {
+        if (idle) {
+            resume();
+        }
         n_delivered++;
-        return node->ff_send_out(r);
+        if (aligner != nullptr) {
+            aligner->align(aligner_id, std::get<2>(r->getControlFields()));
+        }
+        if (wm_period == 0) {
+            return node->ff_send_out(r);
+        }
+        uint64_t ts = std::get<2>(r->getControlFields()); // r cannot be accessed after the delivery
+        bool done = node->ff_send_out(r);
+        checkPeriodicWatermark(ts);
+        return done;
+    }
+
+    /** 
+     *  \brief Deliver a watermark stating that no further result with timestamp smaller
+     *         than the given one will be delivered by this shipper. It is ignored if the
+     *         watermarks are not enabled or if the watermark does not advance
+     *  
+     *  \param _wm value of the watermark
+     *  \return delivery status (done -> true, failed -> false)
+     */  
+    bool pushWatermark(uint64_t _wm)
+    {
+        if (!withWatermarks || _wm <= last_wm) {
+            return true;
+        }
+        // a watermark also shows that the replica is not idle
+        idle = false;
+        if (idle_timeout > 0) {
+            last_active = current_time_usecs();
+        }
+        last_wm = _wm;
+        return node->ff_send_out(createWatermark(_wm));
     }
 };
 
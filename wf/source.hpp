@@ -24,7 +24,12 @@
  *  @section Source (Description)
  *  
  *  This file implements the Source operator in charge of generating the items of
- *  a data stream.
+ *  a data stream. In the DEFAULT mode, the replicas can also generate watermarks,
+ *  either periodically or explicitly through the Shipper (see watermark.hpp). With
+ *  an idle timeout, a replica whose function has not sent anything for that wall-clock
+ *  time sends the idle mark, so it does not hold back the watermark of the other ones.
+ *  This needs the single-loop version of the function (using the Shipper), which must
+ *  return periodically also when there is nothing to send.
  *  
  *  The template parameter tuple_t must be default constructible, with a copy
  *  Constructor and a copy assignment operator, and it must provide and implement
@@ -36,12 +41,14 @@
 
 /// includes
 #include<string>
+#include<memory>
 #include<ff/node.hpp>
 #include<ff/pipeline.hpp>
 #include<ff/all2all.hpp>
 #include<basic.hpp>
 #include<shipper.hpp>
 #include<context.hpp>
+#include<time_aligner.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
 #endif
@@ -78,6 +85,8 @@ private:
     std::string name; // name of the Source
     size_t parallelism; // internal parallelism of the Source
     bool used; // true if the Source has been added/chained in a MultiPipe
+    bool withWatermarks; // true if the Source generates watermarks
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
     // class Source_Node
     class Source_Node: public ff::ff_node_t<tuple_t>
     {
@@ -94,6 +103,12 @@ private:
         Shipper<tuple_t> *shipper = nullptr; // shipper object used for the delivery of results (single-loop version)
         RuntimeContext context; // RuntimeContext
         bool terminated; // true if the replica has finished its work
+        bool withWatermarks = false; // true if the replica generates watermarks
+        uint64_t wm_period = 0; // period of the watermarks generated automatically (zero means disabled)
+        uint64_t wm_lateness = 0; // lateness of the watermarks generated automatically
+        uint64_t wm_idle_timeout = 0; // wall-clock time (in microseconds) without outputs after which the replica is idle (zero means disabled)
+        std::shared_ptr<Time_Aligner> aligner; // aligner shared by the replicas (nullptr if the event-time alignment is disabled)
+        Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the Source is not placed by the PipeGraph)
 #if defined (TRACE_WINDFLOW)
         Stats_Record stats_record;
         double avg_td_us = 0;
@@ -163,10 +178,21 @@ private:
         // svc_init method (utilized by the FastFlow runtime)
         int svc_init() override
         {
+            // bind the replica to its CPU before it allocates its state
+            placement.bind();
             // create the shipper object used by this replica
             shipper = new Shipper<tuple_t>(*this);
+            context.setShipper(shipper);
+            if (withWatermarks) {
+                shipper->setWatermarks(wm_period, wm_lateness, wm_idle_timeout);
+            }
+            if (aligner) {
+                shipper->setAligner(aligner.get(), context.getReplicaIndex());
+            }
 #if defined (TRACE_WINDFLOW)
             stats_record = Stats_Record(name, std::to_string(this->get_my_id()), false, false);
+            stats_record.cpu = placement.getCPU();
+            stats_record.numa_node = placement.getNode();
 #endif
             return 0;
         }
@@ -181,9 +207,15 @@ private:
             }
             source_func_calls++;
 #endif
+            // execute the callbacks of the expired timers of the replica
+            context.pollTimers();
             // itemized version
             if (isItemized) {
                 if (isEND) {
+                    // the replica does not hold back the other ones anymore
+                    if (aligner) {
+                        aligner->terminate(context.getReplicaIndex());
+                    }
                     terminated = true;
 #if defined (TRACE_WINDFLOW)
                     stats_record.set_Terminated();
@@ -212,12 +244,25 @@ private:
                     stats_record.bytes_sent += sizeof(tuple_t);
                     startTD = current_time_nsecs();
 #endif
+                    // the shipper generates the periodic watermarks after the tuple (and it aligns the replica)
+                    if (withWatermarks) {
+                        shipper->push(t);
+                        return this->GO_ON;
+                    }
+                    // wait until the tuple is not too far ahead of the other replicas
+                    if (aligner) {
+                        aligner->align(context.getReplicaIndex(), std::get<2>(t->getControlFields()));
+                    }
                     return t;
                 }
             }
             // single-loop version
             else {
                 if (isEND) {
+                    // the replica does not hold back the other ones anymore
+                    if (aligner) {
+                        aligner->terminate(context.getReplicaIndex());
+                    }
                     terminated = true;
 #if defined (TRACE_WINDFLOW)
                     stats_record.set_Terminated();
@@ -231,6 +276,10 @@ private:
                     else {
                         isEND = !rich_source_func_loop(*shipper, context); // call the generation function sending some tuples through the shipper
                     }
+                    // the replica notifies that it is idle if the function has not sent anything for a while
+                    if (withWatermarks) {
+                        shipper->checkIdleness();
+                    }
 #if defined (TRACE_WINDFLOW)
                     uint64_t delivered = (shipper->delivered() - last_delivered_count);
                     last_delivered_count = shipper->delivered();
@@ -266,11 +315,38 @@ private:
             return terminated;
         }
 
+        // method to set the CPU and NUMA node of the replica
+        void setPlacement(Placement_Replica _placement)
+        {
+            placement = _placement;
+        }
+
+        // method to enable the generation of watermarks
+        void setWatermarks(uint64_t _period, uint64_t _lateness, uint64_t _idle_timeout)
+        {
+            withWatermarks = true;
+            wm_period = _period;
+            wm_lateness = _lateness;
+            wm_idle_timeout = _idle_timeout;
+        }
+
+        // method to enable the event-time alignment with the other replicas
+        void setAligner(std::shared_ptr<Time_Aligner> _aligner)
+        {
+            aligner = _aligner;
+        }
+
 #if defined (TRACE_WINDFLOW)
         // method to return a copy of the Stats_Record of this node
         Stats_Record get_StatsRecord() const
         {
-            return stats_record;
+            Stats_Record record = stats_record;
+            if (aligner) {
+                record.isAlignedSource = true;
+                record.throttled = aligner->getThrottled(context.getReplicaIndex());
+                record.throttled_usec = aligner->getThrottledTime(context.getReplicaIndex());
+            }
+            return record;
         }
 #endif
     };
@@ -283,25 +359,55 @@ public:
      *  \param _parallelism internal parallelism of the Source operator
      *  \param _name name of the Source operator
      *  \param _closing_func closing function
+     *  \param _withWatermarks true if the Source generates watermarks (DEFAULT mode only)
+     *  \param _wm_period watermarks are generated each time the highest timestamp advances by _wm_period
+     *         time units (zero means that watermarks are only generated through the Shipper)
+     *  \param _wm_lateness the generated watermarks are _wm_lateness time units behind the highest timestamp
+     *  \param _withAlignment true if the replicas are aligned in event time
+     *  \param _align_delta maximum distance (in time units) of the timestamps generated by a replica from
+     *         the lowest timestamp generated by the other replicas (meaningful if _withAlignment is true)
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+     *  \param _wm_idle_timeout wall-clock time (in microseconds) without outputs after which a replica
+     *         sends the idle mark and stops holding back the watermark (zero means disabled)
      */ 
     template<typename F_t>
     Source(F_t _func,
            size_t _parallelism,
            std::string _name,
-           closing_func_t _closing_func):
+           closing_func_t _closing_func,
+           bool _withWatermarks=false,
+           uint64_t _wm_period=0,
+           uint64_t _wm_lateness=0,
+           bool _withAlignment=false,
+           uint64_t _align_delta=0,
+           std::vector<int> _cpus={},
+           uint64_t _wm_idle_timeout=0):
            name(_name),
            parallelism(_parallelism),
-           used(false)
+           used(false),
+           withWatermarks(_withWatermarks),
+           cpus(_cpus)
     {
         // check the validity of the parallelism value
         if (_parallelism == 0) {
             std::cerr << RED << "WindFlow Error: Source has parallelism zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // aligner shared by the replicas (useless with only one replica)
+        std::shared_ptr<Time_Aligner> aligner;
+        if (_withAlignment && _parallelism > 1) {
+            aligner = std::make_shared<Time_Aligner>(_parallelism, _align_delta);
+        }
         // vector of Source_Node
         std::vector<ff_node *> first_set;
         for (size_t i=0; i<_parallelism; i++) {
             auto *seq = new Source_Node(_func, _name, RuntimeContext(_parallelism, i), _closing_func);
+            if (_withWatermarks) {
+                seq->setWatermarks(_wm_period, _wm_lateness, _wm_idle_timeout);
+            }
+            if (aligner) {
+                seq->setAligner(aligner);
+            }
             first_set.push_back(seq);
         }
         // add first set
@@ -348,6 +454,18 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        auto placements = _manager.assign(name, this->getFirstSet().size(), cpus);
+        for (size_t i=0; i<placements.size(); i++) {
+            static_cast<Source_Node *>(this->getFirstSet()[i])->setPlacement(placements[i]);
+        }
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
@@ -24,18 +24,80 @@
  *  @section Splitting_Emitter (Description)
  *  
  *  This file implements the splitting emitter in charge of splitting of a MultiPipe.
+ *  The splitting logic returns the identifier of one destination, a vector of
+ *  identifiers or a std::bitset of destinations. An input with one destination is
+ *  forwarded as it is, while an input with several destinations is sent to all of
+ *  them within a single shared envelope with a reference counter (see createSharedInput
+ *  in meta.hpp). The nodes that only read their inputs release the envelope, and the
+ *  tuple is deleted by the last one. The nodes that modify or keep their inputs take
+ *  the ownership of the tuple with copy-on-write, i.e. they copy it only if other
+ *  destinations still refer to it.
  */ 
 
 #ifndef SPLITTING_H
 #define SPLITTING_H
 
 // includes
+#include<bitset>
 #include<vector>
+#include<functional>
 #include<ff/multinode.hpp>
+#include<meta.hpp>
 #include<basic_emitter.hpp>
+#include<watermark.hpp>
 
 namespace wf {
 
+// metafunction to check whether a type is a std::bitset
+template<typename T>
+struct is_bitset: std::false_type {};
+
+template<size_t N>
+struct is_bitset<std::bitset<N>>: std::true_type {};
+
+/** 
+ *  \class Key_Splitter
+ *  
+ *  \brief Splitting logic based on the key of the inputs
+ *  
+ *  This class implements a splitting logic sending each input to the MultiPipe
+ *  selected by the hashcode of its key (see the split_by_key() method of the
+ *  MultiPipe). All the inputs with the same key are delivered to the same branch.
+ */ 
+template<typename tuple_t>
+class Key_Splitter
+{
+private:
+    // type of the function to map the key hashcode onto an identifier starting from zero to n_dest-1
+    using routing_func_t = std::function<size_t(size_t, size_t)>;
+    size_t n_dest; // number of destinations
+    routing_func_t routing_func; // routing function
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _n_dest number of destinations
+     *  \param _routing_func function to map the key hashcode onto an identifier starting from zero to _n_dest-1
+     */ 
+    Key_Splitter(size_t _n_dest,
+                 routing_func_t _routing_func=default_routing):
+                 n_dest(_n_dest),
+                 routing_func(_routing_func) {}
+
+    /** 
+     *  \brief Select the destination of an input
+     *  
+     *  \param _t input tuple
+     *  \return identifier of the destination starting from zero to n_dest-1
+     */ 
+    size_t operator()(const tuple_t &_t) const
+    {
+        auto key = std::get<0>(_t.getControlFields()); // key
+        return routing_func(std::hash<decltype(key)>()(key), n_dest);
+    }
+};
+
 // class Splitting_Emitter
 template<typename F_t>
 class Splitting_Emitter: public Basic_Emitter
@@ -51,28 +113,24 @@ private:
         "WindFlow Compilation Error - unknown signature used in a MultiPipe splitting:\n"
         "  Candidate 1 : size_t(const tuple_t &)\n"
         "  Candidate 2 : std::vector<size_t>(const tuple_t &)\n"
-        "  Candidate 3 : size_t(tuple_t &)\n"
-        "  Candidate 4 : std::vector<size_t>(tuple_t &)\n"
+        "  Candidate 3 : std::bitset<N>(const tuple_t &)\n"
+        "  Candidate 4 : size_t(tuple_t &)\n"
+        "  Candidate 5 : std::vector<size_t>(tuple_t &)\n"
+        "  Candidate 6 : std::bitset<N>(tuple_t &)\n"
         "  You can replace size_t in the signatures above with any C++ integral type\n");
     size_t n_dest; // number of destinations
     bool isCombined; // true if this node is used within a Tree_Emitter node
     std::vector<std::pair<void *, int>> output_queue; // used in case of Tree_Emitter mode
 
-    // method for calling the splitting function (used if it returns a single identifier)
-    template<typename split_func_t=F_t>
-    std::vector<size_t> callSplittingFunction(typename std::enable_if<std::is_same<split_func_t, split_func_t>::value && std::is_integral<result_t>::value, F_t>::type &func, tuple_t &t)
-    {
-        std::vector<size_t> dests;
-        auto dest = func(t);
-        dests.push_back(dest); // integral type will be converted into size_t
-        return dests;
-    }
-
-    // method for calling the splitting function (used if it returns a vector of identifiers)
-    template<typename split_func_t=F_t>
-    auto callSplittingFunction(typename std::enable_if<std::is_same<split_func_t, split_func_t>::value && !std::is_integral<result_t>::value, F_t>::type &func, tuple_t &t)
+    // send a message to a destination
+    void send(void *_msg, size_t _dest)
     {
-        return func(t);
+        if (!isCombined) {
+            this->ff_send_out_to(_msg, _dest);
+        }
+        else {
+            output_queue.push_back(std::make_pair(_msg, _dest));
+        }
     }
 
 public:
@@ -99,27 +157,49 @@ public:
     // svc method (utilized by the FastFlow runtime)
     void *svc(void *in) override
     {
-        tuple_t *t = reinterpret_cast<tuple_t *>(in);
-        auto dests_w = callSplittingFunction(splitting_func, *t);
-        assert(dests_w.size() <= n_dest);
-        // the input must be dropped (like in a filter)
-        if (dests_w.size() == 0) {
-            delete t;
+        // watermarks are broadcast to all the destinations
+        if (isWatermark(in)) {
+            for (size_t i=0; i<n_dest; i++) {
+                send(in, i);
+            }
             return this->GO_ON;
         }
-        size_t idx = 0;
-        while (idx < dests_w.size()) {
-            assert(dests_w[idx] < n_dest);
-            // send tuple
-            if (!isCombined) {
-                this->ff_send_out_to(t, dests_w[idx]);
+        // the splitting logic can modify the input, so it must be owned by this node
+        tuple_t *t = ownInput(reinterpret_cast<tuple_t *>(in));
+        auto dests_w = splitting_func(*t);
+        // single destination: the input is forwarded without any copy
+        if constexpr (std::is_integral<result_t>::value) {
+            assert(static_cast<size_t>(dests_w) < n_dest);
+            send(t, dests_w); // integral type will be converted into size_t
+        }
+        // set of destinations: the same envelope is sent to all of them
+        else if constexpr (is_bitset<result_t>::value) {
+            size_t n_sends = dests_w.count();
+            // the input must be dropped (like in a filter)
+            if (n_sends == 0) {
+                delete t;
+                return this->GO_ON;
+            }
+            tuple_t *out = (n_sends > 1) ? createSharedInput(t, n_sends) : t;
+            for (size_t i=0; n_sends>0; i++) {
+                if (dests_w.test(i)) {
+                    assert(i < n_dest);
+                    n_sends--;
+                    send(out, i);
+                }
             }
-            else {
-                output_queue.push_back(std::make_pair(t, dests_w[idx]));
+        }
+        else {
+            assert(dests_w.size() <= n_dest);
+            // the input must be dropped (like in a filter)
+            if (dests_w.size() == 0) {
+                delete t;
+                return this->GO_ON;
             }
-            idx++;
-            if (idx < dests_w.size()) {
-                t = new tuple_t(*t); // copy of the input tuple
+            tuple_t *out = (dests_w.size() > 1) ? createSharedInput(t, dests_w.size()) : t;
+            for (size_t idx=0; idx<dests_w.size(); idx++) {
+                assert(static_cast<size_t>(dests_w[idx]) < n_dest);
+                send(out, dests_w[idx]);
             }
         }
         return this->GO_ON;
@@ -32,8 +32,13 @@
 // includes
 #include<vector>
 #include<basic.hpp>
+#include<meta.hpp>
 #include<ff/multinode.hpp>
 #include<basic_emitter.hpp>
+#include<watermark.hpp>
+#include<key_groups.hpp>
+#include<elastic.hpp>
+#include<ondemand.hpp>
 
 namespace wf {
 
@@ -50,23 +55,43 @@ private:
     std::vector<std::pair<void *, int>> output_queue; // used in case of Tree_Emitter mode
     size_t dest_w; // used to select the destination
     size_t n_dest; // number of destinations
+    KeyGroup_Router router; // router of the key groups (disabled if the key groups are not used)
+    Elastic_Router elastic; // router among the active replicas (disabled if the operator is not elastic)
+    OnDemand_Router ondemand; // router to the replicas with the shortest queues (disabled if the on-demand scheduling is not used)
+
+    // send a message to a destination
+    void send(void *_msg, size_t _dest)
+    {
+        if (!isCombined) {
+            this->ff_send_out_to(_msg, _dest);
+        }
+        else {
+            output_queue.push_back(std::make_pair(_msg, _dest));
+        }
+    }
 
 public:
     // Constructor I
-    Standard_Emitter(size_t _n_dest):
+    Standard_Emitter(size_t _n_dest,
+                     std::shared_ptr<Elastic_Controller> _elastic=nullptr,
+                     std::shared_ptr<Credit_Table> _ondemand=nullptr):
                      isKeyBy(false),
                      isCombined(false),
                      dest_w(0),
-                     n_dest(_n_dest) {}
+                     n_dest(_n_dest),
+                     elastic(_elastic),
+                     ondemand(_ondemand) {}
 
     // Constructor II
     Standard_Emitter(routing_func_t _routing_func,
-                     size_t _n_dest):
+                     size_t _n_dest,
+                     std::shared_ptr<KeyGroup_Manager> _kg_manager=nullptr):
                      isKeyBy(true),
                      routing_func(_routing_func),
                      isCombined(false),
                      dest_w(0),
-                     n_dest(_n_dest) {}
+                     n_dest(_n_dest),
+                     router(_kg_manager) {}
 
     // clone method
     Basic_Emitter *clone() const override
@@ -84,13 +109,43 @@ public:
     // svc method (utilized by the FastFlow runtime)
     void *svc(void *in) override
     {
+        // the replicas parked or activated again since the last input are notified (if the operator is elastic)
+        if (elastic.isEnabled()) {
+            elastic.sync([this](void *_msg, size_t _dest) { send(_msg, _dest); });
+        }
+        // watermarks are broadcast to all the destinations (after the release markers of the migrated key groups), or to the active ones if the operator is elastic
+        if (isWatermark(in)) {
+            if (router.isEnabled()) {
+                router.sync([this](void *_msg, size_t _dest) { send(_msg, _dest); });
+            }
+            size_t n = n_dest;
+            if (elastic.isEnabled()) {
+                elastic.setPunctuation(in);
+                n = elastic.getActive();
+            }
+            for (size_t i=0; i<n; i++) {
+                if (!isCombined) {
+                    this->ff_send_out_to(in, i);
+                }
+                else {
+                    output_queue.push_back(std::make_pair(in, i));
+                }
+            }
+            return this->GO_ON;
+        }
+        // a shared envelope of a split is forwarded as it is (the replicas own it with copy-on-write only if they modify it)
         tuple_t *t = reinterpret_cast<tuple_t *>(in);
         if (isKeyBy) { // keyed-based distribution enabled
             // extract the key from the input tuple
-            auto key = std::get<0>(t->getControlFields()); // key
+            auto key = std::get<0>(extractTuple<tuple_t, tuple_t>(t)->getControlFields()); // key
             size_t hashcode = std::hash<decltype(key)>()(key); // compute the hashcode of the key
-            // evaluate the routing function
-            dest_w = routing_func(hashcode, n_dest);
+            // evaluate the routing function (through the assignment of the key groups if they are used)
+            if (router.isEnabled()) {
+                dest_w = router.route(hashcode, [this](void *_msg, size_t _dest) { send(_msg, _dest); });
+            }
+            else {
+                dest_w = routing_func(hashcode, n_dest);
+            }
             // send the tuple
             if (!isCombined)
                this->ff_send_out_to(t, dest_w);
@@ -98,6 +153,16 @@ public:
                 output_queue.push_back(std::make_pair(t, dest_w));
             return this->GO_ON;
         }
+        else if (elastic.isEnabled()) { // round-robin among the active replicas of an elastic operator
+            dest_w = elastic.route();
+            send(t, dest_w);
+            return this->GO_ON;
+        }
+        else if (ondemand.isEnabled()) { // on-demand scheduling to the replica with the shortest queue
+            dest_w = ondemand.route();
+            send(t, dest_w);
+            return this->GO_ON;
+        }
         else { // default distribution
             if (!isCombined) {
                 return t; // <- pseudo round-robin of FastFlow
@@ -113,6 +178,19 @@ public:
         }
     }
 
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        // the release markers of the migrations not applied yet are sent before the EOS
+        if (router.isEnabled()) {
+            router.close([this](void *_msg, size_t _dest) { send(_msg, _dest); });
+        }
+        // the parked replicas wake up to receive the EOS
+        if (elastic.isEnabled()) {
+            elastic.close();
+        }
+    }
+
     // svc_end method (FastFlow runtime)
     void svc_end() override {}
 
@@ -35,12 +35,29 @@
 #include<fstream>
 #include<iomanip>
 #include<sstream>
+#include<vector>
+#include<algorithm>
 #include<time.h>
 #include<rapidjson/prettywriter.h>
 #include<basic.hpp>
 
 namespace wf {
 
+// compute the imbalance of the inputs received by the replicas of an operator (maximum over average, one if balanced)
+inline double compute_imbalance(const std::vector<uint64_t> &_inputs)
+{
+    uint64_t total = 0;
+    uint64_t max = 0;
+    for (auto n: _inputs) {
+        total += n;
+        max = std::max(max, n);
+    }
+    if (total == 0) {
+        return 1;
+    }
+    return ((double) max * _inputs.size()) / total;
+}
+
 // class Stats_Record
 class Stats_Record
 {
@@ -77,6 +94,26 @@ public:
     uint64_t num_kernels = 0; // number of kernels calls
     uint64_t bytes_copied_hd = 0; // bytes copied from Host to Device
     uint64_t bytes_copied_dh = 0; // bytes copied from Device to Host
+    // the following variables are meaningful for replicas processing time-based windows in quanta
+    uint64_t ring_max_size = 0; // maximum number of open quanta per key
+    double ring_occupancy = 0; // average number of open quanta per key
+    uint64_t quanta_skipped = 0; // number of empty quanta coalesced without being materialized
+    // the following variables are meaningful for replicas processing session windows
+    bool isSessionOP = false; // true if the replica processes session windows
+    uint64_t sessions_opened = 0; // number of sessions opened
+    uint64_t sessions_merged = 0; // number of sessions merged with a previous one
+    uint64_t active_keys = 0; // number of keys with open sessions
+    // the following variables are meaningful for the nodes reordering inputs in PROBABILISTIC mode
+    bool isSlackNode = false; // true if the record belongs to a KSlack_Node
+    uint64_t slack_K = 0; // current value of the slack
+    uint64_t slack_buffer_size = 0; // current number of buffered inputs
+    // the following variables are meaningful for the Source replicas aligned in event time
+    bool isAlignedSource = false; // true if the record belongs to a Source replica aligned with the other ones
+    uint64_t throttled = 0; // number of times the replica has been throttled
+    uint64_t throttled_usec = 0; // time spent by the replica while being throttled (in microseconds)
+    // the following variables are meaningful for the replicas placed by the PipeGraph
+    int cpu = -1; // CPU of the replica (-1 if the replica is not placed)
+    int numa_node = -1; // NUMA node of the CPU (-1 if the replica is not placed)
 
     // Contructor I
     Stats_Record()
@@ -118,6 +155,10 @@ public:
     {
         // append the statistics of this operator replica
         writer.StartObject();
+        if (isSlackNode) {
+            writer.Key("Operator_name");
+            writer.String(nameOP.c_str());
+        }
         writer.Key("Replica_id");
         writer.String(nameReplica.c_str());
         writer.Key("Starting_time");
@@ -143,6 +184,8 @@ public:
         if (isWinOP) {
             writer.Key("Inputs_ingored");
             writer.Uint64(inputs_ignored);
+            writer.Key("Inputs_ignored_ratio");
+            writer.Double((inputs_received > 0) ? ((double) inputs_ignored) / inputs_received : 0);
         }
         writer.Key("Outputs_sent");
         writer.Uint64(outputs_sent);
@@ -152,6 +195,12 @@ public:
         writer.Double(service_time.count());
         writer.Key("Eff_Service_time_usec");
         writer.Double(eff_service_time.count());
+        if (cpu >= 0) {
+            writer.Key("CPU");
+            writer.Int(cpu);
+            writer.Key("NUMA_node");
+            writer.Int(numa_node);
+        }
         if (isGPUReplica) {
             writer.Key("Kernels_launched");
             writer.Uint64(num_kernels);
@@ -160,6 +209,38 @@ public:
             writer.Key("Bytes_D2H");
             writer.Uint64(bytes_copied_dh);
         }
+        if (ring_max_size > 0) {
+            writer.Key("Quanta_ring_size");
+            writer.Uint64(ring_max_size);
+            writer.Key("Quanta_ring_occupancy");
+            writer.Double(ring_occupancy);
+            writer.Key("Quanta_skipped");
+            writer.Uint64(quanta_skipped);
+        }
+        if (isSlackNode) {
+            writer.Key("Slack_K");
+            writer.Uint64(slack_K);
+            writer.Key("Slack_dropped");
+            writer.Uint64(inputs_ignored);
+            writer.Key("Slack_drop_rate");
+            writer.Double((inputs_received > 0) ? ((double) inputs_ignored) / inputs_received : 0);
+            writer.Key("Slack_buffer_size");
+            writer.Uint64(slack_buffer_size);
+        }
+        if (isAlignedSource) {
+            writer.Key("Throttled");
+            writer.Uint64(throttled);
+            writer.Key("Throttled_time_usec");
+            writer.Uint64(throttled_usec);
+        }
+        if (isSessionOP) {
+            writer.Key("Sessions_opened");
+            writer.Uint64(sessions_opened);
+            writer.Key("Sessions_merged");
+            writer.Uint64(sessions_merged);
+            writer.Key("Active_keys");
+            writer.Uint64(active_keys);
+        }
         writer.EndObject();
     }
 };
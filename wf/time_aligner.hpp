@@ -0,0 +1,146 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    time_aligner.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    05/11/2020
+ *  
+ *  @brief Event-time alignment of the replicas of a Source operator
+ *  
+ *  @section Time_Aligner (Description)
+ *  
+ *  This file implements the Time_Aligner class shared by the replicas of a Source
+ *  operator. Each replica publishes the highest timestamp it is going to generate,
+ *  and it is throttled while that timestamp is more than delta time units ahead of
+ *  the lowest one published by the other replicas (the shared low-watermark). In this
+ *  way, the nodes reordering the stream in the DETERMINISTIC and PROBABILISTIC modes
+ *  (Ordering_Node and KSlack_Node) never buffer the inputs of a fast channel for more
+ *  than delta time units while waiting for the slowest channel.
+ *  
+ *  The replica generating the lowest timestamp is never throttled, since the timestamp
+ *  is published before waiting. A terminated replica does not hold back the others.
+ */ 
+
+#ifndef TIME_ALIGNER_H
+#define TIME_ALIGNER_H
+
+// includes
+#include<vector>
+#include<atomic>
+#include<thread>
+#include<limits>
+#include<basic.hpp>
+
+namespace wf {
+
+// class Time_Aligner
+class Time_Aligner
+{
+private:
+    // struct of the state of a replica (each one in its own cache line)
+    struct alignas(64) Replica_State
+    {
+        std::atomic<uint64_t> max_ts; // highest timestamp published by the replica
+        uint64_t low; // last low-watermark read by the replica (used by the replica only)
+        uint64_t throttled; // number of times the replica has been throttled
+        uint64_t throttled_usec; // time spent by the replica while being throttled (in microseconds)
+
+        // Constructor
+        Replica_State(): max_ts(0), low(0), throttled(0), throttled_usec(0) {}
+    };
+    std::vector<Replica_State> states; // states of the replicas
+    uint64_t delta; // maximum distance in time units from the low-watermark
+
+    // check whether a timestamp is more than delta time units ahead of the low-watermark
+    bool isAhead(uint64_t _ts, uint64_t _low) const
+    {
+        return (_ts > delta) && (_ts - delta > _low);
+    }
+
+public:
+    // Constructor
+    Time_Aligner(size_t _n_replicas,
+                 uint64_t _delta):
+                 states(_n_replicas),
+                 delta(_delta) {}
+
+    // publish the highest timestamp that will be generated by a replica
+    void publish(size_t _id, uint64_t _ts)
+    {
+        Replica_State &state = states[_id];
+        if (_ts > state.max_ts.load(std::memory_order_relaxed)) {
+            state.max_ts.store(_ts, std::memory_order_release);
+        }
+    }
+
+    // get the lowest timestamp published by the replicas other than the given one
+    uint64_t getLowWatermark(size_t _id) const
+    {
+        uint64_t low = std::numeric_limits<uint64_t>::max();
+        for (size_t i=0; i<states.size(); i++) {
+            if (i != _id) {
+                low = std::min(low, states[i].max_ts.load(std::memory_order_acquire));
+            }
+        }
+        return low;
+    }
+
+    // publish the timestamp of the next tuple of a replica and wait until it is not too far ahead of the other replicas
+    void align(size_t _id, uint64_t _ts)
+    {
+        Replica_State &state = states[_id];
+        publish(_id, _ts);
+        // fast path: the low-watermark never goes back, so the last one read suffices
+        if (!isAhead(_ts, state.low)) {
+            return;
+        }
+        state.low = getLowWatermark(_id);
+        if (!isAhead(_ts, state.low)) {
+            return;
+        }
+        // throttling
+        uint64_t start = current_time_usecs();
+        state.throttled++;
+        while (isAhead(_ts, state.low)) {
+            std::this_thread::yield();
+            state.low = getLowWatermark(_id);
+        }
+        state.throttled_usec += current_time_usecs() - start;
+    }
+
+    // notify the termination of a replica (it does not hold back the others anymore)
+    void terminate(size_t _id)
+    {
+        states[_id].max_ts.store(std::numeric_limits<uint64_t>::max(), std::memory_order_release);
+    }
+
+    // get the number of times a replica has been throttled
+    uint64_t getThrottled(size_t _id) const
+    {
+        return states[_id].throttled;
+    }
+
+    // get the time spent by a replica while being throttled (in microseconds)
+    uint64_t getThrottledTime(size_t _id) const
+    {
+        return states[_id].throttled_usec;
+    }
+};
+
+} // namespace wf
+
+#endif
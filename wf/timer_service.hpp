@@ -0,0 +1,233 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    timer_service.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    02/11/2020
+ *  
+ *  @brief Class implementing the processing-time timers of an operator replica
+ *  
+ *  @section TimerService (Description)
+ *  
+ *  This file implements the TimerService class. It is a private facility per replica
+ *  used to register callbacks to be executed at a given processing time (one-shot
+ *  timers) or periodically (periodic timers). The timers are kept in a hashed timer
+ *  wheel, and they are checked by the replica itself within its own processing loop
+ *  (before each input and on the arrival of punctuations like watermarks), so no
+ *  further thread is used and the callbacks are never executed concurrently with the
+ *  processing logic of the replica. FastFlow cannot wake up a replica waiting on its
+ *  empty input queue after a timeout, so on an idle stream the wakeups are the idle
+ *  marks that the Sources repeat after each idle timeout of their watermarks, and
+ *  the delay of the timers is bounded by that timeout (DEFAULT mode). Without the
+ *  idle timeout, the timers of an idle replica fire at its next input or at the end
+ *  of the stream. The callbacks can emit results through the Shipper of the replica
+ *  (see RuntimeContext).
+ */ 
+
+#ifndef TIMER_SERVICE_H
+#define TIMER_SERVICE_H
+
+/// includes
+#include<vector>
+#include<algorithm>
+#include<functional>
+#include<unordered_set>
+#include<basic.hpp>
+
+namespace wf {
+
+class RuntimeContext;
+
+/** 
+ *  \class TimerService
+ *  
+ *  \brief TimerService class used to maintain the processing-time timers of an operator replica
+ *  
+ *  This class implements the TimerService object. Timers are identified by a unique number
+ *  and their callbacks receive the RuntimeContext of the replica. The resolution of the
+ *  timers is given by the length of the tick of the wheel.
+ */ 
+class TimerService
+{
+public:
+    /// type of the callback of a timer
+    using timer_func_t = std::function<void(RuntimeContext &)>;
+
+private:
+    // struct of a timer registered in the wheel
+    struct Timer_Entry
+    {
+        uint64_t id; // identifier of the timer
+        uint64_t deadline; // firing time of the timer (in microseconds)
+        uint64_t period; // period of the timer (zero for one-shot timers)
+        timer_func_t func; // callback of the timer
+    };
+    uint64_t tick_len; // length of a tick of the wheel (in microseconds)
+    std::vector<std::vector<Timer_Entry>> wheel; // slots of the wheel (a timer is in the slot of its deadline tick)
+    uint64_t last_tick; // last tick whose slot has been checked (the one of the current tick is checked when the tick is over)
+    uint64_t next_id; // identifier of the next registered timer
+    std::unordered_set<uint64_t> active; // identifiers of the timers not fired yet or periodic (cancelled timers are removed lazily)
+    std::vector<Timer_Entry> expired; // timers expired during the current check (reused to avoid allocations)
+
+    // insert a timer in the slot of its deadline tick
+    void insert(Timer_Entry &&_entry)
+    {
+        uint64_t tick = std::max(_entry.deadline / tick_len, last_tick + 1);
+        wheel[tick & (wheel.size() - 1)].push_back(std::move(_entry));
+    }
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _tick_len length of a tick of the wheel in microseconds (resolution of the timers)
+     *  \param _n_slots number of slots of the wheel (rounded up to a power of two)
+     */ 
+    TimerService(uint64_t _tick_len=1000,
+                 size_t _n_slots=256):
+                 tick_len(std::max<uint64_t>(_tick_len, 1)),
+                 last_tick(0),
+                 next_id(0)
+    {
+        size_t n = 1;
+        while (n < _n_slots) {
+            n <<= 1;
+        }
+        wheel.resize(n);
+    }
+
+    /** 
+     *  \brief Register a one-shot timer
+     *  
+     *  \param _time processing time (in microseconds, as returned by current_time_usecs()) when the timer fires
+     *  \param _func callback of the timer
+     *  \return identifier of the timer
+     */ 
+    uint64_t registerTimer(uint64_t _time, timer_func_t _func)
+    {
+        if (active.empty()) {
+            last_tick = (current_time_usecs() / tick_len) - 1;
+        }
+        uint64_t id = next_id++;
+        active.insert(id);
+        insert(Timer_Entry{id, _time, 0, _func});
+        return id;
+    }
+
+    /** 
+     *  \brief Register a periodic timer whose first firing is after one period
+     *  
+     *  \param _period period of the timer (in microseconds)
+     *  \param _func callback of the timer
+     *  \return identifier of the timer
+     */ 
+    uint64_t registerPeriodicTimer(uint64_t _period, timer_func_t _func)
+    {
+        if (active.empty()) {
+            last_tick = (current_time_usecs() / tick_len) - 1;
+        }
+        _period = std::max<uint64_t>(_period, 1);
+        uint64_t id = next_id++;
+        active.insert(id);
+        insert(Timer_Entry{id, current_time_usecs() + _period, _period, _func});
+        return id;
+    }
+
+    /** 
+     *  \brief Cancel a timer (if it has not fired yet or it is periodic)
+     *  
+     *  \param _id identifier of the timer
+     */ 
+    void cancelTimer(uint64_t _id)
+    {
+        active.erase(_id);
+    }
+
+    /** 
+     *  \brief Return the number of timers still active
+     *  
+     *  \return number of active timers
+     */ 
+    size_t getNumTimers() const
+    {
+        return active.size();
+    }
+
+    /** 
+     *  \brief Execute the callbacks of the expired timers (in order of firing time)
+     *  
+     *  \param _context RuntimeContext passed to the callbacks
+     */ 
+    void poll(RuntimeContext &_context)
+    {
+        // fast path: no timer or no tick is over since the last check
+        if (active.empty()) {
+            return;
+        }
+        uint64_t now = current_time_usecs();
+        uint64_t end_tick = (now / tick_len) - 1; // last tick that is over
+        if (end_tick <= last_tick) {
+            return;
+        }
+        // check the slots of the elapsed ticks (each slot at most once)
+        uint64_t n_ticks = std::min<uint64_t>(end_tick - last_tick, wheel.size());
+        for (uint64_t t=end_tick-n_ticks+1; t<=end_tick; t++) {
+            auto &slot = wheel[t & (wheel.size() - 1)];
+            size_t j = 0;
+            for (size_t i=0; i<slot.size(); i++) {
+                if (active.find(slot[i].id) == active.end()) {
+                    continue; // cancelled timer
+                }
+                if (slot[i].deadline <= now) {
+                    expired.push_back(std::move(slot[i]));
+                }
+                else {
+                    if (i != j) {
+                        slot[j] = std::move(slot[i]);
+                    }
+                    j++;
+                }
+            }
+            slot.resize(j);
+        }
+        last_tick = end_tick;
+        // execute the callbacks (they can register or cancel timers)
+        std::sort(expired.begin(), expired.end(), [](const Timer_Entry &a, const Timer_Entry &b) { return a.deadline < b.deadline; });
+        std::vector<Timer_Entry> fired;
+        fired.swap(expired);
+        for (auto &entry: fired) {
+            if (active.find(entry.id) == active.end()) {
+                continue; // cancelled by a previous callback
+            }
+            if (entry.period == 0) {
+                active.erase(entry.id);
+            }
+            (entry.func)(_context);
+            // periodic timers are re-inserted (skipping the periods already elapsed)
+            if (entry.period > 0 && active.find(entry.id) != active.end()) {
+                entry.deadline += entry.period * (1 + (now - entry.deadline) / entry.period);
+                insert(std::move(entry));
+            }
+        }
+        fired.clear();
+        fired.swap(expired);
+    }
+};
+
+} // namespace wf
+
+#endif
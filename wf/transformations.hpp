@@ -33,18 +33,46 @@
 // includes
 #include<ff/ff.hpp>
 #include<basic.hpp>
+#include<watermark.hpp>
+#include<key_groups.hpp>
 
 namespace wf {
 
 // struct of the dummy multi-input node
 struct dummy_mi: ff::ff_minode
 {
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+    std::unordered_map<size_t, size_t> markers; // number of release markers received for each key group
+
     dummy_mi(ordering_mode_t _mode=ordering_mode_t::TS, std::atomic<unsigned long> *atomic_num_dropped=nullptr) {}
 
     void *svc(void *in) override
     {
+        // watermarks are merged among the input channels and forwarded
+        if (isWatermark(in)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(in))) {
+                this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+            }
+            return this->GO_ON;
+        }
+        // release markers of the key groups are forwarded once received from all the input channels
+        if (isKeyGroupMarker(in)) {
+            size_t &count = markers[getKeyGroup(in)];
+            if (++count == this->get_num_inchannels()) {
+                markers.erase(getKeyGroup(in));
+                return in;
+            }
+            return this->GO_ON;
+        }
         return in;
     }
+
+    void eosnotify(ssize_t id) override
+    {
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+        }
+    }
 };
 
 // struct of the dummy multi-ouput node
@@ -0,0 +1,228 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */
+
+/** 
+ *  @file    watermark.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    23/10/2020
+ *  
+ *  @brief Watermark punctuations
+ *  
+ *  @section Watermarks (Description)
+ *  
+ *  Watermarks are punctuations notifying the progress of event time in the DEFAULT
+ *  mode. A watermark with value w received from an input channel states that no
+ *  further tuple with timestamp smaller than w will be received from that channel.
+ *  
+ *  Watermarks are not allocated in the heap: their value is encoded in the pointer
+ *  exchanged between the nodes, whose lowest bit is set (it is always zero for the
+ *  pointers to tuples and wrappers). So, a watermark can be broadcast to several
+ *  destinations without any reference counting. Nodes with multiple input channels
+ *  forward the minimum of the most recent watermarks received from their channels
+ *  (a terminated channel does not hold back the watermark anymore).
+ *  
+ *  A Source replica that has not delivered anything for a given wall-clock time (idle
+ *  timeout) sends an idle mark, i.e. a watermark with the reserved value IDLE_WATERMARK.
+ *  The channel is excluded from the minimum until it delivers a new watermark (sent by
+ *  the replica before its next tuple), and a node whose open channels are all idle
+ *  forwards the idle mark in turn. The idle marks are repeated after each idle timeout
+ *  while the replica is idle, and an idle node forwards those of its first open channel.
+ *  The tuples received from a channel which becomes active again may be late with
+ *  respect to the watermark reached in the meantime.
+ */ 
+
+#ifndef WATERMARK_H
+#define WATERMARK_H
+
+// includes
+#include<vector>
+#include<limits>
+#include<algorithm>
+#include<stdint.h>
+#include<sys/types.h>
+
+namespace wf {
+
+// reserved value of the idle marks (the encoded pointer never clashes with the special values of FastFlow)
+#define IDLE_WATERMARK ((((uint64_t) 1) << 62) - 1)
+
+// greatest value of a watermark
+#define MAX_WATERMARK (IDLE_WATERMARK - 1)
+
+// function createWatermark: encode a watermark into a pointer
+inline void *createWatermark(uint64_t _wm)
+{
+    if (_wm > MAX_WATERMARK) {
+        _wm = MAX_WATERMARK;
+    }
+    return reinterpret_cast<void *>((static_cast<uintptr_t>(_wm) << 1) | 1);
+}
+
+// function isWatermark: check whether a pointer received by a node is a watermark
+inline bool isWatermark(const void *_p)
+{
+    uintptr_t v = reinterpret_cast<uintptr_t>(_p);
+    return ((v & 1) != 0) && ((v >> 63) == 0);
+}
+
+// function getWatermark: decode the value of a watermark
+inline uint64_t getWatermark(const void *_p)
+{
+    return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(_p) >> 1);
+}
+
+// function createIdleMark: encode the idle mark into a pointer
+inline void *createIdleMark()
+{
+    return reinterpret_cast<void *>((static_cast<uintptr_t>(IDLE_WATERMARK) << 1) | 1);
+}
+
+// function isIdleMark: check whether a pointer received by a node is an idle mark
+inline bool isIdleMark(const void *_p)
+{
+    return isWatermark(_p) && (getWatermark(_p) == IDLE_WATERMARK);
+}
+
+// class Watermark_Merger
+class Watermark_Merger
+{
+private:
+    std::vector<uint64_t> wms; // most recent watermark received from each input channel
+    std::vector<bool> closed; // closed[i] is true if the i-th input channel is terminated
+    std::vector<bool> idle; // idle[i] is true if the i-th input channel is idle
+    uint64_t current; // current watermark (minimum among the input channels still open and not idle)
+    bool active; // true if at least one watermark has been received
+    bool allIdle; // true if all the input channels still open are idle
+
+    // adapt the vectors to the number of input channels (a node without input channels, like the
+    // second one of a combination, has a single logical channel whose identifier is meaningless)
+    size_t getChannel(ssize_t _ch, size_t _n_channels)
+    {
+        size_t ch = (_ch < 0 || _n_channels <= 1) ? 0 : _ch;
+        size_t n = std::max(std::max(_n_channels, (size_t) 1), ch + 1);
+        if (wms.size() < n) {
+            wms.resize(n, 0);
+            closed.resize(n, false);
+            idle.resize(n, false);
+        }
+        return ch;
+    }
+
+    // get the first input channel still open
+    size_t firstOpen() const
+    {
+        size_t i = 0;
+        while (i < closed.size() && closed[i]) {
+            i++;
+        }
+        return i;
+    }
+
+    // recompute the current watermark, returns true if it has advanced or if the idleness of the node has changed
+    bool advance()
+    {
+        uint64_t min = std::numeric_limits<uint64_t>::max();
+        bool open = false;
+        bool working = false;
+        for (size_t i=0; i<wms.size(); i++) {
+            if (!closed[i]) {
+                open = true;
+                if (!idle[i]) {
+                    working = true;
+                    min = std::min(min, wms[i]);
+                }
+            }
+        }
+        bool wasIdle = allIdle;
+        allIdle = open && !working;
+        // all the input channels are terminated or idle
+        if (!working) {
+            return allIdle && !wasIdle;
+        }
+        if (min > current) {
+            current = min;
+            return true;
+        }
+        // the current watermark is forwarded again when the node is not idle anymore
+        return wasIdle;
+    }
+
+public:
+    // Constructor
+    Watermark_Merger(): current(0), active(false), allIdle(false) {}
+
+    // receive a watermark (or an idle mark) from an input channel, returns true if the punctuation to be forwarded has changed
+    bool update(ssize_t _ch, size_t _n_channels, uint64_t _wm)
+    {
+        size_t ch = getChannel(_ch, _n_channels);
+        active = true;
+        if (_wm == IDLE_WATERMARK) {
+            // the idle marks repeated by the first open channel are forwarded by an idle node (once per period of that channel)
+            if (idle[ch]) {
+                return allIdle && (ch == firstOpen());
+            }
+            idle[ch] = true;
+            return advance();
+        }
+        // the channel is active again
+        if (idle[ch]) {
+            idle[ch] = false;
+            wms[ch] = std::max(wms[ch], _wm);
+            return advance();
+        }
+        if (_wm > wms[ch]) {
+            wms[ch] = _wm;
+            return advance();
+        }
+        return false;
+    }
+
+    // notify the termination of an input channel, returns true if the punctuation to be forwarded has changed
+    bool close(ssize_t _ch, size_t _n_channels)
+    {
+        size_t ch = getChannel(_ch, _n_channels);
+        closed[ch] = true;
+        return active && advance();
+    }
+
+    // get the current watermark
+    uint64_t get() const
+    {
+        return current;
+    }
+
+    // check whether watermarks have been received
+    bool isActive() const
+    {
+        return active;
+    }
+
+    // check whether all the input channels still open are idle
+    bool isIdle() const
+    {
+        return allIdle;
+    }
+
+    // create the punctuation to be forwarded with the given watermark (the idle mark if the node is idle)
+    void *createPunctuation(uint64_t _wm) const
+    {
+        return allIdle ? createIdleMark() : createWatermark(_wm);
+    }
+};
+
+} // namespace wf
+
+#endif
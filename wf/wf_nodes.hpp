@@ -37,6 +37,8 @@
 #include<ff/multinode.hpp>
 #include<meta.hpp>
 #include<basic_emitter.hpp>
+#include<watermark.hpp>
+#include<win_scheduler.hpp>
 
 namespace wf {
 
@@ -63,14 +65,42 @@ private:
     struct Key_Descriptor
     {
         uint64_t rcv_counter; // number of tuples received of this key
-        tuple_t last_tuple; // copy of the last tuple received of this key (the one with highest timestamp)
+        uint64_t last_id; // identifier of the last tuple received of this key (the one with highest id/timestamp)
+        uint64_t last_ts; // timestamp of the last tuple received of this key (the one with highest id/timestamp)
+        typename Win_Scheduler_Router<key_t>::Key_Cache windows; // owners of the windows of this key (used with the dynamic scheduling)
 
         // Constructor
-        Key_Descriptor(): rcv_counter(0) {}
+        Key_Descriptor(): rcv_counter(0), last_id(0), last_ts(0) {}
     };
     std::unordered_map<key_t, Key_Descriptor> keyMap; // hash table that maps a descriptor for each key
     bool isCombined; // true if this node is used within a Tree_Emitter node
     std::vector<std::pair<void *, int>> output_queue; // used in case of Tree_Emitter mode
+    bool announceKeys; // true if the keys must be announced to all the internal operators (watermarks are used)
+    bool isBroadcast; // true if the tuples are sent to all the internal operators (used with the shared archive)
+    Win_Scheduler_Router<key_t> winScheduler; // assignment of the windows to the internal operators (used with the dynamic scheduling)
+    size_t n_groups; // number of groups of internal operators (the windows of a key are assigned to the operators of its group)
+    size_t group_size; // number of internal operators per group
+
+    // send an EOS marker with the given control fields to all the internal operators
+    void sendEOSMarker(const key_t &_key, uint64_t _id, uint64_t _ts)
+    {
+        tuple_t *t = new tuple_t();
+        t->setControlFields(_key, _id, _ts);
+        // the marker is sent to the internal operators of the group of the key
+        size_t first = (std::hash<key_t>()(_key) % n_groups) * group_size;
+        wrapper_in_t *wt = new wrapper_in_t(t, group_size, true); // eos marker enabled
+        for (size_t i=first; i < first + group_size; i++) {
+            if (!isCombined) {
+                this->ff_send_out_to(wt, i);
+            }
+            else {
+                output_queue.push_back(std::make_pair(wt, i));
+            }
+        }
+        if (winScheduler.isEnabled()) {
+            winScheduler.addSentAll();
+        }
+    }
 
 public:
     // Constructor
@@ -81,7 +111,10 @@ public:
                size_t _id_outer,
                size_t _n_outer,
                uint64_t _slide_outer,
-               role_t _role):
+               role_t _role,
+               bool _broadcast=false,
+               std::shared_ptr<Win_Scheduler<key_t>> _scheduler=nullptr,
+               size_t _n_groups=1):
                winType(_winType),
                win_len(_win_len),
                slide_len(_slide_len),
@@ -91,7 +124,12 @@ public:
                slide_outer(_slide_outer),
                role(_role),
                to_workers(pardegree),
-               isCombined(false) {}
+               isCombined(false),
+               announceKeys(false),
+               isBroadcast(_broadcast),
+               winScheduler(_scheduler),
+               n_groups(_n_groups),
+               group_size(_pardegree / _n_groups) {}
 
     // clone method
     Basic_Emitter *clone() const override
@@ -109,6 +147,33 @@ public:
     // svc method (utilized by the FastFlow runtime)
     void *svc(void *in) override
     {
+        // watermarks are broadcast to all the internal operators
+        if (isWatermark(in)) {
+            // from now on the keys are announced to all the internal operators (time-based windows only)
+            if (!announceKeys && winType == win_type_t::TB) {
+                announceKeys = true;
+                // EOS markers are sent so that also the internal operators not receiving tuples of a key
+                // can fire the windows of that key on the arrival of the next watermarks
+                for (auto &k: keyMap) {
+                    if ((k.second).rcv_counter > 0) {
+                        sendEOSMarker(k.first, (k.second).last_id, (k.second).last_ts);
+                    }
+                }
+            }
+            for (size_t i=0; i<pardegree; i++) {
+                if (!isCombined) {
+                    this->ff_send_out_to(in, i);
+                }
+                else {
+                    output_queue.push_back(std::make_pair(in, i));
+                }
+            }
+            return this->GO_ON;
+        }
+        // a shared envelope of a split is owned with copy-on-write before being wrapped
+        if constexpr (std::is_same<tuple_t, input_t>::value) {
+            in = ownInput(reinterpret_cast<tuple_t *>(in));
+        }
         input_t *wt = reinterpret_cast<input_t *>(in);
         // extract the key and id/timestamp fields from the input tuple
         tuple_t *t = extractTuple<tuple_t, input_t>(wt);
@@ -123,18 +188,14 @@ public:
             it = keyMap.find(key);
         }
         Key_Descriptor &key_d = (*it).second;
-        // keep track of the last tuple (the one with highest timestamp with that key)
-        if (key_d.rcv_counter == 0) {
-            key_d.rcv_counter++;
-            key_d.last_tuple = *t;
+        // keep track of the control fields of the last tuple (the one with highest id/timestamp with that key)
+        uint64_t last = (winType == win_type_t::CB) ? key_d.last_id : key_d.last_ts;
+        if (key_d.rcv_counter == 0 || id > last) {
+            key_d.last_id = std::get<1>(t->getControlFields());
+            key_d.last_ts = std::get<2>(t->getControlFields());
         }
-        else {
-            key_d.rcv_counter++;
-            // get the id/timestamp of current last_tuple
-            uint64_t last_id = (winType == win_type_t::CB) ? std::get<1>((key_d.last_tuple).getControlFields()) : std::get<2>((key_d.last_tuple).getControlFields());
-            if (id > last_id) {
-                key_d.last_tuple = *t;
-            }
+        if (key_d.rcv_counter++ == 0 && announceKeys) {
+            sendEOSMarker(key, key_d.last_id, key_d.last_ts);
         }
         // delete the input if it is an EOS marker
         if (isEOSMarker<tuple_t, input_t>(*wt)) {
@@ -182,12 +243,34 @@ public:
         // determine the set of internal operators that will receive the tuple
         uint64_t countRcv = 0;
         uint64_t i = first_w;
-        // the first window of the key is assigned to worker startDstIdx
-        size_t startDstIdx = hashcode % pardegree;
-        while ((i <= last_w) && (countRcv < pardegree)) {
-            to_workers[countRcv] = (startDstIdx + i) % pardegree;
-            countRcv++;
-            i++;
+        // with the dynamic scheduling the tuple is sent to the owners of its windows (the windows not assigned yet
+        // are assigned to the internal operators with the smallest load), the late windows are skipped
+        if (winScheduler.isEnabled()) {
+            countRcv = winScheduler.route(key, key_d.windows, first_w, last_w, to_workers);
+        }
+        // with the shared archive the owner of the key appends all its tuples and the other ones wait for it in timestamp order
+        if (isBroadcast) {
+            for (countRcv = 0; countRcv < pardegree; countRcv++) {
+                to_workers[countRcv] = countRcv;
+            }
+        }
+        else if (!winScheduler.isEnabled()) {
+            // the first window of the key is assigned to worker startDstIdx of the group of the key
+            size_t firstGroupIdx = (hashcode % n_groups) * group_size;
+            size_t startDstIdx = hashcode % group_size;
+            while ((i <= last_w) && (countRcv < group_size)) {
+                to_workers[countRcv] = firstGroupIdx + (startDstIdx + i) % group_size;
+                countRcv++;
+                i++;
+            }
+        }
+        // the tuple belongs only to windows already fired (dynamic scheduling)
+        if (countRcv == 0) {
+            deleteTuple<tuple_t, input_t>(wt);
+            return this->GO_ON;
+        }
+        if (winScheduler.isEnabled()) {
+            winScheduler.addSent(to_workers, countRcv);
         }
         // prepare the wrapper to be sent
         wrapper_in_t *out = prepareWrapper<input_t, wrapper_in_t>(wt, countRcv);
@@ -210,20 +293,14 @@ public:
         for (auto &k: keyMap) {
             Key_Descriptor &key_d = k.second;
             if (key_d.rcv_counter > 0) {
-                // send the last tuple to all the internal operators as an EOS marker
-                tuple_t *t = new tuple_t();
-                *t = key_d.last_tuple;
-                wrapper_in_t *wt = new wrapper_in_t(t, pardegree, true); // eos marker enabled
-                for (size_t i=0; i < pardegree; i++) {
-                    if (!isCombined) {
-                        this->ff_send_out_to(wt, i);
-                    }
-                    else {
-                        output_queue.push_back(std::make_pair(wt, i));
-                    }
-                }
+                // send an EOS marker with the control fields of the last tuple to all the internal operators
+                sendEOSMarker(k.first, key_d.last_id, key_d.last_ts);
             }
         }
+        // report the inputs sent to the internal operators and not reported yet
+        if (winScheduler.isEnabled()) {
+            winScheduler.flush();
+        }
     }
 
     // svc_end method (utilized by the FastFlow runtime)
@@ -260,13 +337,38 @@ private:
     struct Key_Descriptor
     {
         uint64_t next_win; // next window to be transmitted of that key
-        std::deque<result_t *> resultsSet; // std::deque of buffered results of that key
+        std::vector<result_t *> ring; // circular buffer of the results of that key (indexed by wid - next_win starting from head)
+        size_t head; // position in the ring of the result of the window next_win
 
         // Constructor
-        Key_Descriptor(): next_win(0) {}
+        Key_Descriptor(): next_win(0), ring(DEFAULT_RING_CAPACITY, nullptr), head(0) {}
     };
     // hash table that maps key identifiers onto key descriptors
     std::unordered_map<key_t, Key_Descriptor> keyMap;
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+
+    // move the head of the ring of a key to the next window
+    void advanceRing(Key_Descriptor &_key_d)
+    {
+        _key_d.next_win++;
+        _key_d.head = (_key_d.head + 1) & ((_key_d.ring).size() - 1);
+    }
+
+    // enlarge the ring of a key (the capacity is kept a power of two) to buffer at least _size results
+    void growRing(Key_Descriptor &_key_d, uint64_t _size)
+    {
+        size_t capacity = (_key_d.ring).size();
+        while (capacity < _size) {
+            capacity <<= 1;
+        }
+        std::vector<result_t *> ring(capacity, nullptr);
+        size_t mask = (_key_d.ring).size() - 1;
+        for (size_t i=0; i<(_key_d.ring).size(); i++) {
+            ring[i] = (_key_d.ring)[(_key_d.head + i) & mask];
+        }
+        (_key_d.ring).swap(ring);
+        _key_d.head = 0;
+    }
 
 public:
     // svc_init method (utilized by the FastFlow runtime)
@@ -278,39 +380,47 @@ public:
     // svc method (utilized by the FastFlow runtime)
     result_t *svc(result_t *r) override
     {
+        // watermarks are merged among the input channels and forwarded
+        if (isWatermark(r)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(r))) {
+                this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+            }
+            return this->GO_ON;
+        }
         // extract key and identifier from the result
         auto key = std::get<0>(r->getControlFields()); // key
         uint64_t wid = std::get<1>(r->getControlFields()); // identifier
-        // find the corresponding key descriptor
-        auto it = keyMap.find(key);
-        if (it == keyMap.end()) {
-            // create the descriptor of that key
-            keyMap.insert(std::make_pair(key, Key_Descriptor()));
-            it = keyMap.find(key);
-        }
-        Key_Descriptor &key_d = (*it).second;
-        uint64_t &next_win = key_d.next_win;
-        std::deque<result_t *> &resultsSet = key_d.resultsSet;
-        // add the new result at the correct place
-        if ((wid - next_win) >= resultsSet.size()) {
-            size_t new_size = (wid - next_win) + 1;
-            resultsSet.resize(new_size, nullptr);
-        }
-        resultsSet[wid - next_win] = r;
-        // scan all the buffered results and emit the ones in order
-        auto itr = resultsSet.begin();
-        for (; itr < resultsSet.end(); itr++) {
-            if (*itr != nullptr) {
-                this->ff_send_out(*itr);
-                next_win++;
+        // find the corresponding key descriptor (created if not present)
+        Key_Descriptor &key_d = keyMap[key];
+        uint64_t dist = wid - key_d.next_win;
+        // the result is not the next one of its key: it is buffered at the correct place
+        if (dist > 0) {
+            if (dist >= (key_d.ring).size()) {
+                growRing(key_d, dist + 1);
             }
-            else break;
+            (key_d.ring)[(key_d.head + dist) & ((key_d.ring).size() - 1)] = r;
+            return this->GO_ON;
+        }
+        // the result is the next one of its key: it is emitted with the following ones already buffered
+        this->ff_send_out(r);
+        advanceRing(key_d);
+        while ((key_d.ring)[key_d.head] != nullptr) {
+            this->ff_send_out((key_d.ring)[key_d.head]);
+            (key_d.ring)[key_d.head] = nullptr;
+            advanceRing(key_d);
         }
-        // delete the entries of the emitted results
-        resultsSet.erase(resultsSet.begin(), itr);
         return this->GO_ON;
     }
 
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+        }
+    }
+
     // svc_end method (utilized by the FastFlow runtime)
     void svc_end() override {}
 };
@@ -44,6 +44,8 @@
 #include<basic.hpp>
 #include<win_seq.hpp>
 #include<wf_nodes.hpp>
+#include<win_scheduler.hpp>
+#include<shared_archive.hpp>
 #include<wm_nodes.hpp>
 #include<ordering_node.hpp>
 #include<tree_emitter.hpp>
@@ -93,6 +95,8 @@ private:
     using wf_emitter_t = WF_Emitter<tuple_t, input_t>;
     // type of the WF_Collector node
     using wf_collector_t = WF_Collector<result_t>;
+    // key data type
+    using key_t = typename std::remove_reference<decltype(std::get<0>(std::declval<tuple_t>().getControlFields()))>::type;
     // friendships with other classes in the library
     template<typename T1, typename T2, typename T3>
     friend class Pane_Farm;
@@ -120,6 +124,9 @@ private:
     uint64_t triggering_delay; // triggering delay in time units (meaningful for TB windows only)
     win_type_t winType; // type of windows (count-based or time-based)
     std::vector<ff_node *> wf_workers; // vector of pointers to the Win_Farm workers (Win_Seq or Pane_Farm or Win_MapReduce instances)
+    std::shared_ptr<Win_Scheduler<key_t>> scheduler; // scheduler of the windows among the replicas (nullptr with the static scheduling)
+    std::shared_ptr<Shared_Archive<tuple_t, key_t>> shared_archive; // archive shared by the replicas (nullptr if each replica has its own archives)
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
 
     // Private Constructor
     template<typename F_t>
@@ -134,7 +141,10 @@ private:
              bool _ordered,
              opt_level_t _opt_level,
              WinOperatorConfig _config,
-             role_t _role):
+             role_t _role,
+             bool _dynamic=false,
+             bool _shared=false,
+             std::vector<int> _cpus={}):
              name(_name),
              parallelism(_parallelism),
              used(false),
@@ -148,7 +158,8 @@ private:
              win_len(_win_len),
              slide_len(_slide_len),
              triggering_delay(_triggering_delay),
-             winType(_winType)
+             winType(_winType),
+             cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
@@ -165,21 +176,60 @@ private:
             //std::cerr << YELLOW << "WindFlow Warning: optimization level has no effect" << DEFAULT_COLOR << std::endl;
             outer_opt_level = opt_level_t::LEVEL0;
         }
+        // the dynamic scheduling is possible only if the windows are not partitioned among several operators
+        if (_dynamic && _role != role_t::SEQ) {
+            std::cerr << RED << "WindFlow Error: Win_Farm within other operators cannot use the dynamic scheduling" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // with the dynamic scheduling, the windows are assigned by the emitter to the Win_Seq with the smallest load
+        if (_dynamic) {
+            scheduler = std::make_shared<Win_Scheduler<key_t>>(_parallelism);
+        }
+        // the shared archive is possible only if the windows are not partitioned among several operators
+        if (_shared && _role != role_t::SEQ) {
+            std::cerr << RED << "WindFlow Error: Win_Farm within other operators cannot use the shared archive" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // the tuples are appended to the shared archive in timestamp order
+        if (_shared && _winType != win_type_t::TB) {
+            std::cerr << RED << "WindFlow Error: Win_Farm with the shared archive requires time-based windows" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // with the shared archive, each tuple is stored once regardless of the parallelism
+        if (_shared) {
+            shared_archive = std::make_shared<Shared_Archive<tuple_t, key_t>>(_parallelism, _win_len);
+        }
         // std::vector of Win_Seq
         std::vector<ff_node *> w;
         // private sliding factor of each Win_Seq
-        uint64_t private_slide = _slide_len * _parallelism;
+        uint64_t private_slide = _dynamic ? _slide_len : _slide_len * _parallelism;
         // create the Win_Seq
         for (size_t i = 0; i < _parallelism; i++) {
             // configuration structure of the Win_Seq
-            WinOperatorConfig configSeq(_config.id_inner, _config.n_inner, _config.slide_inner, i, _parallelism, _slide_len);
+            WinOperatorConfig configSeq(_config.id_inner, _config.n_inner, _config.slide_inner, _dynamic ? 0 : i, _dynamic ? 1 : _parallelism, _slide_len);
             auto *seq = new win_seq_t(_func, _win_len, private_slide, _triggering_delay, _winType, _name, _closing_func, RuntimeContext(_parallelism, i), configSeq, _role);
+            if (_dynamic) {
+                // the incremental queries would be run by all the Win_Seq on all the windows
+                if (!seq->isNIC) {
+                    std::cerr << RED << "WindFlow Error: Win_Farm with the dynamic scheduling requires a non-incremental query" << DEFAULT_COLOR << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                seq->enableDynamicScheduling(scheduler, i);
+            }
+            if (_shared) {
+                // the incremental queries do not keep the tuples
+                if (!seq->isNIC) {
+                    std::cerr << RED << "WindFlow Error: Win_Farm with the shared archive requires a non-incremental query" << DEFAULT_COLOR << std::endl;
+                    exit(EXIT_FAILURE);
+                }
+                seq->enableSharedArchive(shared_archive, i);
+            }
             w.push_back(seq);
             wf_workers.push_back(seq);
         }
         ff::ff_farm::add_workers(w);
         // create the Emitter and Collector nodes
-        ff::ff_farm::add_emitter(new wf_emitter_t(_winType, _win_len, _slide_len, _parallelism, _config.id_inner, _config.n_inner, _config.slide_inner, _role));
+        ff::ff_farm::add_emitter(new wf_emitter_t(_winType, _win_len, _slide_len, _parallelism, _config.id_inner, _config.n_inner, _config.slide_inner, _role, _shared, scheduler));
         if (_ordered) {
             ff::ff_farm::add_collector(new wf_collector_t());
         }
@@ -241,6 +291,9 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _dynamic true if each window is evaluated by the least loaded replica (non-incremental queries only), false otherwise
+     *  \param _shared true if the tuples are stored once in an archive shared by the replicas (non-incremental queries on TB windows only), false otherwise
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     template<typename F_t>
     Win_Farm(F_t _win_func,
@@ -252,8 +305,11 @@ public:
              std::string _name,
              closing_func_t _closing_func,
              bool _ordered,
-             opt_level_t _opt_level):
-             Win_Farm(_win_func, _win_len, _slide_len, _triggering_delay, _winType, _parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), role_t::SEQ) {}
+             opt_level_t _opt_level,
+             bool _dynamic=false,
+             bool _shared=false,
+             std::vector<int> _cpus={}):
+             Win_Farm(_win_func, _win_len, _slide_len, _triggering_delay, _winType, _parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), role_t::SEQ, _dynamic, _shared, _cpus) {}
 
     /** 
      *  \brief Constructor II (Nesting with Pane_Farm)
@@ -268,6 +324,9 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _dynamic dynamic scheduling of the windows (must be false, it is not supported with nested operators)
+     *  \param _shared shared archive of the tuples (must be false, it is not supported with nested operators)
+     *  \param _cpus CPUs of the replicas of the nested operators (empty to use the placement policy of the PipeGraph)
      */ 
     Win_Farm(pane_farm_t &_pf,
              uint64_t _win_len,
@@ -278,7 +337,10 @@ public:
              std::string _name,
              closing_func_t _closing_func,
              bool _ordered,
-             opt_level_t _opt_level):
+             opt_level_t _opt_level,
+             bool _dynamic=false,
+             bool _shared=false,
+             std::vector<int> _cpus={}):
              name(_name),
              parallelism(_num_replicas * (_pf.plq_parallelism + _pf.wlq_parallelism)),
              used(false),
@@ -292,13 +354,23 @@ public:
              win_len(_win_len),
              slide_len(_slide_len),
              triggering_delay(_triggering_delay),
-             winType(_winType)
+             winType(_winType),
+             cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
             std::cerr << RED << "WindFlow Error: window length or slide in Win_Farm cannot be zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the windows are evaluated by the nested operators
+        if (_dynamic) {
+            std::cerr << RED << "WindFlow Error: Win_Farm with nested operators cannot use the dynamic scheduling" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (_shared) {
+            std::cerr << RED << "WindFlow Error: Win_Farm with nested operators cannot use the shared archive" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // check the validity of the number of replicas
         if (_num_replicas == 0) {
             std::cerr << RED << "WindFlow Error: number of replicas of the Pane_Farm within the Win_Farm is zero" << DEFAULT_COLOR << std::endl;
@@ -312,6 +384,11 @@ public:
         else {
             _pf.used4Nesting = true;
         }
+        // the replicas of the nested operators are placed by the Win_Farm
+        if (!_pf.cpus.empty()) {
+            std::cerr << RED << "WindFlow Error: CPUs of a Pane_Farm nested in a Win_Farm must be given to the Win_Farm" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // check the compatibility of the windowing parameters
         if (_pf.win_len != _win_len || _pf.slide_len != _slide_len || _pf.triggering_delay != _triggering_delay || _pf.winType != _winType) {
             std::cerr << RED << "WindFlow Error: incompatible windowing parameters between Win_Farm and Pane_Farm" << DEFAULT_COLOR << std::endl;
@@ -388,6 +465,9 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _dynamic dynamic scheduling of the windows (must be false, it is not supported with nested operators)
+     *  \param _shared shared archive of the tuples (must be false, it is not supported with nested operators)
+     *  \param _cpus CPUs of the replicas of the nested operators (empty to use the placement policy of the PipeGraph)
      */ 
     Win_Farm(win_mapreduce_t &_wmr,
              uint64_t _win_len,
@@ -398,7 +478,10 @@ public:
              std::string _name,
              closing_func_t _closing_func,
              bool _ordered,
-             opt_level_t _opt_level):
+             opt_level_t _opt_level,
+             bool _dynamic=false,
+             bool _shared=false,
+             std::vector<int> _cpus={}):
              name(_name),
              parallelism(_num_replicas * (_wmr.map_parallelism + _wmr.reduce_parallelism)),
              used(false),
@@ -412,13 +495,23 @@ public:
              win_len(_win_len),
              slide_len(_slide_len),
              triggering_delay(_triggering_delay),
-             winType(_winType)
+             winType(_winType),
+             cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
             std::cerr << RED << "WindFlow Error: window length or slide in Win_Farm cannot be zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // the windows are evaluated by the nested operators
+        if (_dynamic) {
+            std::cerr << RED << "WindFlow Error: Win_Farm with nested operators cannot use the dynamic scheduling" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (_shared) {
+            std::cerr << RED << "WindFlow Error: Win_Farm with nested operators cannot use the shared archive" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // check the validity of the number of replicas
         if (_num_replicas == 0) {
             std::cerr << RED << "WindFlow Error: number of replicas of the Win_MapReduce within the Win_Farm is zero" << DEFAULT_COLOR << std::endl;
@@ -432,6 +525,11 @@ public:
         else {
             _wmr.used4Nesting = true;
         }
+        // the replicas of the nested operators are placed by the Win_Farm
+        if (!_wmr.cpus.empty()) {
+            std::cerr << RED << "WindFlow Error: CPUs of a Win_MapReduce nested in a Win_Farm must be given to the Win_Farm" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // check the compatibility of the windowing parameters
         if (_wmr.win_len != _win_len || _wmr.slide_len != _slide_len || _wmr.triggering_delay != _triggering_delay || _wmr.winType != _winType) {
             std::cerr << RED << "WindFlow Error: incompatible windowing parameters between Win_Farm and Win_MapReduce" << DEFAULT_COLOR << std::endl;
@@ -504,6 +602,42 @@ public:
         return isComplex;
     }
 
+    /** 
+     *  \brief Check whether the Win_Farm schedules the windows dynamically
+     *  \return true if each window is evaluated by the least loaded replica
+     */ 
+    bool isDynamicScheduling() const
+    {
+        return scheduler != nullptr;
+    }
+
+    /** 
+     *  \brief Get the scheduler of the windows among the replicas of the Win_Farm
+     *  \return scheduler of the windows (nullptr with the static scheduling)
+     */ 
+    std::shared_ptr<Win_Scheduler<key_t>> getWinScheduler() const
+    {
+        return scheduler;
+    }
+
+    /** 
+     *  \brief Check whether the replicas of the Win_Farm share the archive of the tuples
+     *  \return true if each tuple is stored once regardless of the parallelism
+     */ 
+    bool isSharedArchive() const
+    {
+        return shared_archive != nullptr;
+    }
+
+    /** 
+     *  \brief Get the archive of the tuples shared by the replicas of the Win_Farm
+     *  \return shared archive (nullptr if each replica has its own archives)
+     */ 
+    std::shared_ptr<Shared_Archive<tuple_t, key_t>> getSharedArchive() const
+    {
+        return shared_archive;
+    }
+
     /** 
      *  \brief Get the optimization level used to build the Win_Farm
      *  \return adopted utilization level by the Win_Farm
@@ -628,6 +762,33 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *         (with nested operators, the replicas of their stages are placed one replica after the other)
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        if (this->getInnerType() == pattern_t::SEQ_CPU) {
+            auto placements = _manager.assign(name, wf_workers.size(), cpus);
+            for (size_t i=0; i<placements.size(); i++) {
+                static_cast<win_seq_t *>(wf_workers[i])->setPlacement(placements[i]);
+            }
+        }
+        else {
+            size_t inner_parallelism = inner_parallelism_1 + inner_parallelism_2;
+            auto placements = _manager.assign(name, wf_workers.size() * inner_parallelism, cpus);
+            for (size_t i=0; i<wf_workers.size(); i++) {
+                if (this->getInnerType() == pattern_t::PF_CPU) {
+                    static_cast<panewrap_farm_t *>(wf_workers[i])->set_Placements(placements, i * inner_parallelism);
+                }
+                else {
+                    static_cast<winwrap_map_t *>(wf_workers[i])->set_Placements(placements, i * inner_parallelism);
+                }
+            }
+        }
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
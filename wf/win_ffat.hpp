@@ -0,0 +1,383 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    win_ffat.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    19/10/2020
+ *  
+ *  @brief Win_FFAT operator executing a windowed query in parallel
+ *         on multi-core CPUs using the FlatFAT algorithm
+ *  
+ *  @section Win_FFAT (Description)
+ *  
+ *  This file implements the Win_FFAT operator able to execute windowed queries on a
+ *  multicore. Like the Win_Farm, the operator assigns consecutive windows of the same
+ *  sub-stream to different replicas in a round-robin fashion, so it is useful when a
+ *  few keys carry most of the traffic. Each replica processes its windows using the
+ *  FlatFAT algorithm, thus the windows of the same replica must overlap.
+ *  
+ *  The replicas are organized in groups of the same size, each key is assigned to a
+ *  group and its windows are distributed among the replicas of that group. The size
+ *  of the groups is the largest divisor of the parallelism such that the slide length
+ *  multiplied by it is smaller than the window length. With one group (the default if
+ *  the windows are long enough), all the replicas compute the windows of all the keys.
+ *  With one replica per group, the keys are partitioned among the replicas as in the
+ *  Key_FFAT operator.
+ *  
+ *  Cost: each tuple belongs to windows of all the replicas of the group of its key, so
+ *  it is lifted and combined into the quanta of each of them. The lift and combine work
+ *  per tuple is multiplied by the size of the groups, while the work on the windows (the
+ *  updates of the FlatFAT and the queries) is divided among them. The operator pays off
+ *  with respect to the Key_FFAT only when a few keys are hot and the work on the windows
+ *  dominates. With count-based windows, the tuples are broadcast to all the replicas
+ *  (to be renumbered), and each replica discards the ones of the keys of other groups.
+ *  
+ *  The template parameters tuple_t and result_t must be default constructible, with
+ *  a copy constructor and copy assignment operator, and they must provide and implement
+ *  the setControlFields() and getControlFields() methods.
+ */ 
+
+#ifndef WIN_FFAT_H
+#define WIN_FFAT_H
+
+/// includes
+#include<ff/pipeline.hpp>
+#include<ff/all2all.hpp>
+#include<ff/farm.hpp>
+#include<ff/optimize.hpp>
+#include<basic.hpp>
+#include<win_seqffat.hpp>
+#include<wf_nodes.hpp>
+#include<basic_operator.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Win_FFAT
+ *  
+ *  \brief Win_FFAT operator executing a windowed query in parallel on multi-core CPUs
+ *         leveraging the FlatFAT algorithm
+ *  
+ *  This class implements the Win_FFAT operator executing windowed queries in parallel on
+ *  a multicore. In the operator, consecutive windows of the same sub-stream are executed
+ *  in parallel by different replicas of the group of the key, and each replica processes
+ *  its windows efficiently by using the FlatFAT algorithm.
+ */ 
+template<typename tuple_t, typename result_t>
+class Win_FFAT: public ff::ff_farm, public Basic_Operator
+{
+public:
+    /// type of the lift function
+    using winLift_func_t = std::function<void(const tuple_t &, result_t &)>;
+    /// type of the rich lift function
+    using rich_winLift_func_t = std::function<void(const tuple_t &, result_t &, RuntimeContext &)>;
+    /// type of the combine function
+    using winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
+    /// type of the rich combine function
+    using rich_winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &, RuntimeContext &)>;
+    /// type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext &)>;
+
+private:
+    // type of the wrapper of input tuples
+    using wrapper_in_t = wrapper_tuple_t<tuple_t>;
+    // type of the Win_SeqFFAT to be created
+    using win_seqffat_t = Win_SeqFFAT<tuple_t, result_t, wrapper_in_t>;
+    // type of the WF_Emitter node
+    using wf_emitter_t = WF_Emitter<tuple_t>;
+    // type of the WF_Collector node
+    using wf_collector_t = WF_Collector<result_t>;
+    // friendships with other classes in the library
+    friend class MultiPipe;
+    std::string name; // name of the Win_FFAT
+    size_t parallelism; // internal parallelism of the Win_FFAT
+    bool used; // true if the Win_FFAT has been added/chained in a MultiPipe
+    uint64_t win_len; // window length (no. of tuples or in time units)
+    uint64_t slide_len; // slide length (no. of tuples or in time units)
+    uint64_t triggering_delay; // triggering delay in time units (meaningful for TB windows only)
+    win_type_t winType; // type of windows (count-based or time-based)
+    size_t n_groups; // number of groups of replicas (the keys are partitioned among the groups)
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _winLift_func the (riched or not) lift function to translate a tuple into a result (with a signature accepted by the Win_FFAT operator)
+     *  \param _winComb_func the (riched or not) combine function to combine two results into a result (with a signature accepted by the Win_FFAT operator)
+     *  \param _win_len window length (in no. of tuples or in time units)
+     *  \param _slide_len slide length (in no. of tuples or in time units)
+     *  \param _triggering_delay (triggering delay in time units, meaningful for TB windows only otherwise it must be 0)
+     *  \param _winType window type (count-based CB or time-based TB)
+     *  \param _parallelism internal parallelism of the Win_FFAT operator
+     *  \param _name string with the unique name of the operator
+     *  \param _closing_func closing function
+     *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
+     */ 
+    template<typename lift_F_t, typename comb_F_t>
+    Win_FFAT(lift_F_t _winLift_func,
+             comb_F_t _winComb_func,
+             uint64_t _win_len,
+             uint64_t _slide_len,
+             uint64_t _triggering_delay,
+             win_type_t _winType,
+             size_t _parallelism,
+             std::string _name,
+             closing_func_t _closing_func,
+             bool _ordered,
+             std::vector<int> _cpus={}):
+             name(_name),
+             parallelism(_parallelism),
+             used(false),
+             win_len(_win_len),
+             slide_len(_slide_len),
+             triggering_delay(_triggering_delay),
+             winType(_winType),
+             n_groups(1),
+             cpus(_cpus)
+    {
+        // check the validity of the windowing parameters
+        if (_win_len == 0 || _slide_len == 0) {
+            std::cerr << RED << "WindFlow Error: window length or slide in Win_FFAT cannot be zero" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the validity of the parallelism value
+        if (_parallelism == 0) {
+            std::cerr << RED << "WindFlow Error: Win_FFAT has parallelism zero" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // check the use of sliding windows
+        if (_slide_len >= _win_len) {
+            std::cerr << RED << "WindFlow Error: Win_FFAT can be used with sliding windows only (s<w)" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        // windows of the same replica must overlap to be processed with the FlatFAT: the replicas are split
+        // in the smallest number of groups (dividing the parallelism) with at most max_group replicas each
+        size_t max_group = (_win_len - 1) / _slide_len;
+        while (_parallelism % n_groups != 0 || _parallelism / n_groups > max_group) {
+            n_groups++;
+        }
+        size_t group_size = _parallelism / n_groups;
+        // private sliding factor of each Win_SeqFFAT
+        uint64_t private_slide = _slide_len * group_size;
+        // std::vector of Win_SeqFFAT
+        std::vector<ff_node *> w(_parallelism);
+        // create the Win_SeqFFAT
+        for (size_t i = 0; i < _parallelism; i++) {
+            // configuration structure of the Win_SeqFFAT (position within its group)
+            WinOperatorConfig configSeq(0, 1, _slide_len, i % group_size, group_size, _slide_len);
+            auto *ffat = new win_seqffat_t(_winLift_func, _winComb_func, _win_len, private_slide, _triggering_delay, _winType, _name, _closing_func, RuntimeContext(_parallelism, i), configSeq);
+            ffat->setKeyPartition(i / group_size, n_groups);
+            w[i] = ffat;
+        }
+        ff::ff_farm::add_workers(w);
+        // create the Emitter and Collector nodes
+        ff::ff_farm::add_emitter(new wf_emitter_t(_winType, _win_len, _slide_len, _parallelism, 0, 1, _slide_len, role_t::SEQ, false, nullptr, n_groups));
+        if (_ordered) {
+            ff::ff_farm::add_collector(new wf_collector_t());
+        }
+        else {
+            ff::ff_farm::add_collector(nullptr);
+        }
+        // when the Win_FFAT will be destroyed we need aslo to destroy the emitter, workers and collector
+        ff::ff_farm::cleanup_all();
+    }
+
+    /** 
+     *  \brief Get the window type (CB or TB) utilized by the Win_FFAT
+     *  \return adopted windowing semantics (count-based or time-based)
+     */ 
+    win_type_t getWinType() const
+    {
+        return winType;
+    }
+
+    /** 
+     *  \brief Get the number of groups of replicas of the Win_FFAT
+     *  \return number of groups (the windows of a key are computed by the replicas of its group)
+     */ 
+    size_t getNumGroups() const
+    {
+        return n_groups;
+    }
+
+    /** 
+     *  \brief Get the number of ignored tuples by the Win_FFAT
+     *  \return number of tuples ignored during the processing by the Win_FFAT
+     */ 
+    size_t getNumIgnoredTuples() const
+    {
+        size_t count = 0;
+        auto workers = this->getWorkers();
+        for (auto *w: workers) {
+            auto *seq = static_cast<win_seqffat_t *>(w);
+            count += seq->getNumIgnoredTuples();
+        }
+        return count;
+    }
+
+    /** 
+     *  \brief Get the name of the Win_FFAT
+     *  \return string representing the name of the Win_FFAT
+     */ 
+    std::string getName() const override
+    {
+        return name;
+    }
+
+    /** 
+     *  \brief Get the total parallelism within the Win_FFAT
+     *  \return total parallelism within the Win_FFAT
+     */ 
+    size_t getParallelism() const override
+    {
+        return parallelism;
+    }
+
+    /** 
+     *  \brief Return the routing mode of inputs to the Win_FFAT
+     *  \return routing mode (always COMPLEX for the Win_FFAT)
+     */ 
+    routing_modes_t getRoutingMode() const override
+    {
+        return routing_modes_t::COMPLEX;
+    }
+
+    /** 
+     *  \brief Check whether the Win_FFAT has been used in a MultiPipe
+     *  \return true if the Win_FFAT has been added/chained to an existing MultiPipe
+     */ 
+    bool isUsed() const override
+    {
+        return used;
+    }
+
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        auto placements = _manager.assign(name, this->getWorkers().size(), cpus);
+        for (size_t i=0; i<placements.size(); i++) {
+            static_cast<win_seqffat_t *>(this->getWorkers()[i])->setPlacement(placements[i]);
+        }
+    }
+
+    /** 
+     *  \brief Check whether the operator has been terminated
+     *  \return true if the operator has finished its work
+     */ 
+    virtual bool isTerminated() const override
+    {
+        bool terminated = true;
+        // scan all the replicas to check their termination
+        for(auto *w: this->getWorkers()) {
+            auto *seq = static_cast<win_seqffat_t *>(w);
+            terminated = terminated && seq->isTerminated();
+        }
+        return terminated;
+    }
+
+#if defined (TRACE_WINDFLOW)
+    /// Dump the log file (JSON format) in the LOG_DIR directory
+    void dump_LogFile() const override
+    {
+        // create and open the log file in the LOG_DIR directory
+        std::ofstream logfile;
+#if defined (LOG_DIR)
+        std::string log_dir = std::string(STRINGIFY(LOG_DIR));
+        std::string filename = std::string(STRINGIFY(LOG_DIR)) + "/" + std::to_string(getpid()) + "_" + name + ".json";
+#else
+        std::string log_dir = std::string("log");
+        std::string filename = "log/" + std::to_string(getpid()) + "_" + name + ".json";
+#endif
+        // create the log directory
+        if (mkdir(log_dir.c_str(), 0777) != 0) {
+            struct stat st;
+            if((stat(log_dir.c_str(), &st) != 0) || !S_ISDIR(st.st_mode)) {
+                std::cerr << RED << "WindFlow Error: directory for log files cannot be created" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+        }
+        logfile.open(filename);
+        // create the rapidjson writer
+        rapidjson::StringBuffer buffer;
+        rapidjson::PrettyWriter<rapidjson::StringBuffer> writer(buffer);
+        // append the statistics of this operator
+        this->append_Stats(writer);
+        // serialize the object to file
+        logfile << buffer.GetString();
+        logfile.close();
+    }
+
+    /// append the statistics (JSON format) of this operator
+    void append_Stats(rapidjson::PrettyWriter<rapidjson::StringBuffer> &writer) const override
+    {
+        // create the header of the JSON file
+        writer.StartObject();
+        writer.Key("Operator_name");
+        writer.String(name.c_str());
+        writer.Key("Operator_type");
+        writer.String("Win_FFAT");
+        writer.Key("Distribution");
+        writer.String("COMPLEX");
+        writer.Key("isTerminated");
+        writer.Bool(this->isTerminated());
+        writer.Key("isWindowed");
+        writer.Bool(true);
+        writer.Key("isGPU");
+        writer.Bool(false);
+        writer.Key("Window_type");
+        if (winType == win_type_t::CB) {
+            writer.String("count-based");
+        }
+        else {
+            writer.String("time-based");
+            writer.Key("Window_delay");
+            writer.Uint(triggering_delay);
+        }
+        writer.Key("Window_length");
+        writer.Uint(win_len);
+        writer.Key("Window_slide");
+        writer.Uint(slide_len);
+        writer.Key("Parallelism");
+        writer.Uint(parallelism);
+        writer.Key("Replicas");
+        writer.StartArray();
+        // get statistics from all the replicas of the operator
+        for(auto *w: this->getWorkers()) {
+            auto *seq = static_cast<win_seqffat_t *>(w);
+            Stats_Record record = seq->get_StatsRecord();
+            record.append_Stats(writer);
+        }
+        writer.EndArray();
+        writer.EndObject();
+    }
+#endif
+
+    /// deleted constructors/operators
+    Win_FFAT(const Win_FFAT &) = delete; // copy constructor
+    Win_FFAT(Win_FFAT &&) = delete; // move constructor
+    Win_FFAT &operator=(const Win_FFAT &) = delete; // copy assignment operator
+    Win_FFAT &operator=(Win_FFAT &&) = delete; // move assignment operator
+};
+
+} // namespace wf
+
+#endif
@@ -128,6 +128,7 @@ private:
     WinOperatorConfig config;
     std::vector<ff_node *> map_workers; // vector of pointers to the Win_Seq instances in the MAP stage
     std::vector<ff_node *> reduce_workers; // vector of pointers to the Win_Seq instances in the REDUCE stage
+    std::vector<int> cpus; // CPUs of the replicas (empty if they are placed according to the policy of the PipeGraph)
 
     // Private Constructor
     template <typename F_t, typename G_t>
@@ -143,7 +144,8 @@ private:
                   closing_func_t _closing_func,
                   bool _ordered,
                   opt_level_t _opt_level,
-                  WinOperatorConfig _config):
+                  WinOperatorConfig _config,
+                  std::vector<int> _cpus={}):
                   name(_name),
                   parallelism(_map_parallelism + _reduce_parallelism),
                   used(false),
@@ -157,7 +159,8 @@ private:
                   reduce_parallelism(_reduce_parallelism),
                   ordered(_ordered),
                   opt_level(_opt_level),
-                  config(WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  config(WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len)),
+                  cpus(_cpus)
     {
         // check the validity of the windowing parameters
         if (_win_len == 0 || _slide_len == 0) {
@@ -263,6 +266,17 @@ private:
         }
     }
 
+    // set the placement of the Win_Seq instances of the MAP and REDUCE stages (starting from the given one of the vector)
+    void set_Placements(const std::vector<Placement_Replica> &_placements, size_t _first)
+    {
+        for (size_t i=0; i<map_workers.size(); i++) {
+            static_cast<Win_Seq<tuple_t, result_t, wrapper_in_t> *>(map_workers[i])->setPlacement(_placements[_first + i]);
+        }
+        for (size_t i=0; i<reduce_workers.size(); i++) {
+            static_cast<Win_Seq<result_t, result_t> *>(reduce_workers[i])->setPlacement(_placements[_first + map_workers.size() + i]);
+        }
+    }
+
 public:
     /** 
      *  \brief Constructor I
@@ -279,6 +293,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(map_func_t _map_func,
                   reduce_func_t _reduce_func,
@@ -291,8 +306,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_map_func, _reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_map_func, _reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         map_func = _map_func;
         reduce_func = _reduce_func;
@@ -317,6 +333,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(rich_map_func_t _rich_map_func,
                   reduce_func_t _reduce_func,
@@ -329,8 +346,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_rich_map_func, _reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_rich_map_func, _reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_map_func = _rich_map_func;
         reduce_func = _reduce_func;
@@ -355,6 +373,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(map_func_t _map_func,
                   rich_reduce_func_t _rich_reduce_func,
@@ -367,8 +386,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_map_func, _rich_reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_map_func, _rich_reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         map_func = _map_func;
         rich_reduce_func = _rich_reduce_func;
@@ -393,6 +413,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(rich_map_func_t _rich_map_func,
                   rich_reduce_func_t _rich_reduce_func,
@@ -405,8 +426,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_rich_map_func, _rich_reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_rich_map_func, _rich_reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_map_func = _rich_map_func;
         rich_reduce_func = _rich_reduce_func;
@@ -431,6 +453,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(mapupdate_func_t _mapupdate_func,
                   reduceupdate_func_t _reduceupdate_func,
@@ -443,8 +466,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_mapupdate_func, _reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_mapupdate_func, _reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         mapupdate_func = _mapupdate_func;
         reduceupdate_func = _reduceupdate_func;
@@ -469,6 +493,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(rich_mapupdate_func_t _rich_mapupdate_func,
                   reduceupdate_func_t _reduceupdate_func,
@@ -481,8 +506,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_rich_mapupdate_func, _reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_rich_mapupdate_func, _reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_mapupdate_func = _rich_mapupdate_func;
         reduceupdate_func = _reduceupdate_func;
@@ -507,6 +533,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(mapupdate_func_t _mapupdate_func,
                   rich_reduceupdate_func_t _rich_reduceupdate_func,
@@ -519,8 +546,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_mapupdate_func, _rich_reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_mapupdate_func, _rich_reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         mapupdate_func = _mapupdate_func;
         rich_reduceupdate_func = _rich_reduceupdate_func;
@@ -545,6 +573,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(rich_mapupdate_func_t _rich_mapupdate_func,
                   rich_reduceupdate_func_t _rich_reduceupdate_func,
@@ -557,8 +586,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_rich_mapupdate_func, _rich_reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_rich_mapupdate_func, _rich_reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_mapupdate_func = _rich_mapupdate_func;
         rich_reduceupdate_func = _rich_reduceupdate_func;
@@ -583,6 +613,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(map_func_t _map_func,
                   reduceupdate_func_t _reduceupdate_func,
@@ -595,8 +626,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_map_func, _reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_map_func, _reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         map_func = _map_func;
         reduceupdate_func = _reduceupdate_func;
@@ -621,6 +653,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(rich_map_func_t _rich_map_func,
                   reduceupdate_func_t _reduceupdate_func,
@@ -633,8 +666,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_rich_map_func, _reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_rich_map_func, _reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_map_func = _rich_map_func;
         reduceupdate_func = _reduceupdate_func;
@@ -659,6 +693,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(map_func_t _map_func,
                   rich_reduceupdate_func_t _rich_reduceupdate_func,
@@ -671,8 +706,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_map_func, _rich_reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_map_func, _rich_reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         map_func = _map_func;
         rich_reduceupdate_func = _rich_reduceupdate_func;
@@ -697,6 +733,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(rich_map_func_t _rich_map_func,
                   rich_reduceupdate_func_t _rich_reduceupdate_func,
@@ -709,8 +746,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_rich_map_func, _rich_reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_rich_map_func, _rich_reduceupdate_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_map_func = _rich_map_func;
         rich_reduceupdate_func = _rich_reduceupdate_func;
@@ -735,6 +773,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(mapupdate_func_t _mapupdate_func,
                   reduce_func_t _reduce_func,
@@ -747,8 +786,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_mapupdate_func, _reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_mapupdate_func, _reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         mapupdate_func = _mapupdate_func;
         reduce_func = _reduce_func;
@@ -773,6 +813,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(rich_mapupdate_func_t _rich_mapupdate_func,
                   reduce_func_t _reduce_func,
@@ -785,8 +826,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_rich_mapupdate_func, _reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_rich_mapupdate_func, _reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_mapupdate_func = _rich_mapupdate_func;
         reduce_func = _reduce_func;
@@ -811,6 +853,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(mapupdate_func_t _mapupdate_func,
                   rich_reduce_func_t _rich_reduce_func,
@@ -823,8 +866,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_mapupdate_func, _rich_reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_mapupdate_func, _rich_reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         mapupdate_func = _mapupdate_func;
         rich_reduce_func = _rich_reduce_func;
@@ -849,6 +893,7 @@ public:
      *  \param _closing_func closing function
      *  \param _ordered true if the results of the same key must be emitted in order, false otherwise
      *  \param _opt_level optimization level used to build the operator
+     *  \param _cpus CPUs of the replicas (empty to use the placement policy of the PipeGraph)
      */ 
     Win_MapReduce(rich_mapupdate_func_t _rich_mapupdate_func,
                   rich_reduce_func_t _rich_reduce_func,
@@ -861,8 +906,9 @@ public:
                   std::string _name,
                   closing_func_t _closing_func,
                   bool _ordered,
-                  opt_level_t _opt_level):
-                  Win_MapReduce(_rich_mapupdate_func, _rich_reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len))
+                  opt_level_t _opt_level,
+                  std::vector<int> _cpus={}):
+                  Win_MapReduce(_rich_mapupdate_func, _rich_reduce_func, _win_len, _slide_len, _triggering_delay, _winType, _map_parallelism, _reduce_parallelism, _name, _closing_func, _ordered, _opt_level, WinOperatorConfig(0, 1, _slide_len, 0, 1, _slide_len), _cpus)
     {
         rich_mapupdate_func = _rich_mapupdate_func;
         rich_reduce_func = _rich_reduce_func;
@@ -967,6 +1013,15 @@ public:
         return used;
     }
 
+    /** 
+     *  \brief Place the replicas of the operator on the CPUs assigned by a placement manager
+     *  \param _manager placement manager of the PipeGraph
+     */ 
+    void place(Placement_Manager &_manager) override
+    {
+        set_Placements(_manager.assign(name, map_workers.size() + reduce_workers.size(), cpus), 0);
+    }
+
     /** 
      *  \brief Check whether the operator has been terminated
      *  \return true if the operator has finished its work
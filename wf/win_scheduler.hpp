@@ -0,0 +1,477 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+
+/** 
+ *  @file    win_scheduler.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    14/11/2020
+ *  
+ *  @brief Dynamic scheduling of the windows among the replicas of a Win_Farm
+ *  
+ *  @section Win_Scheduler (Description)
+ *  
+ *  This file implements the Win_Scheduler class shared by the replicas (Win_Seq nodes)
+ *  of a Win_Farm operator with the dynamic scheduling of the windows. With the static
+ *  scheduling, the i-th window of a key is computed by the replica (start + i) % n,
+ *  so a replica receiving costly windows falls behind while the other ones are idle,
+ *  and the WF_Collector buffers the results of the other replicas meanwhile.
+ *  
+ *  With the dynamic scheduling, each window is assigned by the emitters to the replica
+ *  with the smallest estimated load when its first tuple is routed, and the tuples are
+ *  sent to the replicas owning the windows containing them, so they are not replicated
+ *  more than with the static scheduling. The load of a replica is the time needed to
+ *  evaluate the windows assigned to it and not evaluated yet, plus the time needed to
+ *  process the inputs sent to it and not processed yet (its queue depth), where both
+ *  the costs of the windows and of the inputs are moving averages of the times measured
+ *  by the replicas. Each replica opens all the windows of the tuples it receives, and
+ *  it evaluates only the windows it owns (the other ones are purged). A window without
+ *  tuples is evaluated by the first replica firing it. Each window is evaluated exactly
+ *  once, so the WF_Collector receives exactly one result per window and it keeps them
+ *  in order as before. The assignment of a window is kept until its owner fires it.
+ */ 
+
+#ifndef WIN_SCHEDULER_H
+#define WIN_SCHEDULER_H
+
+/// includes
+#include<mutex>
+#include<deque>
+#include<atomic>
+#include<limits>
+#include<memory>
+#include<vector>
+#include<algorithm>
+#include<unordered_map>
+#include<basic.hpp>
+
+namespace wf {
+
+/** 
+ *  \class Win_Scheduler
+ *  
+ *  \brief Dynamic scheduling of the windows among the replicas of a Win_Farm
+ *  
+ *  This class implements the assignment of the windows to the replicas of a Win_Farm
+ *  with the dynamic scheduling, shared by its emitters and replicas, together with the
+ *  statistics used to estimate the load of the replicas.
+ */ 
+template<typename key_t>
+class Win_Scheduler
+{
+public:
+    /// owner of a window not assigned yet
+    static constexpr size_t UNASSIGNED = std::numeric_limits<size_t>::max();
+    /// owner of a window already fired by its owner
+    static constexpr size_t FIRED = std::numeric_limits<size_t>::max() - 1;
+
+    // struct of the assignment of the windows of a key
+    struct Key_Schedule
+    {
+        std::mutex mutex; // mutex protecting the assignment of the windows of the key
+        uint64_t base; // lwid of the first window in owners
+        std::deque<size_t> owners; // owners[i] is the owner of the window base+i (UNASSIGNED or FIRED)
+
+        // Constructor
+        Key_Schedule(): base(0) {}
+    };
+
+private:
+    // struct of the statistics of a replica (each one in its own cache line)
+    struct alignas(64) Replica_Stats
+    {
+        std::atomic<uint64_t> windows; // number of windows evaluated by the replica
+        std::atomic<uint64_t> busy; // time spent by the replica evaluating windows (in nanoseconds)
+        std::atomic<uint64_t> assigned; // number of windows assigned to the replica
+        std::atomic<uint64_t> sent; // number of inputs sent to the replica
+        std::atomic<uint64_t> processed; // number of inputs processed by the replica
+
+        // Constructor
+        Replica_Stats(): windows(0), busy(0), assigned(0), sent(0), processed(0) {}
+    };
+    std::mutex mutex; // mutex protecting the table of the keys
+    std::unordered_map<key_t, std::unique_ptr<Key_Schedule>> schedules; // assignment of the windows of each key
+    std::vector<Replica_Stats> stats; // statistics of the replicas
+    std::atomic<uint64_t> win_cost; // moving average of the time needed to evaluate a window (in nanoseconds)
+    std::atomic<uint64_t> input_cost; // moving average of the time needed to process an input (in nanoseconds)
+    std::atomic<size_t> next_choice; // first replica considered by the next choice (to break the ties in round-robin)
+
+    // update a moving average (concurrent updates can be lost, the average is an estimate anyway)
+    static void updateCost(std::atomic<uint64_t> &_cost, uint64_t _nsecs)
+    {
+        uint64_t old = _cost.load(std::memory_order_relaxed);
+        _cost.store((old == 0) ? _nsecs : old - (old >> 3) + (_nsecs >> 3), std::memory_order_relaxed);
+    }
+
+    // choose the replica with the smallest estimated load
+    size_t choose()
+    {
+        double w_cost = win_cost.load(std::memory_order_relaxed);
+        double i_cost = input_cost.load(std::memory_order_relaxed);
+        size_t n = stats.size();
+        size_t first = next_choice.fetch_add(1, std::memory_order_relaxed) % n;
+        size_t best = first;
+        double best_load = std::numeric_limits<double>::max();
+        for (size_t j=0; j<n; j++) {
+            size_t i = (first + j) % n;
+            double load = getPendingWindows(i) * w_cost + getBacklog(i) * i_cost;
+            if (load < best_load) {
+                best = i;
+                best_load = load;
+            }
+        }
+        return best;
+    }
+
+    // get the owner of a window, assigning it if needed (the mutex of the key must be held)
+    size_t &getOwner(Key_Schedule &_schedule, uint64_t _lwid)
+    {
+        while (_schedule.base + (_schedule.owners).size() <= _lwid) {
+            (_schedule.owners).push_back(UNASSIGNED);
+        }
+        return (_schedule.owners)[_lwid - _schedule.base];
+    }
+
+public:
+    /** 
+     *  \brief Constructor
+     *  
+     *  \param _n_replicas number of replicas of the Win_Farm
+     */ 
+    Win_Scheduler(size_t _n_replicas):
+                  stats(std::max<size_t>(_n_replicas, 1)),
+                  win_cost(0),
+                  input_cost(0),
+                  next_choice(0) {}
+
+    // get the number of replicas
+    size_t getNumReplicas() const
+    {
+        return stats.size();
+    }
+
+    // get the assignment of the windows of a key (created if not present, the address does not change)
+    Key_Schedule *getSchedule(const key_t &_key)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &s = schedules[_key];
+        if (s == nullptr) {
+            s = std::make_unique<Key_Schedule>();
+        }
+        return s.get();
+    }
+
+    // get the owners of the windows from _first to _last of a key, assigning the ones not assigned yet (called by the emitters)
+    void assign(Key_Schedule *_schedule, uint64_t _first, uint64_t _last, std::deque<size_t> &_owners)
+    {
+        std::lock_guard<std::mutex> lock(_schedule->mutex);
+        for (uint64_t w=_first; w<=_last; w++) {
+            // the window has already been fired (and its assignment discarded)
+            if (w < _schedule->base) {
+                _owners.push_back(FIRED);
+                continue;
+            }
+            size_t &owner = getOwner(*_schedule, w);
+            if (owner == UNASSIGNED) {
+                owner = choose();
+                stats[owner].assigned.fetch_add(1, std::memory_order_relaxed);
+            }
+            _owners.push_back(owner);
+        }
+    }
+
+    // fire a window of a key by a replica, returns true if the window must be evaluated by the caller (its owner, or the first replica firing it if not assigned)
+    bool fire(Key_Schedule *_schedule, uint64_t _lwid, size_t _replica)
+    {
+        std::lock_guard<std::mutex> lock(_schedule->mutex);
+        if (_lwid < _schedule->base) {
+            return false;
+        }
+        size_t &owner = getOwner(*_schedule, _lwid);
+        if (owner == UNASSIGNED) {
+            owner = _replica;
+            stats[_replica].assigned.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (owner != _replica) {
+            return false;
+        }
+        // the assignment is discarded once the window has been fired by its owner
+        owner = FIRED;
+        while (!(_schedule->owners).empty() && (_schedule->owners).front() == FIRED) {
+            (_schedule->owners).pop_front();
+            _schedule->base++;
+        }
+        return true;
+    }
+
+    // add a window evaluated by a replica with its processing time (in nanoseconds)
+    void addEvaluated(size_t _replica, uint64_t _nsecs)
+    {
+        stats[_replica].windows.fetch_add(1, std::memory_order_relaxed);
+        stats[_replica].busy.fetch_add(_nsecs, std::memory_order_relaxed);
+        updateCost(win_cost, _nsecs);
+    }
+
+    // add inputs sent to a replica
+    void addSent(size_t _replica, uint64_t _n)
+    {
+        stats[_replica].sent.fetch_add(_n, std::memory_order_relaxed);
+    }
+
+    // add inputs processed by a replica
+    void addProcessed(size_t _replica, uint64_t _n)
+    {
+        stats[_replica].processed.fetch_add(_n, std::memory_order_relaxed);
+    }
+
+    // add the processing time of a sampled input (in nanoseconds, without the evaluation of the windows)
+    void addInputCost(uint64_t _nsecs)
+    {
+        updateCost(input_cost, _nsecs);
+    }
+
+    /** 
+     *  \brief Get the number of windows evaluated by a replica
+     *  
+     *  \param _replica identifier of the replica
+     *  \return number of windows evaluated by the replica
+     */ 
+    uint64_t getNumWindows(size_t _replica) const
+    {
+        return stats[_replica].windows.load(std::memory_order_relaxed);
+    }
+
+    /** 
+     *  \brief Get the time spent by a replica evaluating windows
+     *  
+     *  \param _replica identifier of the replica
+     *  \return time spent by the replica evaluating windows (in nanoseconds)
+     */ 
+    uint64_t getBusyTime(size_t _replica) const
+    {
+        return stats[_replica].busy.load(std::memory_order_relaxed);
+    }
+
+    /** 
+     *  \brief Get the number of windows assigned to a replica and not evaluated yet
+     *  
+     *  \param _replica identifier of the replica
+     *  \return number of pending windows of the replica
+     */ 
+    uint64_t getPendingWindows(size_t _replica) const
+    {
+        uint64_t assigned = stats[_replica].assigned.load(std::memory_order_relaxed);
+        uint64_t windows = stats[_replica].windows.load(std::memory_order_relaxed);
+        return (assigned > windows) ? assigned - windows : 0;
+    }
+
+    /** 
+     *  \brief Get the number of inputs sent to a replica and not processed yet
+     *  
+     *  \param _replica identifier of the replica
+     *  \return estimated backlog of the replica
+     */ 
+    uint64_t getBacklog(size_t _replica) const
+    {
+        uint64_t sent = stats[_replica].sent.load(std::memory_order_relaxed);
+        uint64_t processed = stats[_replica].processed.load(std::memory_order_relaxed);
+        return (sent > processed) ? sent - processed : 0;
+    }
+};
+
+// class Win_Scheduler_Router (used by each emitter of a Win_Farm with the dynamic scheduling)
+template<typename key_t>
+class Win_Scheduler_Router
+{
+private:
+    using scheduler_t = Win_Scheduler<key_t>;
+    std::shared_ptr<scheduler_t> scheduler; // scheduler of the windows (nullptr with the static scheduling)
+    std::vector<uint64_t> sent; // number of inputs sent to each replica and not reported yet
+    uint64_t n_inputs; // number of inputs routed so far
+
+public:
+    // struct of the owners of the windows of a key known by the emitter (the assignments do not change)
+    struct Key_Cache
+    {
+        typename scheduler_t::Key_Schedule *schedule = nullptr; // assignment of the windows of the key
+        uint64_t base = 0; // lwid of the first window in owners
+        std::deque<size_t> owners; // owners[i] is the owner of the window base+i
+    };
+
+    // Constructor
+    Win_Scheduler_Router(std::shared_ptr<scheduler_t> _scheduler=nullptr):
+                         scheduler(_scheduler),
+                         n_inputs(0)
+    {
+        if (scheduler != nullptr) {
+            sent.resize(scheduler->getNumReplicas(), 0);
+        }
+    }
+
+    // check whether the dynamic scheduling is used
+    bool isEnabled() const
+    {
+        return scheduler != nullptr;
+    }
+
+    // get the distinct owners of the windows from _first to _last of a key (the ones already fired are skipped), returns their number
+    size_t route(const key_t &_key, Key_Cache &_cache, uint64_t _first, uint64_t _last, std::vector<size_t> &_dests)
+    {
+        if (_cache.schedule == nullptr) {
+            _cache.schedule = scheduler->getSchedule(_key);
+        }
+        // the windows before _first are not needed anymore (unless a later tuple is out of order)
+        while (!(_cache.owners).empty() && _cache.base < _first) {
+            (_cache.owners).pop_front();
+            _cache.base++;
+        }
+        // the owners not known are obtained from the scheduler (and the windows not assigned yet are assigned)
+        if ((_cache.owners).empty() || _first < _cache.base) {
+            (_cache.owners).clear();
+            _cache.base = _first;
+        }
+        uint64_t known = _cache.base + (_cache.owners).size();
+        if (known <= _last) {
+            scheduler->assign(_cache.schedule, known, _last, _cache.owners);
+        }
+        size_t count = 0;
+        for (uint64_t w=_first; w<=_last; w++) {
+            size_t owner = (_cache.owners)[w - _cache.base];
+            if (owner == scheduler_t::FIRED || std::find(_dests.begin(), _dests.begin() + count, owner) != _dests.begin() + count) {
+                continue;
+            }
+            _dests[count++] = owner;
+        }
+        return count;
+    }
+
+    // count an input sent to the first _n replicas in _dests
+    void addSent(const std::vector<size_t> &_dests, size_t _n)
+    {
+        for (size_t i=0; i<_n; i++) {
+            sent[_dests[i]]++;
+        }
+        if ((++n_inputs & (DEFAULT_WIN_SCHEDULER_REPORT - 1)) == 0) {
+            flush();
+        }
+    }
+
+    // count an input sent to all the replicas
+    void addSentAll()
+    {
+        for (auto &s: sent) {
+            s++;
+        }
+        if ((++n_inputs & (DEFAULT_WIN_SCHEDULER_REPORT - 1)) == 0) {
+            flush();
+        }
+    }
+
+    // report the inputs sent and not reported yet
+    void flush()
+    {
+        for (size_t i=0; i<sent.size(); i++) {
+            if (sent[i] > 0) {
+                scheduler->addSent(i, sent[i]);
+                sent[i] = 0;
+            }
+        }
+    }
+};
+
+// class Win_Scheduler_Replica (used by each replica of a Win_Farm with the dynamic scheduling)
+template<typename key_t>
+class Win_Scheduler_Replica
+{
+private:
+    using scheduler_t = Win_Scheduler<key_t>;
+    std::shared_ptr<scheduler_t> scheduler; // scheduler of the windows (nullptr with the static scheduling)
+    size_t id; // identifier of the replica
+    uint64_t n_inputs; // number of inputs received
+    uint64_t eval_nsecs; // time spent evaluating windows during the sampled input (in nanoseconds)
+
+public:
+    // Constructor
+    Win_Scheduler_Replica(std::shared_ptr<scheduler_t> _scheduler=nullptr,
+                          size_t _id=0):
+                          scheduler(_scheduler),
+                          id(_id),
+                          n_inputs(0),
+                          eval_nsecs(0) {}
+
+    // check whether the dynamic scheduling is used
+    bool isEnabled() const
+    {
+        return scheduler != nullptr;
+    }
+
+    // get the assignment of the windows of a key
+    typename scheduler_t::Key_Schedule *getSchedule(const key_t &_key)
+    {
+        return scheduler->getSchedule(_key);
+    }
+
+    // fire a window of a key, returns true if the window must be evaluated by this replica (always true with the static scheduling)
+    bool fire(typename scheduler_t::Key_Schedule *_schedule, uint64_t _lwid)
+    {
+        return (scheduler == nullptr) || scheduler->fire(_schedule, _lwid, id);
+    }
+
+    // add a window evaluated by the replica with its processing time (in nanoseconds)
+    void addEvaluated(uint64_t _nsecs)
+    {
+        eval_nsecs += _nsecs;
+        scheduler->addEvaluated(id, _nsecs);
+    }
+
+    // count a received input and start the measurement of its cost (one input every DEFAULT_WIN_SCHEDULER_SAMPLING), returns zero if the input is not sampled
+    uint64_t startSample()
+    {
+        if (scheduler == nullptr) {
+            return 0;
+        }
+        if ((++n_inputs & (DEFAULT_WIN_SCHEDULER_REPORT - 1)) == 0) {
+            scheduler->addProcessed(id, DEFAULT_WIN_SCHEDULER_REPORT);
+        }
+        if ((n_inputs & (DEFAULT_WIN_SCHEDULER_SAMPLING - 1)) != 0) {
+            return 0;
+        }
+        eval_nsecs = 0;
+        return current_time_nsecs();
+    }
+
+    // report the inputs received and not reported yet
+    void flush()
+    {
+        if (scheduler != nullptr && (n_inputs & (DEFAULT_WIN_SCHEDULER_REPORT - 1)) != 0) {
+            scheduler->addProcessed(id, n_inputs & (DEFAULT_WIN_SCHEDULER_REPORT - 1));
+            n_inputs &= ~((uint64_t) DEFAULT_WIN_SCHEDULER_REPORT - 1);
+        }
+    }
+
+    // end the measurement of the cost of a sampled input (the windows evaluated meanwhile are not counted)
+    void endSample(uint64_t _start)
+    {
+        if (_start > 0) {
+            uint64_t elapsed = current_time_nsecs() - _start;
+            scheduler->addInputCost((elapsed > eval_nsecs) ? elapsed - eval_nsecs : 0);
+        }
+    }
+};
+
+} // namespace wf
+
+#endif
@@ -45,6 +45,11 @@
 #include<meta.hpp>
 #include<window.hpp>
 #include<context.hpp>
+#include<watermark.hpp>
+#include<key_groups.hpp>
+#include<win_scheduler.hpp>
+#include<shared_archive.hpp>
+#include<placement.hpp>
 #include<iterable.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
@@ -81,6 +86,8 @@ private:
     tuple_t tmp; // never used
     // key data type
     using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
+    // type of the archive shared by the replicas of a Win_Farm
+    using shared_archive_t = Shared_Archive<tuple_t, key_t>;
     // friendships with other classes in the library
     template<typename T1, typename T2, typename T3>
     friend class Win_Farm;
@@ -103,6 +110,10 @@ private:
         uint64_t next_ids; // progressive counter (used if isRenumbering is true)
         uint64_t next_lwid; // next window to be opened of this key (lwid)
         int64_t last_lwid; // last window closed of this key (lwid)
+        typename Win_Scheduler<key_t>::Key_Schedule *schedule; // assignment of the windows of this key to the replicas (used with the dynamic scheduling)
+        typename shared_archive_t::Key_Handle shared; // handle to the shared archive of this key (used with the shared archive)
+        size_t owner; // identifier of the replica appending the tuples of this key to the shared archive
+        uint64_t initial_id; // initial timestamp of the keyed sub-stream arriving at this node (used with the shared archive)
 
         // Constructor
         Key_Descriptor(compare_func_t _compare_func,
@@ -111,7 +122,10 @@ private:
                        emit_counter(_emit_counter),
                        next_ids(0),
                        next_lwid(0),
-                       last_lwid(-1)
+                       last_lwid(-1),
+                       schedule(nullptr),
+                       owner(0),
+                       initial_id(0)
         {
             wins.reserve(DEFAULT_VECTOR_CAPACITY);
         }
@@ -123,7 +137,11 @@ private:
                        emit_counter(_k.emit_counter),
                        next_ids(_k.next_ids),
                        next_lwid(_k.next_lwid),
-                       last_lwid(_k.last_lwid) {}
+                       last_lwid(_k.last_lwid),
+                       schedule(_k.schedule),
+                       shared(_k.shared),
+                       owner(_k.owner),
+                       initial_id(_k.initial_id) {}
     };
     win_func_t win_func; // function for the non-incremental window processing
     rich_win_func_t rich_win_func; // rich function for the non-incremental window processing
@@ -147,6 +165,13 @@ private:
     size_t eos_received; // number of received EOS messages
     bool terminated; // true if the replica has finished its work
     bool isRenumbering; // if true, the node assigns increasing identifiers to the input tuples (useful for count-based windows in DEFAULT mode)
+    uint64_t early_interval; // interval (in microseconds) between two early results of the open windows (zero means no early firing)
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+    KeyGroup_Replica<std::unordered_map<key_t, Key_Descriptor>> keyGroups; // key groups of the replica (used if they can be migrated among the replicas)
+    Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the operator is not placed by the PipeGraph)
+    Win_Scheduler_Replica<key_t> winScheduler; // windows assigned to the replica (used with the dynamic scheduling)
+    std::shared_ptr<shared_archive_t> shared_archive; // archive shared by the replicas (nullptr if each replica has its own archives)
+    size_t replica_id; // identifier of the replica within the Win_Farm (used with the dynamic scheduling and the shared archive)
 #if defined (TRACE_WINDFLOW)
     Stats_Record stats_record;
     double avg_td_us = 0;
@@ -162,6 +187,15 @@ private:
             std::cerr << RED << "WindFlow Error: window length or slide in Win_Seq cannot be zero" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        // early results are possible only if the windows are not partitioned among several nodes
+        if (early_interval > 0 && role != role_t::SEQ) {
+            std::cerr << RED << "WindFlow Error: early firing in Win_Seq is possible with the SEQ role only" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (early_interval > 0 && !decltype(check_early_t((result_t *) nullptr))::value) {
+            std::cerr << RED << "WindFlow Error: early firing requires a result type with the setEarly(bool) method" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // define the compare function depending on the window type
         if (winType == win_type_t::CB) {
             compare_func = [](const tuple_t &t1, const tuple_t &t2) {
@@ -175,12 +209,249 @@ private:
         }
     }
 
+    // method to set the CPU and NUMA node of the replica
+    void setPlacement(Placement_Replica _placement)
+    {
+        placement = _placement;
+    }
+
+    // method to enable the migration of the key groups
+    void enableKeyGroups(std::shared_ptr<KeyGroup_Manager> _manager, size_t _id)
+    {
+        keyGroups.init(_manager, _id, &keyMap,
+                       [this](void *_input) { svc(reinterpret_cast<input_t *>(_input)); },
+                       [this](uint64_t _wm) { forwardWatermark(_wm); });
+    }
+
+    // method to enable the dynamic scheduling of the windows (the replica opens the windows of the tuples it receives and evaluates the ones assigned to it)
+    void enableDynamicScheduling(std::shared_ptr<Win_Scheduler<key_t>> _scheduler, size_t _id)
+    {
+        winScheduler = Win_Scheduler_Replica<key_t>(_scheduler, _id);
+        replica_id = _id;
+    }
+
+    // method to enable the shared archive (the tuples of the keys owned by the replica are appended to it, the windows are computed on it)
+    void enableSharedArchive(std::shared_ptr<shared_archive_t> _shared_archive, size_t _id)
+    {
+        shared_archive = _shared_archive;
+        replica_id = _id;
+    }
+
     // method to set the indexes useful if role is MAP
     void setMapIndexes(size_t _first, size_t _second) {
         map_indexes.first = _first; // id
         map_indexes.second = _second; // pardegree
     }
 
+    // method to get the gwid of the first window of a key assigned to this node and the initial identifier/timestamp of the keyed sub-stream
+    std::pair<uint64_t, uint64_t> getKeyOffsets(size_t _hashcode) const
+    {
+        // gwid of the first window of that key assigned to this Win_Seq node
+        uint64_t first_gwid_key = ((config.id_inner - (_hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.n_outer + (config.id_outer - (_hashcode % config.n_outer) + config.n_outer) % config.n_outer;
+        // initial identifer/timestamp of the keyed sub-stream arriving at this Win_Seq node
+        uint64_t initial_outer = ((config.id_outer - (_hashcode % config.n_outer) + config.n_outer) % config.n_outer) * config.slide_outer;
+        uint64_t initial_inner = ((config.id_inner - (_hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.slide_inner;
+        uint64_t initial_id = initial_outer + initial_inner;
+        // special cases: if role is WLQ or REDUCE
+        if (role == role_t::WLQ || role == role_t::REDUCE) {
+            initial_id = initial_inner;
+        }
+        return std::make_pair(first_gwid_key, initial_id);
+    }
+
+    // method to open all the windows of a key up to the one with the given lwid
+    void openWindows(const key_t &_key, Key_Descriptor &_key_d, uint64_t _first_gwid_key, uint64_t _initial_id, long _last_w)
+    {
+        for (long lwid = _key_d.next_lwid; lwid <= _last_w; lwid++) {
+            // translate the lwid into the corresponding gwid
+            uint64_t gwid = _first_gwid_key + (lwid * config.n_outer * config.n_inner);
+            if (winType == win_type_t::CB) {
+                (_key_d.wins).push_back(win_t(_key, lwid, gwid, Triggerer_CB(win_len, slide_len, lwid, _initial_id), win_type_t::CB, win_len, slide_len));
+            }
+            else {
+                (_key_d.wins).push_back(win_t(_key, lwid, gwid, Triggerer_TB(win_len, slide_len, lwid, _initial_id, triggering_delay), win_type_t::TB, win_len, slide_len));
+            }
+            _key_d.next_lwid++;
+        }
+    }
+
+    // method to run the non-incremental query on the tuples of a window received so far
+    void evaluateWindow(Key_Descriptor &_key_d, win_t &_win, result_t &_res)
+    {
+        // with the shared archive, the range is given by the boundaries of the window
+        if (shared_archive != nullptr) {
+            uint64_t start = _key_d.initial_id + _win.getLWID() * slide_len;
+            auto its = shared_archive->getWinRange(_key_d.shared, replica_id, start, start + win_len);
+            Iterable<tuple_t> iter(its.first, its.second);
+            if (!isRich) {
+                win_func(_win.getGWID(), iter, _res);
+            }
+            else {
+                rich_win_func(_win.getGWID(), iter, _res, context);
+            }
+            return;
+        }
+        // acquire from the archive the optionals to the first and the last tuple of the window
+        std::optional<tuple_t> t_s = _win.getFirstTuple();
+        std::optional<tuple_t> t_e = _win.getLastTuple();
+        std::pair<input_iterator_t, input_iterator_t> its;
+        // empty window
+        if (!t_s) {
+            its.first = (_key_d.archive).end();
+            its.second = (_key_d.archive).end();
+        }
+        // non-empty window (the last tuple is missing if the window is not complete or it is fired by a watermark)
+        else {
+            if (!t_e) {
+                its = (_key_d.archive).getWinRange(*t_s);
+            }
+            else {
+                its = (_key_d.archive).getWinRange(*t_s, *t_e);
+            }
+        }
+        Iterable<tuple_t> iter(its.first, its.second);
+        // non-incremental query -> call rich_/win_func
+        if (!isRich) {
+            win_func(_win.getGWID(), iter, _res);
+        }
+        else {
+            rich_win_func(_win.getGWID(), iter, _res, context);
+        }
+    }
+
+    // method to check whether a fired window is assigned to the replica (always true with the static scheduling)
+    bool claimWindow(Key_Descriptor &_key_d, win_t &_win)
+    {
+        return winScheduler.fire(_key_d.schedule, _win.getLWID());
+    }
+
+    // method to run the non-incremental query on a fired window (timed with the dynamic scheduling)
+    void evaluateFiredWindow(Key_Descriptor &_key_d, win_t &_win)
+    {
+        // with the shared archive, wait for the owner of the key to append all the tuples of the window
+        if (shared_archive != nullptr) {
+            shared_archive->waitFor(_key_d.owner, _key_d.initial_id + _win.getLWID() * slide_len + win_len);
+        }
+        if (!winScheduler.isEnabled()) {
+            evaluateWindow(_key_d, _win, _win.getResult());
+            return;
+        }
+        uint64_t start = current_time_nsecs();
+        evaluateWindow(_key_d, _win, _win.getResult());
+        winScheduler.addEvaluated(current_time_nsecs() - start);
+    }
+
+    // method to process a fired window of a key and to send its result
+    void fireWindow(const key_t &_key, size_t _hashcode, Key_Descriptor &_key_d, win_t &_win)
+    {
+        // with the dynamic scheduling, the window is evaluated and its result is sent only by the replica owning it
+        bool claimed = claimWindow(_key_d, _win);
+        // non-incremental query -> call win_func
+        if (isNIC && claimed) {
+            evaluateFiredWindow(_key_d, _win);
+        }
+        // purge the tuples from the archive (if the window is not empty)
+        std::optional<tuple_t> t_s = _win.getFirstTuple();
+        if (shared_archive != nullptr) {
+            shared_archive->release(_key_d.shared, replica_id, _key_d.initial_id + (_win.getLWID() + 1) * slide_len);
+        }
+        else if (t_s) {
+            (_key_d.archive).purge(*t_s);
+        }
+        _key_d.last_lwid++;
+        if (!claimed) {
+            return;
+        }
+        // send the result of the fired window
+        result_t *out = new result_t(_win.getResult());
+        if (early_interval > 0) {
+            markResult(*out, false);
+        }
+        // special cases: role is PLQ or MAP
+        if (role == role_t::MAP) {
+            out->setControlFields(_key, _key_d.emit_counter, std::get<2>(out->getControlFields()));
+            _key_d.emit_counter += map_indexes.second;
+        }
+        else if (role == role_t::PLQ) {
+            uint64_t new_id = ((config.id_inner - (_hashcode % config.n_inner) + config.n_inner) % config.n_inner) + (_key_d.emit_counter * config.n_inner);
+            out->setControlFields(_key, new_id, std::get<2>(out->getControlFields()));
+            _key_d.emit_counter++;
+        }
+        this->ff_send_out(out);
+#if defined (TRACE_WINDFLOW)
+        stats_record.outputs_sent++;
+        stats_record.bytes_sent += sizeof(result_t);
+#endif
+    }
+
+    // method to send the early results of the open windows updated after their last early result (the windows stay open)
+    void emitEarlyResults()
+    {
+        for (auto &k: keyMap) {
+            Key_Descriptor &key_d = k.second;
+            for (auto &win: key_d.wins) {
+                if (!win.hasEarlyUpdates()) {
+                    continue;
+                }
+                // the incremental query has already updated the result, the non-incremental one is run on a copy
+                result_t *out = new result_t(win.getResult());
+                if (isNIC) {
+                    evaluateWindow(key_d, win, *out);
+                }
+                markResult(*out, true);
+                win.setEarlyFired();
+                this->ff_send_out(out);
+#if defined (TRACE_WINDFLOW)
+                stats_record.outputs_sent++;
+                stats_record.bytes_sent += sizeof(result_t);
+#endif
+            }
+        }
+    }
+
+    // method to process a watermark and forward it
+    void forwardWatermark(uint64_t _wm)
+    {
+        // the tuples with smaller timestamp have already been processed
+        if (shared_archive != nullptr) {
+            shared_archive->publish(replica_id, _wm);
+        }
+        if (winType == win_type_t::TB) {
+            processWatermark(_wm);
+        }
+        this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(_wm)));
+    }
+
+    // method to fire the time-based windows of all the keys completed by the watermark
+    void processWatermark(uint64_t _wm)
+    {
+        for (auto &k: keyMap) {
+            Key_Descriptor &key_d = k.second;
+            size_t hashcode = std::hash<key_t>()(k.first); // compute the hashcode of the key
+            auto offsets = getKeyOffsets(hashcode);
+            uint64_t initial_id = offsets.second;
+            if (_wm <= initial_id) {
+                continue;
+            }
+            // open the windows starting before the watermark (the ones of the sliding/tumbling case suffice also for the hopping case)
+            long last_w = ceil(((double) _wm - initial_id)/((double) slide_len)) - 1;
+            openWindows(k.first, key_d, offsets.first, initial_id, last_w);
+            // fire the windows (in order) whose final boundary is not greater than the watermark
+            auto &wins = key_d.wins;
+            size_t cnt_fired = 0;
+            for (auto &win: wins) {
+                win_event_t event = win.onWatermark(_wm);
+                if (event != win_event_t::DELAYED && event != win_event_t::FIRED) {
+                    break;
+                }
+                fireWindow(k.first, hashcode, key_d, win);
+                cnt_fired++;
+            }
+            // purge the fired windows
+            wins.erase(wins.begin(), wins.begin() + cnt_fired);
+        }
+    }
+
 public:
     // Constructor I
     Win_Seq(win_func_t _win_func,
@@ -192,7 +463,8 @@ public:
             closing_func_t _closing_func,
             RuntimeContext _context,
             WinOperatorConfig _config,
-            role_t _role):
+            role_t _role,
+            uint64_t _early_interval=0):
             win_func(_win_func),
             win_len(_win_len),
             slide_len(_slide_len),
@@ -208,7 +480,9 @@ public:
             ignored_tuples(0),
             eos_received(0),
             terminated(false),
-            isRenumbering(false)
+            isRenumbering(false),
+            early_interval(_early_interval),
+            replica_id(0)
     {
         init();
     }
@@ -223,7 +497,8 @@ public:
             closing_func_t _closing_func,
             RuntimeContext _context,
             WinOperatorConfig _config,
-            role_t _role):
+            role_t _role,
+            uint64_t _early_interval=0):
             rich_win_func(_rich_win_func),
             win_len(_win_len),
             slide_len(_slide_len),
@@ -239,7 +514,9 @@ public:
             ignored_tuples(0),
             eos_received(0),
             terminated(false),
-            isRenumbering(false)
+            isRenumbering(false),
+            early_interval(_early_interval),
+            replica_id(0)
     {
         init();
     }
@@ -254,7 +531,8 @@ public:
             closing_func_t _closing_func,
             RuntimeContext _context,
             WinOperatorConfig _config,
-            role_t _role):
+            role_t _role,
+            uint64_t _early_interval=0):
             winupdate_func(_winupdate_func),
             win_len(_win_len),
             slide_len(_slide_len),
@@ -270,7 +548,9 @@ public:
             ignored_tuples(0),
             eos_received(0),
             terminated(false),
-            isRenumbering(false)
+            isRenumbering(false),
+            early_interval(_early_interval),
+            replica_id(0)
     {
         init();
     }
@@ -285,7 +565,8 @@ public:
             closing_func_t _closing_func,
             RuntimeContext _context,
             WinOperatorConfig _config,
-            role_t _role):
+            role_t _role,
+            uint64_t _early_interval=0):
             rich_winupdate_func(_rich_winupdate_func),
             win_len(_win_len),
             slide_len(_slide_len),
@@ -301,7 +582,9 @@ public:
             ignored_tuples(0),
             eos_received(0),
             terminated(false),
-            isRenumbering(false)
+            isRenumbering(false),
+            early_interval(_early_interval),
+            replica_id(0)
     {
         init();
     }
@@ -309,15 +592,52 @@ public:
     // svc_init method (utilized by the FastFlow runtime)
     int svc_init() override
     {
+        // bind the replica to its CPU before it allocates its state
+        placement.bind();
 #if defined (TRACE_WINDFLOW)
             stats_record = Stats_Record(name, std::to_string(this->get_my_id()), true, false);
+            stats_record.cpu = placement.getCPU();
+            stats_record.numa_node = placement.getNode();
 #endif
+        // the early results are produced periodically by a timer of the replica
+        if (early_interval > 0) {
+            context.registerPeriodicTimer(early_interval, [this](RuntimeContext &) { emitEarlyResults(); });
+        }
         return 0;
     }
 
     // svc method (utilized by the FastFlow runtime)
     result_t *svc(input_t *wt) override
     {
+        // execute the callbacks of the expired timers of the replica
+        context.pollTimers();
+        // install the key groups migrated to the replica and release the ones migrated to other replicas
+        if (keyGroups.isEnabled()) {
+            keyGroups.poll();
+            if (isKeyGroupMarker(wt)) {
+                keyGroups.release(getKeyGroup(wt), this->get_num_inchannels());
+                return this->GO_ON;
+            }
+        }
+        // watermarks fire the time-based windows completed by them and are forwarded (unless a key group is migrating to the replica)
+        if (isWatermark(wt)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(wt))) {
+                if (!keyGroups.deferWatermark(wm_merger.get())) {
+                    forwardWatermark(wm_merger.get());
+                }
+            }
+            return this->GO_ON;
+        }
+        // the tuples of the key groups not installed yet are buffered until their state is received
+        uint64_t sample = 0;
+        if (keyGroups.isEnabled()) {
+            if (!keyGroups.admit(std::get<0>((extractTuple<tuple_t, input_t>(wt))->getControlFields()), wt)) {
+                return this->GO_ON;
+            }
+            sample = keyGroups.startSample();
+        }
+        // the cost of one input every DEFAULT_WIN_SCHEDULER_SAMPLING is measured (dynamic scheduling)
+        uint64_t win_sample = winScheduler.startSample();
 #if defined (TRACE_WINDFLOW)
         startTS = current_time_nsecs();
         if (stats_record.inputs_received == 0) {
@@ -331,12 +651,24 @@ public:
         auto key = std::get<0>(t->getControlFields()); // key
         size_t hashcode = std::hash<decltype(key)>()(key); // compute the hashcode of the key
         uint64_t id = (winType == win_type_t::CB) ? std::get<1>(t->getControlFields()) : std::get<2>(t->getControlFields()); // identifier or timestamp
+        // the tuples with smaller timestamp have already been processed (the inputs are ordered with the shared archive)
+        if (shared_archive != nullptr) {
+            shared_archive->publish(replica_id, id);
+        }
         // access the descriptor of the input key
         auto it = keyMap.find(key);
         if (it == keyMap.end()) {
             // create the descriptor of that key
             keyMap.insert(std::make_pair(key, Key_Descriptor(compare_func, role == role_t::MAP ? map_indexes.first : 0)));
             it = keyMap.find(key);
+            if (winScheduler.isEnabled()) {
+                ((*it).second).schedule = winScheduler.getSchedule(key);
+            }
+            if (shared_archive != nullptr) {
+                ((*it).second).shared = shared_archive->getHandle(key);
+                ((*it).second).owner = shared_archive->getOwner(hashcode);
+                ((*it).second).initial_id = getKeyOffsets(hashcode).second;
+            }
         }
         Key_Descriptor &key_d = (*it).second;
         // check if isRenumbering is enabled (used for count-based windows in DEFAULT mode)
@@ -345,15 +677,13 @@ public:
             id = key_d.next_ids++;
             t->setControlFields(std::get<0>(t->getControlFields()), id, std::get<2>(t->getControlFields()));
         }
-        // gwid of the first window of that key assigned to this Win_Seq node
-        uint64_t first_gwid_key = ((config.id_inner - (hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.n_outer + (config.id_outer - (hashcode % config.n_outer) + config.n_outer) % config.n_outer;
-        // initial identifer/timestamp of the keyed sub-stream arriving at this Win_Seq node
-        uint64_t initial_outer = ((config.id_outer - (hashcode % config.n_outer) + config.n_outer) % config.n_outer) * config.slide_outer;
-        uint64_t initial_inner = ((config.id_inner - (hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.slide_inner;
-        uint64_t initial_id = initial_outer + initial_inner;
-        // special cases: if role is WLQ or REDUCE
-        if (role == role_t::WLQ || role == role_t::REDUCE) {
-            initial_id = initial_inner;
+        // gwid of the first window of that key assigned to this Win_Seq node and initial identifer/timestamp of the keyed sub-stream
+        auto offsets = getKeyOffsets(hashcode);
+        uint64_t first_gwid_key = offsets.first;
+        uint64_t initial_id = offsets.second;
+        // the owner of the key appends all its tuples to the shared archive, also the ones outside the windows of this node
+        if (shared_archive != nullptr && key_d.owner == replica_id && !isEOSMarker<tuple_t, input_t>(*wt)) {
+            shared_archive->append(key_d.shared, *t, replica_id);
         }
         // check if the tuple must be ignored
         uint64_t min_boundary = (key_d.last_lwid >= 0) ? win_len + (key_d.last_lwid  * slide_len) : 0;
@@ -410,22 +740,12 @@ public:
             }
         }
         // copy the tuple into the archive of the corresponding key
-        if (!isEOSMarker<tuple_t, input_t>(*wt) && isNIC) {
+        if (!isEOSMarker<tuple_t, input_t>(*wt) && isNIC && shared_archive == nullptr) {
             (key_d.archive).insert(*t);
         }
         auto &wins = key_d.wins;
         // create all the new windows that need to be opened by the arrival of t
-        for (long lwid = key_d.next_lwid; lwid <= last_w; lwid++) {
-            // translate the lwid into the corresponding gwid
-            uint64_t gwid = first_gwid_key + (lwid * config.n_outer * config.n_inner);
-            if (winType == win_type_t::CB) {
-                wins.push_back(win_t(key, lwid, gwid, Triggerer_CB(win_len, slide_len, lwid, initial_id), win_type_t::CB, win_len, slide_len));
-            }
-            else {
-                wins.push_back(win_t(key, lwid, gwid, Triggerer_TB(win_len, slide_len, lwid, initial_id, triggering_delay), win_type_t::TB, win_len, slide_len));
-            }
-            key_d.next_lwid++;
-        }
+        openWindows(key, key_d, first_gwid_key, initial_id, last_w);
         // evaluate all the open windows
         size_t cnt_fired = 0;
         for (auto &win: wins) {
@@ -443,59 +763,16 @@ public:
                 }
             }
             else if (event == win_event_t::FIRED) { // window is fired
-                // acquire from the archive the optionals to the first and the last tuple of the window
-                std::optional<tuple_t> t_s = win.getFirstTuple();
-                std::optional<tuple_t> t_e = win.getLastTuple();
-                // non-incremental query -> call win_func
-                if (isNIC) {
-                    std::pair<input_iterator_t, input_iterator_t> its;
-                    // empty window
-                    if (!t_s) {
-                        its.first = (key_d.archive).end();
-                        its.second = (key_d.archive).end();
-                    }
-                    // non-empty window
-                    else {
-                        its = (key_d.archive).getWinRange(*t_s, *t_e);
-                    }
-                    Iterable<tuple_t> iter(its.first, its.second);
-                    // non-incremental query -> call rich_/win_func
-                    if (!isRich) {
-                        win_func(win.getGWID(), iter, win.getResult());
-                    }
-                    else {
-                        rich_win_func(win.getGWID(), iter, win.getResult(), context);
-                    }
-                }
-                // purge the tuples from the archive (if the window is not empty)
-                if (t_s) {
-                    (key_d.archive).purge(*t_s);
-                }
+                fireWindow(key, hashcode, key_d, win);
                 cnt_fired++;
-                key_d.last_lwid++;
-                // send the result of the fired window
-                result_t *out = new result_t(win.getResult());
-                // special cases: role is PLQ or MAP
-                if (role == role_t::MAP) {
-                    out->setControlFields(key, key_d.emit_counter, std::get<2>(out->getControlFields()));
-                    key_d.emit_counter += map_indexes.second;
-                }
-                else if (role == role_t::PLQ) {
-                    uint64_t new_id = ((config.id_inner - (hashcode % config.n_inner) + config.n_inner) % config.n_inner) + (key_d.emit_counter * config.n_inner);
-                    out->setControlFields(key, new_id, std::get<2>(out->getControlFields()));
-                    key_d.emit_counter++;
-                }
-                this->ff_send_out(out);
-#if defined (TRACE_WINDFLOW)
-                stats_record.outputs_sent++;
-                stats_record.bytes_sent += sizeof(result_t);
-#endif
             }
         }
         // purge the fired windows
         wins.erase(wins.begin(), wins.begin() + cnt_fired);
         // delete the received tuple
         deleteTuple<tuple_t, input_t>(wt);
+        keyGroups.endSample(sample);
+        winScheduler.endSample(win_sample);
 #if defined (TRACE_WINDFLOW)
         endTS = current_time_nsecs();
         endTD = current_time_nsecs();
@@ -514,46 +791,46 @@ public:
     void eosnotify(ssize_t id) override
     {
         eos_received++;
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            if (!keyGroups.deferWatermark(wm_merger.get())) {
+                forwardWatermark(wm_merger.get());
+            }
+        }
         // check the number of received EOS messages
         if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
             return;
         }
+        // wait for the key groups still migrating to the replica
+        if (keyGroups.isEnabled()) {
+            keyGroups.drain();
+        }
+        // last check of the timers of the replica
+        context.pollTimers();
+        // report the inputs processed by the replica (dynamic scheduling)
+        winScheduler.flush();
+        // all the tuples of the keys owned by the replica have been appended to the shared archive
+        if (shared_archive != nullptr) {
+            shared_archive->terminate(replica_id);
+        }
         // iterate over all the keys
         for (auto &k: keyMap) {
             auto &wins = (k.second).wins;
             // iterate over all the existing windows of the key
             for (auto &win: wins) {
+                // with the dynamic scheduling, the window is evaluated and its result is sent only by the replica owning it
+                if (!claimWindow(k.second, win)) {
+                    continue;
+                }
                 // non-incremental query
                 if (isNIC) {
-                    // acquire from the archive the optional to the first and the last tuples of the window
-                    std::optional<tuple_t> t_s = win.getFirstTuple();
-                    std::optional<tuple_t> t_e = win.getLastTuple();
-                    std::pair<input_iterator_t, input_iterator_t> its;
-                    // empty window
-                    if (!t_s) {
-                        its.first = ((k.second).archive).end();
-                        its.second = ((k.second).archive).end();
-                    }
-                    // non-empty window
-                    else {
-                        if (!t_e) {
-                            its = ((k.second).archive).getWinRange(*t_s);
-                        }
-                        else {
-                            its = ((k.second).archive).getWinRange(*t_s, *t_e);
-                        }
-                    }
-                    Iterable<tuple_t> iter(its.first, its.second);
-                    // non-incremental query -> call rich_/win_func
-                    if (!isRich) {
-                        win_func(win.getGWID(), iter, win.getResult());
-                    }
-                    else {
-                        rich_win_func(win.getGWID(), iter, win.getResult(), context);
-                    }
+                    evaluateFiredWindow(k.second, win);
                 }
                 // send the result of the window
                 result_t *out = new result_t(win.getResult());
+                if (early_interval > 0) {
+                    markResult(*out, false);
+                }
                 // special cases: role is PLQ or MAP
                 if (role == role_t::MAP) {
                     out->setControlFields(k.first, (k.second).emit_counter, std::get<2>(out->getControlFields()));
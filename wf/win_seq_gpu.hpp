@@ -48,6 +48,7 @@
 #include<ff/multinode.hpp>
 #include<meta.hpp>
 #include<window.hpp>
+#include<watermark.hpp>
 #include<meta_gpu.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
@@ -177,6 +178,7 @@ private:
     size_t ignored_tuples; // number of ignored tuples
     size_t eos_received; // number of received EOS messages
     bool terminated; // true if the replica has finished its work
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
     bool isRenumbering; // if true, the node assigns increasing identifiers to the input tuples (useful for count-based windows in DEFAULT mode)
     size_t scratchpad_size = 0; // size of the scratchpage memory area on the GPU (one per CUDA thread)
     // memory arrays allocated in a page-locked manner on the HOST (prefix "pinned" used for them)
@@ -390,6 +392,13 @@ public:
     // svc method (utilized by the FastFlow runtime)
     result_t *svc(input_t *wt) override
     {
+        // watermarks are only forwarded (windows are fired in batches by the tuples)
+        if (isWatermark(wt)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(wt))) {
+                this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(wm_merger.get())));
+            }
+            return this->GO_ON;
+        }
 #if defined (TRACE_WINDFLOW)
         startTS = current_time_nsecs();
         if (stats_record.inputs_received == 0) {
@@ -648,6 +657,10 @@ public:
     void eosnotify(ssize_t id) override
     {
         eos_received++;
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(wm_merger.get())));
+        }
         // check the number of received EOS messages
         if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
             return;
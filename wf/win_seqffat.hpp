@@ -28,6 +28,10 @@
  *  ona multicore. The node executes streaming windows in a serial fashion on a CPU core.
  *  The algorithm is the one implemented by the FlatFAT data structure.
  *  
+ *  With time-based windows, each key keeps a bounded ring of open quanta whose size
+ *  depends on the triggering delay. Out-of-order tuples falling in an open quantum
+ *  are merged in place, while long sequences of empty quanta are coalesced.
+ *  
  *  The template parameters tuple_t and result_t must be default constructible, with
  *  a copy Constructor and a copy assignment operator, and they must provide and implement
  *  the setControlFields() and getControlFields() methods.
@@ -48,6 +52,10 @@
 #include<meta.hpp>
 #include<flatfat.hpp>
 #include<meta_gpu.hpp>
+#include<quanta_ring.hpp>
+#include<watermark.hpp>
+#include<key_groups.hpp>
+#include<placement.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
 #endif
@@ -55,8 +63,8 @@
 namespace wf {
 
 // Win_SeqFFAT class
-template<typename tuple_t, typename result_t>
-class Win_SeqFFAT: public ff::ff_minode_t<tuple_t, result_t>
+template<typename tuple_t, typename result_t, typename input_t>
+class Win_SeqFFAT: public ff::ff_minode_t<input_t, result_t>
 {
 public:
     // type of the lift function
@@ -79,19 +87,23 @@ private:
     // friendships with other classes in the library
     template<typename T1, typename T2>
     friend class Key_FFAT;
+    template<typename T1, typename T2>
+    friend class Win_FFAT;
     // struct of a key descriptor
     struct Key_Descriptor
     {
         fat_t fat; // FlatFAT of this key
         std::vector<result_t> pending_tuples; // vector of pending tuples of this key
-        std::deque<result_t> acc_results; // deque of acculumated results
-        uint64_t cb_id; // identifier used in the count-based translation
-        uint64_t last_quantum; // identifier of the last quantum
+        Quanta_Ring<result_t> ring; // ring of the open quanta (for time-based windows only)
+        uint64_t empty_run; // number of consecutive empty quanta processed so far
+        bool has_empty_result; // true if empty_result is valid
+        result_t empty_result; // cached result of a window made of empty quanta only
         uint64_t rcv_counter; // number of tuples received of this key
         uint64_t slide_counter; // counter of the tuples in the last slide
         uint64_t ts_rcv_counter; // counter of received tuples (count-based translation)
         uint64_t next_ids; // progressive counter (used if isRenumbering is true)
         uint64_t next_lwid; // next window to be opened of this key (lwid)
+        uint64_t early_counter; // value of rcv_counter when the last early result of this key was produced
 
         // Constructor I
         Key_Descriptor(winComb_func_t *_winComb_func,
@@ -99,13 +111,14 @@ private:
                        key_t _key,
                        RuntimeContext *_context):
                        fat(_winComb_func, false /* not commutative by default */, _win_len, _key, _context),
-                       cb_id(0),
-                       last_quantum(0),
+                       empty_run(0),
+                       has_empty_result(false),
                        rcv_counter(0),
                        slide_counter(0),
                        ts_rcv_counter(0),
                        next_ids(0),
-                       next_lwid(0) {}
+                       next_lwid(0),
+                       early_counter(0) {}
 
         // Constructor II
         Key_Descriptor(rich_winComb_func_t *_rich_winComb_func,
@@ -113,26 +126,29 @@ private:
                        key_t _key,
                        RuntimeContext *_context):
                        fat(_rich_winComb_func, false /* not commutative by default */, _win_len, _key, _context),
-                       cb_id(0),
-                       last_quantum(0),
+                       empty_run(0),
+                       has_empty_result(false),
                        rcv_counter(0),
                        slide_counter(0),
                        ts_rcv_counter(0),
                        next_ids(0),
-                       next_lwid(0) {}
+                       next_lwid(0),
+                       early_counter(0) {}
 
         // move Constructor
         Key_Descriptor(Key_Descriptor &&_k):
                        fat(std::move(_k.fat)),
                        pending_tuples(std::move(_k.pending_tuples)),
-                       acc_results(std::move(_k.acc_results)),
-                       cb_id(_k.cb_id),
-                       last_quantum(_k.last_quantum),
+                       ring(std::move(_k.ring)),
+                       empty_run(_k.empty_run),
+                       has_empty_result(_k.has_empty_result),
+                       empty_result(std::move(_k.empty_result)),
                        rcv_counter(_k.rcv_counter),
                        slide_counter(_k.slide_counter),
                        ts_rcv_counter(_k.ts_rcv_counter),
                        next_ids(_k.next_ids),
-                       next_lwid(_k.next_lwid) {}
+                       next_lwid(_k.next_lwid),
+                       early_counter(_k.early_counter) {}
     };
     winLift_func_t winLift_func; // lift function
     winComb_func_t winComb_func; // combine function
@@ -143,6 +159,7 @@ private:
     uint64_t win_len; // window length (no. of tuples or in time units)
     uint64_t slide_len; // slide length (no. of tuples or in time units)
     uint64_t triggering_delay; // triggering delay in time units (meaningful for TB windows only)
+    size_t max_ring_size; // maximum number of open quanta per key (for time-based windows only)
     win_type_t winType; // window type (CB or TB)
     std::string name; // string of the unique name of the node
     bool isRichLift; // flag stating whether the lift function is riched
@@ -154,6 +171,12 @@ private:
     size_t eos_received; // number of received EOS messages
     bool terminated; // true if the replica has finished its work
     bool isRenumbering; // if true, the node assigns increasing identifiers to the input tuples (useful for count-based windows in DEFAULT mode)
+    bool isPreAggregated; // if true, the inputs are partial results of the tuples of the same quantum pre-aggregated by the emitter
+    uint64_t early_interval; // interval (in microseconds) between two early results of the open windows (zero means no early firing)
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+    KeyGroup_Replica<std::unordered_map<key_t, Key_Descriptor>> keyGroups; // key groups of the replica (used if they can be migrated among the replicas)
+    std::pair<size_t, size_t> key_partition = std::make_pair(0, 1); // partition of the keys processed by the node and number of partitions (used by the Win_FFAT)
+    Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the operator is not placed by the PipeGraph)
 #if defined (TRACE_WINDFLOW)
     Stats_Record stats_record;
     double avg_td_us = 0;
@@ -184,17 +207,54 @@ private:
             std::cerr << RED << "WindFlow Error: Win_SeqFFAT can be used with sliding windows only (s<w)" << DEFAULT_COLOR << std::endl;
             exit(EXIT_FAILURE);
         }
+        if (early_interval > 0 && !decltype(check_early_t((result_t *) nullptr))::value) {
+            std::cerr << RED << "WindFlow Error: early firing requires a result type with the setEarly(bool) method" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
         // set the quantum value (for time-based windows only)
         if (winType == win_type_t::TB) {
-            quantum = gcd(win_len, slide_len);
+            // the quantum must also divide the initial timestamps of the sub-streams (see svcTBWindows)
+            quantum = gcd(gcd(win_len, slide_len), gcd(config.slide_outer, config.slide_inner));
             win_len = win_len / quantum;
             slide_len = slide_len / quantum;
+            // open quanta of a key never span more than the triggering delay plus two quanta
+            max_ring_size = (triggering_delay / quantum) + 2;
         }
         else {
             quantum = 0; // zero, quantum is never used
+            max_ring_size = 0;
         }
     }
 
+    // method to set the CPU and NUMA node of the replica
+    void setPlacement(Placement_Replica _placement)
+    {
+        placement = _placement;
+    }
+
+    // method to enable the migration of the key groups (the FlatFATs installed in the replica use its combine functions and RuntimeContext)
+    void enableKeyGroups(std::shared_ptr<KeyGroup_Manager> _manager, size_t _id)
+    {
+        keyGroups.init(_manager, _id, &keyMap,
+                       [this](void *_input) { svc(reinterpret_cast<input_t *>(_input)); },
+                       [this](uint64_t _wm) { processWatermark(_wm); },
+                       [this](Key_Descriptor &_key_d) { (_key_d.fat).rebind(&winComb_func, &rich_winComb_func, &context); });
+    }
+
+    // method to set the partition of the keys processed by the node (the inputs of the other keys are discarded)
+    void setKeyPartition(size_t _id, size_t _n)
+    {
+        key_partition = std::make_pair(_id, _n);
+    }
+
+    // method to get the initial identifier/timestamp of the keyed sub-stream arriving at this node
+    uint64_t getInitialId(size_t hashcode) const
+    {
+        uint64_t initial_outer = ((config.id_outer - (hashcode % config.n_outer) + config.n_outer) % config.n_outer) * config.slide_outer;
+        uint64_t initial_inner = ((config.id_inner - (hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.slide_inner;
+        return initial_outer + initial_inner;
+    }
+
 public:
     // Constructor I
     Win_SeqFFAT(winLift_func_t _winLift_func,
@@ -206,7 +266,8 @@ public:
                 std::string _name,
                 closing_func_t _closing_func,
                 RuntimeContext _context,
-                WinOperatorConfig _config):
+                WinOperatorConfig _config,
+                uint64_t _early_interval=0):
                 winLift_func(_winLift_func),
                 winComb_func(_winComb_func),
                 win_len(_win_len),
@@ -222,7 +283,9 @@ public:
                 ignored_tuples(0),
                 eos_received(0),
                 terminated(false),
-                isRenumbering(false)
+                isRenumbering(false),
+                isPreAggregated(false),
+                early_interval(_early_interval)
     {
         init();
     }
@@ -237,7 +300,8 @@ public:
                 std::string _name,
                 closing_func_t _closing_func,
                 RuntimeContext _context,
-                WinOperatorConfig _config):
+                WinOperatorConfig _config,
+                uint64_t _early_interval=0):
                 rich_winLift_func(_rich_winLift_func),
                 winComb_func(_winComb_func),
                 win_len(_win_len),
@@ -253,7 +317,9 @@ public:
                 ignored_tuples(0),
                 eos_received(0),
                 terminated(false),
-                isRenumbering(false)
+                isRenumbering(false),
+                isPreAggregated(false),
+                early_interval(_early_interval)
     {
         init();
     }
@@ -268,7 +334,8 @@ public:
                 std::string _name,
                 closing_func_t _closing_func,
                 RuntimeContext _context,
-                WinOperatorConfig _config):
+                WinOperatorConfig _config,
+                uint64_t _early_interval=0):
                 winLift_func(_winLift_func),
                 rich_winComb_func(_rich_winComb_func),
                 win_len(_win_len),
@@ -284,7 +351,9 @@ public:
                 ignored_tuples(0),
                 eos_received(0),
                 terminated(false),
-                isRenumbering(false)
+                isRenumbering(false),
+                isPreAggregated(false),
+                early_interval(_early_interval)
     {
         init();
     }
@@ -299,7 +368,8 @@ public:
                 std::string _name,
                 closing_func_t _closing_func,
                 RuntimeContext _context,
-                WinOperatorConfig _config):
+                WinOperatorConfig _config,
+                uint64_t _early_interval=0):
                 rich_winLift_func(_rich_winLift_func),
                 rich_winComb_func(_rich_winComb_func),
                 win_len(_win_len),
@@ -315,7 +385,9 @@ public:
                 ignored_tuples(0),
                 eos_received(0),
                 terminated(false),
-                isRenumbering(false)
+                isRenumbering(false),
+                isPreAggregated(false),
+                early_interval(_early_interval)
     {
         init();
     }
@@ -323,15 +395,68 @@ public:
     // svc_init method (utilized by the FastFlow runtime)
     int svc_init() override
     {
+        // bind the replica to its CPU before it allocates its state
+        placement.bind();
 #if defined (TRACE_WINDFLOW)
         stats_record = Stats_Record(name, std::to_string(this->get_my_id()), true, false);
+        stats_record.cpu = placement.getCPU();
+        stats_record.numa_node = placement.getNode();
+        stats_record.ring_max_size = max_ring_size;
 #endif
+        // the early results are produced periodically by a timer of the replica
+        if (early_interval > 0) {
+            context.registerPeriodicTimer(early_interval, [this](RuntimeContext &) { emitEarlyResults(); });
+        }
         return 0;
     }
 
     // svc method (utilized by the FastFlow runtime)
-    result_t *svc(tuple_t *t) override
+    result_t *svc(input_t *wt) override
     {
+        // execute the callbacks of the expired timers of the replica
+        context.pollTimers();
+        // install the key groups migrated to the replica and release the ones migrated to other replicas
+        if (keyGroups.isEnabled()) {
+            keyGroups.poll();
+            if (isKeyGroupMarker(wt)) {
+                keyGroups.release(getKeyGroup(wt), this->get_num_inchannels());
+                return this->GO_ON;
+            }
+        }
+        // watermarks close the quanta completed by them and are forwarded (unless a key group is migrating to the replica)
+        if (isWatermark(wt)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(wt))) {
+                if (!keyGroups.deferWatermark(wm_merger.get())) {
+                    processWatermark(wm_merger.get());
+                }
+            }
+            return this->GO_ON;
+        }
+        // the tuples of the key groups not installed yet are buffered until their state is received
+        uint64_t sample = 0;
+        if (keyGroups.isEnabled()) {
+            if (!keyGroups.admit(std::get<0>((extractTuple<tuple_t, input_t>(wt))->getControlFields()), wt)) {
+                return this->GO_ON;
+            }
+            sample = keyGroups.startSample();
+        }
+        // the inputs of the keys of the other partitions are discarded (they are broadcast with count-based windows)
+        if (key_partition.second > 1 && !isPreAggregated) {
+            auto key = std::get<0>((extractTuple<tuple_t, input_t>(wt))->getControlFields());
+            if (std::hash<key_t>()(key) % key_partition.second != key_partition.first) {
+                deleteTuple<tuple_t, input_t>(wt);
+                return this->GO_ON;
+            }
+        }
+        // EOS markers are not needed by the FlatFAT algorithm (with time-based windows they only announce
+        // a key, whose quanta will be closed by the next watermarks)
+        if (!isPreAggregated && isEOSMarker<tuple_t, input_t>(*wt)) {
+            if (winType == win_type_t::TB) {
+                getTBKeyDescriptor(std::get<0>((extractTuple<tuple_t, input_t>(wt))->getControlFields()));
+            }
+            deleteTuple<tuple_t, input_t>(wt);
+            return this->GO_ON;
+        }
 #if defined (TRACE_WINDFLOW)
         startTS = current_time_nsecs();
         if (stats_record.inputs_received == 0) {
@@ -342,11 +467,15 @@ public:
 #endif
         // two separate logics depending on the window type
         if (winType == win_type_t::CB) {
-            svcCBWindows(t);
+            svcCBWindows(wt);
+        }
+        else if (isPreAggregated) {
+            svcTBPartials(reinterpret_cast<result_t *>(wt));
         }
         else {
-            svcTBWindows(t);
+            svcTBWindows(wt);
         }
+        keyGroups.endSample(sample);
 #if defined (TRACE_WINDFLOW)
         endTS = current_time_nsecs();
         endTD = current_time_nsecs();
@@ -362,8 +491,9 @@ public:
     }
 
     // processing logic with count-based windows
-    void svcCBWindows(tuple_t *t)
+    void svcCBWindows(input_t *wt)
     {
+        tuple_t *t = extractTuple<tuple_t, input_t>(wt);
         // extract the key and id fields from the input tuple
         auto key = std::get<0>(t->getControlFields()); // key
         size_t hashcode = std::hash<decltype(key)>()(key); // compute the hashcode of the key
@@ -386,6 +516,11 @@ public:
             id = key_d.next_ids++;
             t->setControlFields(std::get<0>(t->getControlFields()), id, std::get<2>(t->getControlFields()));
         }
+        // tuples preceding the first window of the key assigned to this node are discarded
+        if (id < getInitialId(hashcode)) {
+            deleteTuple<tuple_t, input_t>(wt);
+            return;
+        }
         // gwid of the first window of that key assigned to this Win_SeqFFAT node
         uint64_t first_gwid_key = ((config.id_inner - (hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.n_outer + (config.id_outer - (hashcode % config.n_outer) + config.n_outer) % config.n_outer;
         key_d.rcv_counter++;
@@ -430,6 +565,9 @@ public:
             (key_d.fat).remove(slide_len);
             // send the window result
             out->setControlFields(std::get<0>(out->getControlFields()), gwid, std::get<2>(out->getControlFields()));
+            if (early_interval > 0) {
+                markResult(*out, false);
+            }
             this->ff_send_out(out);
 #if defined (TRACE_WINDFLOW)
             stats_record.outputs_sent++;
@@ -437,92 +575,263 @@ public:
 #endif
         }
         // delete the input
-        delete t;
+        deleteTuple<tuple_t, input_t>(wt);
     }
 
     // processing logic with time-based windows
-    void svcTBWindows(tuple_t *t)
+    void svcTBWindows(input_t *wt)
     {
+        tuple_t *t = extractTuple<tuple_t, input_t>(wt);
         // extract the key and timestamp fields from the input tuple
         auto key = std::get<0>(t->getControlFields()); // key
         uint64_t ts = std::get<2>(t->getControlFields()); // timestamp
-        // access the descriptor of the input key
-        auto it = keyMap.find(key);
-        if (it == keyMap.end()) {
-            if (!isRichCombine) {
-                keyMap.insert(std::make_pair(key, Key_Descriptor(&winComb_func, win_len, key, &context)));
+        // access the descriptor of the input key (nullptr if the tuple must be ignored)
+        Key_Descriptor *key_d = admitTB(key, ts);
+        if (key_d != nullptr) {
+            // convert the input tuple to a result with the lift function
+            result_t tmp;
+            tmp.setControlFields(key, 0, ts);
+            if (!isRichLift) {
+                winLift_func(*t, tmp);
             }
             else {
-                keyMap.insert(std::make_pair(key, Key_Descriptor(&rich_winComb_func, win_len, key, &context)));
+                rich_winLift_func(*t, tmp, context);
             }
-            it = keyMap.find(key);
+            insertTB(key, *key_d, ts, tmp);
         }
-        Key_Descriptor &key_d = (*it).second;
-        // compute the identifier of the quantum containing the input tuple
+        // delete the input
+        deleteTuple<tuple_t, input_t>(wt);
+    }
+
+    // processing logic with time-based windows and inputs pre-aggregated by the emitter (the lift function has already been applied)
+    void svcTBPartials(result_t *r)
+    {
+        // extract the key and timestamp fields from the partial result
+        auto key = std::get<0>(r->getControlFields()); // key
+        uint64_t ts = std::get<2>(r->getControlFields()); // timestamp
+        // access the descriptor of the input key (nullptr if the partial result must be ignored)
+        Key_Descriptor *key_d = admitTB(key, ts);
+        if (key_d != nullptr) {
+            insertTB(key, *key_d, ts, *r);
+        }
+        delete r;
+    }
+
+    // get the descriptor of the key of an input and close the quanta completed by it, returns nullptr if the input must be ignored
+    Key_Descriptor *admitTB(const key_t &key, uint64_t ts)
+    {
+        Key_Descriptor &key_d = getTBKeyDescriptor(key);
+        // compute the identifier of the quantum containing the input
         uint64_t quantum_id = ts / quantum;
-        // check if the tuple must be ignored
-        if (quantum_id < key_d.last_quantum) {
+        // check if the input must be ignored (its quantum has already been closed)
+        if ((key_d.ring).isClosed(quantum_id)) {
 #if defined (TRACE_WINDFLOW)
             stats_record.inputs_ignored++;
 #endif
             ignored_tuples++;
-            delete t;
-            return;
+            return nullptr;
         }
         key_d.rcv_counter++;
-        auto &acc_results = key_d.acc_results;
-        int64_t distance = quantum_id - key_d.last_quantum;
-        // resize acc_results properly
-        for (size_t i=acc_results.size(); i<=distance; i++){
-            result_t r;
-            r.setControlFields(key, key_d.cb_id, ((key_d.last_quantum+i+1) * quantum)-1);
-            key_d.cb_id++;
-            acc_results.push_back(r);
-        }
-        // add the input tuple to the correct quantum
-        result_t tmp;
-        tmp.setControlFields(key, 0, ts);
-        if (!isRichLift) {
-            winLift_func(*t, tmp);
+        // close the quanta that are complete by taking into account the triggering delay
+        uint64_t first_open = (ts >= triggering_delay) ? (ts - triggering_delay) / quantum : 0;
+        closeQuanta(key, key_d, first_open);
+        return &key_d;
+    }
+
+    // combine a lifted input into the open quantum containing it
+    void insertTB(const key_t &key, Key_Descriptor &key_d, uint64_t ts, const result_t &lifted)
+    {
+        uint64_t quantum_id = ts / quantum;
+        // find the slot of the quantum in the ring (late tuples are merged in place)
+        bool opened;
+        result_t &slot = (key_d.ring).getSlot(quantum_id, opened);
+        if (opened) {
+            slot = result_t();
+            slot.setControlFields(key, quantum_id, ((quantum_id+1) * quantum)-1);
+        }
+        result_t tmp2;
+        tmp2.setControlFields(key, 0, std::max(std::get<2>(slot.getControlFields()), std::get<2>(lifted.getControlFields())));
+        if (!isRichCombine) {
+            winComb_func(slot, lifted, tmp2);
         }
         else {
-            rich_winLift_func(*t, tmp, context);
+            rich_winComb_func(slot, lifted, tmp2, context);
         }
-        // compute the identifier of the corresponding quantum
-        size_t id = quantum_id - key_d.last_quantum;
-        result_t tmp2;
-        tmp2.setControlFields(key, 0, std::max(std::get<2>((acc_results[id]).getControlFields()), std::get<2>((tmp).getControlFields())));
+        slot = tmp2;
+#if defined (TRACE_WINDFLOW)
+        // update the average number of open quanta per key
+        double occupancy = (double) ((key_d.ring).getLast() - (key_d.ring).getFirst() + 1);
+        uint64_t accepted = stats_record.inputs_received - stats_record.inputs_ignored;
+        stats_record.ring_occupancy += (1.0 / accepted) * (occupancy - stats_record.ring_occupancy);
+#endif
+    }
+
+    // get the descriptor of a key (created if it does not exist) with time-based windows
+    Key_Descriptor &getTBKeyDescriptor(const key_t &key)
+    {
+        auto it = keyMap.find(key);
+        if (it == keyMap.end()) {
+            if (!isRichCombine) {
+                keyMap.insert(std::make_pair(key, Key_Descriptor(&winComb_func, win_len, key, &context)));
+            }
+            else {
+                keyMap.insert(std::make_pair(key, Key_Descriptor(&rich_winComb_func, win_len, key, &context)));
+            }
+            it = keyMap.find(key);
+            // the first quantum of the key is the one where the first window assigned to this node starts
+            uint64_t initial_quantum = getInitialId(std::hash<key_t>()(key)) / quantum;
+            (((*it).second).ring).start(initial_quantum, max_ring_size);
+        }
+        return (*it).second;
+    }
+
+    // combine two partial results of a key into the first one
+    void combineInto(const key_t &key, result_t &acc, const result_t &r)
+    {
+        result_t tmp;
+        tmp.setControlFields(key, 0, std::max(std::get<2>(acc.getControlFields()), std::get<2>(r.getControlFields())));
         if (!isRichCombine) {
-            winComb_func(acc_results[id], tmp, tmp2);
+            winComb_func(acc, r, tmp);
         }
         else {
-            rich_winComb_func(acc_results[id], tmp, tmp2, context);
-        }
-        acc_results[id] = tmp2;
-        // check whether there are complete quantums by taking into account the triggering delay
-        size_t n_completed = 0;
-        for (size_t i=0; i<acc_results.size(); i++) {
-            uint64_t final_ts = ((key_d.last_quantum+i+1) * quantum)-1;
-            if (final_ts + triggering_delay < ts) {
-                n_completed++;
-                processWindows(key_d, acc_results[i]);
-                key_d.last_quantum++;
+            rich_winComb_func(acc, r, tmp, context);
+        }
+        acc = tmp;
+    }
+
+    // send the early results of the next window of the keys updated after their last early result (the windows stay open)
+    void emitEarlyResults()
+    {
+        for (auto &k: keyMap) {
+            auto key = k.first;
+            auto &key_d = k.second;
+            if (key_d.rcv_counter == key_d.early_counter) {
+                continue;
+            }
+            size_t hashcode = std::hash<key_t>()(key); // compute the hashcode of the key
+            uint64_t first_gwid_key = ((config.id_inner - (hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.n_outer + (config.id_outer - (hashcode % config.n_outer) + config.n_outer) % config.n_outer;
+            uint64_t gwid = first_gwid_key + (key_d.next_lwid * config.n_outer * config.n_inner);
+            // partial query: the content of the FlatFAT followed by the pending tuples/quanta
+            result_t *out;
+            bool valid = !(key_d.fat).is_Empty();
+            if (valid) {
+                out = (key_d.fat).getResult();
             }
             else {
-                break;
+                out = new result_t();
+                out->setControlFields(key, 0, 0);
+            }
+            for (auto &r: key_d.pending_tuples) {
+                if (!valid) {
+                    *out = r;
+                    valid = true;
+                }
+                else {
+                    combineInto(key, *out, r);
+                }
+            }
+            // with time-based windows, the open quanta (received within the triggering delay) belonging to the window are also combined
+            if (winType == win_type_t::TB && (key_d.ring).getUsedCount() > 0) {
+                uint64_t in_window = key_d.ts_rcv_counter - (key_d.next_lwid * slide_len); // quanta of the window already closed
+                uint64_t missing = (win_len > in_window) ? win_len - in_window : 0;
+                for (uint64_t i=0; i<missing && i<max_ring_size; i++) {
+                    const result_t *r = (key_d.ring).peek(i);
+                    if (r == nullptr) {
+                        continue;
+                    }
+                    if (!valid) {
+                        *out = *r;
+                        valid = true;
+                    }
+                    else {
+                        combineInto(key, *out, *r);
+                    }
+                }
+            }
+            key_d.early_counter = key_d.rcv_counter;
+            if (!valid) {
+                delete out;
+                continue;
+            }
+            out->setControlFields(key, gwid, std::get<2>(out->getControlFields()));
+            markResult(*out, true);
+            this->ff_send_out(out);
+#if defined (TRACE_WINDFLOW)
+            stats_record.outputs_sent++;
+            stats_record.bytes_sent += sizeof(result_t);
+#endif
+        }
+    }
+
+    // close the quanta of all the keys completed by the watermark (with time-based windows) and forward it
+    void processWatermark(uint64_t _wm)
+    {
+        if (winType == win_type_t::TB) {
+            for (auto &k: keyMap) {
+                closeQuanta(k.first, k.second, _wm / quantum);
+            }
+        }
+        this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(_wm)));
+    }
+
+    // close all the open quanta of a key with identifier lower than up_to
+    void closeQuanta(key_t key, Key_Descriptor &key_d, uint64_t up_to)
+    {
+        (key_d.ring).close(up_to,
+                           [&](result_t &r) { key_d.empty_run = 0; processWindows(key_d, r); },
+                           [&](uint64_t first, uint64_t count) { processEmptyQuanta(key, key_d, first, count); });
+    }
+
+    // process a sequence of consecutive empty quanta of a key starting from the quantum first (for time-based logic)
+    void processEmptyQuanta(key_t key, Key_Descriptor &key_d, uint64_t first, uint64_t count)
+    {
+        size_t hashcode = std::hash<key_t>()(key); // compute the hashcode of the key
+        // gwid of the first window of that key assigned to this Win_SeqFFAT node
+        uint64_t first_gwid_key = ((config.id_inner - (hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.n_outer + (config.id_outer - (hashcode % config.n_outer) + config.n_outer) % config.n_outer;
+        while (count > 0) {
+            // windows made of empty quanta only are emitted without updating the FlatFAT (the last
+            // win_len quanta are always processed normally to leave the FlatFAT in the right state)
+            bool skip = key_d.has_empty_result && (key_d.slide_counter == 0) && (key_d.ts_rcv_counter >= win_len) && (key_d.empty_run + slide_len >= win_len) && (count >= win_len + slide_len);
+            if (skip) {
+                uint64_t n_windows = (count - win_len) / slide_len;
+                for (uint64_t i=0; i<n_windows; i++) {
+                    first += slide_len;
+                    uint64_t lwid = key_d.next_lwid;
+                    uint64_t gwid = first_gwid_key + (lwid * config.n_outer * config.n_inner);
+                    key_d.next_lwid++;
+                    result_t *out = new result_t(key_d.empty_result);
+                    out->setControlFields(key, gwid, (first * quantum)-1);
+                    if (early_interval > 0) {
+                        markResult(*out, false);
+                    }
+                    this->ff_send_out(out);
+#if defined (TRACE_WINDFLOW)
+                    stats_record.outputs_sent++;
+                    stats_record.bytes_sent += sizeof(result_t);
+#endif
+                }
+                key_d.ts_rcv_counter += n_windows * slide_len;
+                key_d.empty_run += n_windows * slide_len;
+                count -= n_windows * slide_len;
+#if defined (TRACE_WINDFLOW)
+                stats_record.quanta_skipped += n_windows * slide_len;
+#endif
+            }
+            else {
+                result_t r;
+                r.setControlFields(key, first, ((first+1) * quantum)-1);
+                key_d.empty_run++;
+                processWindows(key_d, r);
+                first++;
+                count--;
             }
         }
-        // remove the accumulated results of all the complete quantums
-        acc_results.erase(acc_results.begin(), acc_results.begin() + n_completed);
-        // delete the input
-        delete t;
     }
 
     // process a window (for time-based logic)
     void processWindows(Key_Descriptor &key_d, result_t &r)
     {
         auto key = std::get<0>(r.getControlFields()); // key
-        uint64_t id = std::get<1>(r.getControlFields()); // identifier
         size_t hashcode = std::hash<decltype(key)>()(key); // compute the hashcode of the key
         // gwid of the first window of that key assigned to this Win_SeqFFAT node
         uint64_t first_gwid_key = ((config.id_inner - (hashcode % config.n_inner) + config.n_inner) % config.n_inner) * config.n_outer + (config.id_outer - (hashcode % config.n_outer) + config.n_outer) % config.n_outer;
@@ -557,8 +866,16 @@ public:
             out = (key_d.fat).getResult();
             // purge the tuples in the last slide from FlatFAT
             (key_d.fat).remove(slide_len);
+            // cache the result of the first window made of empty quanta only
+            if (!key_d.has_empty_result && key_d.empty_run >= win_len) {
+                key_d.empty_result = *out;
+                key_d.has_empty_result = true;
+            }
             // send the window result
             out->setControlFields(std::get<0>(out->getControlFields()), gwid, std::get<2>(out->getControlFields()));
+            if (early_interval > 0) {
+                markResult(*out, false);
+            }
             this->ff_send_out(out);
 #if defined (TRACE_WINDFLOW)
             stats_record.outputs_sent++;
@@ -571,10 +888,22 @@ public:
     void eosnotify(ssize_t id) override
     {
         eos_received++;
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            if (!keyGroups.deferWatermark(wm_merger.get())) {
+                processWatermark(wm_merger.get());
+            }
+        }
         // check the number of received EOS messages
         if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
             return;
         }
+        // wait for the key groups still migrating to the replica
+        if (keyGroups.isEnabled()) {
+            keyGroups.drain();
+        }
+        // last check of the timers of the replica
+        context.pollTimers();
         // two separate logics depending on the window type
         if (winType == win_type_t::CB) {
             eosnotifyCBWindows(id);
@@ -613,6 +942,9 @@ public:
                 fat.remove(slide_len);
                 // send the window result
                 out->setControlFields(std::get<0>(out->getControlFields()), gwid, std::get<2>(out->getControlFields()));
+                if (early_interval > 0) {
+                    markResult(*out, false);
+                }
                 this->ff_send_out(out);
 #if defined (TRACE_WINDFLOW)
                 stats_record.outputs_sent++;
@@ -631,11 +963,9 @@ public:
             size_t hashcode = std::hash<decltype(key)>()(key); // compute the hashcode of the key
             auto &key_d = k.second;
             auto &fat = key_d.fat;
-            auto &acc_results = key_d.acc_results;
-            // add all the accumulated results
-            for (size_t i=0; i<acc_results.size(); i++) {
-               processWindows(key_d, acc_results[i]);
-               key_d.last_quantum++;
+            // close all the quanta still open
+            if (key_d.rcv_counter > 0) {
+                closeQuanta(key, key_d, (key_d.ring).getLast() + 1);
             }
             // add all the pending tuples to the FlatFAT
             fat.insert(key_d.pending_tuples);
@@ -652,6 +982,9 @@ public:
                 fat.remove(slide_len);
                 // send the window result
                 out->setControlFields(std::get<0>(out->getControlFields()), gwid, std::get<2>(out->getControlFields()));
+                if (early_interval > 0) {
+                    markResult(*out, false);
+                }
                 this->ff_send_out(out);
 #if defined (TRACE_WINDFLOW)
                 stats_record.outputs_sent++;
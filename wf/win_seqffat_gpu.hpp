@@ -51,6 +51,7 @@
 #include<meta.hpp>
 #include<meta_gpu.hpp>
 #include<flatfat_gpu.hpp>
+#include<watermark.hpp>
 #if defined (TRACE_WINDFLOW)
     #include<stats_record.hpp>
 #endif
@@ -153,6 +154,7 @@ private:
     size_t ignored_tuples; // number of ignored tuples
     size_t eos_received; // number of received EOS messages
     bool terminated; // true if the replica has finished its work
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
     bool isRenumbering; // if true, the node assigns increasing identifiers to the input tuples (useful for count-based windows in DEFAULT mode)
     // GPU variables
     int gpu_id; // identifier of the chosen GPU device
@@ -308,6 +310,13 @@ public:
     // svc method (utilized by the FastFlow runtime)
     result_t *svc(tuple_t *t) override
     {
+        // watermarks are only forwarded (windows are fired in batches by the tuples)
+        if (isWatermark(t)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(t))) {
+                this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(wm_merger.get())));
+            }
+            return this->GO_ON;
+        }
 #if defined (TRACE_WINDFLOW)
         startTS = current_time_nsecs();
         if (stats_record.inputs_received == 0) {
@@ -552,6 +561,10 @@ public:
     void eosnotify(ssize_t id) override
     {
         eos_received++;
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(wm_merger.get())));
+        }
         // check the number of received EOS messages
         if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
             return;
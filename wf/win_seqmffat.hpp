@@ -0,0 +1,617 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    win_seqmffat.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    20/10/2020
+ *  
+ *  @brief Win_SeqMFFAT node executing associative windowed queries with several
+ *         window specifications on a multi-core CPU with the FlatFAT algorithm
+ *  
+ *  @section Win_SeqMFFAT (Description)
+ *  
+ *  This file implements the Win_SeqMFFAT node able to execute the same associative
+ *  windowed query with a list of time-based window specifications (length and slide).
+ *  The stream is sliced once in quanta whose size is the gcd of all the window lengths
+ *  and slides. Each tuple is lifted and combined only once into its quantum, and the
+ *  result of each closed quantum is shared by the FlatFAT structures of all the window
+ *  specifications.
+ *  
+ *  The identifier of each result is wid * n + i, where wid is the identifier of the
+ *  window in its specification, n is the number of specifications and i is the index
+ *  of the specification (in the order used to define them).
+ *  
+ *  Each window specification coalesces the long sequences of empty quanta of a key
+ *  (e.g., a gap of the key or a jump of the watermark) as the Win_SeqFFAT node does,
+ *  so the windows made of empty quanta only do not update its FlatFAT.
+ *  
+ *  The template parameters tuple_t and result_t must be default constructible, with
+ *  a copy Constructor and a copy assignment operator, and they must provide and implement
+ *  the setControlFields() and getControlFields() methods.
+ */ 
+
+#ifndef WIN_SEQMFFAT_H
+#define WIN_SEQMFFAT_H
+
+// includes
+#include<vector>
+#include<string>
+#include<utility>
+#include<unordered_map>
+#include<math.h>
+#include<ff/node.hpp>
+#include<ff/multinode.hpp>
+#include<basic.hpp>
+#include<meta.hpp>
+#include<flatfat.hpp>
+#include<quanta_ring.hpp>
+#include<watermark.hpp>
+#include<placement.hpp>
+#if defined (TRACE_WINDFLOW)
+    #include<stats_record.hpp>
+#endif
+
+namespace wf {
+
+// Win_SeqMFFAT class
+template<typename tuple_t, typename result_t>
+class Win_SeqMFFAT: public ff::ff_minode_t<tuple_t, result_t>
+{
+public:
+    // type of the lift function
+    using winLift_func_t = std::function<void(const tuple_t &, result_t &)>;
+    // type of the rich lift function
+    using rich_winLift_func_t = std::function<void(const tuple_t &, result_t &, RuntimeContext &)>;
+    // type of the combine function
+    using winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
+    // type of the rich combine function
+    using rich_winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &, RuntimeContext &)>;
+    // type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext &)>;
+
+private:
+    // type of the FlatFAT
+    using fat_t = FlatFAT<tuple_t, result_t>;
+    tuple_t tmp; // never used
+    // key data type
+    using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
+    // friendships with other classes in the library
+    template<typename T1, typename T2>
+    friend class Key_MFFAT;
+    // struct of the state of a window specification within a key
+    struct Spec_Descriptor
+    {
+        fat_t fat; // FlatFAT of this window specification
+        std::vector<result_t> pending_tuples; // vector of pending quanta of this window specification
+        uint64_t ts_rcv_counter; // number of quanta received by this window specification
+        uint64_t slide_counter; // counter of the quanta in the last slide
+        uint64_t next_lwid; // next window to be opened of this window specification
+        uint64_t empty_run; // number of consecutive empty quanta processed so far by this window specification
+        bool has_empty_result; // true if empty_result is valid
+        result_t empty_result; // cached result of a window of this specification made of empty quanta only
+
+        // Constructor I
+        Spec_Descriptor(winComb_func_t *_winComb_func,
+                        size_t _win_len,
+                        key_t _key,
+                        RuntimeContext *_context):
+                        fat(_winComb_func, false /* not commutative by default */, _win_len, _key, _context),
+                        ts_rcv_counter(0),
+                        slide_counter(0),
+                        next_lwid(0),
+                        empty_run(0),
+                        has_empty_result(false) {}
+
+        // Constructor II
+        Spec_Descriptor(rich_winComb_func_t *_rich_winComb_func,
+                        size_t _win_len,
+                        key_t _key,
+                        RuntimeContext *_context):
+                        fat(_rich_winComb_func, false /* not commutative by default */, _win_len, _key, _context),
+                        ts_rcv_counter(0),
+                        slide_counter(0),
+                        next_lwid(0),
+                        empty_run(0),
+                        has_empty_result(false) {}
+    };
+    // struct of a key descriptor
+    struct Key_Descriptor
+    {
+        std::vector<Spec_Descriptor> specs; // states of the window specifications of this key
+        Quanta_Ring<result_t> ring; // ring of the open quanta
+        uint64_t rcv_counter; // number of tuples received of this key
+
+        // Constructor
+        Key_Descriptor():
+                       rcv_counter(0) {}
+    };
+    winLift_func_t winLift_func; // lift function
+    winComb_func_t winComb_func; // combine function
+    rich_winLift_func_t rich_winLift_func; // rich lift function
+    rich_winComb_func_t rich_winComb_func; // rich combine function
+    closing_func_t closing_func; // closing function
+    uint64_t quantum; // quantum value (gcd of all the window lengths and slides)
+    std::vector<std::pair<uint64_t, uint64_t>> specs; // window specifications (length and slide in no. of quanta)
+    uint64_t triggering_delay; // triggering delay in time units
+    size_t max_ring_size; // maximum number of open quanta per key
+    std::string name; // string of the unique name of the node
+    bool isRichLift; // flag stating whether the lift function is riched
+    bool isRichCombine; // flag stating whether the combine function is riched
+    RuntimeContext context; // RuntimeContext
+    std::unordered_map<key_t, Key_Descriptor> keyMap; // hash table that maps a descriptor for each key
+    size_t ignored_tuples; // number of ignored tuples
+    size_t eos_received; // number of received EOS messages
+    bool terminated; // true if the replica has finished its work
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+    Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the operator is not placed by the PipeGraph)
+#if defined (TRACE_WINDFLOW)
+    Stats_Record stats_record;
+    double avg_td_us = 0;
+    double avg_ts_us = 0;
+    volatile uint64_t startTD, startTS, endTD, endTS;
+#endif
+
+    // function to compute the gcd (std::gcd is available only in C++17)
+    uint64_t gcd(uint64_t u, uint64_t v) {
+        while (v != 0) {
+            unsigned long r = u % v;
+            u = v;
+            v = r;
+        }
+        return u;
+    };
+
+    // private initialization method
+    void init()
+    {
+        // check the validity of the window specifications
+        if (specs.size() == 0) {
+            std::cerr << RED << "WindFlow Error: Win_SeqMFFAT needs at least one window specification" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        quantum = 0;
+        for (auto &s: specs) {
+            if (s.first == 0 || s.second == 0) {
+                std::cerr << RED << "WindFlow Error: window length or slide cannot be zero" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            if (s.second >= s.first) {
+                std::cerr << RED << "WindFlow Error: Win_SeqMFFAT can be used with sliding windows only (s<w)" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            quantum = gcd(quantum, gcd(s.first, s.second));
+        }
+        // translate the window specifications in no. of quanta
+        for (auto &s: specs) {
+            s.first = s.first / quantum;
+            s.second = s.second / quantum;
+        }
+        // open quanta of a key never span more than the triggering delay plus two quanta
+        max_ring_size = (triggering_delay / quantum) + 2;
+    }
+
+    // method to create the descriptor of a new key
+    Key_Descriptor &createKey(key_t key)
+    {
+        Key_Descriptor &key_d = keyMap[key];
+        (key_d.specs).reserve(specs.size());
+        for (auto &s: specs) {
+            if (!isRichCombine) {
+                (key_d.specs).push_back(Spec_Descriptor(&winComb_func, s.first, key, &context));
+            }
+            else {
+                (key_d.specs).push_back(Spec_Descriptor(&rich_winComb_func, s.first, key, &context));
+            }
+        }
+        (key_d.ring).start(0, max_ring_size);
+        return key_d;
+    }
+
+    // method to set the CPU and NUMA node of the replica
+    void setPlacement(Placement_Replica _placement)
+    {
+        placement = _placement;
+    }
+
+public:
+    // Constructor I
+    Win_SeqMFFAT(winLift_func_t _winLift_func,
+                 winComb_func_t _winComb_func,
+                 std::vector<std::pair<uint64_t, uint64_t>> _specs,
+                 uint64_t _triggering_delay,
+                 std::string _name,
+                 closing_func_t _closing_func,
+                 RuntimeContext _context):
+                 winLift_func(_winLift_func),
+                 winComb_func(_winComb_func),
+                 closing_func(_closing_func),
+                 specs(_specs),
+                 triggering_delay(_triggering_delay),
+                 name(_name),
+                 isRichLift(false),
+                 isRichCombine(false),
+                 context(_context),
+                 ignored_tuples(0),
+                 eos_received(0),
+                 terminated(false)
+    {
+        init();
+    }
+
+    // Constructor II
+    Win_SeqMFFAT(rich_winLift_func_t _rich_winLift_func,
+                 winComb_func_t _winComb_func,
+                 std::vector<std::pair<uint64_t, uint64_t>> _specs,
+                 uint64_t _triggering_delay,
+                 std::string _name,
+                 closing_func_t _closing_func,
+                 RuntimeContext _context):
+                 winComb_func(_winComb_func),
+                 rich_winLift_func(_rich_winLift_func),
+                 closing_func(_closing_func),
+                 specs(_specs),
+                 triggering_delay(_triggering_delay),
+                 name(_name),
+                 isRichLift(true),
+                 isRichCombine(false),
+                 context(_context),
+                 ignored_tuples(0),
+                 eos_received(0),
+                 terminated(false)
+    {
+        init();
+    }
+
+    // Constructor III
+    Win_SeqMFFAT(winLift_func_t _winLift_func,
+                 rich_winComb_func_t _rich_winComb_func,
+                 std::vector<std::pair<uint64_t, uint64_t>> _specs,
+                 uint64_t _triggering_delay,
+                 std::string _name,
+                 closing_func_t _closing_func,
+                 RuntimeContext _context):
+                 winLift_func(_winLift_func),
+                 rich_winComb_func(_rich_winComb_func),
+                 closing_func(_closing_func),
+                 specs(_specs),
+                 triggering_delay(_triggering_delay),
+                 name(_name),
+                 isRichLift(false),
+                 isRichCombine(true),
+                 context(_context),
+                 ignored_tuples(0),
+                 eos_received(0),
+                 terminated(false)
+    {
+        init();
+    }
+
+    // Constructor IV
+    Win_SeqMFFAT(rich_winLift_func_t _rich_winLift_func,
+                 rich_winComb_func_t _rich_winComb_func,
+                 std::vector<std::pair<uint64_t, uint64_t>> _specs,
+                 uint64_t _triggering_delay,
+                 std::string _name,
+                 closing_func_t _closing_func,
+                 RuntimeContext _context):
+                 rich_winLift_func(_rich_winLift_func),
+                 rich_winComb_func(_rich_winComb_func),
+                 closing_func(_closing_func),
+                 specs(_specs),
+                 triggering_delay(_triggering_delay),
+                 name(_name),
+                 isRichLift(true),
+                 isRichCombine(true),
+                 context(_context),
+                 ignored_tuples(0),
+                 eos_received(0),
+                 terminated(false)
+    {
+        init();
+    }
+
+    // svc_init method (utilized by the FastFlow runtime)
+    int svc_init() override
+    {
+        // bind the replica to its CPU before it allocates its state
+        placement.bind();
+#if defined (TRACE_WINDFLOW)
+        stats_record = Stats_Record(name, std::to_string(this->get_my_id()), true, false);
+        stats_record.cpu = placement.getCPU();
+        stats_record.numa_node = placement.getNode();
+        stats_record.ring_max_size = max_ring_size;
+#endif
+        return 0;
+    }
+
+    // svc method (utilized by the FastFlow runtime)
+    result_t *svc(tuple_t *t) override
+    {
+        // execute the callbacks of the expired timers of the replica
+        context.pollTimers();
+        // watermarks close the quanta completed by them and are forwarded
+        if (isWatermark(t)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(t))) {
+                processWatermark(wm_merger.get());
+            }
+            return this->GO_ON;
+        }
+#if defined (TRACE_WINDFLOW)
+        startTS = current_time_nsecs();
+        if (stats_record.inputs_received == 0) {
+            startTD = current_time_nsecs();
+        }
+        stats_record.inputs_received++;
+        stats_record.bytes_received += sizeof(tuple_t);
+#endif
+        // extract the key and timestamp fields from the input tuple
+        auto key = std::get<0>(t->getControlFields()); // key
+        uint64_t ts = std::get<2>(t->getControlFields()); // timestamp
+        // access the descriptor of the input key
+        auto it = keyMap.find(key);
+        Key_Descriptor &key_d = (it == keyMap.end()) ? createKey(key) : (*it).second;
+        // compute the identifier of the quantum containing the input tuple
+        uint64_t quantum_id = ts / quantum;
+        // check if the tuple must be ignored (its quantum has already been closed)
+        if ((key_d.ring).isClosed(quantum_id)) {
+#if defined (TRACE_WINDFLOW)
+            stats_record.inputs_ignored++;
+#endif
+            ignored_tuples++;
+            delete t;
+            return this->GO_ON;
+        }
+        key_d.rcv_counter++;
+        // close the quanta that are complete by taking into account the triggering delay
+        uint64_t first_open = (ts >= triggering_delay) ? (ts - triggering_delay) / quantum : 0;
+        closeQuanta(key, key_d, first_open);
+        // convert the input tuple to a result with the lift function (once for all the specifications)
+        result_t tmp;
+        tmp.setControlFields(key, 0, ts);
+        if (!isRichLift) {
+            winLift_func(*t, tmp);
+        }
+        else {
+            rich_winLift_func(*t, tmp, context);
+        }
+        // find the slot of the quantum in the ring (late tuples are merged in place)
+        bool opened;
+        result_t &slot = (key_d.ring).getSlot(quantum_id, opened);
+        if (opened) {
+            slot = result_t();
+            slot.setControlFields(key, quantum_id, ((quantum_id+1) * quantum)-1);
+        }
+        result_t tmp2;
+        tmp2.setControlFields(key, 0, std::max(std::get<2>(slot.getControlFields()), std::get<2>((tmp).getControlFields())));
+        if (!isRichCombine) {
+            winComb_func(slot, tmp, tmp2);
+        }
+        else {
+            rich_winComb_func(slot, tmp, tmp2, context);
+        }
+        slot = tmp2;
+        // delete the input
+        delete t;
+#if defined (TRACE_WINDFLOW)
+        endTS = current_time_nsecs();
+        endTD = current_time_nsecs();
+        double elapsedTS_us = ((double) (endTS - startTS)) / 1000;
+        avg_ts_us += (1.0 / stats_record.inputs_received) * (elapsedTS_us - avg_ts_us);
+        double elapsedTD_us = ((double) (endTD - startTD)) / 1000;
+        avg_td_us += (1.0 / stats_record.inputs_received) * (elapsedTD_us - avg_td_us);
+        stats_record.service_time = std::chrono::duration<double, std::micro>(avg_ts_us);
+        stats_record.eff_service_time = std::chrono::duration<double, std::micro>(avg_td_us);
+        startTD = current_time_nsecs();
+#endif
+        return this->GO_ON;
+    }
+
+    // close all the open quanta of a key with identifier lower than up_to
+    void closeQuanta(key_t key, Key_Descriptor &key_d, uint64_t up_to)
+    {
+        (key_d.ring).close(up_to,
+                           [&](result_t &r) { processQuantum(key_d, r); },
+                           [&](uint64_t first, uint64_t count) { processEmptyQuanta(key, key_d, first, count); });
+    }
+
+    // add the result of a closed quantum to all the window specifications of its key
+    void processQuantum(Key_Descriptor &key_d, const result_t &r)
+    {
+        for (size_t i=0; i<specs.size(); i++) {
+            (key_d.specs[i]).empty_run = 0;
+            processSpec(key_d.specs[i], i, r);
+        }
+    }
+
+    // process a sequence of consecutive empty quanta of a key starting from the quantum first
+    void processEmptyQuanta(key_t key, Key_Descriptor &key_d, uint64_t first, uint64_t count)
+    {
+        // each window specification coalesces the sequence independently of the others
+        for (size_t i=0; i<specs.size(); i++) {
+            Spec_Descriptor &spec_d = key_d.specs[i];
+            uint64_t win_len = specs[i].first;
+            uint64_t slide_len = specs[i].second;
+            uint64_t id = first;
+            uint64_t n = count;
+            while (n > 0) {
+                // windows made of empty quanta only are emitted without updating the FlatFAT (the last
+                // win_len quanta are always processed normally to leave the FlatFAT in the right state)
+                bool skip = spec_d.has_empty_result && (spec_d.slide_counter == 0) && (spec_d.ts_rcv_counter >= win_len) && (spec_d.empty_run + slide_len >= win_len) && (n >= win_len + slide_len);
+                if (skip) {
+                    uint64_t n_windows = (n - win_len) / slide_len;
+                    for (uint64_t w=0; w<n_windows; w++) {
+                        id += slide_len;
+                        result_t *out = new result_t(spec_d.empty_result);
+                        out->setControlFields(key, 0, (id * quantum)-1);
+                        sendResult(out, spec_d, i);
+                    }
+                    spec_d.ts_rcv_counter += n_windows * slide_len;
+                    spec_d.empty_run += n_windows * slide_len;
+                    n -= n_windows * slide_len;
+#if defined (TRACE_WINDFLOW)
+                    stats_record.quanta_skipped += n_windows * slide_len;
+#endif
+                }
+                else {
+                    result_t r;
+                    r.setControlFields(key, id, ((id+1) * quantum)-1);
+                    spec_d.empty_run++;
+                    processSpec(spec_d, i, r);
+                    id++;
+                    n--;
+                }
+            }
+        }
+    }
+
+    // add the result of a closed quantum to a window specification
+    void processSpec(Spec_Descriptor &spec_d, size_t spec_idx, const result_t &r)
+    {
+        uint64_t win_len = specs[spec_idx].first;
+        uint64_t slide_len = specs[spec_idx].second;
+        (spec_d.pending_tuples).push_back(r);
+        spec_d.ts_rcv_counter++;
+        spec_d.slide_counter++;
+        // check whether the current window of the specification has been fired
+        if ((spec_d.ts_rcv_counter == win_len) || ((spec_d.ts_rcv_counter > win_len) && (spec_d.slide_counter % slide_len == 0))) {
+            spec_d.slide_counter = 0;
+            // add all the pending quanta to the FlatFAT
+            (spec_d.fat).insert(spec_d.pending_tuples);
+            // clear the vector of pending quanta
+            (spec_d.pending_tuples).clear();
+            // get the result of the fired window
+            result_t *out = (spec_d.fat).getResult();
+            // purge the quanta in the last slide from FlatFAT
+            (spec_d.fat).remove(slide_len);
+            // cache the result of the first window made of empty quanta only
+            if (!spec_d.has_empty_result && spec_d.empty_run >= win_len) {
+                spec_d.empty_result = *out;
+                spec_d.has_empty_result = true;
+            }
+            sendResult(out, spec_d, spec_idx);
+        }
+    }
+
+    // send a window result tagged with the index of its window specification
+    void sendResult(result_t *out, Spec_Descriptor &spec_d, size_t spec_idx)
+    {
+        uint64_t id = (spec_d.next_lwid * specs.size()) + spec_idx;
+        spec_d.next_lwid++;
+        out->setControlFields(std::get<0>(out->getControlFields()), id, std::get<2>(out->getControlFields()));
+        this->ff_send_out(out);
+#if defined (TRACE_WINDFLOW)
+        stats_record.outputs_sent++;
+        stats_record.bytes_sent += sizeof(result_t);
+#endif
+    }
+
+    // close the quanta of all the keys completed by the watermark and forward it
+    void processWatermark(uint64_t _wm)
+    {
+        for (auto &k: keyMap) {
+            closeQuanta(k.first, k.second, _wm / quantum);
+        }
+        this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(_wm)));
+    }
+
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        eos_received++;
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            processWatermark(wm_merger.get());
+        }
+        // check the number of received EOS messages
+        if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
+            return;
+        }
+        // last check of the timers of the replica
+        context.pollTimers();
+        // iterate over all the keys
+        for (auto &k: keyMap) {
+            auto key = k.first;
+            auto &key_d = k.second;
+            // close all the quanta still open
+            if (key_d.rcv_counter > 0) {
+                closeQuanta(key, key_d, (key_d.ring).getLast() + 1);
+            }
+            // emit the partial windows of all the window specifications
+            for (size_t i=0; i<specs.size(); i++) {
+                Spec_Descriptor &spec_d = key_d.specs[i];
+                auto &fat = spec_d.fat;
+                // add all the pending quanta to the FlatFAT
+                fat.insert(spec_d.pending_tuples);
+                // loop until the FlatFAT is empty
+                while (!fat.is_Empty()) {
+                    // get the result of the partial window
+                    result_t *out = fat.getResult();
+                    // purge the quanta from Flat FAT
+                    fat.remove(specs[i].second);
+                    sendResult(out, spec_d, i);
+                }
+            }
+        }
+        terminated = true;
+#if defined (TRACE_WINDFLOW)
+        stats_record.set_Terminated();
+#endif
+    }
+
+    // svc_end method (utilized by the FastFlow runtime)
+    void svc_end() override
+    {
+        // call the closing function
+        closing_func(context);
+    }
+
+    // method to return the number of ignored tuples by this node
+    size_t getNumIgnoredTuples() const
+    {
+        return ignored_tuples;
+    }
+
+    // method the check the termination of the replica
+    bool isTerminated() const
+    {
+        return terminated;
+    }
+
+#if defined (TRACE_WINDFLOW)
+    // method to return a copy of the Stats_Record of this node
+    Stats_Record get_StatsRecord() const
+    {
+        return stats_record;
+    }
+#endif
+
+    // method to start the node execution asynchronously
+    int run(bool) override
+    {
+        return ff::ff_minode::run();
+    }
+
+    // method to wait the node termination
+    int wait() override
+    {
+        return ff::ff_minode::wait();
+    }
+};
+
+} // namespace wf
+
+#endif
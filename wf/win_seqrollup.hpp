@@ -0,0 +1,435 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    win_seqrollup.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    21/10/2020
+ *  
+ *  @brief Win_SeqRollup node executing a chain of rollup windows on a multi-core CPU
+ *  
+ *  @section Win_SeqRollup (Description)
+ *  
+ *  This file implements the Win_SeqRollup node able to execute a chain of time-based
+ *  tumbling windows (e.g., per-second, per-minute and per-hour results) on a CPU core.
+ *  The first level lifts and combines the input tuples. Each other level combines the
+ *  results of the previous level in-process with its own combine function, so neither
+ *  the input tuples nor the intermediate results are archived or re-keyed.
+ *  
+ *  The length of each level must be a multiple of the length of the previous one.
+ *  The identifier of each result is wid * n + l, where wid is the index of the window
+ *  in its level (its starting time divided by the level length), n is the number of
+ *  levels and l is the index of the level.
+ *  
+ *  The template parameters tuple_t and result_t must be default constructible, with
+ *  a copy Constructor and a copy assignment operator, and they must provide and implement
+ *  the setControlFields() and getControlFields() methods.
+ */ 
+
+#ifndef WIN_SEQROLLUP_H
+#define WIN_SEQROLLUP_H
+
+// includes
+#include<vector>
+#include<string>
+#include<utility>
+#include<functional>
+#include<unordered_map>
+#include<ff/node.hpp>
+#include<ff/multinode.hpp>
+#include<basic.hpp>
+#include<context.hpp>
+#include<quanta_ring.hpp>
+#include<watermark.hpp>
+#include<placement.hpp>
+#if defined (TRACE_WINDFLOW)
+    #include<stats_record.hpp>
+#endif
+
+namespace wf {
+
+// Win_SeqRollup class
+template<typename tuple_t, typename result_t>
+class Win_SeqRollup: public ff::ff_minode_t<tuple_t, result_t>
+{
+public:
+    // type of the lift function
+    using winLift_func_t = std::function<void(const tuple_t &, result_t &)>;
+    // type of the rich lift function
+    using rich_winLift_func_t = std::function<void(const tuple_t &, result_t &, RuntimeContext &)>;
+    // type of the combine function
+    using winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
+    // type of the rich combine function
+    using rich_winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &, RuntimeContext &)>;
+    // type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext &)>;
+
+private:
+    tuple_t tmp; // never used
+    // key data type
+    using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
+    // friendships with other classes in the library
+    template<typename T1, typename T2>
+    friend class Key_Rollup;
+    // struct of a level of the rollup chain
+    struct Level
+    {
+        uint64_t win_len; // window length of the level (in time units)
+        uint64_t ratio; // number of windows of the previous level composing a window of this level
+        rich_winComb_func_t comb_func; // combine function of the level
+    };
+    // struct of the state of a level within a key
+    struct Level_Descriptor
+    {
+        result_t acc; // partial result of the open window of the level
+        uint64_t count; // number of results of the previous level combined in acc
+        uint64_t next_wid; // index of the open window of the level
+
+        // Constructor
+        Level_Descriptor(): count(0), next_wid(0) {}
+    };
+    // struct of a key descriptor
+    struct Key_Descriptor
+    {
+        std::vector<Level_Descriptor> levels; // states of the levels (the first level uses the ring)
+        Quanta_Ring<result_t> ring; // ring of the open windows of the first level
+        uint64_t rcv_counter; // number of tuples received of this key
+
+        // Constructor
+        Key_Descriptor(size_t _n_levels):
+                       levels(_n_levels),
+                       rcv_counter(0) {}
+    };
+    rich_winLift_func_t lift_func; // lift function
+    std::vector<Level> levels; // levels of the rollup chain
+    uint64_t triggering_delay; // triggering delay in time units
+    size_t max_ring_size; // maximum number of open windows of the first level per key
+    closing_func_t closing_func; // closing function
+    std::string name; // string of the unique name of the node
+    RuntimeContext context; // RuntimeContext
+    std::unordered_map<key_t, Key_Descriptor> keyMap; // hash table that maps a descriptor for each key
+    size_t ignored_tuples; // number of ignored tuples
+    size_t eos_received; // number of received EOS messages
+    bool terminated; // true if the replica has finished its work
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+    Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the operator is not placed by the PipeGraph)
+#if defined (TRACE_WINDFLOW)
+    Stats_Record stats_record;
+    double avg_td_us = 0;
+    double avg_ts_us = 0;
+    volatile uint64_t startTD, startTS, endTD, endTS;
+#endif
+
+    // convert a lift function into a rich lift function
+    static rich_winLift_func_t toRichLift(winLift_func_t _f)
+    {
+        return [_f](const tuple_t &t, result_t &r, RuntimeContext &) { _f(t, r); };
+    }
+
+    // convert a rich lift function (nothing to do)
+    static rich_winLift_func_t toRichLift(rich_winLift_func_t _f)
+    {
+        return _f;
+    }
+
+    // method to set the CPU and NUMA node of the replica
+    void setPlacement(Placement_Replica _placement)
+    {
+        placement = _placement;
+    }
+
+public:
+    // convert a combine function into a rich combine function
+    static rich_winComb_func_t toRichComb(winComb_func_t _f)
+    {
+        return [_f](const result_t &r1, const result_t &r2, result_t &out, RuntimeContext &) { _f(r1, r2, out); };
+    }
+
+    // convert a rich combine function (nothing to do)
+    static rich_winComb_func_t toRichComb(rich_winComb_func_t _f)
+    {
+        return _f;
+    }
+
+    // Constructor
+    template<typename lift_F_t, typename comb_F_t>
+    Win_SeqRollup(lift_F_t _lift_func,
+                  comb_F_t _comb_func,
+                  uint64_t _win_len,
+                  std::vector<std::pair<uint64_t, rich_winComb_func_t>> _upper_levels,
+                  uint64_t _triggering_delay,
+                  std::string _name,
+                  closing_func_t _closing_func,
+                  RuntimeContext _context):
+                  lift_func(toRichLift(_lift_func)),
+                  triggering_delay(_triggering_delay),
+                  closing_func(_closing_func),
+                  name(_name),
+                  context(_context),
+                  ignored_tuples(0),
+                  eos_received(0),
+                  terminated(false)
+    {
+        // check the validity of the levels
+        if (_win_len == 0) {
+            std::cerr << RED << "WindFlow Error: window length of a rollup level cannot be zero" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        levels.push_back(Level{_win_len, 1, toRichComb(_comb_func)});
+        for (auto &l: _upper_levels) {
+            uint64_t prev_len = levels.back().win_len;
+            if (l.first <= prev_len || l.first % prev_len != 0) {
+                std::cerr << RED << "WindFlow Error: the window length of a rollup level must be a multiple of the one of the previous level" << DEFAULT_COLOR << std::endl;
+                exit(EXIT_FAILURE);
+            }
+            levels.push_back(Level{l.first, l.first / prev_len, l.second});
+        }
+        // open windows of the first level never span more than the triggering delay plus two windows
+        max_ring_size = (triggering_delay / _win_len) + 2;
+    }
+
+    // svc_init method (utilized by the FastFlow runtime)
+    int svc_init() override
+    {
+        // bind the replica to its CPU before it allocates its state
+        placement.bind();
+#if defined (TRACE_WINDFLOW)
+        stats_record = Stats_Record(name, std::to_string(this->get_my_id()), true, false);
+        stats_record.cpu = placement.getCPU();
+        stats_record.numa_node = placement.getNode();
+        stats_record.ring_max_size = max_ring_size;
+#endif
+        return 0;
+    }
+
+    // svc method (utilized by the FastFlow runtime)
+    result_t *svc(tuple_t *t) override
+    {
+        // execute the callbacks of the expired timers of the replica
+        context.pollTimers();
+        // watermarks close the windows completed by them and are forwarded
+        if (isWatermark(t)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(t))) {
+                processWatermark(wm_merger.get());
+            }
+            return this->GO_ON;
+        }
+#if defined (TRACE_WINDFLOW)
+        startTS = current_time_nsecs();
+        if (stats_record.inputs_received == 0) {
+            startTD = current_time_nsecs();
+        }
+        stats_record.inputs_received++;
+        stats_record.bytes_received += sizeof(tuple_t);
+#endif
+        // extract the key and timestamp fields from the input tuple
+        auto key = std::get<0>(t->getControlFields()); // key
+        uint64_t ts = std::get<2>(t->getControlFields()); // timestamp
+        uint64_t win_id = ts / levels[0].win_len; // window of the first level containing the tuple
+        // access the descriptor of the input key
+        auto it = keyMap.find(key);
+        if (it == keyMap.end()) {
+            it = keyMap.insert(std::make_pair(key, Key_Descriptor(levels.size()))).first;
+            // the key starts at the beginning of the window of the last level containing the tuple
+            uint64_t top_len = levels.back().win_len;
+            uint64_t start_ts = (ts / top_len) * top_len;
+            Key_Descriptor &key_d = (*it).second;
+            (key_d.ring).start(start_ts / levels[0].win_len, max_ring_size);
+            for (size_t l=0; l<levels.size(); l++) {
+                (key_d.levels[l]).next_wid = start_ts / levels[l].win_len;
+            }
+        }
+        Key_Descriptor &key_d = (*it).second;
+        // check if the tuple must be ignored (its window has already been closed)
+        if ((key_d.ring).isClosed(win_id)) {
+#if defined (TRACE_WINDFLOW)
+            stats_record.inputs_ignored++;
+#endif
+            ignored_tuples++;
+            delete t;
+            return this->GO_ON;
+        }
+        key_d.rcv_counter++;
+        // close the windows of the first level that are complete by taking into account the triggering delay
+        uint64_t first_open = (ts >= triggering_delay) ? (ts - triggering_delay) / levels[0].win_len : 0;
+        closeWindows(key, key_d, first_open);
+        // convert the input tuple to a result with the lift function
+        result_t lifted;
+        lifted.setControlFields(key, 0, ts);
+        lift_func(*t, lifted, context);
+        // find the slot of the window in the ring (late tuples are merged in place)
+        bool opened;
+        result_t &slot = (key_d.ring).getSlot(win_id, opened);
+        if (opened) {
+            slot = lifted;
+        }
+        else {
+            result_t out;
+            out.setControlFields(key, 0, ts);
+            (levels[0].comb_func)(slot, lifted, out, context);
+            slot = out;
+        }
+        // delete the input
+        delete t;
+#if defined (TRACE_WINDFLOW)
+        endTS = current_time_nsecs();
+        endTD = current_time_nsecs();
+        double elapsedTS_us = ((double) (endTS - startTS)) / 1000;
+        avg_ts_us += (1.0 / stats_record.inputs_received) * (elapsedTS_us - avg_ts_us);
+        double elapsedTD_us = ((double) (endTD - startTD)) / 1000;
+        avg_td_us += (1.0 / stats_record.inputs_received) * (elapsedTD_us - avg_td_us);
+        stats_record.service_time = std::chrono::duration<double, std::micro>(avg_ts_us);
+        stats_record.eff_service_time = std::chrono::duration<double, std::micro>(avg_td_us);
+        startTD = current_time_nsecs();
+#endif
+        return this->GO_ON;
+    }
+
+    // close all the open windows of the first level with index lower than up_to
+    void closeWindows(key_t key, Key_Descriptor &key_d, uint64_t up_to)
+    {
+        (key_d.ring).close(up_to,
+                           [&](result_t &r) { emitWindow(key, key_d, 0, r); },
+                           [&](uint64_t, uint64_t count) {
+                               // empty windows are emitted as in the other time-based operators
+                               for (uint64_t i=0; i<count; i++) {
+                                   emitWindow(key, key_d, 0, result_t());
+                               }
+                           });
+    }
+
+    // emit the result of the open window of a level and forward it to the next level
+    void emitWindow(key_t key, Key_Descriptor &key_d, size_t level, result_t res)
+    {
+        Level_Descriptor &level_d = key_d.levels[level];
+        uint64_t wid = level_d.next_wid++;
+        level_d.count = 0;
+        res.setControlFields(key, (wid * levels.size()) + level, ((wid + 1) * levels[level].win_len) - 1);
+        this->ff_send_out(new result_t(res));
+#if defined (TRACE_WINDFLOW)
+        stats_record.outputs_sent++;
+        stats_record.bytes_sent += sizeof(result_t);
+#endif
+        if (level + 1 < levels.size()) {
+            addToLevel(key, key_d, level + 1, res);
+        }
+    }
+
+    // combine a result of the previous level into the open window of a level
+    void addToLevel(key_t key, Key_Descriptor &key_d, size_t level, const result_t &r)
+    {
+        Level_Descriptor &level_d = key_d.levels[level];
+        if (level_d.count == 0) {
+            level_d.acc = r;
+        }
+        else {
+            result_t out;
+            out.setControlFields(key, 0, std::get<2>(r.getControlFields()));
+            (levels[level].comb_func)(level_d.acc, r, out, context);
+            level_d.acc = out;
+        }
+        level_d.count++;
+        // the window of the level is complete
+        if (level_d.count == levels[level].ratio) {
+            emitWindow(key, key_d, level, level_d.acc);
+        }
+    }
+
+    // close the windows of the first level of all the keys completed by the watermark and forward it
+    void processWatermark(uint64_t _wm)
+    {
+        for (auto &k: keyMap) {
+            closeWindows(k.first, k.second, _wm / levels[0].win_len);
+        }
+        this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(_wm)));
+    }
+
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        eos_received++;
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            processWatermark(wm_merger.get());
+        }
+        // check the number of received EOS messages
+        if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
+            return;
+        }
+        // last check of the timers of the replica
+        context.pollTimers();
+        // iterate over all the keys
+        for (auto &k: keyMap) {
+            auto key = k.first;
+            auto &key_d = k.second;
+            // close all the windows of the first level still open
+            closeWindows(key, key_d, (key_d.ring).getLast() + 1);
+            // emit the partial windows of the other levels
+            for (size_t l=1; l<levels.size(); l++) {
+                if ((key_d.levels[l]).count > 0) {
+                    emitWindow(key, key_d, l, (key_d.levels[l]).acc);
+                }
+            }
+        }
+        terminated = true;
+#if defined (TRACE_WINDFLOW)
+        stats_record.set_Terminated();
+#endif
+    }
+
+    // svc_end method (utilized by the FastFlow runtime)
+    void svc_end() override
+    {
+        // call the closing function
+        closing_func(context);
+    }
+
+    // method to return the number of ignored tuples by this node
+    size_t getNumIgnoredTuples() const
+    {
+        return ignored_tuples;
+    }
+
+    // method the check the termination of the replica
+    bool isTerminated() const
+    {
+        return terminated;
+    }
+
+#if defined (TRACE_WINDFLOW)
+    // method to return a copy of the Stats_Record of this node
+    Stats_Record get_StatsRecord() const
+    {
+        return stats_record;
+    }
+#endif
+
+    // method to start the node execution asynchronously
+    int run(bool) override
+    {
+        return ff::ff_minode::run();
+    }
+
+    // method to wait the node termination
+    int wait() override
+    {
+        return ff::ff_minode::wait();
+    }
+};
+
+} // namespace wf
+
+#endif
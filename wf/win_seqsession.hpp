@@ -0,0 +1,618 @@
+/******************************************************************************
+ *  This program is free software; you can redistribute it and/or modify it
+ *  under the terms of the GNU Lesser General Public License version 3 as
+ *  published by the Free Software Foundation.
+ *  
+ *  This program is distributed in the hope that it will be useful, but WITHOUT
+ *  ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+ *  FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public
+ *  License for more details.
+ *  
+ *  You should have received a copy of the GNU Lesser General Public License
+ *  along with this program; if not, write to the Free Software Foundation,
+ *  Inc., 59 Temple Place - Suite 330, Boston, MA 02111-1307, USA.
+ ******************************************************************************
+ */ 
+
+/** 
+ *  @file    win_seqsession.hpp
+ *  @author  Gabriele Mencagli
+ *  @date    22/10/2020
+ *  
+ *  @brief Win_SeqSession node executing keyed session windows on a multi-core CPU
+ *  
+ *  @section Win_SeqSession (Description)
+ *  
+ *  This file implements the Win_SeqSession node able to execute session windows on a
+ *  CPU core. A session of a key groups the tuples whose timestamps are closer than the
+ *  gap, and optionally it cannot last more than a maximum duration. The open sessions
+ *  of each key are kept in an ordered map of disjoint intervals, which are merged when
+ *  an out-of-order tuple fills the gap between them. The descriptor of a key is removed
+ *  as soon as it has no open session.
+ *  
+ *  A session is fired when the watermark of the node (the highest timestamp received
+ *  minus the triggering delay) exceeds its last timestamp plus the gap (or its start
+ *  plus the maximum duration), or at the end of the stream. The identifier of each
+ *  result is the timestamp of the first tuple of the session, and its timestamp is the
+ *  one of the last tuple.
+ *  
+ *  With incremental functions, the partial results of two sessions merged by a tuple
+ *  received out-of-order are combined with the combine function of the node. Without
+ *  it, the sessions cannot be merged, so the inputs must be ordered (see Key_Session).
+ *  
+ *  The template parameters tuple_t and result_t must be default constructible, with
+ *  a copy Constructor and a copy assignment operator, and they must provide and implement
+ *  the setControlFields() and getControlFields() methods.
+ */ 
+
+#ifndef WIN_SEQSESSION_H
+#define WIN_SEQSESSION_H
+
+// includes
+#include<map>
+#include<deque>
+#include<queue>
+#include<vector>
+#include<string>
+#include<functional>
+#include<unordered_map>
+#include<ff/node.hpp>
+#include<ff/multinode.hpp>
+#include<basic.hpp>
+#include<context.hpp>
+#include<iterable.hpp>
+#include<watermark.hpp>
+#include<placement.hpp>
+#if defined (TRACE_WINDFLOW)
+    #include<stats_record.hpp>
+#endif
+
+namespace wf {
+
+// Win_SeqSession class
+template<typename tuple_t, typename result_t>
+class Win_SeqSession: public ff::ff_minode_t<tuple_t, result_t>
+{
+public:
+    // type of the non-incremental session processing function
+    using win_func_t = std::function<void(uint64_t, const Iterable<tuple_t> &, result_t &)>;
+    // type of the rich non-incremental session processing function
+    using rich_win_func_t = std::function<void(uint64_t, const Iterable<tuple_t> &, result_t &, RuntimeContext &)>;
+    // type of the incremental session processing function
+    using winupdate_func_t = std::function<void(uint64_t, const tuple_t &, result_t &)>;
+    // type of the rich incremental session processing function
+    using rich_winupdate_func_t = std::function<void(uint64_t, const tuple_t &, result_t &, RuntimeContext &)>;
+    // type of the function combining the partial results of two sessions (incremental functions only)
+    using winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &)>;
+    // type of the rich function combining the partial results of two sessions (incremental functions only)
+    using rich_winComb_func_t = std::function<void(const result_t &, const result_t &, result_t &, RuntimeContext &)>;
+    // type of the closing function
+    using closing_func_t = std::function<void(RuntimeContext &)>;
+
+private:
+    tuple_t tmp; // never used
+    // key data type
+    using key_t = typename std::remove_reference<decltype(std::get<0>(tmp.getControlFields()))>::type;
+    // friendships with other classes in the library
+    template<typename T1, typename T2>
+    friend class Key_Session;
+    // struct of an open session
+    struct Session
+    {
+        uint64_t end; // timestamp of the last tuple of the session
+        std::deque<tuple_t> tuples; // tuples of the session ordered by timestamp (non-incremental functions only)
+        result_t result; // partial result of the session (incremental functions only)
+    };
+    // struct of a key descriptor
+    struct Key_Descriptor
+    {
+        std::map<uint64_t, Session> sessions; // open sessions of the key indexed by their starting timestamp
+    };
+    // struct of a timer of an open session
+    struct Timer
+    {
+        uint64_t time; // firing time of the session (it may be postponed)
+        key_t key; // key of the session
+        uint64_t start; // starting timestamp of the session
+
+        // operator > used to order the timers
+        bool operator>(const Timer &_other) const
+        {
+            return time > _other.time;
+        }
+    };
+    win_func_t win_func; // function for the non-incremental session processing
+    rich_win_func_t rich_win_func; // rich function for the non-incremental session processing
+    winupdate_func_t winupdate_func; // function for the incremental session processing
+    rich_winupdate_func_t rich_winupdate_func; // rich function for the incremental session processing
+    rich_winComb_func_t comb_func; // function combining the partial results of two merged sessions (incremental functions only, it can be empty)
+    closing_func_t closing_func; // closing function
+    uint64_t gap; // session gap in time units
+    uint64_t max_duration; // maximum duration of a session in time units (zero means no limit)
+    uint64_t triggering_delay; // triggering delay in time units
+    std::string name; // string of the unique name of the node
+    bool isNIC; // this flag is true if the node is instantiated with a non-incremental function
+    bool isRich; // flag stating whether the function to be used is riched
+    RuntimeContext context; // RuntimeContext
+    std::unordered_map<key_t, Key_Descriptor> keyMap; // hash table that maps a descriptor for each key with open sessions
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers; // min-heap of the timers of the open sessions
+    uint64_t max_ts; // highest timestamp received so far
+    uint64_t punct_wm; // most recent watermark received as a punctuation
+    size_t ignored_tuples; // number of ignored tuples
+    size_t eos_received; // number of received EOS messages
+    bool terminated; // true if the replica has finished its work
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
+    Placement_Replica placement; // CPU and NUMA node of the replica (not placed if the operator is not placed by the PipeGraph)
+#if defined (TRACE_WINDFLOW)
+    Stats_Record stats_record;
+    double avg_td_us = 0;
+    double avg_ts_us = 0;
+    volatile uint64_t startTD, startTS, endTD, endTS;
+#endif
+
+    // private initialization method
+    void init()
+    {
+        // check the validity of the session parameters
+        if (gap == 0) {
+            std::cerr << RED << "WindFlow Error: session gap cannot be zero" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+        if (max_duration > 0 && max_duration < gap) {
+            std::cerr << RED << "WindFlow Error: maximum duration of a session cannot be smaller than the gap" << DEFAULT_COLOR << std::endl;
+            exit(EXIT_FAILURE);
+        }
+    }
+
+    // compute the firing time of an open session
+    uint64_t getFiringTime(uint64_t _start, const Session &_s) const
+    {
+        uint64_t time = _s.end + gap;
+        if (max_duration > 0 && _start + max_duration < time) {
+            time = _start + max_duration;
+        }
+        return time;
+    }
+
+    // add a tuple to an open session
+    void addTuple(key_t key, uint64_t start, Session &s, const tuple_t &t, uint64_t ts)
+    {
+        if (isNIC) {
+            // tuples are appended unless they are received out-of-order
+            if ((s.tuples).empty() || ts >= std::get<2>(((s.tuples).back()).getControlFields())) {
+                (s.tuples).push_back(t);
+            }
+            else {
+                auto pos = std::upper_bound((s.tuples).begin(), (s.tuples).end(), ts, [](uint64_t _ts, const tuple_t &_t) {
+                    return _ts < std::get<2>(_t.getControlFields());
+                });
+                (s.tuples).insert(pos, t);
+            }
+        }
+        else {
+            if (!isRich) {
+                winupdate_func(start, t, s.result);
+            }
+            else {
+                rich_winupdate_func(start, t, s.result, context);
+            }
+        }
+        if (ts > s.end) {
+            s.end = ts;
+        }
+    }
+
+    // append the content of a session to the one of the session preceding it
+    void mergeSession(key_t key, uint64_t start, Session &s, Session &next)
+    {
+        if (isNIC) {
+            // tuples of the next session all follow the ones of the previous session
+            for (auto &t: next.tuples) {
+                (s.tuples).push_back(std::move(t));
+            }
+        }
+        else {
+            result_t out;
+            out.setControlFields(key, start, std::max(s.end, next.end));
+            comb_func(s.result, next.result, out, context);
+            s.result = out;
+        }
+        s.end = std::max(s.end, next.end);
+    }
+
+    // insert a tuple in the open sessions of its key (merging sessions if necessary)
+    void insertTuple(key_t key, Key_Descriptor &key_d, const tuple_t &t, uint64_t ts)
+    {
+        auto &sessions = key_d.sessions;
+        auto next = sessions.upper_bound(ts); // first session starting after ts
+        auto prev = (next != sessions.begin()) ? std::prev(next) : sessions.end(); // last session starting before or at ts
+        bool joinPrev = (prev != sessions.end()) && (ts < (prev->second).end + gap) && (max_duration == 0 || ts < prev->first + max_duration);
+        bool joinNext = (next != sessions.end()) && (next->first < ts + gap) && (max_duration == 0 || (next->second).end < ts + max_duration);
+        // the tuple fills the gap between two sessions
+        if (joinPrev && joinNext) {
+            if (canMerge() && (max_duration == 0 || (next->second).end < prev->first + max_duration)) {
+                addTuple(key, prev->first, prev->second, t, ts);
+                mergeSession(key, prev->first, prev->second, next->second);
+                sessions.erase(next); // its timer becomes stale
+#if defined (TRACE_WINDFLOW)
+                stats_record.sessions_merged++;
+#endif
+                return;
+            }
+            // the two sessions cannot be merged (the merged one would last more than the maximum duration)
+            joinNext = false;
+        }
+        if (joinPrev) {
+            addTuple(key, prev->first, prev->second, t, ts);
+        }
+        else if (joinNext) {
+            // the session starts earlier, so its key in the map must be changed
+            auto node = sessions.extract(next);
+            node.key() = ts;
+            auto it = sessions.insert(std::move(node)).position;
+            addTuple(key, ts, it->second, t, ts);
+            // the timer of the old starting timestamp becomes stale
+            timers.push(Timer{getFiringTime(ts, it->second), key, ts});
+        }
+        else {
+            // open a new session
+            Session s;
+            s.end = ts;
+            if (!isNIC) {
+                (s.result).setControlFields(key, ts, ts);
+            }
+            auto it = sessions.insert(std::make_pair(ts, std::move(s))).first;
+            addTuple(key, ts, it->second, t, ts);
+            timers.push(Timer{getFiringTime(ts, it->second), key, ts});
+#if defined (TRACE_WINDFLOW)
+            stats_record.sessions_opened++;
+#endif
+        }
+    }
+
+    // fire all the sessions whose firing time is not greater than the watermark
+    void fireSessions(uint64_t watermark)
+    {
+        while (!timers.empty() && (timers.top()).time <= watermark) {
+            Timer timer = timers.top();
+            timers.pop();
+            // check whether the timer is stale
+            auto it = keyMap.find(timer.key);
+            if (it == keyMap.end()) {
+                continue;
+            }
+            auto &sessions = ((*it).second).sessions;
+            auto it2 = sessions.find(timer.start);
+            if (it2 == sessions.end()) {
+                continue;
+            }
+            // the session has been extended after the creation of the timer
+            uint64_t time = getFiringTime(it2->first, it2->second);
+            if (time > watermark) {
+                timers.push(Timer{time, timer.key, timer.start});
+                continue;
+            }
+            emitSession(timer.key, it2->first, it2->second);
+            sessions.erase(it2);
+            // inactive keys do not keep any state
+            if (sessions.empty()) {
+                keyMap.erase(it);
+            }
+        }
+    }
+
+    // fire the sessions completed by a watermark received as a punctuation and forward it
+    void processWatermark(uint64_t _wm)
+    {
+        punct_wm = _wm;
+        fireSessions(punct_wm);
+#if defined (TRACE_WINDFLOW)
+        stats_record.active_keys = keyMap.size();
+#endif
+        this->ff_send_out(reinterpret_cast<result_t *>(wm_merger.createPunctuation(_wm)));
+    }
+
+    // compute and send the result of a session
+    void emitSession(key_t key, uint64_t start, Session &s)
+    {
+        result_t *out;
+        if (isNIC) {
+            out = new result_t();
+            out->setControlFields(key, start, s.end);
+            Iterable<tuple_t> iter((s.tuples).begin(), (s.tuples).end());
+            if (!isRich) {
+                win_func(start, iter, *out);
+            }
+            else {
+                rich_win_func(start, iter, *out, context);
+            }
+        }
+        else {
+            out = new result_t(s.result);
+        }
+        out->setControlFields(key, start, s.end);
+        this->ff_send_out(out);
+#if defined (TRACE_WINDFLOW)
+        stats_record.outputs_sent++;
+        stats_record.bytes_sent += sizeof(result_t);
+#endif
+    }
+
+    // method to set the function combining the partial results of two merged sessions (incremental functions only)
+    void setCombineFunction(rich_winComb_func_t _comb_func)
+    {
+        comb_func = _comb_func;
+    }
+
+    // check whether two open sessions bridged by a tuple can be merged
+    bool canMerge() const
+    {
+        return isNIC || comb_func;
+    }
+
+    // method to set the CPU and NUMA node of the replica
+    void setPlacement(Placement_Replica _placement)
+    {
+        placement = _placement;
+    }
+
+public:
+    // convert a combine function into a rich combine function
+    static rich_winComb_func_t toRichComb(winComb_func_t _f)
+    {
+        return [_f](const result_t &r1, const result_t &r2, result_t &out, RuntimeContext &) { _f(r1, r2, out); };
+    }
+
+    // convert a rich combine function (nothing to do)
+    static rich_winComb_func_t toRichComb(rich_winComb_func_t _f)
+    {
+        return _f;
+    }
+
+    // Constructor I
+    Win_SeqSession(win_func_t _win_func,
+                   uint64_t _gap,
+                   uint64_t _max_duration,
+                   uint64_t _triggering_delay,
+                   std::string _name,
+                   closing_func_t _closing_func,
+                   RuntimeContext _context):
+                   win_func(_win_func),
+                   closing_func(_closing_func),
+                   gap(_gap),
+                   max_duration(_max_duration),
+                   triggering_delay(_triggering_delay),
+                   name(_name),
+                   isNIC(true),
+                   isRich(false),
+                   context(_context),
+                   max_ts(0),
+                   punct_wm(0),
+                   ignored_tuples(0),
+                   eos_received(0),
+                   terminated(false)
+    {
+        init();
+    }
+
+    // Constructor II
+    Win_SeqSession(rich_win_func_t _rich_win_func,
+                   uint64_t _gap,
+                   uint64_t _max_duration,
+                   uint64_t _triggering_delay,
+                   std::string _name,
+                   closing_func_t _closing_func,
+                   RuntimeContext _context):
+                   rich_win_func(_rich_win_func),
+                   closing_func(_closing_func),
+                   gap(_gap),
+                   max_duration(_max_duration),
+                   triggering_delay(_triggering_delay),
+                   name(_name),
+                   isNIC(true),
+                   isRich(true),
+                   context(_context),
+                   max_ts(0),
+                   punct_wm(0),
+                   ignored_tuples(0),
+                   eos_received(0),
+                   terminated(false)
+    {
+        init();
+    }
+
+    // Constructor III
+    Win_SeqSession(winupdate_func_t _winupdate_func,
+                   uint64_t _gap,
+                   uint64_t _max_duration,
+                   uint64_t _triggering_delay,
+                   std::string _name,
+                   closing_func_t _closing_func,
+                   RuntimeContext _context):
+                   winupdate_func(_winupdate_func),
+                   closing_func(_closing_func),
+                   gap(_gap),
+                   max_duration(_max_duration),
+                   triggering_delay(_triggering_delay),
+                   name(_name),
+                   isNIC(false),
+                   isRich(false),
+                   context(_context),
+                   max_ts(0),
+                   punct_wm(0),
+                   ignored_tuples(0),
+                   eos_received(0),
+                   terminated(false)
+    {
+        init();
+    }
+
+    // Constructor IV
+    Win_SeqSession(rich_winupdate_func_t _rich_winupdate_func,
+                   uint64_t _gap,
+                   uint64_t _max_duration,
+                   uint64_t _triggering_delay,
+                   std::string _name,
+                   closing_func_t _closing_func,
+                   RuntimeContext _context):
+                   rich_winupdate_func(_rich_winupdate_func),
+                   closing_func(_closing_func),
+                   gap(_gap),
+                   max_duration(_max_duration),
+                   triggering_delay(_triggering_delay),
+                   name(_name),
+                   isNIC(false),
+                   isRich(true),
+                   context(_context),
+                   max_ts(0),
+                   punct_wm(0),
+                   ignored_tuples(0),
+                   eos_received(0),
+                   terminated(false)
+    {
+        init();
+    }
+
+    // svc_init method (utilized by the FastFlow runtime)
+    int svc_init() override
+    {
+        // bind the replica to its CPU before it allocates its state
+        placement.bind();
+#if defined (TRACE_WINDFLOW)
+        stats_record = Stats_Record(name, std::to_string(this->get_my_id()), true, false);
+        stats_record.cpu = placement.getCPU();
+        stats_record.numa_node = placement.getNode();
+        stats_record.isSessionOP = true;
+#endif
+        return 0;
+    }
+
+    // svc method (utilized by the FastFlow runtime)
+    result_t *svc(tuple_t *t) override
+    {
+        // execute the callbacks of the expired timers of the replica
+        context.pollTimers();
+        // watermarks fire the sessions completed by them and are forwarded
+        if (isWatermark(t)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(t))) {
+                processWatermark(wm_merger.get());
+            }
+            return this->GO_ON;
+        }
+#if defined (TRACE_WINDFLOW)
+        startTS = current_time_nsecs();
+        if (stats_record.inputs_received == 0) {
+            startTD = current_time_nsecs();
+        }
+        stats_record.inputs_received++;
+        stats_record.bytes_received += sizeof(tuple_t);
+#endif
+        // extract the key and timestamp fields from the input tuple
+        auto key = std::get<0>(t->getControlFields()); // key
+        uint64_t ts = std::get<2>(t->getControlFields()); // timestamp
+        if (ts > max_ts) {
+            max_ts = ts;
+        }
+        uint64_t watermark = (max_ts >= triggering_delay) ? max_ts - triggering_delay : 0;
+        watermark = std::max(watermark, punct_wm);
+        // tuples older than the watermark might belong to sessions already fired
+        if (ts < watermark) {
+#if defined (TRACE_WINDFLOW)
+            stats_record.inputs_ignored++;
+#endif
+            ignored_tuples++;
+            delete t;
+            return this->GO_ON;
+        }
+        // fire the sessions that cannot receive this tuple or any other future tuple
+        fireSessions(watermark);
+        // access the descriptor of the input key
+        insertTuple(key, keyMap[key], *t, ts);
+        // delete the input
+        delete t;
+#if defined (TRACE_WINDFLOW)
+        stats_record.active_keys = keyMap.size();
+        endTS = current_time_nsecs();
+        endTD = current_time_nsecs();
+        double elapsedTS_us = ((double) (endTS - startTS)) / 1000;
+        avg_ts_us += (1.0 / stats_record.inputs_received) * (elapsedTS_us - avg_ts_us);
+        double elapsedTD_us = ((double) (endTD - startTD)) / 1000;
+        avg_td_us += (1.0 / stats_record.inputs_received) * (elapsedTD_us - avg_td_us);
+        stats_record.service_time = std::chrono::duration<double, std::micro>(avg_ts_us);
+        stats_record.eff_service_time = std::chrono::duration<double, std::micro>(avg_td_us);
+        startTD = current_time_nsecs();
+#endif
+        return this->GO_ON;
+    }
+
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        eos_received++;
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            processWatermark(wm_merger.get());
+        }
+        // check the number of received EOS messages
+        if ((eos_received != this->get_num_inchannels()) && (this->get_num_inchannels() != 0)) { // workaround due to FastFlow
+            return;
+        }
+        // last check of the timers of the replica
+        context.pollTimers();
+        // fire all the open sessions of all the keys
+        for (auto &k: keyMap) {
+            for (auto &s: (k.second).sessions) {
+                emitSession(k.first, s.first, s.second);
+            }
+        }
+        keyMap.clear();
+        timers = std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>>();
+        terminated = true;
+#if defined (TRACE_WINDFLOW)
+        stats_record.set_Terminated();
+#endif
+    }
+
+    // svc_end method (utilized by the FastFlow runtime)
+    void svc_end() override
+    {
+        // call the closing function
+        closing_func(context);
+    }
+
+    // method to return the number of ignored tuples by this node
+    size_t getNumIgnoredTuples() const
+    {
+        return ignored_tuples;
+    }
+
+    // method the check the termination of the replica
+    bool isTerminated() const
+    {
+        return terminated;
+    }
+
+#if defined (TRACE_WINDFLOW)
+    // method to return a copy of the Stats_Record of this node
+    Stats_Record get_StatsRecord() const
+    {
+        return stats_record;
+    }
+#endif
+
+    // method to start the node execution asynchronously
+    int run(bool) override
+    {
+        return ff::ff_minode::run();
+    }
+
+    // method to wait the node termination
+    int wait() override
+    {
+        return ff::ff_minode::wait();
+    }
+};
+
+} // namespace wf
+
+#endif
@@ -40,6 +40,10 @@
 #include<win_farm.hpp>
 #include<key_farm.hpp>
 #include<key_ffat.hpp>
+#include<win_ffat.hpp>
+#include<key_mffat.hpp>
+#include<key_rollup.hpp>
+#include<key_session.hpp>
 #include<pane_farm.hpp>
 #include<win_mapreduce.hpp>
 #if defined (TRACE_WINDFLOW)
@@ -48,5 +52,9 @@
 #include<multipipe.hpp>
 #include<pipegraph.hpp>
 #include<sink.hpp>
+#include<partitioners.hpp>
+#include<key_groups.hpp>
+#include<elastic.hpp>
+#include<ondemand.hpp>
 
 #endif
@@ -136,6 +136,7 @@ private:
     triggerer_t triggerer; // triggerer used by the window (it must be compliant with its type)
     win_type_t winType; // type of the window (CB or TB)
     size_t no_tuples; // number of tuples raising a IN event for the window
+    size_t no_tuples_early; // number of tuples of the window when its last early result was produced
     bool batched; // flag stating whether the window is batched or not
     result_t result; // result of the window processing
     std::optional<tuple_t> firstTuple;
@@ -156,6 +157,7 @@ public:
            triggerer(_triggerer),
            winType(_winType),
            no_tuples(0),
+           no_tuples_early(0),
            batched(false)
     {
         // initialize the key, gwid and timestamp of the window result
@@ -176,6 +178,7 @@ public:
         triggerer = win.triggerer;
         winType = win.winType;
         no_tuples = win.no_tuples;
+        no_tuples_early = win.no_tuples_early;
         batched = win.batched;
         result = win.result;
         firstTuple = win.firstTuple;
@@ -250,6 +253,13 @@ public:
         }
     }
 
+    // method to evaluate the status of a time-based window given a watermark (the window can be
+    // fired if the triggerer returns DELAYED or FIRED, since no further tuple of the window will arrive)
+    win_event_t onWatermark(uint64_t _wm) const
+    {
+        return triggerer(_wm);
+    }
+
     // set the window as batched
     void setBatched()
     {
@@ -298,6 +308,18 @@ public:
         return no_tuples;
     }
 
+    // the method returns true if the window has received tuples after its last early result
+    bool hasEarlyUpdates() const
+    {
+        return no_tuples > no_tuples_early;
+    }
+
+    // set the window as updated by an early result
+    void setEarlyFired()
+    {
+        no_tuples_early = no_tuples;
+    }
+
     // the method returns true if the window was batched
     bool isBatched() const
     {
@@ -37,6 +37,7 @@
 #include<ff/multinode.hpp>
 #include<meta.hpp>
 #include<basic_emitter.hpp>
+#include<watermark.hpp>
 
 namespace wf {
 
@@ -56,15 +57,33 @@ private:
     struct Key_Descriptor
     {
         uint64_t rcv_counter; // number of tuples received of this key
-        tuple_t last_tuple; // copy of the last tuple received of this key (the one with highest timestamp)
+        uint64_t last_id; // identifier of the last tuple received of this key (the one with highest id/timestamp)
+        uint64_t last_ts; // timestamp of the last tuple received of this key (the one with highest id/timestamp)
         size_t nextDst; // id of the Win_Seq receiving the next tuple of this key
 
         // Constructor
-        Key_Descriptor(size_t _nextDst): rcv_counter(0), nextDst(_nextDst) {}
+        Key_Descriptor(size_t _nextDst): rcv_counter(0), last_id(0), last_ts(0), nextDst(_nextDst) {}
     };
     std::unordered_map<key_t, Key_Descriptor> keyMap; // hash table that maps a descriptor for each key
     bool isCombined; // true if this node is used within a Tree_Emitter node
     std::vector<std::pair<void *, int>> output_queue; // used in case of Tree_Emitter mode
+    bool announceKeys; // true if the keys must be announced to all the internal operators (watermarks are used)
+
+    // send an EOS marker with the given control fields to all the internal operators
+    void sendEOSMarker(const key_t &_key, uint64_t _id, uint64_t _ts)
+    {
+        tuple_t *t = new tuple_t();
+        t->setControlFields(_key, _id, _ts);
+        wrapper_in_t *wt = new wrapper_in_t(t, map_degree, true); // eos marker enabled
+        for (size_t i=0; i < map_degree; i++) {
+            if (!isCombined) {
+                this->ff_send_out_to(wt, i);
+            }
+            else {
+                output_queue.push_back(std::make_pair(wt, i));
+            }
+        }
+    }
 
 public:
     // Constructor
@@ -72,7 +91,8 @@ public:
                    win_type_t _winType):
                    map_degree(_map_degree),
                    winType(_winType),
-                   isCombined(false) {}
+                   isCombined(false),
+                   announceKeys(false) {}
 
     // clone method
     Basic_Emitter *clone() const override
@@ -90,6 +110,33 @@ public:
     // svc method (utilized by the FastFlow runtime)
     void *svc(void *in) override
     {
+        // watermarks are broadcast to all the internal operators
+        if (isWatermark(in)) {
+            // from now on the keys are announced to all the internal operators (time-based windows only)
+            if (!announceKeys && winType == win_type_t::TB) {
+                announceKeys = true;
+                // EOS markers are sent so that also the internal operators not receiving tuples of a key
+                // can fire the windows of that key on the arrival of the next watermarks
+                for (auto &k: keyMap) {
+                    if ((k.second).rcv_counter > 0) {
+                        sendEOSMarker(k.first, (k.second).last_id, (k.second).last_ts);
+                    }
+                }
+            }
+            for (size_t i=0; i<map_degree; i++) {
+                if (!isCombined) {
+                    this->ff_send_out_to(in, i);
+                }
+                else {
+                    output_queue.push_back(std::make_pair(in, i));
+                }
+            }
+            return this->GO_ON;
+        }
+        // a shared envelope of a split is owned with copy-on-write before being wrapped
+        if constexpr (std::is_same<tuple_t, input_t>::value) {
+            in = ownInput(reinterpret_cast<tuple_t *>(in));
+        }
         input_t *wt = reinterpret_cast<input_t *>(in);
         // extract the key and id/timestamp fields from the input tuple
         tuple_t *t = extractTuple<tuple_t, input_t>(wt);
@@ -104,18 +151,14 @@ public:
             it = keyMap.find(key);
         }
         Key_Descriptor &key_d = (*it).second;
-        // keep track of the last tuple (the one with highest timestamp with that key)
-        if (key_d.rcv_counter == 0) {
-            key_d.rcv_counter++;
-            key_d.last_tuple = *t;
+        // keep track of the control fields of the last tuple (the one with highest id/timestamp with that key)
+        uint64_t last = (winType == win_type_t::CB) ? key_d.last_id : key_d.last_ts;
+        if (key_d.rcv_counter == 0 || id > last) {
+            key_d.last_id = std::get<1>(t->getControlFields());
+            key_d.last_ts = std::get<2>(t->getControlFields());
         }
-        else {
-            key_d.rcv_counter++;
-            // get the id/timestamp of current last_tuple
-            uint64_t last_id = (winType == win_type_t::CB) ? std::get<1>((key_d.last_tuple).getControlFields()) : std::get<2>((key_d.last_tuple).getControlFields());
-            if (id > last_id) {
-                key_d.last_tuple = *t;
-            }
+        if (key_d.rcv_counter++ == 0 && announceKeys) {
+            sendEOSMarker(key, key_d.last_id, key_d.last_ts);
         }
         // delete the input if it is an EOS marker
         if (isEOSMarker<tuple_t, input_t>(*wt)) {
@@ -142,18 +185,8 @@ public:
         for (auto &k: keyMap) {
             Key_Descriptor &key_d = k.second;
             if (key_d.rcv_counter > 0) {
-                // send the last tuple to all the internal operators
-                tuple_t *tuple = new tuple_t();
-                *tuple = key_d.last_tuple;
-                wrapper_in_t *out = new wrapper_in_t(tuple, map_degree, true); // eos marker enabled
-                for (size_t i=0; i < map_degree; i++) {
-                    if (!isCombined) {
-                        this->ff_send_out_to(out, i);
-                    }
-                    else {
-                        output_queue.push_back(std::make_pair(out, i));
-                    }
-                }
+                // send an EOS marker with the control fields of the last tuple to all the internal operators
+                sendEOSMarker(k.first, key_d.last_id, key_d.last_ts);
             }
         }
     }
@@ -218,6 +251,11 @@ public:
     // svc method (utilized by the FastFlow runtime)
     wrapper_in_t *svc(wrapper_in_t *wt) override
     {
+        // watermarks are forwarded to the Win_Seq
+        if (isWatermark(wt)) {
+            this->ff_send_out(wt);
+            return this->GO_ON;
+        }
         // extract the key field from the input tuple
         tuple_t *t = extractTuple<tuple_t, wrapper_in_t>(wt);
         auto key = std::get<0>(t->getControlFields()); // key
@@ -273,6 +311,7 @@ private:
     };
     // hash table that maps key identifiers onto key descriptors
     std::unordered_map<key_t, Key_Descriptor> keyMap;
+    Watermark_Merger wm_merger; // merger of the watermarks received from the input channels
 
 public:
     // svc_init method (utilized by the FastFlow runtime)
@@ -284,6 +323,13 @@ public:
     // svc method (utilized by the FastFlow runtime)
     result_t *svc(result_t *r) override
     {
+        // watermarks are merged among the input channels and forwarded
+        if (isWatermark(r)) {
+            if (wm_merger.update(this->get_channel_id(), this->get_num_inchannels(), getWatermark(r))) {
+                this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+            }
+            return this->GO_ON;
+        }
         // extract key and identifier from the result
         auto key = std::get<0>(r->getControlFields()); // key
         uint64_t wid = std::get<1>(r->getControlFields()); // identifier
@@ -317,6 +363,15 @@ public:
         return this->GO_ON;
     }
 
+    // method to manage the EOS (utilized by the FastFlow runtime)
+    void eosnotify(ssize_t id) override
+    {
+        // the watermark can advance when an input channel is terminated
+        if (wm_merger.close(id, this->get_num_inchannels())) {
+            this->ff_send_out(wm_merger.createPunctuation(wm_merger.get()));
+        }
+    }
+
     // svc_end method (utilized by the FastFlow runtime)
     void svc_end() override {}
 };